@@ -30,6 +30,7 @@ struct Instance {
   std::vector<std::string> GetSinkStreamValues(CS_Sink sink);
   std::vector<std::string> GetSourceStreamValues(CS_Source source);
   void UpdateStreamValues();
+  void UpdateLatencyValues();
 
   wpi::mutex m_mutex;
   std::atomic<int> m_defaultUsbDevice{0};
@@ -203,6 +204,60 @@ void Instance::UpdateStreamValues() {
   }
 }
 
+// Publishes a latency histogram as its count, and mean, median, 95th
+// percentile, and maximum in milliseconds; zeros if nothing was recorded
+static void PutLatencyValue(nt::NetworkTable* table, std::string_view key,
+                            CS_Handle handle, CS_LatencyStage stage) {
+  CS_Status status = 0;
+  auto histogram = cs::GetTelemetryLatency(handle, stage, &status);
+  if (status != CS_OK || histogram.count == 0) {
+    table->GetEntry(key).SetDoubleArray({0.0, 0.0, 0.0, 0.0, 0.0});
+    return;
+  }
+  table->GetEntry(key).SetDoubleArray(
+      {static_cast<double>(histogram.count),
+       histogram.total / 1000.0 / histogram.count,
+       cs::GetLatencyPercentile(histogram, 50) / 1000.0,
+       cs::GetLatencyPercentile(histogram, 95) / 1000.0,
+       histogram.max / 1000.0});
+}
+
+void Instance::UpdateLatencyValues() {
+  std::scoped_lock lock(m_mutex);
+  // Over all the sources...
+  for (const auto& i : m_tables) {
+    auto table = i.second.get();
+    PutLatencyValue(table, "Latency/captureToPut", i.first,
+                    CS_LATENCY_CAPTURE_TO_PUT);
+    PutLatencyValue(table, "Latency/convert", i.first, CS_LATENCY_CONVERT);
+    PutLatencyValue(table, "Latency/encode", i.first, CS_LATENCY_ENCODE);
+  }
+
+  // Over all the sinks...
+  for (const auto& i : m_sinks) {
+    CS_Status status = 0;
+    CS_Sink sink = i.second.GetHandle();
+
+    // Get the source's subtable (if none exists, we're done)
+    CS_Source source = m_fixedSources.lookup(sink);
+    if (source == 0) {
+      source = cs::GetSinkSource(sink, &status);
+    }
+    if (source == 0) {
+      continue;
+    }
+    auto table = m_tables.lookup(source);
+    if (table) {
+      auto prefix = fmt::format("Latency/{}/", i.getKey());
+      PutLatencyValue(table.get(), prefix + "sinkWait", sink,
+                      CS_LATENCY_SINK_WAIT);
+      PutLatencyValue(table.get(), prefix + "captureToSink", sink,
+                      CS_LATENCY_CAPTURE_TO_SINK);
+      PutLatencyValue(table.get(), prefix + "send", sink, CS_LATENCY_SEND);
+    }
+  }
+}
+
 static std::string PixelFormatToString(int pixelFormat) {
   switch (pixelFormat) {
     case cs::VideoMode::PixelFormat::kMJPEG:
@@ -297,6 +352,11 @@ Instance::Instance() {
   // - "modes" (string array): Available video modes
   // - "Property/{Property}" - Property values
   // - "PropertyInfo/{Property}" - Property supporting information
+  // - "Latency/{Stage}" (double array): Count, and mean, median, 95th
+  //   percentile, and maximum latency (ms) of a source stage over the
+  //   telemetry period; only published once cs::SetTelemetryPeriod() is called
+  // - "Latency/{Sink.Name}/{Stage}" (double array): The same, for a sink stage
+  //   of each sink of the source
 
   // Listener for video events
   m_videoListener = cs::VideoListener{
@@ -405,11 +465,14 @@ Instance::Instance() {
             UpdateStreamValues();
             break;
           }
+          case cs::VideoEvent::kTelemetryUpdated:
+            UpdateLatencyValues();
+            break;
           default:
             break;
         }
       },
-      0x4fff, true};
+      0xcfff, true};
 
   // Listener for NetworkTable events
   // We don't currently support changing settings via NT due to
@@ -335,7 +335,10 @@ public class CameraServerJNI {
   //
   public enum TelemetryKind {
     kSourceBytesReceived(1),
-    kSourceFramesReceived(2);
+    kSourceFramesReceived(2),
+    kSourceJpegCacheHits(3),
+    kSourceJpegEncodes(4),
+    kSourceJpegEncodeTime(5);
 
     private final int value;
 
@@ -71,4 +71,16 @@ public class UsbCamera extends VideoCamera {
     CameraServerJNI.setProperty(
         CameraServerJNI.getSourceProperty(m_handle, "connect_verbose"), level);
   }
+
+  /**
+   * Set whether frames reference the camera's capture buffers instead of copying them (zero
+   * copy). A few buffers are lent at a time; when they are all held by frames, further frames are
+   * copied. Only supported on Linux.
+   *
+   * @param enabled true to enable zero copy
+   */
+  public void setZeroCopy(boolean enabled) {
+    CameraServerJNI.setProperty(
+        CameraServerJNI.getSourceProperty(m_handle, "zero_copy"), enabled ? 1 : 0);
+  }
 }
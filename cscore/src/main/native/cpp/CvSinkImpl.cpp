@@ -8,6 +8,7 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <wpi/SmallString.h>
+#include <wpi/timestamp.h>
 
 #include "Handle.h"
 #include "Instance.h"
@@ -58,23 +59,48 @@ uint64_t CvSinkImpl::GrabFrame(cv::Mat& image) {
     return 0;
   }
 
+  auto start = wpi::Now();
   auto frame = source->GetNextFrame();  // blocks
-  if (!frame) {
-    // Bad frame; sleep for 20 ms so we don't consume all processor time.
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
-    return 0;  // signal error
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_SINK_WAIT,
+                                wpi::Now() - start);
+  return GrabFrameImpl(std::move(source), std::move(frame), image, false);
+}
+
+uint64_t CvSinkImpl::GrabFrame(cv::Mat& image, double timeout) {
+  SetEnabled(true);
+
+  auto source = GetSource();
+  if (!source) {
+    // Source disconnected; sleep for one second
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    return 0;
   }
 
-  if (!frame.GetCv(image)) {
-    // Shouldn't happen, but just in case...
-    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  auto start = wpi::Now();
+  auto frame = source->GetNextFrame(timeout);  // blocks
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_SINK_WAIT,
+                                wpi::Now() - start);
+  return GrabFrameImpl(std::move(source), std::move(frame), image, false);
+}
+
+uint64_t CvSinkImpl::GrabFrameDirect(cv::Mat& image) {
+  SetEnabled(true);
+
+  auto source = GetSource();
+  if (!source) {
+    // Source disconnected; sleep for one second
+    std::this_thread::sleep_for(std::chrono::seconds(1));
     return 0;
   }
 
-  return frame.GetTime();
+  auto start = wpi::Now();
+  auto frame = source->GetNextFrame();  // blocks
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_SINK_WAIT,
+                                wpi::Now() - start);
+  return GrabFrameImpl(std::move(source), std::move(frame), image, true);
 }
 
-uint64_t CvSinkImpl::GrabFrame(cv::Mat& image, double timeout) {
+uint64_t CvSinkImpl::GrabFrameDirect(cv::Mat& image, double timeout) {
   SetEnabled(true);
 
   auto source = GetSource();
@@ -84,20 +110,48 @@ uint64_t CvSinkImpl::GrabFrame(cv::Mat& image, double timeout) {
     return 0;
   }
 
+  auto start = wpi::Now();
   auto frame = source->GetNextFrame(timeout);  // blocks
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_SINK_WAIT,
+                                wpi::Now() - start);
+  return GrabFrameImpl(std::move(source), std::move(frame), image, true);
+}
+
+uint64_t CvSinkImpl::GrabFrameImpl(std::shared_ptr<SourceImpl> source,
+                                   Frame frame, cv::Mat& image, bool direct) {
   if (!frame) {
     // Bad frame; sleep for 20 ms so we don't consume all processor time.
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
     return 0;  // signal error
   }
 
-  if (!frame.GetCv(image)) {
+  if (!direct) {
+    if (!frame.GetCv(image)) {
+      // Shouldn't happen, but just in case...
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      return 0;
+    }
+    m_telemetry.RecordSinkLatency(*this, CS_LATENCY_CAPTURE_TO_SINK,
+                                  wpi::Now() - frame.GetTime());
+    return frame.GetTime();
+  }
+
+  Image* rawImage = frame.GetImage(frame.GetOriginalWidth(),
+                                   frame.GetOriginalHeight(), VideoMode::kBGR);
+  if (!rawImage) {
     // Shouldn't happen, but just in case...
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
     return 0;
   }
 
-  return frame.GetTime();
+  // Hold the frame (and its source) so the image data stays valid; this
+  // releases the previously held frame.
+  image = rawImage->AsMat();
+  m_directFrame = std::move(frame);
+  m_directSource = std::move(source);
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_CAPTURE_TO_SINK,
+                                wpi::Now() - m_directFrame.GetTime());
+  return m_directFrame.GetTime();
 }
 
 // Send HTTP response and a stream of JPG-frames
@@ -174,6 +228,25 @@ uint64_t GrabSinkFrameTimeout(CS_Sink sink, cv::Mat& image, double timeout,
   return static_cast<CvSinkImpl&>(*data->sink).GrabFrame(image, timeout);
 }
 
+uint64_t GrabSinkFrameDirect(CS_Sink sink, cv::Mat& image, CS_Status* status) {
+  auto data = Instance::GetInstance().GetSink(sink);
+  if (!data || data->kind != CS_SINK_CV) {
+    *status = CS_INVALID_HANDLE;
+    return 0;
+  }
+  return static_cast<CvSinkImpl&>(*data->sink).GrabFrameDirect(image);
+}
+
+uint64_t GrabSinkFrameTimeoutDirect(CS_Sink sink, cv::Mat& image,
+                                    double timeout, CS_Status* status) {
+  auto data = Instance::GetInstance().GetSink(sink);
+  if (!data || data->kind != CS_SINK_CV) {
+    *status = CS_INVALID_HANDLE;
+    return 0;
+  }
+  return static_cast<CvSinkImpl&>(*data->sink).GrabFrameDirect(image, timeout);
+}
+
 std::string GetSinkError(CS_Sink sink, CS_Status* status) {
   auto data = Instance::GetInstance().GetSink(sink);
   if (!data || (data->kind & SinkMask) == 0) {
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <string_view>
 #include <thread>
 
@@ -36,12 +37,25 @@ class CvSinkImpl : public SinkImpl {
   uint64_t GrabFrame(cv::Mat& image);
   uint64_t GrabFrame(cv::Mat& image, double timeout);
 
+  // Like GrabFrame(), but image refers to the frame's BGR image rather than a
+  // copy.  The frame is held (and its image kept out of the pool) until the
+  // next grab.
+  uint64_t GrabFrameDirect(cv::Mat& image);
+  uint64_t GrabFrameDirect(cv::Mat& image, double timeout);
+
  private:
+  uint64_t GrabFrameImpl(std::shared_ptr<SourceImpl> source, Frame frame,
+                         cv::Mat& image, bool direct);
   void ThreadMain();
 
   std::atomic_bool m_active;  // set to false to terminate threads
   std::thread m_thread;
   std::function<void(uint64_t time)> m_processFrame;
+
+  // Frame returned by the last direct grab, and its source (which the frame
+  // refers to).  Only accessed by the grabbing thread.
+  std::shared_ptr<SourceImpl> m_directSource;
+  Frame m_directFrame;
 };
 
 }  // namespace cs
@@ -9,13 +9,32 @@
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <wpi/timestamp.h>
 
 #include "Instance.h"
 #include "Log.h"
+#include "PixelUtil.h"
 #include "SourceImpl.h"
+#include "Telemetry.h"
 
 using namespace cs;
 
+// Gets the cv::imdecode() flags to decode at 1/scale of the full size; the
+// JPEG decoder does this in its inverse DCT.
+static int GetDecodeFlags(int color, int scale) {
+  bool gray = color == cv::IMREAD_GRAYSCALE;
+  switch (scale) {
+    case 2:
+      return gray ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+    case 4:
+      return gray ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+    case 8:
+      return gray ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+    default:
+      return color;
+  }
+}
+
 Frame::Frame(SourceImpl& source, std::string_view error, Time time)
     : m_impl{source.AllocFrameImpl().release()} {
   m_impl->refcount = 1;
@@ -206,54 +225,32 @@ Image* Frame::ConvertImpl(Image* image, VideoMode::PixelFormat pixelFormat,
   // If the source image is a JPEG, we need to decode it before we can do
   // anything else with it.  Note that if the destination format is JPEG, we
   // still need to do this (unless it was already a JPEG, in which case we
-  // would have returned above).
+  // would have returned above).  Grayscale is decoded directly.
   if (cur->pixelFormat == VideoMode::kMJPEG) {
+    if (pixelFormat == VideoMode::kGray) {
+      return ConvertMJPEGToGray(cur);
+    }
     cur = ConvertMJPEGToBGR(cur);
     if (pixelFormat == VideoMode::kBGR) {
       return cur;
     }
   }
 
-  // Color convert
+  // Color convert.  Each pair of formats is converted directly, except to
+  // JPEG, which is compressed from BGR (or grayscale).
   switch (pixelFormat) {
     case VideoMode::kRGB565:
-      // If source is YUYV or Gray, need to convert to BGR first
       if (cur->pixelFormat == VideoMode::kYUYV) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage =
-                GetExistingImage(cur->width, cur->height, VideoMode::kBGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertYUYVToBGR(cur);
-        }
+        return ConvertYUYVToRGB565(cur);
       } else if (cur->pixelFormat == VideoMode::kGray) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage =
-                GetExistingImage(cur->width, cur->height, VideoMode::kBGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertGrayToBGR(cur);
-        }
+        return ConvertGrayToRGB565(cur);
       }
       return ConvertBGRToRGB565(cur);
     case VideoMode::kGray:
-      // If source is YUYV or RGB565, need to convert to BGR first
       if (cur->pixelFormat == VideoMode::kYUYV) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage =
-                GetExistingImage(cur->width, cur->height, VideoMode::kBGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertYUYVToBGR(cur);
-        }
+        return ConvertYUYVToGray(cur);
       } else if (cur->pixelFormat == VideoMode::kRGB565) {
-        // Check to see if BGR version already exists...
-        if (Image* newImage =
-                GetExistingImage(cur->width, cur->height, VideoMode::kBGR)) {
-          cur = newImage;
-        } else {
-          cur = ConvertRGB565ToBGR(cur);
-        }
+        return ConvertRGB565ToGray(cur);
       }
       return ConvertBGRToGray(cur);
     case VideoMode::kBGR:
@@ -283,19 +280,24 @@ Image* Frame::ConvertImpl(Image* image, VideoMode::PixelFormat pixelFormat,
   return cur;
 }
 
-Image* Frame::ConvertMJPEGToBGR(Image* image) {
+Image* Frame::ConvertMJPEGToBGR(Image* image, int scale) {
   if (!image || image->pixelFormat != VideoMode::kMJPEG) {
     return nullptr;
   }
+  int flags = GetDecodeFlags(cv::IMREAD_COLOR, scale);
+  int width = (image->width + scale - 1) / scale;
+  int height = (image->height + scale - 1) / scale;
 
   // Allocate an BGR image
-  auto newImage =
-      m_impl->source.AllocImage(VideoMode::kBGR, image->width, image->height,
-                                image->width * image->height * 3);
+  auto newImage = m_impl->source.AllocImage(VideoMode::kBGR, width, height,
+                                            width * height * 3);
 
   // Decode
+  auto start = wpi::Now();
   cv::Mat newMat = newImage->AsMat();
-  cv::imdecode(image->AsInputArray(), cv::IMREAD_COLOR, &newMat);
+  cv::imdecode(image->AsInputArray(), flags, &newMat);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -306,19 +308,24 @@ Image* Frame::ConvertMJPEGToBGR(Image* image) {
   return rv;
 }
 
-Image* Frame::ConvertMJPEGToGray(Image* image) {
+Image* Frame::ConvertMJPEGToGray(Image* image, int scale) {
   if (!image || image->pixelFormat != VideoMode::kMJPEG) {
     return nullptr;
   }
+  int flags = GetDecodeFlags(cv::IMREAD_GRAYSCALE, scale);
+  int width = (image->width + scale - 1) / scale;
+  int height = (image->height + scale - 1) / scale;
 
   // Allocate an grayscale image
-  auto newImage =
-      m_impl->source.AllocImage(VideoMode::kGray, image->width, image->height,
-                                image->width * image->height);
+  auto newImage = m_impl->source.AllocImage(VideoMode::kGray, width, height,
+                                            width * height);
 
   // Decode
+  auto start = wpi::Now();
   cv::Mat newMat = newImage->AsMat();
-  cv::imdecode(image->AsInputArray(), cv::IMREAD_GRAYSCALE, &newMat);
+  cv::imdecode(image->AsInputArray(), flags, &newMat);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -340,7 +347,62 @@ Image* Frame::ConvertYUYVToBGR(Image* image) {
                                 image->width * image->height * 3);
 
   // Convert
+  auto start = wpi::Now();
   cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_YUV2BGR_YUYV);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
+
+  // Save the result
+  Image* rv = newImage.release();
+  if (m_impl) {
+    std::scoped_lock lock(m_impl->mutex);
+    m_impl->images.push_back(rv);
+  }
+  return rv;
+}
+
+Image* Frame::ConvertYUYVToGray(Image* image) {
+  if (!image || image->pixelFormat != VideoMode::kYUYV) {
+    return nullptr;
+  }
+
+  // Allocate a Grayscale image
+  auto newImage =
+      m_impl->source.AllocImage(VideoMode::kGray, image->width, image->height,
+                                image->width * image->height);
+
+  // Convert
+  auto start = wpi::Now();
+  cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_YUV2GRAY_YUYV);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
+
+  // Save the result
+  Image* rv = newImage.release();
+  if (m_impl) {
+    std::scoped_lock lock(m_impl->mutex);
+    m_impl->images.push_back(rv);
+  }
+  return rv;
+}
+
+Image* Frame::ConvertYUYVToRGB565(Image* image) {
+  if (!image || image->pixelFormat != VideoMode::kYUYV) {
+    return nullptr;
+  }
+
+  // Allocate a RGB565 image
+  auto newImage =
+      m_impl->source.AllocImage(VideoMode::kRGB565, image->width, image->height,
+                                image->width * image->height * 2);
+
+  // Convert
+  auto start = wpi::Now();
+  cs::ConvertYUYVToRGB565(reinterpret_cast<const uint8_t*>(image->data()),
+                          reinterpret_cast<uint8_t*>(newImage->data()),
+                          image->width * image->height);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -362,7 +424,10 @@ Image* Frame::ConvertBGRToRGB565(Image* image) {
                                 image->width * image->height * 2);
 
   // Convert
+  auto start = wpi::Now();
   cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_RGB2BGR565);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -384,7 +449,37 @@ Image* Frame::ConvertRGB565ToBGR(Image* image) {
                                 image->width * image->height * 3);
 
   // Convert
+  auto start = wpi::Now();
   cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_BGR5652RGB);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
+
+  // Save the result
+  Image* rv = newImage.release();
+  if (m_impl) {
+    std::scoped_lock lock(m_impl->mutex);
+    m_impl->images.push_back(rv);
+  }
+  return rv;
+}
+
+Image* Frame::ConvertRGB565ToGray(Image* image) {
+  if (!image || image->pixelFormat != VideoMode::kRGB565) {
+    return nullptr;
+  }
+
+  // Allocate a Grayscale image
+  auto newImage =
+      m_impl->source.AllocImage(VideoMode::kGray, image->width, image->height,
+                                image->width * image->height);
+
+  // Convert
+  auto start = wpi::Now();
+  cs::ConvertRGB565ToGray(reinterpret_cast<const uint8_t*>(image->data()),
+                          reinterpret_cast<uint8_t*>(newImage->data()),
+                          image->width * image->height);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -406,7 +501,10 @@ Image* Frame::ConvertBGRToGray(Image* image) {
                                 image->width * image->height);
 
   // Convert
+  auto start = wpi::Now();
   cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_BGR2GRAY);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -428,7 +526,35 @@ Image* Frame::ConvertGrayToBGR(Image* image) {
                                 image->width * image->height * 3);
 
   // Convert
+  auto start = wpi::Now();
   cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_GRAY2BGR);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
+
+  // Save the result
+  Image* rv = newImage.release();
+  if (m_impl) {
+    std::scoped_lock lock(m_impl->mutex);
+    m_impl->images.push_back(rv);
+  }
+  return rv;
+}
+
+Image* Frame::ConvertGrayToRGB565(Image* image) {
+  if (!image || image->pixelFormat != VideoMode::kGray) {
+    return nullptr;
+  }
+
+  // Allocate a RGB565 image
+  auto newImage =
+      m_impl->source.AllocImage(VideoMode::kRGB565, image->width, image->height,
+                                image->width * image->height * 2);
+
+  // Convert
+  auto start = wpi::Now();
+  cv::cvtColor(image->AsMat(), newImage->AsMat(), cv::COLOR_GRAY2BGR565);
+  m_impl->source.m_telemetry.RecordSourceLatency(
+      m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -465,8 +591,12 @@ Image* Frame::ConvertBGRToMJPEG(Image* image, int quality) {
   } else {
     m_impl->compressionParams[1] = quality;
   }
+  auto start = wpi::Now();
   cv::imencode(".jpg", image->AsMat(), newImage->vec(),
                m_impl->compressionParams);
+  newImage->jpegQuality = quality;
+  m_impl->source.m_telemetry.RecordSourceJpegEncode(m_impl->source,
+                                                    wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -500,8 +630,12 @@ Image* Frame::ConvertGrayToMJPEG(Image* image, int quality) {
   } else {
     m_impl->compressionParams[1] = quality;
   }
+  auto start = wpi::Now();
   cv::imencode(".jpg", image->AsMat(), newImage->vec(),
                m_impl->compressionParams);
+  newImage->jpegQuality = quality;
+  m_impl->source.m_telemetry.RecordSourceJpegEncode(m_impl->source,
+                                                    wpi::Now() - start);
 
   // Save the result
   Image* rv = newImage.release();
@@ -518,6 +652,11 @@ Image* Frame::GetImageImpl(int width, int height,
   std::scoped_lock lock(m_impl->mutex);
   Image* cur = GetNearestImage(width, height, pixelFormat, requiredJpegQuality);
   if (!cur || cur->Is(width, height, pixelFormat, requiredJpegQuality)) {
+    // JPEG images other than the original were compressed for an earlier
+    // request, and are shared by all requests with the same parameters
+    if (cur && pixelFormat == VideoMode::kMJPEG && cur != m_impl->images[0]) {
+      m_impl->source.m_telemetry.RecordSourceJpegCacheHits(m_impl->source, 1);
+    }
     return cur;
   }
 
@@ -529,9 +668,22 @@ Image* Frame::GetImageImpl(int width, int height,
   // If the source image is a JPEG, we need to decode it before we can do
   // anything else with it.  Note that if the destination format is JPEG, we
   // still need to do this (unless the width/height/compression were the same,
-  // in which case we already returned the existing JPEG above).
+  // in which case we already returned the existing JPEG above).  When the
+  // destination is at most half the size, the decoder scales the image down
+  // by as much as it can (up to 1/8) while still covering the destination,
+  // leaving only the remainder to the resize below.  Grayscale is decoded
+  // directly.
   if (cur->pixelFormat == VideoMode::kMJPEG) {
-    cur = ConvertMJPEGToBGR(cur);
+    int scale = 1;
+    while (scale < 8 && width * scale * 2 <= cur->width &&
+           height * scale * 2 <= cur->height) {
+      scale *= 2;
+    }
+    if (pixelFormat == VideoMode::kGray) {
+      cur = ConvertMJPEGToGray(cur, scale);
+    } else {
+      cur = ConvertMJPEGToBGR(cur, scale);
+    }
   }
 
   // Resize
@@ -542,8 +694,11 @@ Image* Frame::GetImageImpl(int width, int height,
         width * height * (cur->size() / (cur->width * cur->height)));
 
     // Resize
+    auto start = wpi::Now();
     cv::Mat newMat = newImage->AsMat();
     cv::resize(cur->AsMat(), newMat, newMat.size(), 0, 0);
+    m_impl->source.m_telemetry.RecordSourceLatency(
+        m_impl->source, CS_LATENCY_CONVERT, wpi::Now() - start);
 
     // Save the result
     cur = newImage.release();
@@ -4,14 +4,19 @@
 
 #include "HttpCameraImpl.h"
 
+#include <cstring>
+#include <utility>
+
+#include <fmt/format.h>
 #include <wpi/MemAlloc.h>
 #include <wpi/StringExtras.h>
 #include <wpi/timestamp.h>
-#include <wpinet/TCPConnector.h>
+#include <wpinet/uv/GetAddrInfo.h>
+#include <wpinet/uv/Tcp.h>
+#include <wpinet/uv/Timer.h>
 
 #include "Handle.h"
 #include "Instance.h"
-#include "JpegUtil.h"
 #include "Log.h"
 #include "Notifier.h"
 #include "Telemetry.h"
@@ -19,141 +24,171 @@
 
 using namespace cs;
 
-HttpCameraImpl::HttpCameraImpl(std::string_view name, CS_HttpCameraKind kind,
-                               wpi::Logger& logger, Notifier& notifier,
-                               Telemetry& telemetry)
-    : SourceImpl{name, logger, notifier, telemetry}, m_kind{kind} {}
+static constexpr wpi::uv::Timer::Time kRetryDelay{250};
+static constexpr wpi::uv::Timer::Time kMonitorPeriod{1000};
 
-HttpCameraImpl::~HttpCameraImpl() {
-  m_active = false;
-
-  // force wakeup of monitor thread
-  m_monitorCond.notify_one();
-
-  // join monitor thread
-  if (m_monitorThread.joinable()) {
-    m_monitorThread.join();
+// Creates a socket, connects it to the host of a request, and sends the
+// request.  Resolution and connection failures are reported through the
+// socket's error signal.
+static std::shared_ptr<wpi::uv::Tcp> SendRequest(wpi::uv::Loop& loop,
+                                                 const wpi::HttpRequest& req) {
+  auto tcp = wpi::uv::Tcp::Create(loop);
+  if (!tcp) {
+    return nullptr;
   }
 
-  // Close file if it's open
-  {
-    std::scoped_lock lock(m_mutex);
-    if (m_streamConn) {
-      m_streamConn->stream->close();
-    }
-    if (m_settingsConn) {
-      m_settingsConn->stream->close();
+  std::string request =
+      fmt::format("GET /{} HTTP/1.1\r\nHost: {}\r\n", req.path, req.host);
+  if (!req.auth.empty()) {
+    request += fmt::format("Authorization: Basic {}\r\n", req.auth);
+  }
+  request += "\r\n";
+
+  // the resolver may finish after the socket is closed, so only hold a weak
+  // reference to it
+  auto resolver = std::make_shared<wpi::uv::GetAddrInfoReq>();
+  resolver->resolved.connect(
+      [weak = std::weak_ptr{tcp},
+       request = std::move(request)](const addrinfo& addrinfo) {
+        auto tcp = weak.lock();
+        if (!tcp || tcp->IsClosing()) {
+          return;
+        }
+        tcp->Connect(*addrinfo.ai_addr, [h = tcp.get(), request] {
+          h->Write({wpi::uv::Buffer::Dup(request)}, [](auto bufs, auto) {
+            for (auto&& buf : bufs) {
+              buf.Deallocate();
+            }
+          });
+          h->StartRead();
+        });
+      });
+  resolver->error = [weak = std::weak_ptr{tcp}](wpi::uv::Error err) {
+    if (auto tcp = weak.lock()) {
+      tcp->ReportError(err.code());
     }
-  }
-
-  // force wakeup of camera thread in case it's waiting on cv
-  m_sinkEnabledCond.notify_one();
-
-  // join camera thread
-  if (m_streamThread.joinable()) {
-    m_streamThread.join();
-  }
-
-  // force wakeup of settings thread
-  m_settingsCond.notify_one();
+  };
 
-  // join settings thread
-  if (m_settingsThread.joinable()) {
-    m_settingsThread.join();
-  }
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  hints.ai_flags = AI_NUMERICSERV;
+  wpi::uv::GetAddrInfo(loop, resolver, req.host, fmt::format("{}", req.port),
+                       &hints);
+  return tcp;
 }
 
-void HttpCameraImpl::Start() {
-  // Kick off the stream and settings threads
-  m_streamThread = std::thread(&HttpCameraImpl::StreamThreadMain, this);
-  m_settingsThread = std::thread(&HttpCameraImpl::SettingsThreadMain, this);
-  m_monitorThread = std::thread(&HttpCameraImpl::MonitorThreadMain, this);
+HttpCameraImpl::HttpCameraImpl(std::string_view name, CS_HttpCameraKind kind,
+                               wpi::Logger& logger, Notifier& notifier,
+                               Telemetry& telemetry, wpi::EventLoopRunner& loop)
+    : SourceImpl{name, logger, notifier, telemetry},
+      m_loop{loop},
+      m_parser{[this](size_t size) {
+                 return AllocImage(VideoMode::PixelFormat::kMJPEG, 0, 0, size);
+               },
+               [this](auto image) { StreamFrame(std::move(image)); },
+               [this](auto msg) { StreamError(msg); }},
+      m_kind{kind} {
+  m_response.header.connect([this](auto name, auto value) {
+    if (wpi::equals_lower(name, "content-type")) {
+      m_responseContentType = value;
+    }
+  });
+  m_response.headersComplete.connect([this](bool) {
+    // the multipart stream follows; stop the parser there
+    m_responseHeadersDone = true;
+    m_response.Pause(true);
+  });
 }
 
-void HttpCameraImpl::MonitorThreadMain() {
-  while (m_active) {
-    std::unique_lock lock(m_mutex);
-    // sleep for 1 second between checks
-    m_monitorCond.wait_for(lock, std::chrono::seconds(1),
-                           [=] { return !m_active; });
+HttpCameraImpl::~HttpCameraImpl() {
+  m_active = false;
 
-    if (!m_active) {
-      break;
+  // close the connections and timers; callbacks that can still occur after
+  // this don't refer to the camera
+  m_loop.ExecSync([&](wpi::uv::Loop&) {
+    m_streamErrorConn.disconnect();
+    m_streamClosedConn.disconnect();
+    if (m_streamTcp) {
+      m_streamTcp->Close();
     }
-
-    // check to see if we got any frames, and close the stream if not
-    // (this will result in an error at the read point, and ultimately
-    // a reconnect attempt)
-    if (m_streamConn && m_frameCount == 0) {
-      SWARNING("{}", "Monitor detected stream hung, disconnecting");
-      m_streamConn->stream->close();
+    if (m_retryTimer) {
+      m_retryTimer->Close();
     }
-
-    // reset the frame counter
-    m_frameCount = 0;
-  }
-
-  SDEBUG("{}", "Monitor Thread exiting");
+    if (m_monitorTimer) {
+      m_monitorTimer->Close();
+    }
+  });
 }
 
-void HttpCameraImpl::StreamThreadMain() {
-  while (m_active) {
-    SetConnected(false);
-
-    // sleep between retries
-    std::this_thread::sleep_for(std::chrono::milliseconds(250));
-
-    // disconnect if not enabled
-    if (!IsEnabled()) {
-      std::unique_lock lock(m_mutex);
-      if (m_streamConn) {
-        m_streamConn->stream->close();
-      }
-      // Wait for enable
-      m_sinkEnabledCond.wait(lock, [=] { return !m_active || IsEnabled(); });
-      if (!m_active) {
-        return;
-      }
+void HttpCameraImpl::Start() {
+  m_loop.ExecSync([&](wpi::uv::Loop& loop) {
+    m_retryTimer = wpi::uv::Timer::Create(loop);
+    m_monitorTimer = wpi::uv::Timer::Create(loop);
+    if (!m_retryTimer || !m_monitorTimer) {
+      m_retryTimer.reset();
+      return;
     }
+    m_retryTimer->timeout.connect([this] { StreamConnect(); });
+
+    m_monitorTimer->timeout.connect([this] {
+      // check to see if we got any frames, and close the stream if not
+      // (this will result in a reconnect attempt)
+      if (m_streamTcp && m_frameCount == 0) {
+        SWARNING("{}", "Monitor detected stream hung, disconnecting");
+        m_streamTcp->Close();
+      }
 
-    // connect
-    wpi::SmallString<64> boundary;
-    wpi::HttpConnection* conn = DeviceStreamConnect(boundary);
-
-    if (!m_active) {
-      break;
-    }
+      // reset the frame counter
+      m_frameCount = 0;
+    });
 
-    // keep retrying
-    if (!conn) {
-      continue;
-    }
+    Update();
+  });
+}
 
-    // update connected since we're actually connected
-    SetConnected(true);
+// Connects or disconnects the stream as sinks are enabled and disabled or the
+// stream settings change, and sends changed settings to the camera.
+void HttpCameraImpl::Update() {
+  if (!m_active || !m_retryTimer) {
+    return;
+  }
 
-    // stream
-    DeviceStream(conn->is, boundary.str());
-    {
-      std::unique_lock lock(m_mutex);
-      m_streamConn = nullptr;
+  if (m_streamTcp) {
+    if (!IsEnabled() || m_streamSettingsUpdated) {
+      m_streamTcp->Close();  // reconnects if still enabled
     }
+  } else if (IsEnabled() && !m_retryTimer->IsActive()) {
+    m_retryTimer->Start(kRetryDelay);
   }
 
-  SDEBUG("{}", "Camera Thread exiting");
-  SetConnected(false);
+  wpi::HttpRequest req;
+  {
+    std::scoped_lock lock(m_mutex);
+    if (m_prefLocation == -1 || m_settings.empty()) {
+      return;
+    }
+    req = wpi::HttpRequest{m_locations[m_prefLocation], m_settings};
+    m_settings.clear();
+  }
+  DeviceSendSettings(req);
 }
 
-wpi::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
-    wpi::SmallVectorImpl<char>& boundary) {
+void HttpCameraImpl::StreamConnect() {
+  if (!m_active || m_streamTcp || !IsEnabled()) {
+    return;
+  }
+
   // Build the request
   wpi::HttpRequest req;
   {
     std::scoped_lock lock(m_mutex);
     if (m_locations.empty()) {
       SERROR("{}", "locations array is empty!?");
-      std::this_thread::sleep_for(std::chrono::seconds(1));
-      return nullptr;
+      m_retryTimer->Start(wpi::uv::Timer::Time{1000});
+      return;
     }
     if (m_nextLocation >= m_locations.size()) {
       m_nextLocation = 0;
@@ -162,44 +197,88 @@ wpi::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
     m_streamSettingsUpdated = false;
   }
 
-  // Try to connect
-  auto stream =
-      wpi::TCPConnector::connect(req.host.c_str(), req.port, m_logger, 1);
-
-  if (!m_active || !stream) {
-    return nullptr;
+  auto tcp = SendRequest(m_retryTimer->GetLoopRef(), req);
+  if (!tcp) {
+    m_retryTimer->Start(kRetryDelay);
+    return;
   }
-
-  auto connPtr = std::make_unique<wpi::HttpConnection>(std::move(stream), 1);
-  wpi::HttpConnection* conn = connPtr.get();
-
-  // update m_streamConn
-  {
-    std::scoped_lock lock(m_mutex);
-    m_frameCount = 1;  // avoid a race with monitor thread
-    m_streamConn = std::move(connPtr);
+  m_streamTcp = tcp;
+  m_streamHost = req.host;
+  m_response.Reset(wpi::HttpParser::kResponse);
+  m_responseHeadersDone = false;
+  m_responseContentType.clear();
+  m_numErrors = 0;
+
+  // The contents of images are read directly into the image being received;
+  // everything else is read into m_readBuf and parsed from there.
+  tcp->SetBufferAllocator(
+      [this](size_t) {
+        auto buf = m_parser.GetBuffer();
+        if (!m_responseHeadersDone || buf.empty()) {
+          return wpi::uv::Buffer{m_readBuf.data(), m_readBuf.size()};
+        }
+        return wpi::uv::Buffer{buf.data(), buf.size()};
+      },
+      [](wpi::uv::Buffer&) {});
+  tcp->data.connect([this](wpi::uv::Buffer& buf, size_t len) {
+    if (buf.base == m_readBuf.data()) {
+      StreamData({buf.base, len});
+    } else {
+      m_parser.Filled(len);
+    }
+  });
+  tcp->end.connect([h = tcp.get()] { h->Close(); });
+  m_streamErrorConn = tcp->error.connect_connection(
+      [this, h = tcp.get()](wpi::uv::Error err) {
+        SWARNING("\"{}\": {}", m_streamHost, err.str());
+        h->Close();
+      });
+  m_streamClosedConn =
+      tcp->closed.connect_connection([this] { StreamClosed(); });
+
+  // avoid a hung connection attempt or stream; the monitor closes the stream
+  // unless a frame is received in each period after the first
+  m_frameCount = 1;
+  m_monitorTimer->Start(kMonitorPeriod, kMonitorPeriod);
+}
+
+void HttpCameraImpl::StreamData(std::string_view data) {
+  if (!m_responseHeadersDone) {
+    data = m_response.Execute(data);
+    if (!m_responseHeadersDone) {
+      if (m_response.HasError()) {
+        SWARNING("\"{}\": did not receive HTTP response", m_streamHost);
+        m_streamTcp->Close();
+      }
+      return;
+    }
+    if (!StreamStart()) {
+      m_streamTcp->Close();
+      return;
+    }
   }
+  m_parser.Execute(data);
+}
 
-  std::string warn;
-  if (!conn->Handshake(req, &warn)) {
-    SWARNING("{}", warn);
-    std::scoped_lock lock(m_mutex);
-    m_streamConn = nullptr;
-    return nullptr;
+// Checks the response headers and starts parsing the multipart stream
+bool HttpCameraImpl::StreamStart() {
+  if (m_response.GetStatusCode() != 200) {
+    SWARNING("\"{}\": received {} response", m_streamHost,
+             m_response.GetStatusCode());
+    return false;
   }
 
   // Parse Content-Type header to get the boundary
-  auto [mediaType, contentType] = wpi::split(conn->contentType.str(), ';');
+  auto [mediaType, contentType] = wpi::split(m_responseContentType.str(), ';');
   mediaType = wpi::trim(mediaType);
   if (mediaType != "multipart/x-mixed-replace") {
-    SWARNING("\"{}\": unrecognized Content-Type \"{}\"", req.host, mediaType);
-    std::scoped_lock lock(m_mutex);
-    m_streamConn = nullptr;
-    return nullptr;
+    SWARNING("\"{}\": unrecognized Content-Type \"{}\"", m_streamHost,
+             mediaType);
+    return false;
   }
 
   // media parameters
-  boundary.clear();
+  wpi::SmallString<64> boundary;
   while (!contentType.empty()) {
     std::string_view keyvalue;
     std::tie(keyvalue, contentType) = wpi::split(contentType, ';');
@@ -215,162 +294,75 @@ wpi::HttpConnection* HttpCameraImpl::DeviceStreamConnect(
   }
 
   if (boundary.empty()) {
-    SWARNING("\"{}\": empty multi-part boundary or no Content-Type", req.host);
-    std::scoped_lock lock(m_mutex);
-    m_streamConn = nullptr;
-    return nullptr;
-  }
-
-  return conn;
-}
-
-void HttpCameraImpl::DeviceStream(wpi::raw_istream& is,
-                                  std::string_view boundary) {
-  // Stored here so we reuse it from frame to frame
-  std::string imageBuf;
-
-  // keep track of number of bad images received; if we receive 3 bad images
-  // in a row, we reconnect
-  int numErrors = 0;
-
-  // streaming loop
-  while (m_active && !is.has_error() && IsEnabled() && numErrors < 3 &&
-         !m_streamSettingsUpdated) {
-    if (!FindMultipartBoundary(is, boundary, nullptr)) {
-      break;
-    }
-
-    // Read the next two characters after the boundary (normally \r\n)
-    // Handle just \n for LabVIEW however
-    char eol[2];
-    is.read(eol, 1);
-    if (!m_active || is.has_error()) {
-      break;
-    }
-    if (eol[0] != '\n') {
-      is.read(eol + 1, 1);
-      if (!m_active || is.has_error()) {
-        break;
-      }
-      // End-of-stream is indicated with trailing --
-      if (eol[0] == '-' && eol[1] == '-') {
-        break;
-      }
-    }
-
-    if (!DeviceStreamFrame(is, imageBuf)) {
-      ++numErrors;
-    } else {
-      numErrors = 0;
-    }
-  }
-}
-
-bool HttpCameraImpl::DeviceStreamFrame(wpi::raw_istream& is,
-                                       std::string& imageBuf) {
-  // Read the headers
-  wpi::SmallString<64> contentTypeBuf;
-  wpi::SmallString<64> contentLengthBuf;
-  if (!ParseHttpHeaders(is, &contentTypeBuf, &contentLengthBuf)) {
-    SWARNING("{}", "disconnected during headers");
-    PutError("disconnected during headers", wpi::Now());
-    return false;
-  }
-
-  // Check the content type (if present)
-  if (!contentTypeBuf.str().empty() &&
-      !wpi::starts_with(contentTypeBuf, "image/jpeg")) {
-    auto errMsg =
-        fmt::format("received unknown Content-Type \"{}\"", contentTypeBuf);
-    SWARNING("{}", errMsg);
-    PutError(errMsg, wpi::Now());
+    SWARNING("\"{}\": empty multi-part boundary or no Content-Type",
+             m_streamHost);
     return false;
   }
 
-  unsigned int contentLength = 0;
-  if (auto v = wpi::parse_integer<unsigned int>(contentLengthBuf, 10)) {
-    contentLength = v.value();
-  } else {
-    // Ugh, no Content-Length?  Read the blocks of the JPEG file.
-    int width, height;
-    if (!ReadJpeg(is, imageBuf, &width, &height)) {
-      SWARNING("{}", "did not receive a JPEG image");
-      PutError("did not receive a JPEG image", wpi::Now());
-      return false;
-    }
-    PutFrame(VideoMode::PixelFormat::kMJPEG, width, height, imageBuf,
-             wpi::Now());
-    ++m_frameCount;
-    return true;
-  }
+  m_parser.Reset(boundary);
 
-  // We know how big it is!  Just get a frame of the right size and read
-  // the data directly into it.
-  auto image = AllocImage(VideoMode::PixelFormat::kMJPEG, 0, 0, contentLength);
-  is.read(image->data(), contentLength);
-  if (!m_active || is.has_error()) {
-    return false;
-  }
-  int width, height;
-  if (!GetJpegSize(image->str(), &width, &height)) {
-    SWARNING("{}", "did not receive a JPEG image");
-    PutError("did not receive a JPEG image", wpi::Now());
-    return false;
-  }
-  image->width = width;
-  image->height = height;
-  PutFrame(std::move(image), wpi::Now());
-  ++m_frameCount;
+  // update connected since we're actually connected
+  SetConnected(true);
   return true;
 }
 
-void HttpCameraImpl::SettingsThreadMain() {
-  for (;;) {
-    wpi::HttpRequest req;
-    {
-      std::unique_lock lock(m_mutex);
-      m_settingsCond.wait(lock, [=] {
-        return !m_active || (m_prefLocation != -1 && !m_settings.empty());
-      });
-      if (!m_active) {
-        break;
-      }
-
-      // Build the request
-      req = wpi::HttpRequest{m_locations[m_prefLocation], m_settings};
-    }
-
-    DeviceSendSettings(req);
-  }
-
-  SDEBUG("{}", "Settings Thread exiting");
+void HttpCameraImpl::StreamFrame(std::unique_ptr<Image> image) {
+  m_numErrors = 0;
+  ++m_frameCount;
+  PutFrame(std::move(image), wpi::Now());
 }
 
-void HttpCameraImpl::DeviceSendSettings(wpi::HttpRequest& req) {
-  // Try to connect
-  auto stream =
-      wpi::TCPConnector::connect(req.host.c_str(), req.port, m_logger, 1);
-
-  if (!m_active || !stream) {
-    return;
+void HttpCameraImpl::StreamError(std::string_view msg) {
+  SWARNING("{}", msg);
+  PutError(msg, wpi::Now());
+  if (++m_numErrors >= 3) {
+    m_streamTcp->Close();  // reconnect
   }
+}
 
-  auto connPtr = std::make_unique<wpi::HttpConnection>(std::move(stream), 1);
-  wpi::HttpConnection* conn = connPtr.get();
+void HttpCameraImpl::StreamClosed() {
+  m_streamErrorConn.disconnect();
+  m_streamTcp.reset();
+  m_monitorTimer->Stop();
+  SetConnected(false);
 
-  // update m_settingsConn
-  {
-    std::scoped_lock lock(m_mutex);
-    m_settingsConn = std::move(connPtr);
+  // sleep between retries
+  if (m_active && IsEnabled()) {
+    m_retryTimer->Start(kRetryDelay);
   }
+}
 
-  // Just need a handshake as settings are sent via GET parameters
-  std::string warn;
-  if (!conn->Handshake(req, &warn)) {
-    SWARNING("{}", warn);
+void HttpCameraImpl::DeviceSendSettings(const wpi::HttpRequest& req) {
+  auto tcp = SendRequest(m_retryTimer->GetLoopRef(), req);
+  if (!tcp) {
+    return;
   }
 
-  conn->stream->close();
+  // Just need a response as settings are sent via GET parameters.  The
+  // connection closes itself and may outlive the camera, so the callbacks
+  // don't refer to it.
+  auto response =
+      std::make_shared<wpi::HttpParser>(wpi::HttpParser::kResponse);
+  response->headersComplete.connect(
+      [&logger = m_logger, name = std::string{GetName()}, h = tcp.get(),
+       r = response.get(), host = std::string{req.host}](bool) {
+        if (r->GetStatusCode() != 200) {
+          NamedLog(logger, ::wpi::WPI_LOG_WARNING, __FILE__, __LINE__, name,
+                   FMT_STRING("\"{}\": received {} response to settings"),
+                   host, r->GetStatusCode());
+        }
+        h->Close();
+      });
+  tcp->data.connect(
+      [h = tcp.get(), r = response.get()](wpi::uv::Buffer& buf, size_t len) {
+        r->Execute({buf.base, len});
+        if (r->HasError()) {
+          h->Close();
+        }
+      });
+  tcp->end.connect([h = tcp.get()] { h->Close(); });
+  tcp->error.connect([h = tcp.get()](wpi::uv::Error) { h->Close(); });
+  tcp->SetData(response);
 }
 
 CS_HttpCameraKind HttpCameraImpl::GetKind() const {
@@ -392,10 +384,13 @@ bool HttpCameraImpl::SetUrls(wpi::span<const std::string> urls,
     }
   }
 
-  std::scoped_lock lock(m_mutex);
-  m_locations.swap(locations);
-  m_nextLocation = 0;
-  m_streamSettingsUpdated = true;
+  {
+    std::scoped_lock lock(m_mutex);
+    m_locations.swap(locations);
+    m_nextLocation = 0;
+    m_streamSettingsUpdated = true;
+  }
+  m_loop.ExecAsync([this](wpi::uv::Loop&) { Update(); });
   return true;
 }
 
@@ -513,9 +508,12 @@ bool HttpCameraImpl::SetVideoMode(const VideoMode& mode, CS_Status* status) {
   if (mode.pixelFormat != VideoMode::kMJPEG) {
     return false;
   }
-  std::scoped_lock lock(m_mutex);
-  m_mode = mode;
-  m_streamSettingsUpdated = true;
+  {
+    std::scoped_lock lock(m_mutex);
+    m_mode = mode;
+    m_streamSettingsUpdated = true;
+  }
+  m_loop.ExecAsync([this](wpi::uv::Loop&) { Update(); });
   return true;
 }
 
@@ -524,7 +522,7 @@ void HttpCameraImpl::NumSinksChanged() {
 }
 
 void HttpCameraImpl::NumSinksEnabledChanged() {
-  m_sinkEnabledCond.notify_one();
+  m_loop.ExecAsync([this](wpi::uv::Loop&) { Update(); });
 }
 
 bool AxisCameraImpl::CacheProperties(CS_Status* status) const {
@@ -563,12 +561,13 @@ CS_Source CreateHttpCamera(std::string_view name, std::string_view url,
   std::shared_ptr<HttpCameraImpl> source;
   switch (kind) {
     case CS_HTTP_AXIS:
-      source = std::make_shared<AxisCameraImpl>(name, inst.logger,
-                                                inst.notifier, inst.telemetry);
+      source = std::make_shared<AxisCameraImpl>(
+          name, inst.logger, inst.notifier, inst.telemetry, inst.eventLoop);
       break;
     default:
-      source = std::make_shared<HttpCameraImpl>(name, kind, inst.logger,
-                                                inst.notifier, inst.telemetry);
+      source = std::make_shared<HttpCameraImpl>(
+          name, kind, inst.logger, inst.notifier, inst.telemetry,
+          inst.eventLoop);
       break;
   }
   std::string urlStr{url};
@@ -586,8 +585,8 @@ CS_Source CreateHttpCamera(std::string_view name,
     *status = CS_EMPTY_VALUE;
     return 0;
   }
-  auto source = std::make_shared<HttpCameraImpl>(name, kind, inst.logger,
-                                                 inst.notifier, inst.telemetry);
+  auto source = std::make_shared<HttpCameraImpl>(
+      name, kind, inst.logger, inst.notifier, inst.telemetry, inst.eventLoop);
   if (!source->SetUrls(urls, status)) {
     return 0;
   }
@@ -5,31 +5,42 @@
 #ifndef CSCORE_HTTPCAMERAIMPL_H_
 #define CSCORE_HTTPCAMERAIMPL_H_
 
+#include <array>
 #include <atomic>
 #include <functional>
 #include <initializer_list>
 #include <memory>
 #include <string>
 #include <string_view>
-#include <thread>
 #include <vector>
 
+#include <wpi/Signal.h>
 #include <wpi/SmallString.h>
 #include <wpi/StringMap.h>
-#include <wpi/condition_variable.h>
-#include <wpi/raw_istream.h>
 #include <wpi/span.h>
+#include <wpinet/EventLoopRunner.h>
+#include <wpinet/HttpParser.h>
 #include <wpinet/HttpUtil.h>
 
+#include "MjpegStreamParser.h"
 #include "SourceImpl.h"
 #include "cscore_cpp.h"
 
+namespace wpi::uv {
+class Tcp;
+class Timer;
+}  // namespace wpi::uv
+
 namespace cs {
 
+// The streams of all HTTP cameras are received by a single event loop.  The
+// multipart stream is parsed as it arrives, and the contents of each image
+// are read directly into an image from the source's pool.
 class HttpCameraImpl : public SourceImpl {
  public:
   HttpCameraImpl(std::string_view name, CS_HttpCameraKind kind,
-                 wpi::Logger& logger, Notifier& notifier, Telemetry& telemetry);
+                 wpi::Logger& logger, Notifier& notifier, Telemetry& telemetry,
+                 wpi::EventLoopRunner& loop);
   ~HttpCameraImpl() override;
 
   void Start() override;
@@ -96,60 +107,73 @@ class HttpCameraImpl : public SourceImpl {
                           std::initializer_list<T> choices) const;
 
  private:
-  // The camera streaming thread
-  void StreamThreadMain();
+  // Called on the loop thread
+  void Update();
+  void StreamConnect();
+  void StreamData(std::string_view data);
+  bool StreamStart();
+  void StreamFrame(std::unique_ptr<Image> image);
+  void StreamError(std::string_view msg);
+  void StreamClosed();
+  void DeviceSendSettings(const wpi::HttpRequest& req);
 
-  // Functions used by StreamThreadMain()
-  wpi::HttpConnection* DeviceStreamConnect(
-      wpi::SmallVectorImpl<char>& boundary);
-  void DeviceStream(wpi::raw_istream& is, std::string_view boundary);
-  bool DeviceStreamFrame(wpi::raw_istream& is, std::string& imageBuf);
+  std::atomic_bool m_connected{false};
+  std::atomic_bool m_active{true};  // set to false to terminate loop activity
 
-  // The camera settings thread
-  void SettingsThreadMain();
-  void DeviceSendSettings(wpi::HttpRequest& req);
+  wpi::EventLoopRunner& m_loop;
 
-  // The monitor thread
-  void MonitorThreadMain();
+  //
+  // Variables only accessed from the loop thread
+  //
 
-  std::atomic_bool m_connected{false};
-  std::atomic_bool m_active{true};  // set to false to terminate thread
-  std::thread m_streamThread;
-  std::thread m_settingsThread;
-  std::thread m_monitorThread;
+  // The stream connection, and the timers to reconnect it and to detect a
+  // hung stream
+  std::shared_ptr<wpi::uv::Tcp> m_streamTcp;
+  wpi::sig::ScopedConnection m_streamErrorConn;
+  wpi::sig::ScopedConnection m_streamClosedConn;
+  std::shared_ptr<wpi::uv::Timer> m_retryTimer;
+  std::shared_ptr<wpi::uv::Timer> m_monitorTimer;
+  std::string m_streamHost;
+
+  // HTTP response, until its headers are complete
+  wpi::HttpParser m_response{wpi::HttpParser::kResponse};
+  bool m_responseHeadersDone = false;
+  wpi::SmallString<64> m_responseContentType;
+
+  // Multipart stream following the response headers
+  MjpegStreamParser m_parser;
+
+  // Reads outside of images land here
+  std::array<char, 16384> m_readBuf;
+
+  // number of bad images received in a row; if we receive 3 bad images in a
+  // row, we reconnect
+  int m_numErrors{0};
+
+  // frames received since the last monitor check
+  int m_frameCount{0};
 
   //
   // Variables protected by m_mutex
   //
 
-  // The camera connections
-  std::unique_ptr<wpi::HttpConnection> m_streamConn;
-  std::unique_ptr<wpi::HttpConnection> m_settingsConn;
-
   CS_HttpCameraKind m_kind;
 
   std::vector<wpi::HttpLocation> m_locations;
   size_t m_nextLocation{0};
   int m_prefLocation{-1};  // preferred location
 
-  std::atomic_int m_frameCount{0};
-
-  wpi::condition_variable m_sinkEnabledCond;
-
   wpi::StringMap<wpi::SmallString<16>> m_settings;
-  wpi::condition_variable m_settingsCond;
 
   wpi::StringMap<wpi::SmallString<16>> m_streamSettings;
   std::atomic_bool m_streamSettingsUpdated{false};
-
-  wpi::condition_variable m_monitorCond;
 };
 
 class AxisCameraImpl : public HttpCameraImpl {
  public:
   AxisCameraImpl(std::string_view name, wpi::Logger& logger, Notifier& notifier,
-                 Telemetry& telemetry)
-      : HttpCameraImpl{name, CS_HTTP_AXIS, logger, notifier, telemetry} {}
+                 Telemetry& telemetry, wpi::EventLoopRunner& loop)
+      : HttpCameraImpl{name, CS_HTTP_AXIS, logger, notifier, telemetry, loop} {}
 #if 0
   void SetProperty(int property, int value, CS_Status* status) override;
   void SetStringProperty(int property, std::string_view value,
@@ -5,7 +5,9 @@
 #ifndef CSCORE_IMAGE_H_
 #define CSCORE_IMAGE_H_
 
+#include <functional>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <opencv2/core/core.hpp>
@@ -32,9 +34,22 @@ class Image {
   }
 #endif
 
+  // Wraps a buffer owned by the source (e.g. a mapped camera buffer) instead
+  // of copying it.  The buffer must stay valid until the release function is
+  // called, which happens when the image is destroyed.  The image can't be
+  // resized, and as its capacity is 0, it is never pooled for reuse.
+  Image(uchar* data, size_t size, std::function<void()> release)
+      : m_external{data}, m_externalSize{size}, m_release{std::move(release)} {}
+
   Image(const Image&) = delete;
   Image& operator=(const Image&) = delete;
 
+  ~Image() {
+    if (m_release) {
+      m_release();
+    }
+  }
+
   // Getters
   operator std::string_view() const {  // NOLINT
     return str();
@@ -46,13 +61,17 @@ class Image {
     return m_data.capacity();
   }
   const char* data() const {
-    return reinterpret_cast<const char*>(m_data.data());
+    return reinterpret_cast<const char*>(m_external ? m_external
+                                                    : m_data.data());
   }
   char* data() {
-    return reinterpret_cast<char*>(m_data.data());
+    return reinterpret_cast<char*>(m_external ? m_external : m_data.data());
   }
   size_t size() const {
-    return m_data.size();
+    return m_external ? m_externalSize : m_data.size();
+  }
+  bool IsExternal() const {
+    return m_external != nullptr;
   }
 
   const std::vector<uchar>& vec() const {
@@ -85,11 +104,12 @@ class Image {
         type = CV_8UC1;
         break;
     }
-    return cv::Mat{height, width, type, m_data.data()};
+    return cv::Mat{height, width, type, data()};
   }
 
   cv::_InputArray AsInputArray() {
-    return cv::_InputArray{m_data};
+    return cv::_InputArray{reinterpret_cast<const uchar*>(data()),
+                           static_cast<int>(size())};
   }
 
   bool Is(int width_, int height_) {
@@ -121,6 +141,9 @@ class Image {
 
  private:
   std::vector<uchar> m_data;
+  uchar* m_external{nullptr};
+  size_t m_externalSize{0};
+  std::function<void()> m_release;
 
  public:
   VideoMode::PixelFormat pixelFormat{VideoMode::kUnknown};
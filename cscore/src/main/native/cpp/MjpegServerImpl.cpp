@@ -4,16 +4,20 @@
 
 #include "MjpegServerImpl.h"
 
+#include <algorithm>
 #include <chrono>
 
 #include <fmt/format.h>
 #include <wpi/SmallString.h>
+#include <wpi/SmallVector.h>
 #include <wpi/StringExtras.h>
 #include <wpi/fmt/raw_ostream.h>
+#include <wpi/timestamp.h>
+#include <wpinet/HttpServerConnection.h>
 #include <wpinet/HttpUtil.h>
-#include <wpinet/TCPAcceptor.h>
-#include <wpinet/raw_socket_istream.h>
-#include <wpinet/raw_socket_ostream.h>
+#include <wpinet/raw_uv_ostream.h>
+#include <wpinet/uv/Tcp.h>
+#include <wpinet/uv/util.h>
 
 #include "Handle.h"
 #include "Instance.h"
@@ -30,6 +34,9 @@ using namespace cs;
 // It separates the multipart stream of pictures
 #define BOUNDARY "boundarydonotcross"
 
+// The maximum number of simultaneous client streams.
+static constexpr size_t kMaxStreams = 10;
+
 // A bare-bones HTML webpage for user friendliness.
 static const char* emptyRootPage =
     "</head><body>"
@@ -73,58 +80,77 @@ static const char* startRootPage =
     "<div class=\"settings\">\n";
 static const char* endRootPage = "</div></body></html>";
 
-class MjpegServerImpl::ConnThread : public wpi::SafeThread {
+class MjpegServerImpl::Connection : public wpi::HttpServerConnection {
  public:
-  explicit ConnThread(std::string_view name, wpi::Logger& logger)
-      : m_name(name), m_logger(logger) {}
+  Connection(MjpegServerImpl& server, std::shared_ptr<wpi::uv::Stream> stream);
+
+  void SendFrame(const std::shared_ptr<SourceFrame>& sf);
 
-  void Main() override;
+ protected:
+  void ProcessRequest() override;
+  void BuildCommonHeaders(wpi::raw_ostream& os) override;
 
-  bool ProcessCommand(wpi::raw_ostream& os, SourceImpl& source,
-                      std::string_view parameters, bool respond);
-  void SendJSON(wpi::raw_ostream& os, SourceImpl& source, bool header);
+ private:
+  bool ProcessCommand(SourceImpl& source, std::string_view parameters,
+                      bool respond);
+  void SendJSON(wpi::raw_ostream& os, SourceImpl& source);
   void SendHTMLHeadTitle(wpi::raw_ostream& os) const;
-  void SendHTML(wpi::raw_ostream& os, SourceImpl& source, bool header);
-  void SendStream(wpi::raw_socket_ostream& os);
-  void ProcessRequest();
+  void SendHTML(wpi::raw_ostream& os, SourceImpl& source);
+  void SendStream();
+
+  // Only changed by commands, which are ignored once streaming
+  StreamParams GetStreamParams() const {
+    return {m_width, m_height, m_compression, m_defaultCompression};
+  }
+
+  MjpegServerImpl& m_server;
+  std::string m_name;
+  wpi::Logger& m_logger;
+  wpi::sig::ScopedConnection m_closedConn;
 
-  std::unique_ptr<wpi::NetworkStream> m_stream;
-  std::shared_ptr<SourceImpl> m_source;
   bool m_streaming = false;
-  bool m_noStreaming = false;
+  CS_Sink m_sink = 0;  // handle of the server, for telemetry
   int m_width = 0;
   int m_height = 0;
   int m_compression = -1;
   int m_defaultCompression = 80;
   int m_fps = 0;
 
- private:
-  std::string m_name;
-  wpi::Logger& m_logger;
+  // frame rate limiting
+  Frame::Time m_lastFrameTime = 0;
+  Frame::Time m_timePerFrame = 0;
+  Frame::Time m_averageFrameTime = 0;
+  Frame::Time m_averagePeriod = 1000000;  // 1 second window
 
   std::string_view GetName() { return m_name; }
+};
 
-  std::shared_ptr<SourceImpl> GetSource() {
-    std::scoped_lock lock(m_mutex);
-    return m_source;
+MjpegServerImpl::Connection::Connection(MjpegServerImpl& server,
+                                        std::shared_ptr<wpi::uv::Stream> stream)
+    : HttpServerConnection{stream},
+      m_server{server},
+      m_name{server.GetName()},
+      m_logger{server.m_logger} {
+  {
+    std::scoped_lock lock(server.m_mutex);
+    m_width = server.GetProperty(server.m_widthProp)->value;
+    m_height = server.GetProperty(server.m_heightProp)->value;
+    m_compression = server.GetProperty(server.m_compressionProp)->value;
+    m_defaultCompression =
+        server.GetProperty(server.m_defaultCompressionProp)->value;
+    m_fps = server.GetProperty(server.m_fpsProp)->value;
   }
 
-  void StartStream() {
-    std::scoped_lock lock(m_mutex);
-    if (m_source) {
-      m_source->EnableSink();
-    }
-    m_streaming = true;
-  }
+  // close on write errors
+  stream->error.connect([h = stream.get()](wpi::uv::Error) { h->Close(); });
 
-  void StopStream() {
-    std::scoped_lock lock(m_mutex);
-    if (m_source) {
-      m_source->DisableSink();
+  m_closedConn = stream->closed.connect_connection([this] {
+    if (m_streaming) {
+      m_streaming = false;
+      m_server.StopStream(this, GetStreamParams());
     }
-    m_streaming = false;
-  }
-};
+  });
+}
 
 // Standard header to send along with other header information like mimetype.
 //
@@ -132,69 +158,16 @@ class MjpegServerImpl::ConnThread : public wpi::SafeThread {
 // A browser should connect for each file and not serve files from its cache.
 // Using cached pictures would lead to showing old/outdated pictures.
 // Many browsers seem to ignore, or at least not always obey, those headers.
-static void SendHeader(wpi::raw_ostream& os, int code,
-                       std::string_view codeText, std::string_view contentType,
-                       std::string_view extra = {}) {
-  fmt::print(os, "HTTP/1.0 {} {}\r\n", code, codeText);
-  os << "Connection: close\r\n"
-        "Server: CameraServer/1.0\r\n"
+void MjpegServerImpl::Connection::BuildCommonHeaders(wpi::raw_ostream& os) {
+  os << "Server: CameraServer/1.0\r\n"
         "Cache-Control: no-store, no-cache, must-revalidate, pre-check=0, "
         "post-check=0, max-age=0\r\n"
         "Pragma: no-cache\r\n"
         "Expires: Mon, 3 Jan 2000 12:34:56 GMT\r\n";
-  os << "Content-Type: " << contentType << "\r\n";
-  os << "Access-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: *\r\n";
-  if (!extra.empty()) {
-    os << extra << "\r\n";
-  }
-  os << "\r\n";  // header ends with a blank line
-}
-
-// Send error header and message
-// @param code HTTP error code (e.g. 404)
-// @param message Additional message text
-static void SendError(wpi::raw_ostream& os, int code,
-                      std::string_view message) {
-  std::string_view codeText, extra, baseMessage;
-  switch (code) {
-    case 401:
-      codeText = "Unauthorized";
-      extra = "WWW-Authenticate: Basic realm=\"CameraServer\"";
-      baseMessage = "401: Not Authenticated!";
-      break;
-    case 404:
-      codeText = "Not Found";
-      baseMessage = "404: Not Found!";
-      break;
-    case 500:
-      codeText = "Internal Server Error";
-      baseMessage = "500: Internal Server Error!";
-      break;
-    case 400:
-      codeText = "Bad Request";
-      baseMessage = "400: Not Found!";
-      break;
-    case 403:
-      codeText = "Forbidden";
-      baseMessage = "403: Forbidden!";
-      break;
-    case 503:
-      codeText = "Service Unavailable";
-      baseMessage = "503: Service Unavailable";
-      break;
-    default:
-      code = 501;
-      codeText = "Not Implemented";
-      baseMessage = "501: Not Implemented!";
-      break;
-  }
-  SendHeader(os, code, codeText, "text/plain", extra);
-  os << baseMessage << "\r\n" << message;
 }
 
 // Perform a command specified by HTTP GET parameters.
-bool MjpegServerImpl::ConnThread::ProcessCommand(wpi::raw_ostream& os,
-                                                 SourceImpl& source,
+bool MjpegServerImpl::Connection::ProcessCommand(SourceImpl& source,
                                                  std::string_view parameters,
                                                  bool respond) {
   wpi::SmallString<256> responseBuf;
@@ -219,7 +192,7 @@ bool MjpegServerImpl::ConnThread::ProcessCommand(wpi::raw_ostream& os,
     std::string_view param = wpi::UnescapeURI(rawParam, paramBuf, &error);
     if (error) {
       auto estr = fmt::format("could not unescape parameter \"{}\"", rawParam);
-      SendError(os, 500, estr);
+      SendError(500, estr);
       SDEBUG("{}", estr);
       return false;
     }
@@ -229,7 +202,7 @@ bool MjpegServerImpl::ConnThread::ProcessCommand(wpi::raw_ostream& os,
     std::string_view value = wpi::UnescapeURI(rawValue, valueBuf, &error);
     if (error) {
       auto estr = fmt::format("could not unescape value \"{}\"", rawValue);
-      SendError(os, 500, estr);
+      SendError(500, estr);
       SDEBUG("{}", estr);
       return false;
     }
@@ -325,26 +298,22 @@ bool MjpegServerImpl::ConnThread::ProcessCommand(wpi::raw_ostream& os,
 
   // Send HTTP response
   if (respond) {
-    SendHeader(os, 200, "OK", "text/plain");
-    os << response.str() << "\r\n";
+    response << "\r\n";
+    SendResponse(200, "OK", "text/plain", response.str());
   }
 
   return true;
 }
 
-void MjpegServerImpl::ConnThread::SendHTMLHeadTitle(
+void MjpegServerImpl::Connection::SendHTMLHeadTitle(
     wpi::raw_ostream& os) const {
   os << "<html><head><title>" << m_name << " CameraServer</title>"
      << "<meta charset=\"UTF-8\">";
 }
 
 // Send the root html file with controls for all the settable properties.
-void MjpegServerImpl::ConnThread::SendHTML(wpi::raw_ostream& os,
-                                           SourceImpl& source, bool header) {
-  if (header) {
-    SendHeader(os, 200, "OK", "text/html");
-  }
-
+void MjpegServerImpl::Connection::SendHTML(wpi::raw_ostream& os,
+                                           SourceImpl& source) {
   SendHTMLHeadTitle(os);
   os << startRootPage;
   wpi::SmallVector<int, 32> properties_vec;
@@ -469,16 +438,11 @@ void MjpegServerImpl::ConnThread::SendHTML(wpi::raw_ostream& os,
   }
   os << "</table>\n";
   os << endRootPage << "\r\n";
-  os.flush();
 }
 
 // Send a JSON file which is contains information about the source parameters.
-void MjpegServerImpl::ConnThread::SendJSON(wpi::raw_ostream& os,
-                                           SourceImpl& source, bool header) {
-  if (header) {
-    SendHeader(os, 200, "OK", "application/json");
-  }
-
+void MjpegServerImpl::Connection::SendJSON(wpi::raw_ostream& os,
+                                           SourceImpl& source) {
   os << "{\n\"controls\": [\n";
   wpi::SmallVector<int, 32> properties_vec;
   bool first = true;
@@ -579,17 +543,14 @@ void MjpegServerImpl::ConnThread::SendJSON(wpi::raw_ostream& os,
     os << '}';
   }
   os << "\n]\n}\n";
-  os.flush();
 }
 
 MjpegServerImpl::MjpegServerImpl(std::string_view name, wpi::Logger& logger,
                                  Notifier& notifier, Telemetry& telemetry,
-                                 std::string_view listenAddress, int port,
-                                 std::unique_ptr<wpi::NetworkAcceptor> acceptor)
+                                 std::string_view listenAddress, int port)
     : SinkImpl{name, logger, notifier, telemetry},
       m_listenAddress(listenAddress),
-      m_port(port),
-      m_acceptor{std::move(acceptor)} {
+      m_port(port) {
   m_active = true;
 
   SetDescription(fmt::format("HTTP Server on port {}", port));
@@ -613,7 +574,49 @@ MjpegServerImpl::MjpegServerImpl(std::string_view name, wpi::Logger& logger,
     return std::make_unique<PropertyImpl>("fps", CS_PROP_INTEGER, 1, 0, 0);
   });
 
-  m_serverThread = std::thread(&MjpegServerImpl::ServerThreadMain, this);
+  m_loop.ExecSync([&](wpi::uv::Loop& loop) {
+    m_frameAsync = wpi::uv::Async<>::Create(loop);
+    auto tcp = wpi::uv::Tcp::Create(loop);
+    if (!m_frameAsync || !tcp) {
+      m_active = false;
+      return;
+    }
+    m_frameAsync->wakeup.connect([this] { SendFrames(); });
+
+    // bind and listen errors are reported through the error signal
+    bool failed = false;
+    auto errConn = tcp->error.connect_connection([&](wpi::uv::Error err) {
+      SERROR("could not listen on port {}: {}", m_port, err.str());
+      failed = true;
+    });
+    tcp->Bind(m_listenAddress, m_port);
+    if (!failed) {
+      tcp->Listen();
+    }
+    errConn.disconnect();
+    if (failed) {
+      tcp->Close();
+      m_active = false;
+      return;
+    }
+
+    SDEBUG("{}", "waiting for clients to connect");
+    tcp->connection.connect([this, srv = tcp.get()] {
+      auto tcp = srv->Accept();
+      if (!tcp) {
+        return;
+      }
+      std::string ip;
+      unsigned int port = 0;
+      wpi::uv::AddrToName(tcp->GetPeer(), &ip, &port);
+      SDEBUG("client connection from {}", ip);
+
+      // the connection lives as long as the socket
+      tcp->SetData(std::make_shared<Connection>(*this, tcp));
+    });
+  });
+
+  m_frameThread = std::thread(&MjpegServerImpl::FrameThreadMain, this);
 }
 
 MjpegServerImpl::~MjpegServerImpl() {
@@ -623,379 +626,394 @@ MjpegServerImpl::~MjpegServerImpl() {
 void MjpegServerImpl::Stop() {
   m_active = false;
 
-  // wake up server thread by shutting down the socket
-  m_acceptor->shutdown();
-
-  // join server thread
-  if (m_serverThread.joinable()) {
-    m_serverThread.join();
+  // wake up frame thread, which may be waiting for clients or for a frame
+  std::shared_ptr<SourceImpl> source;
+  {
+    std::scoped_lock lock(m_mutex);
+    source = m_streamSource;
+    m_frameCond.notify_all();
   }
-
-  // close streams
-  for (auto& connThread : m_connThreads) {
-    if (auto thr = connThread.GetThread()) {
-      if (thr->m_stream) {
-        thr->m_stream->close();
-      }
-    }
-    connThread.Stop();
+  if (source) {
+    source->Wakeup();
   }
 
-  // wake up connection threads by forcing an empty frame to be sent
-  if (auto source = GetSource()) {
-    source->Wakeup();
+  // join frame thread
+  if (m_frameThread.joinable()) {
+    m_frameThread.join();
   }
+
+  // close all connections and stop the loop
+  m_loop.Stop();
 }
 
-// Send HTTP response and a stream of JPG-frames
-void MjpegServerImpl::ConnThread::SendStream(wpi::raw_socket_ostream& os) {
-  if (m_noStreaming) {
+// Send HTTP response header; the loop then sends a stream of JPG-frames
+void MjpegServerImpl::Connection::SendStream() {
+  if (m_server.m_streams.size() >= kMaxStreams) {
     SERROR("{}", "Too many simultaneous client streams");
-    SendError(os, 503, "Too many simultaneous streams");
+    SendError(503, "Too many simultaneous streams");
     return;
   }
 
-  os.SetUnbuffered();
-
-  wpi::SmallString<256> header;
-  wpi::raw_svector_ostream oss{header};
-
-  SendHeader(oss, 200, "OK", "multipart/x-mixed-replace;boundary=" BOUNDARY);
-  os << oss.str();
+  wpi::SmallVector<wpi::uv::Buffer, 4> bufs;
+  wpi::raw_uv_ostream os{bufs, 4096};
+  BuildHeader(os, 200, "OK", "multipart/x-mixed-replace;boundary=" BOUNDARY,
+              0);
+  SendData(os.bufs());
 
   SDEBUG("{}", "Headers send, sending stream now");
 
-  Frame::Time lastFrameTime = 0;
-  Frame::Time timePerFrame = 0;
   if (m_fps != 0) {
-    timePerFrame = 1000000.0 / m_fps;
+    m_timePerFrame = 1000000.0 / m_fps;
   }
-  Frame::Time averageFrameTime = 0;
-  Frame::Time averagePeriod = 1000000;  // 1 second window
-  if (averagePeriod < timePerFrame) {
-    averagePeriod = timePerFrame * 10;
+  if (m_averagePeriod < m_timePerFrame) {
+    m_averagePeriod = m_timePerFrame * 10;
   }
 
-  StartStream();
-  while (m_active && !os.has_error()) {
-    auto source = GetSource();
-    if (!source) {
-      // Source disconnected; sleep so we don't consume all processor time.
-      os << "\r\n";  // Keep connection alive
-      std::this_thread::sleep_for(std::chrono::milliseconds(200));
-      continue;
-    }
-    SDEBUG4("{}", "waiting for frame");
-    Frame frame = source->GetNextFrame(0.225);  // blocks
-    if (!m_active) {
-      break;
-    }
-    if (!frame) {
-      // Bad frame; sleep for 20 ms so we don't consume all processor time.
-      os << "\r\n";  // Keep connection alive
-      std::this_thread::sleep_for(std::chrono::milliseconds(20));
-      continue;
-    }
-
-    auto thisFrameTime = frame.GetTime();
-    if (thisFrameTime != 0 && timePerFrame != 0 && lastFrameTime != 0) {
-      Frame::Time deltaTime = thisFrameTime - lastFrameTime;
+  m_sink = Handle{Instance::GetInstance().FindSink(m_server).first,
+                  Handle::kSink};
+  m_streaming = true;
+  m_server.StartStream(this, GetStreamParams());
+}
 
-      // drop frame if it is early compared to the desired frame rate AND
-      // the current average is higher than the desired average
-      if (deltaTime < timePerFrame && averageFrameTime < timePerFrame) {
-        // sleep for 1 ms so we don't consume all processor time
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        continue;
-      }
+// Send a frame (or keep-alive, if the frame is empty) to a streaming client
+void MjpegServerImpl::Connection::SendFrame(
+    const std::shared_ptr<SourceFrame>& sf) {
+  // Drop the frame if the client hasn't received what was already sent.
+  if (m_stream.GetWriteQueueSize() != 0) {
+    SDEBUG4("{}", "client is behind, dropping frame");
+    return;
+  }
 
-      // update average
-      if (averageFrameTime != 0) {
-        averageFrameTime =
-            averageFrameTime * (averagePeriod - timePerFrame) / averagePeriod +
-            deltaTime * timePerFrame / averagePeriod;
-      } else {
-        averageFrameTime = deltaTime;
-      }
-    }
+  Frame& frame = sf->frame;
+  if (!frame) {
+    // Keep connection alive
+    m_stream.Write({wpi::uv::Buffer{"\r\n"}}, [](auto, wpi::uv::Error) {});
+    return;
+  }
 
-    int width = m_width != 0 ? m_width : frame.GetOriginalWidth();
-    int height = m_height != 0 ? m_height : frame.GetOriginalHeight();
-    Image* image = frame.GetImageMJPEG(
-        width, height, m_compression,
-        m_compression == -1 ? m_defaultCompression : m_compression);
-    if (!image) {
-      // Shouldn't happen, but just in case...
-      std::this_thread::sleep_for(std::chrono::milliseconds(20));
-      continue;
-    }
+  auto thisFrameTime = frame.GetTime();
+  if (thisFrameTime != 0 && m_timePerFrame != 0 && m_lastFrameTime != 0) {
+    Frame::Time deltaTime = thisFrameTime - m_lastFrameTime;
 
-    const char* data = image->data();
-    size_t size = image->size();
-    bool addDHT = false;
-    size_t locSOF = size;
-    switch (image->pixelFormat) {
-      case VideoMode::kMJPEG:
-        // Determine if we need to add DHT to it, and allocate enough space
-        // for adding it if required.
-        addDHT = JpegNeedsDHT(data, &size, &locSOF);
-        break;
-      case VideoMode::kYUYV:
-      case VideoMode::kRGB565:
-      default:
-        // Bad frame; sleep for 10 ms so we don't consume all processor time.
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        continue;
+    // drop frame if it is early compared to the desired frame rate AND
+    // the current average is higher than the desired average
+    if (deltaTime < m_timePerFrame && m_averageFrameTime < m_timePerFrame) {
+      return;
     }
 
-    SDEBUG4("sending frame size={} addDHT={}", size, addDHT);
-
-    // print the individual mimetype and the length
-    // sending the content-length fixes random stream disruption observed
-    // with firefox
-    lastFrameTime = thisFrameTime;
-    double timestamp = lastFrameTime / 1000000.0;
-    header.clear();
-    oss << "\r\n--" BOUNDARY "\r\n"
-        << "Content-Type: image/jpeg\r\n";
-    fmt::print(oss, "Content-Length: {}\r\n", size);
-    fmt::print(oss, "X-Timestamp: {}\r\n", timestamp);
-    oss << "\r\n";
-    os << oss.str();
-    if (addDHT) {
-      // Insert DHT data immediately before SOF
-      os << std::string_view(data, locSOF);
-      os << JpegGetDHT();
-      os << std::string_view(data + locSOF, image->size() - locSOF);
+    // update average
+    if (m_averageFrameTime != 0) {
+      m_averageFrameTime = m_averageFrameTime *
+                               (m_averagePeriod - m_timePerFrame) /
+                               m_averagePeriod +
+                           deltaTime * m_timePerFrame / m_averagePeriod;
     } else {
-      os << std::string_view(data, size);
+      m_averageFrameTime = deltaTime;
     }
-    // os.flush();
   }
-  StopStream();
-}
 
-void MjpegServerImpl::ConnThread::ProcessRequest() {
-  wpi::raw_socket_istream is{*m_stream};
-  wpi::raw_socket_ostream os{*m_stream, true};
+  // The frame thread has already compressed the image; it is missing if the
+  // stream started after the frame arrived, or if the compression failed.
+  auto params = GetStreamParams();
+  auto it = std::find_if(sf->images.begin(), sf->images.end(),
+                         [&](const auto& e) { return e.params == params; });
+  if (it == sf->images.end()) {
+    return;
+  }
+  const char* data = it->image->data();
+  size_t size = it->size;
+  size_t locSOF = it->locSOF;
+  bool addDHT = it->addDHT;
+
+  SDEBUG4("sending frame size={} addDHT={}", size, addDHT);
+
+  // print the individual mimetype and the length
+  // sending the content-length fixes random stream disruption observed
+  // with firefox
+  m_lastFrameTime = thisFrameTime;
+  double timestamp = m_lastFrameTime / 1000000.0;
+  wpi::SmallVector<wpi::uv::Buffer, 4> bufs;
+  wpi::raw_uv_ostream os{bufs, 128};
+  os << "\r\n--" BOUNDARY "\r\n"
+     << "Content-Type: image/jpeg\r\n";
+  fmt::print(os, "Content-Length: {}\r\n", size);
+  fmt::print(os, "X-Timestamp: {}\r\n", timestamp);
+  os << "\r\n";
+  size_t headerBufs = bufs.size();
+
+  // The image is sent without copying; the write holds a reference to the
+  // frame until it completes.
+  if (addDHT) {
+    // Insert DHT data immediately before SOF
+    bufs.emplace_back(std::string_view(data, locSOF));
+    bufs.emplace_back(JpegGetDHT());
+    bufs.emplace_back(
+        std::string_view(data + locSOF, it->image->size() - locSOF));
+  } else {
+    bufs.emplace_back(std::string_view(data, size));
+  }
+  // The send and end-to-end latencies are recorded when the write completes.
+  Telemetry& telemetry = m_server.m_telemetry;
+  CS_Sink handle = m_sink;
+  auto start = wpi::Now();
+  m_stream.Write(bufs, [sf, headerBufs, &telemetry, handle, start](
+                           auto bufs, wpi::uv::Error err) {
+    for (auto&& buf : bufs.subspan(0, headerBufs)) {
+      buf.Deallocate();
+    }
+    if (!err) {
+      auto now = wpi::Now();
+      telemetry.RecordLatency(handle, CS_LATENCY_SEND, now - start);
+      telemetry.RecordLatency(handle, CS_LATENCY_CAPTURE_TO_SINK,
+                              now - sf->frame.GetTime());
+    }
+  });
+}
 
-  // Read the request string from the stream
-  wpi::SmallString<128> reqBuf;
-  std::string_view req = is.getline(reqBuf, 4096);
-  if (is.has_error()) {
-    SDEBUG("{}", "error getting request string");
+void MjpegServerImpl::Connection::ProcessRequest() {
+  // Once streaming, further requests are ignored
+  if (m_streaming) {
     return;
   }
 
+  std::string_view url = m_request.GetUrl();
+  bool isGET = m_request.GetMethod() == wpi::HTTP_GET;
+
   enum { kCommand, kStream, kGetSettings, kGetSourceConfig, kRootPage } kind;
   std::string_view parameters;
-  size_t pos;
 
-  SDEBUG("HTTP request: '{}'\n", req);
+  SDEBUG("HTTP request: '{}'\n", url);
 
   // Determine request kind.  Most of these are for mjpgstreamer
   // compatibility, others are for Axis camera compatibility.
-  if ((pos = req.find("POST /stream")) != std::string_view::npos) {
+  if (m_request.GetMethod() == wpi::HTTP_POST &&
+      wpi::starts_with(url, "/stream")) {
     kind = kStream;
-    parameters = wpi::substr(wpi::substr(req, req.find('?', pos + 12)), 1);
-  } else if ((pos = req.find("GET /?action=stream")) !=
-             std::string_view::npos) {
+    parameters = wpi::substr(wpi::substr(url, url.find('?')), 1);
+  } else if (isGET && wpi::starts_with(url, "/?action=stream")) {
     kind = kStream;
-    parameters = wpi::substr(wpi::substr(req, req.find('&', pos + 19)), 1);
-  } else if ((pos = req.find("GET /stream.mjpg")) != std::string_view::npos) {
+    parameters = wpi::substr(wpi::substr(url, url.find('&')), 1);
+  } else if (isGET && wpi::starts_with(url, "/stream.mjpg")) {
     kind = kStream;
-    parameters = wpi::substr(wpi::substr(req, req.find('?', pos + 16)), 1);
-  } else if (req.find("GET /settings") != std::string_view::npos &&
-             req.find(".json") != std::string_view::npos) {
+    parameters = wpi::substr(wpi::substr(url, url.find('?')), 1);
+  } else if (isGET && wpi::starts_with(url, "/settings") &&
+             wpi::contains(url, ".json")) {
     kind = kGetSettings;
-  } else if (req.find("GET /config") != std::string_view::npos &&
-             req.find(".json") != std::string_view::npos) {
+  } else if (isGET && wpi::starts_with(url, "/config") &&
+             wpi::contains(url, ".json")) {
     kind = kGetSourceConfig;
-  } else if (req.find("GET /input") != std::string_view::npos &&
-             req.find(".json") != std::string_view::npos) {
+  } else if (isGET && wpi::starts_with(url, "/input") &&
+             wpi::contains(url, ".json")) {
     kind = kGetSettings;
-  } else if (req.find("GET /output") != std::string_view::npos &&
-             req.find(".json") != std::string_view::npos) {
+  } else if (isGET && wpi::starts_with(url, "/output") &&
+             wpi::contains(url, ".json")) {
     kind = kGetSettings;
-  } else if ((pos = req.find("GET /?action=command")) !=
-             std::string_view::npos) {
+  } else if (isGET && wpi::starts_with(url, "/?action=command")) {
     kind = kCommand;
-    parameters = wpi::substr(wpi::substr(req, req.find('&', pos + 20)), 1);
-  } else if (req.find("GET / ") != std::string_view::npos || req == "GET /\n") {
+    parameters = wpi::substr(wpi::substr(url, url.find('&')), 1);
+  } else if (isGET && url == "/") {
     kind = kRootPage;
   } else {
     SDEBUG("{}", "HTTP request resource not found");
-    SendError(os, 404, "Resource not found");
+    SendError(404, "Resource not found");
     return;
   }
 
-  // Parameter can only be certain characters.  This also strips the EOL.
-  pos = parameters.find_first_not_of(
+  // Parameter can only be certain characters.
+  size_t pos = parameters.find_first_not_of(
       "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_"
       "-=&1234567890%./");
   parameters = wpi::substr(parameters, 0, pos);
   SDEBUG("command parameters: \"{}\"", parameters);
 
-  // Read the rest of the HTTP request.
-  // The end of the request is marked by a single, empty line
-  wpi::SmallString<128> lineBuf;
-  for (;;) {
-    if (wpi::starts_with(is.getline(lineBuf, 4096), "\n")) {
-      break;
-    }
-    if (is.has_error()) {
-      return;
-    }
-  }
-
   // Send response
+  wpi::SmallString<4096> buf;
+  wpi::raw_svector_ostream os{buf};
   switch (kind) {
     case kStream:
-      if (auto source = GetSource()) {
+      if (auto source = m_server.GetSource()) {
         SDEBUG("request for stream {}", source->GetName());
-        if (!ProcessCommand(os, *source, parameters, false)) {
+        if (!ProcessCommand(*source, parameters, false)) {
           return;
         }
       }
-      SendStream(os);
+      SendStream();
       break;
     case kCommand:
-      if (auto source = GetSource()) {
-        ProcessCommand(os, *source, parameters, true);
+      if (auto source = m_server.GetSource()) {
+        ProcessCommand(*source, parameters, true);
       } else {
-        SendHeader(os, 200, "OK", "text/plain");
-        os << "Ignored due to no connected source."
-           << "\r\n";
+        SendResponse(200, "OK", "text/plain",
+                     "Ignored due to no connected source.\r\n");
         SDEBUG("{}", "Ignored due to no connected source.");
       }
       break;
     case kGetSettings:
       SDEBUG("{}", "request for JSON file");
-      if (auto source = GetSource()) {
-        SendJSON(os, *source, true);
+      if (auto source = m_server.GetSource()) {
+        SendJSON(os, *source);
+        SendResponse(200, "OK", "application/json", os.str());
       } else {
-        SendError(os, 404, "Resource not found");
+        SendError(404, "Resource not found");
       }
       break;
     case kGetSourceConfig:
       SDEBUG("{}", "request for JSON file");
-      if (auto source = GetSource()) {
-        SendHeader(os, 200, "OK", "application/json");
+      if (auto source = m_server.GetSource()) {
         CS_Status status = CS_OK;
-        os << source->GetConfigJson(&status);
-        os.flush();
+        SendResponse(200, "OK", "application/json",
+                     source->GetConfigJson(&status));
       } else {
-        SendError(os, 404, "Resource not found");
+        SendError(404, "Resource not found");
       }
       break;
     case kRootPage:
       SDEBUG("{}", "request for root page");
-      SendHeader(os, 200, "OK", "text/html");
-      if (auto source = GetSource()) {
-        SendHTML(os, *source, false);
+      if (auto source = m_server.GetSource()) {
+        SendHTML(os, *source);
       } else {
         SendHTMLHeadTitle(os);
         os << emptyRootPage << "\r\n";
       }
+      SendResponse(200, "OK", "text/html", os.str());
       break;
   }
-
-  SDEBUG("{}", "leaving HTTP client thread");
 }
 
-// worker thread for clients that connected to this server
-void MjpegServerImpl::ConnThread::Main() {
-  std::unique_lock lock(m_mutex);
-  while (m_active) {
-    while (!m_stream) {
-      m_cond.wait(lock);
+// Frame thread; waits for frames while there are streaming clients, and
+// compresses and hands them off to the loop
+void MjpegServerImpl::FrameThreadMain() {
+  std::vector<StreamParams> params;
+  for (;;) {
+    SourceFrame sf;
+    {
+      std::unique_lock lock(m_mutex);
+      m_frameCond.wait(lock, [&] { return !m_active || m_numStreams > 0; });
       if (!m_active) {
-        return;
+        break;
       }
+      sf.source = m_streamSource;
     }
-    lock.unlock();
-    ProcessRequest();
-    lock.lock();
-    m_stream = nullptr;
-  }
-}
 
-// Main server thread
-void MjpegServerImpl::ServerThreadMain() {
-  if (m_acceptor->start() != 0) {
-    m_active = false;
-    return;
+    if (!sf.source) {
+      // Source disconnected; sleep so we don't consume all processor time.
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    } else {
+      SDEBUG4("{}", "waiting for frame");
+      auto start = wpi::Now();
+      sf.frame = sf.source->GetNextFrame(0.225);  // blocks
+      m_telemetry.RecordSinkLatency(*this, CS_LATENCY_SINK_WAIT,
+                                    wpi::Now() - start);
+      if (!m_active) {
+        break;
+      }
+      if (!sf.frame) {
+        // Bad frame; sleep for 20 ms so we don't consume all processor time.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      } else {
+        {
+          std::scoped_lock lock(m_mutex);
+          params = m_streamParams;
+        }
+        EncodeFrame(sf, params);
+      }
+    }
+
+    // Replaces the previous frame if the loop hasn't sent it yet; that frame
+    // is released (outside the lock) at the end of this iteration.
+    {
+      std::scoped_lock lock(m_mutex);
+      std::swap(m_frame, sf);
+      m_framePending = true;
+    }
+    m_frameAsync->Send();
   }
 
-  SDEBUG("{}", "waiting for clients to connect");
-  while (m_active) {
-    auto stream = m_acceptor->accept();
-    if (!stream) {
-      m_active = false;
-      return;
+  SDEBUG("{}", "leaving frame thread");
+}
+
+// Compresses the frame once for each distinct set of stream parameters, so the
+// loop only has to write it out
+void MjpegServerImpl::EncodeFrame(SourceFrame& sf,
+                                  const std::vector<StreamParams>& params) {
+  for (auto&& p : params) {
+    if (std::any_of(sf.images.begin(), sf.images.end(),
+                    [&](const auto& e) { return e.params == p; })) {
+      continue;
     }
-    if (!m_active) {
-      return;
+    int width = p.width != 0 ? p.width : sf.frame.GetOriginalWidth();
+    int height = p.height != 0 ? p.height : sf.frame.GetOriginalHeight();
+    Image* image = sf.frame.GetImageMJPEG(
+        width, height, p.compression,
+        p.compression == -1 ? p.defaultCompression : p.compression);
+    if (!image || image->pixelFormat != VideoMode::kMJPEG) {
+      // Shouldn't happen, but just in case...
+      continue;
     }
 
-    SDEBUG("client connection from {}", stream->getPeerIP());
-
-    auto source = GetSource();
+    // Determine if we need to add DHT to it
+    size_t size = image->size();
+    size_t locSOF = size;
+    bool addDHT = JpegNeedsDHT(image->data(), &size, &locSOF);
+    sf.images.push_back({p, image, size, locSOF, addDHT});
+  }
+}
 
+void MjpegServerImpl::SendFrames() {
+  auto sf = std::make_shared<SourceFrame>();
+  {
     std::scoped_lock lock(m_mutex);
-    // Find unoccupied worker thread, or create one if necessary
-    auto it = std::find_if(m_connThreads.begin(), m_connThreads.end(),
-                           [](const wpi::SafeThreadOwner<ConnThread>& owner) {
-                             auto thr = owner.GetThread();
-                             return !thr || !thr->m_stream;
-                           });
-    if (it == m_connThreads.end()) {
-      m_connThreads.emplace_back();
-      it = std::prev(m_connThreads.end());
+    if (!m_framePending) {
+      return;
     }
+    std::swap(*sf, m_frame);
+    m_framePending = false;
+  }
+  for (auto conn : m_streams) {
+    conn->SendFrame(sf);
+  }
+}
 
-    // Start it if not already started
-    it->Start(GetName(), m_logger);
-
-    auto nstreams =
-        std::count_if(m_connThreads.begin(), m_connThreads.end(),
-                      [](const wpi::SafeThreadOwner<ConnThread>& owner) {
-                        auto thr = owner.GetThread();
-                        return thr && thr->m_streaming;
-                      });
-
-    // Hand off connection to it
-    auto thr = it->GetThread();
-    thr->m_stream = std::move(stream);
-    thr->m_source = source;
-    thr->m_noStreaming = nstreams >= 10;
-    thr->m_width = GetProperty(m_widthProp)->value;
-    thr->m_height = GetProperty(m_heightProp)->value;
-    thr->m_compression = GetProperty(m_compressionProp)->value;
-    thr->m_defaultCompression = GetProperty(m_defaultCompressionProp)->value;
-    thr->m_fps = GetProperty(m_fpsProp)->value;
-    thr->m_cond.notify_one();
+void MjpegServerImpl::StartStream(Connection* conn,
+                                  const StreamParams& params) {
+  m_streams.push_back(conn);
+  std::scoped_lock lock(m_mutex);
+  ++m_numStreams;
+  m_streamParams.push_back(params);
+  if (m_streamSource) {
+    m_streamSource->EnableSink();
   }
+  m_frameCond.notify_one();
+}
 
-  SDEBUG("{}", "leaving server thread");
+void MjpegServerImpl::StopStream(Connection* conn,
+                                 const StreamParams& params) {
+  m_streams.erase(std::remove(m_streams.begin(), m_streams.end(), conn),
+                  m_streams.end());
+  std::scoped_lock lock(m_mutex);
+  --m_numStreams;
+  m_streamParams.erase(
+      std::find(m_streamParams.begin(), m_streamParams.end(), params));
+  if (m_streamSource) {
+    m_streamSource->DisableSink();
+  }
 }
 
 void MjpegServerImpl::SetSourceImpl(std::shared_ptr<SourceImpl> source) {
   std::scoped_lock lock(m_mutex);
-  for (auto& connThread : m_connThreads) {
-    if (auto thr = connThread.GetThread()) {
-      if (thr->m_source != source) {
-        bool streaming = thr->m_streaming;
-        if (thr->m_source && streaming) {
-          thr->m_source->DisableSink();
-        }
-        thr->m_source = source;
-        if (source && streaming) {
-          thr->m_source->EnableSink();
-        }
-      }
+  if (m_streamSource == source) {
+    return;
+  }
+  // move the sink enable of each streaming connection to the new source
+  for (int i = 0; i < m_numStreams; ++i) {
+    if (m_streamSource) {
+      m_streamSource->DisableSink();
+    }
+    if (source) {
+      source->EnableSink();
     }
   }
+  m_streamSource = std::move(source);
 }
 
 namespace cs {
@@ -1005,10 +1023,8 @@ CS_Sink CreateMjpegServer(std::string_view name, std::string_view listenAddress,
   auto& inst = Instance::GetInstance();
   return inst.CreateSink(
       CS_SINK_MJPEG,
-      std::make_shared<MjpegServerImpl>(
-          name, inst.logger, inst.notifier, inst.telemetry, listenAddress, port,
-          std::unique_ptr<wpi::NetworkAcceptor>(
-              new wpi::TCPAcceptor(port, listenAddress, inst.logger))));
+      std::make_shared<MjpegServerImpl>(name, inst.logger, inst.notifier,
+                                        inst.telemetry, listenAddress, port));
 }
 
 std::string GetMjpegServerListenAddress(CS_Sink sink, CS_Status* status) {
@@ -12,26 +12,28 @@
 #include <thread>
 #include <vector>
 
-#include <wpi/SafeThread.h>
-#include <wpi/SmallVector.h>
-#include <wpi/raw_istream.h>
-#include <wpi/raw_ostream.h>
-#include <wpinet/NetworkAcceptor.h>
-#include <wpinet/NetworkStream.h>
-#include <wpinet/raw_socket_ostream.h>
+#include <wpi/condition_variable.h>
+#include <wpinet/EventLoopRunner.h>
+#include <wpinet/uv/Async.h>
 
+#include "Frame.h"
 #include "SinkImpl.h"
 
 namespace cs {
 
 class SourceImpl;
 
+// All clients of a server are serviced by a single event loop.  A single
+// frame thread waits for frames from the source (while any client is
+// streaming), compresses it once for each size and quality the clients ask
+// for, and hands it to the loop, which sends it to every streaming client with
+// non-blocking writes.  A client that has not yet received the previous frame
+// skips the new one.
 class MjpegServerImpl : public SinkImpl {
  public:
   MjpegServerImpl(std::string_view name, wpi::Logger& logger,
                   Notifier& notifier, Telemetry& telemetry,
-                  std::string_view listenAddress, int port,
-                  std::unique_ptr<wpi::NetworkAcceptor> acceptor);
+                  std::string_view listenAddress, int port);
   ~MjpegServerImpl() override;
 
   void Stop();
@@ -39,21 +41,77 @@ class MjpegServerImpl : public SinkImpl {
   int GetPort() { return m_port; }
 
  private:
+  class Connection;
+
+  // Size and quality a client streams at; a zero width or height is the
+  // frame's own, and a compression of -1 uses the default compression
+  struct StreamParams {
+    int width;
+    int height;
+    int compression;
+    int defaultCompression;
+
+    bool operator==(const StreamParams& rhs) const {
+      return width == rhs.width && height == rhs.height &&
+             compression == rhs.compression &&
+             defaultCompression == rhs.defaultCompression;
+    }
+  };
+
+  // A frame compressed for one set of stream parameters
+  struct EncodedImage {
+    StreamParams params;
+    Image* image;  // owned by the frame
+    size_t size;
+    size_t locSOF;
+    bool addDHT;
+  };
+
+  // A frame, with the source that owns it (which must outlive it), and its
+  // compressed images
+  struct SourceFrame {
+    std::shared_ptr<SourceImpl> source;
+    Frame frame;
+    std::vector<EncodedImage> images;
+  };
+
   void SetSourceImpl(std::shared_ptr<SourceImpl> source) override;
 
-  void ServerThreadMain();
+  void FrameThreadMain();
+  void EncodeFrame(SourceFrame& sf, const std::vector<StreamParams>& params);
 
-  class ConnThread;
+  // Called on the loop thread
+  void SendFrames();
+  void StartStream(Connection* conn, const StreamParams& params);
+  void StopStream(Connection* conn, const StreamParams& params);
 
   // Never changed, so not protected by mutex
   std::string m_listenAddress;
   int m_port;
 
-  std::unique_ptr<wpi::NetworkAcceptor> m_acceptor;
   std::atomic_bool m_active;  // set to false to terminate threads
-  std::thread m_serverThread;
 
-  std::vector<wpi::SafeThreadOwner<ConnThread>> m_connThreads;
+  wpi::EventLoopRunner m_loop;
+  std::shared_ptr<wpi::uv::Async<>> m_frameAsync;
+
+  // Streaming connections; only accessed from the loop thread
+  std::vector<Connection*> m_streams;
+
+  // Number of streaming connections, and the source each of them has
+  // enabled (protected by m_mutex)
+  int m_numStreams = 0;
+  std::shared_ptr<SourceImpl> m_streamSource;
+
+  // Stream parameters of each streaming connection (protected by m_mutex)
+  std::vector<StreamParams> m_streamParams;
+
+  // Frame not yet sent by the loop; an empty frame sends a keep-alive
+  // (protected by m_mutex)
+  SourceFrame m_frame;
+  bool m_framePending = false;
+
+  wpi::condition_variable m_frameCond;
+  std::thread m_frameThread;
 
   // property indices
   int m_widthProp;
@@ -0,0 +1,230 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "MjpegStreamParser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include <fmt/format.h>
+#include <wpi/StringExtras.h>
+
+#include "JpegUtil.h"
+
+using namespace cs;
+
+// Longest part header line accepted
+static constexpr size_t kMaxLineLength = 1024;
+
+// Largest image accepted; the size comes from the peer, so don't trust it
+// with unbounded allocations
+static constexpr size_t kMaxImageSize = 32 * 1024 * 1024;
+
+MjpegStreamParser::MjpegStreamParser(AllocFunc alloc, FrameFunc frame,
+                                     ErrorFunc error)
+    : m_alloc{std::move(alloc)},
+      m_frame{std::move(frame)},
+      m_error{std::move(error)} {}
+
+void MjpegStreamParser::Reset(std::string_view boundary) {
+  m_state = kBoundary;
+  m_boundaryWith = fmt::format("\n--{}", boundary);
+  m_boundaryWithout = fmt::format("\n{}", boundary);
+  m_scanner.SetBoundary(boundary);
+  m_scanner.Reset();
+  // The scanner looks for the boundary at the start of a line; the first
+  // boundary normally starts the body.
+  m_scanner.Execute("\n");
+  m_line.clear();
+  m_image.reset();
+}
+
+wpi::span<char> MjpegStreamParser::GetBuffer() {
+  if (m_state != kBody) {
+    return {};
+  }
+  return {m_image->data() + m_pos, m_image->size() - m_pos};
+}
+
+void MjpegStreamParser::Filled(size_t len) {
+  m_pos += len;
+  if (m_pos == m_image->size()) {
+    m_state = kBoundary;
+    FinishImage();
+  }
+}
+
+void MjpegStreamParser::Execute(std::string_view in) {
+  while (!in.empty()) {
+    switch (m_state) {
+      case kBoundary:
+        in = m_scanner.Execute(in);
+        if (m_scanner.IsDone()) {
+          StartHeaders();
+        }
+        break;
+      case kHeaders:
+        in = ExecuteHeaders(in);
+        break;
+      case kBody: {
+        size_t len = (std::min)(in.size(), m_image->size() - m_pos);
+        std::memcpy(m_image->data() + m_pos, in.data(), len);
+        in.remove_prefix(len);
+        Filled(len);
+        break;
+      }
+      case kBodyToBoundary: {
+        std::string_view rest = m_scanner.Execute(in);
+        auto& data = m_image->vec();
+        data.insert(data.end(), in.begin(), in.end() - rest.size());
+        in = rest;
+        if (data.size() > kMaxImageSize && !m_scanner.IsDone()) {
+          m_image.reset();
+          m_error("image too large");
+          m_state = kBoundary;  // skip the rest of it
+        } else if (m_scanner.IsDone()) {
+          FinishBody();
+          StartHeaders();
+        }
+        break;
+      }
+    }
+  }
+}
+
+void MjpegStreamParser::StartHeaders() {
+  m_state = kHeaders;
+  m_inContentType = false;
+  m_inContentLength = false;
+  m_contentType.clear();
+  m_contentLength.clear();
+}
+
+std::string_view MjpegStreamParser::ExecuteHeaders(std::string_view in) {
+  while (m_state == kHeaders) {
+    size_t eol = in.find('\n');
+    if (eol == std::string_view::npos) {
+      m_line.append(in);
+      if (m_line.size() > kMaxLineLength) {
+        m_line.clear();
+        m_error("header line too long");
+        m_state = kBoundary;
+      }
+      return {};
+    }
+
+    // only copy lines split across reads
+    std::string_view line;
+    if (m_line.empty()) {
+      line = in.substr(0, eol);
+    } else {
+      m_line.append(in.substr(0, eol));
+      line = m_line;
+    }
+    in.remove_prefix(eol + 1);
+
+    line = wpi::rtrim(line);
+    if (line.empty()) {
+      StartBody();  // empty line signals end of headers
+    } else {
+      ParseHeader(line);
+    }
+    m_line.clear();
+  }
+  return in;
+}
+
+void MjpegStreamParser::ParseHeader(std::string_view line) {
+  // header fields start at the beginning of the line
+  if (!std::isspace(static_cast<unsigned char>(line[0]))) {
+    m_inContentType = false;
+    m_inContentLength = false;
+    std::string_view field;
+    std::tie(field, line) = wpi::split(line, ':');
+    field = wpi::rtrim(field);
+    if (wpi::equals_lower(field, "content-type")) {
+      m_inContentType = true;
+    } else if (wpi::equals_lower(field, "content-length")) {
+      m_inContentLength = true;
+    } else {
+      return;  // ignore other fields
+    }
+  }
+
+  // collapse whitespace
+  line = wpi::ltrim(line);
+
+  // save field data
+  if (m_inContentType) {
+    m_contentType.append(line.begin(), line.end());
+  } else if (m_inContentLength) {
+    m_contentLength.append(line.begin(), line.end());
+  }
+}
+
+void MjpegStreamParser::StartBody() {
+  // Check the content type (if present)
+  if (!m_contentType.empty() &&
+      !wpi::starts_with(m_contentType, "image/jpeg")) {
+    m_error(fmt::format("received unknown Content-Type \"{}\"",
+                        m_contentType.str()));
+    m_state = kBoundary;
+    return;
+  }
+
+  if (auto v = wpi::parse_integer<unsigned int>(m_contentLength, 10)) {
+    if (v.value() > kMaxImageSize) {
+      m_error(fmt::format("Content-Length {} too large", v.value()));
+      m_state = kBoundary;
+      return;
+    }
+    // We know how big it is!  Receive directly into an image of the right
+    // size.
+    m_image = m_alloc(v.value());
+    m_pos = 0;
+    m_state = kBody;
+    if (m_image->size() == 0) {
+      Filled(0);
+    }
+  } else {
+    // No Content-Length; the image ends at the next boundary.
+    m_image = m_alloc(m_sizeHint);
+    m_image->resize(0);
+    m_state = kBodyToBoundary;
+  }
+}
+
+void MjpegStreamParser::FinishBody() {
+  // Everything up to the end of the boundary line has been added to the
+  // image; remove the boundary and the line break preceding it.
+  std::string_view data = m_image->str();
+  size_t end = data.rfind(m_boundaryWith);
+  if (end == std::string_view::npos) {
+    end = data.rfind(m_boundaryWithout);
+  }
+  if (end == std::string_view::npos) {
+    end = data.size();
+  }
+  if (end > 0 && data[end - 1] == '\r') {
+    --end;
+  }
+  m_image->resize(end);
+  FinishImage();
+}
+
+void MjpegStreamParser::FinishImage() {
+  int width, height;
+  if (!GetJpegSize(m_image->str(), &width, &height)) {
+    m_image.reset();
+    m_error("did not receive a JPEG image");
+    return;
+  }
+  m_image->width = width;
+  m_image->height = height;
+  m_sizeHint = m_image->size();
+  m_frame(std::move(m_image));
+}
@@ -0,0 +1,92 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef CSCORE_MJPEGSTREAMPARSER_H_
+#define CSCORE_MJPEGSTREAMPARSER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <wpi/SmallString.h>
+#include <wpi/span.h>
+#include <wpinet/HttpUtil.h>
+
+#include "Image.h"
+
+namespace cs {
+
+// Incremental parser for the body of a multipart/x-mixed-replace HTTP
+// response carrying JPEG images (an MJPEG stream).  Data is fed to the parser
+// as it arrives, in pieces of any size.
+//
+// The contents of a part with a Content-Length are received directly into an
+// image: while such a part is being received, GetBuffer() returns the unfilled
+// remainder of the image, so the next read can land there instead of being
+// passed to Execute().  Parts without a Content-Length are copied into an
+// image up to the next boundary.
+class MjpegStreamParser {
+ public:
+  // Allocates an image of the given size
+  using AllocFunc = std::function<std::unique_ptr<Image>(size_t size)>;
+  // Called with each complete JPEG image; width and height are set
+  using FrameFunc = std::function<void(std::unique_ptr<Image> image)>;
+  // Called for each part that did not contain a JPEG image
+  using ErrorFunc = std::function<void(std::string_view msg)>;
+
+  MjpegStreamParser(AllocFunc alloc, FrameFunc frame, ErrorFunc error);
+
+  // Starts parsing a new stream.  The boundary must not include the leading
+  // "--".
+  void Reset(std::string_view boundary);
+
+  // Gets the buffer the next bytes of the stream should be read into, or an
+  // empty buffer if they should be passed to Execute().
+  wpi::span<char> GetBuffer();
+
+  // Consumes bytes read into the start of GetBuffer().
+  void Filled(size_t len);
+
+  // Consumes bytes of the stream.
+  void Execute(std::string_view in);
+
+ private:
+  enum State { kBoundary, kHeaders, kBody, kBodyToBoundary };
+
+  void StartHeaders();
+  std::string_view ExecuteHeaders(std::string_view in);
+  void ParseHeader(std::string_view line);
+  void StartBody();
+  void FinishBody();
+  void FinishImage();
+
+  AllocFunc m_alloc;
+  FrameFunc m_frame;
+  ErrorFunc m_error;
+
+  State m_state = kBoundary;
+  std::string m_boundaryWith;     // "\n--boundary"
+  std::string m_boundaryWithout;  // "\nboundary" (sent by some cameras)
+  wpi::HttpMultipartScanner m_scanner{""};
+
+  // part headers
+  std::string m_line;  // incomplete header line
+  bool m_inContentType = false;
+  bool m_inContentLength = false;
+  wpi::SmallString<64> m_contentType;
+  wpi::SmallString<64> m_contentLength;
+
+  // image being received, and how much of it has been received
+  std::unique_ptr<Image> m_image;
+  size_t m_pos = 0;
+
+  // size of the last image, used as the initial size of images without a
+  // Content-Length
+  size_t m_sizeHint = 64 * 1024;
+};
+
+}  // namespace cs
+
+#endif  // CSCORE_MJPEGSTREAMPARSER_H_
@@ -0,0 +1,68 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "PixelUtil.h"
+
+#include <algorithm>
+
+using namespace cs;
+
+// BT.601 video range YUV to RGB coefficients, scaled by 2^14
+static constexpr int kYScale = 19071;   // 1.164
+static constexpr int kVToR = 26149;     // 1.596
+static constexpr int kVToG = -13320;    // -0.813
+static constexpr int kUToG = -6406;     // -0.391
+static constexpr int kUToB = 33063;     // 2.018
+static constexpr int kRound = 1 << 13;
+
+// RGB to gray weights (0.299, 0.587, 0.114), scaled by 2^14
+static constexpr int kRToGray = 4899;
+static constexpr int kGToGray = 9617;
+static constexpr int kBToGray = 1868;
+
+static inline int Clamp8(int v) {
+  return std::clamp(v, 0, 255);
+}
+
+static inline void PutRGB565(uint8_t* dst, int r, int g, int b) {
+  int word = (r >> 3) | ((g << 3) & 0x07e0) | ((b << 8) & 0xf800);
+  dst[0] = word & 0xff;
+  dst[1] = word >> 8;
+}
+
+static inline void YUYVToRGB565(const uint8_t* in, uint8_t* out) {
+  int y0 = (in[0] - 16) * kYScale + kRound;
+  int u = in[1] - 128;
+  int y1 = (in[2] - 16) * kYScale + kRound;
+  int v = in[3] - 128;
+  int dr = kVToR * v;
+  int dg = kVToG * v + kUToG * u;
+  int db = kUToB * u;
+  PutRGB565(out, Clamp8((y0 + dr) >> 14), Clamp8((y0 + dg) >> 14),
+            Clamp8((y0 + db) >> 14));
+  PutRGB565(out + 2, Clamp8((y1 + dr) >> 14), Clamp8((y1 + dg) >> 14),
+            Clamp8((y1 + db) >> 14));
+}
+
+static inline uint8_t RGB565ToGray(const uint8_t* in) {
+  int word = in[0] | (in[1] << 8);
+  int r = (word << 3) & 0xf8;
+  int g = (word >> 3) & 0xfc;
+  int b = (word >> 8) & 0xf8;
+  return (r * kRToGray + g * kGToGray + b * kBToGray + kRound) >> 14;
+}
+
+void cs::ConvertYUYVToRGB565(const uint8_t* __restrict src,
+                             uint8_t* __restrict dst, size_t numPixels) {
+  for (size_t i = 0; i < numPixels / 2; ++i) {
+    YUYVToRGB565(src + i * 4, dst + i * 4);
+  }
+}
+
+void cs::ConvertRGB565ToGray(const uint8_t* __restrict src,
+                             uint8_t* __restrict dst, size_t numPixels) {
+  for (size_t i = 0; i < numPixels; ++i) {
+    dst[i] = RGB565ToGray(src + i * 2);
+  }
+}
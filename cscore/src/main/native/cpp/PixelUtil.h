@@ -0,0 +1,29 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef CSCORE_PIXELUTIL_H_
+#define CSCORE_PIXELUTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cs {
+
+// Pixel format conversions that OpenCV doesn't provide directly.  The loops
+// are branch-free fixed point so the compiler can vectorize them (SSE/AVX2 or
+// NEON, depending on the target).  The source and destination must not
+// overlap.  RGB565 pixels are little endian words with
+// red in the low 5 bits and blue in the high 5 bits, as produced by
+// Frame::ConvertBGRToRGB565().
+
+// YUYV (BT.601 video range, as OpenCV's COLOR_YUV2BGR_YUYV) to RGB565.
+// numPixels must be even.
+void ConvertYUYVToRGB565(const uint8_t* src, uint8_t* dst, size_t numPixels);
+
+// RGB565 to grayscale (with the weights of OpenCV's COLOR_BGR2GRAY).
+void ConvertRGB565ToGray(const uint8_t* src, uint8_t* dst, size_t numPixels);
+
+}  // namespace cs
+
+#endif  // CSCORE_PIXELUTIL_H_
@@ -4,6 +4,8 @@
 
 #include "RawSinkImpl.h"
 
+#include <wpi/timestamp.h>
+
 #include "Instance.h"
 #include "cscore.h"
 #include "cscore_raw.h"
@@ -50,7 +52,10 @@ uint64_t RawSinkImpl::GrabFrame(CS_RawFrame& image) {
     return 0;
   }
 
+  auto start = wpi::Now();
   auto frame = source->GetNextFrame();  // blocks
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_SINK_WAIT,
+                                wpi::Now() - start);
   if (!frame) {
     // Bad frame; sleep for 20 ms so we don't consume all processor time.
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
@@ -70,7 +75,10 @@ uint64_t RawSinkImpl::GrabFrame(CS_RawFrame& image, double timeout) {
     return 0;
   }
 
+  auto start = wpi::Now();
   auto frame = source->GetNextFrame(timeout);  // blocks
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_SINK_WAIT,
+                                wpi::Now() - start);
   if (!frame) {
     // Bad frame; sleep for 20 ms so we don't consume all processor time.
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
@@ -114,6 +122,8 @@ uint64_t RawSinkImpl::GrabFrameImpl(CS_RawFrame& rawFrame,
   std::copy(newImage->data(), newImage->data() + rawFrame.totalData,
             rawFrame.data);
 
+  m_telemetry.RecordSinkLatency(*this, CS_LATENCY_CAPTURE_TO_SINK,
+                                wpi::Now() - incomingFrame.GetTime());
   return incomingFrame.GetTime();
 }
 
@@ -8,6 +8,7 @@
 #include <cstring>
 #include <memory>
 
+#include <wpi/MathExtras.h>
 #include <wpi/StringExtras.h>
 #include <wpi/json.h>
 #include <wpi/timestamp.h>
@@ -18,7 +19,34 @@
 
 using namespace cs;
 
-static constexpr size_t kMaxImagesAvail = 32;
+// Image size classes are four per power of two (so an image is at most 25%
+// larger than needed), starting at 4 KB: 4 KB, 5 KB, 6 KB, 7 KB, 8 KB, 10 KB,
+// and so on.  Larger images than the largest class aren't pooled.
+static constexpr unsigned kMinImageClassBits = 12;
+static constexpr size_t kMaxImagesPerClass = 8;
+
+static size_t GetImageClassSize(size_t cls) {
+  return static_cast<size_t>(4 + cls % 4) << (cls / 4 + kMinImageClassBits - 2);
+}
+
+// smallest class that holds size bytes
+static size_t GetImageClassForSize(size_t size) {
+  if (size <= (size_t{1} << kMinImageClassBits)) {
+    return 0;
+  }
+  unsigned bits = wpi::Log2_64(size - 1);
+  size_t step = size_t{1} << (bits - 2);
+  return (bits - kMinImageClassBits) * 4 + (size + step - 1) / step - 4;
+}
+
+// largest class that fits in capacity bytes, or -1 if none
+static int GetImageClassForCapacity(size_t capacity) {
+  if (capacity < (size_t{1} << kMinImageClassBits)) {
+    return -1;
+  }
+  unsigned bits = wpi::Log2_64(capacity);
+  return (bits - kMinImageClassBits) * 4 + (capacity >> (bits - 2)) - 4;
+}
 
 SourceImpl::SourceImpl(std::string_view name, wpi::Logger& logger,
                        Notifier& notifier, Telemetry& telemetry)
@@ -405,28 +433,23 @@ std::vector<VideoMode> SourceImpl::EnumerateVideoModes(
 std::unique_ptr<Image> SourceImpl::AllocImage(
     VideoMode::PixelFormat pixelFormat, int width, int height, size_t size) {
   std::unique_ptr<Image> image;
-  {
-    std::scoped_lock lock{m_poolMutex};
-    // find the smallest existing frame that is at least big enough.
-    int found = -1;
-    for (size_t i = 0; i < m_imagesAvail.size(); ++i) {
-      // is it big enough?
-      if (m_imagesAvail[i] && m_imagesAvail[i]->capacity() >= size) {
-        // is it smaller than the last found?
-        if (found < 0 ||
-            m_imagesAvail[i]->capacity() < m_imagesAvail[found]->capacity()) {
-          // yes, update
-          found = i;
-        }
+  size_t cls = GetImageClassForSize(size);
+  if (cls < kNumImageClasses) {
+    {
+      std::scoped_lock lock{m_poolMutex};
+      auto& avail = m_imagesAvail[cls];
+      if (!avail.empty()) {
+        image = std::move(avail.back());
+        avail.pop_back();
       }
     }
-
-    // if nothing found, allocate a new buffer
-    if (found < 0) {
-      image = std::make_unique<Image>(size);
-    } else {
-      image = std::move(m_imagesAvail[found]);
+    // if nothing available, allocate a new buffer of the full class size, so
+    // it can be reused for any image of the class
+    if (!image) {
+      image = std::make_unique<Image>(GetImageClassSize(cls));
     }
+  } else {
+    image = std::make_unique<Image>(size);
   }
 
   // Initialize image
@@ -434,6 +457,7 @@ std::unique_ptr<Image> SourceImpl::AllocImage(
   image->pixelFormat = pixelFormat;
   image->width = width;
   image->height = height;
+  image->jpegQuality = -1;
 
   return image;
 }
@@ -454,6 +478,10 @@ void SourceImpl::PutFrame(std::unique_ptr<Image> image, Frame::Time time) {
   // Update telemetry
   m_telemetry.RecordSourceFrames(*this, 1);
   m_telemetry.RecordSourceBytes(*this, static_cast<int>(image->size()));
+  if (time != 0) {
+    m_telemetry.RecordSourceLatency(*this, CS_LATENCY_CAPTURE_TO_PUT,
+                                    wpi::Now() - time);
+  }
 
   // Update frame
   {
@@ -510,28 +538,18 @@ void SourceImpl::UpdatePropertyValue(int property, bool setString, int value,
 }
 
 void SourceImpl::ReleaseImage(std::unique_ptr<Image> image) {
+  int cls = GetImageClassForCapacity(image->capacity());
+  if (cls < 0 || static_cast<size_t>(cls) >= kNumImageClasses) {
+    return;
+  }
   std::scoped_lock lock{m_poolMutex};
   if (m_destroyFrames) {
     return;
   }
-  // Return the frame to the pool.  First try to find an empty slot, otherwise
-  // add it to the end.
-  auto it = std::find(m_imagesAvail.begin(), m_imagesAvail.end(), nullptr);
-  if (it != m_imagesAvail.end()) {
-    *it = std::move(image);
-  } else if (m_imagesAvail.size() > kMaxImagesAvail) {
-    // Replace smallest buffer; don't need to check for null because the above
-    // find would have found it.
-    auto it2 = std::min_element(
-        m_imagesAvail.begin(), m_imagesAvail.end(),
-        [](const std::unique_ptr<Image>& a, const std::unique_ptr<Image>& b) {
-          return a->capacity() < b->capacity();
-        });
-    if ((*it2)->capacity() < image->capacity()) {
-      *it2 = std::move(image);
-    }
-  } else {
-    m_imagesAvail.emplace_back(std::move(image));
+  // Return the image to the pool, unless the pool for its class is full
+  auto& avail = m_imagesAvail[cls];
+  if (avail.size() < kMaxImagesPerClass) {
+    avail.emplace_back(std::move(image));
   }
 }
 
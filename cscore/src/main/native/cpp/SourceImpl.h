@@ -5,6 +5,7 @@
 #ifndef CSCORE_SOURCEIMPL_H_
 #define CSCORE_SOURCEIMPL_H_
 
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <memory>
@@ -178,10 +179,14 @@ class SourceImpl : public PropertyContainer {
 
   bool m_destroyFrames{false};
 
-  // Pool of frames/images to reduce malloc traffic.
+  // Pool of frames/images to reduce malloc traffic.  Images are pooled by
+  // capacity in size classes (see SourceImpl.cpp), so any image in the list
+  // for a class fits an allocation of that class.
+  static constexpr size_t kNumImageClasses = 80;
   wpi::mutex m_poolMutex;
   std::vector<std::unique_ptr<Frame::Impl>> m_framesAvail;
-  std::vector<std::unique_ptr<Image>> m_imagesAvail;
+  std::array<std::vector<std::unique_ptr<Image>>, kNumImageClasses>
+      m_imagesAvail;
 
   std::atomic_bool m_connected{false};
 
@@ -4,6 +4,7 @@
 
 #include "Telemetry.h"
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 
@@ -13,6 +14,7 @@
 #include "Handle.h"
 #include "Instance.h"
 #include "Notifier.h"
+#include "SinkImpl.h"
 #include "SourceImpl.h"
 #include "cscore_cpp.h"
 
@@ -27,10 +29,14 @@ class Telemetry::Thread : public wpi::SafeThread {
   Notifier& m_notifier;
   wpi::DenseMap<std::pair<CS_Handle, int>, int64_t> m_user;
   wpi::DenseMap<std::pair<CS_Handle, int>, int64_t> m_current;
+  wpi::DenseMap<std::pair<CS_Handle, int>, CS_LatencyHistogram> m_userLatency;
+  wpi::DenseMap<std::pair<CS_Handle, int>, CS_LatencyHistogram>
+      m_currentLatency;
   double m_period = 0.0;
   double m_elapsed = 0.0;
   bool m_updated = false;
   int64_t GetValue(CS_Handle handle, CS_TelemetryKind kind, CS_Status* status);
+  void AddLatency(CS_Handle handle, CS_LatencyStage stage, int64_t time);
 };
 
 int64_t Telemetry::Thread::GetValue(CS_Handle handle, CS_TelemetryKind kind,
@@ -43,6 +49,26 @@ int64_t Telemetry::Thread::GetValue(CS_Handle handle, CS_TelemetryKind kind,
   return it->getSecond();
 }
 
+void Telemetry::Thread::AddLatency(CS_Handle handle, CS_LatencyStage stage,
+                                   int64_t time) {
+  time = (std::max)(time, int64_t{0});
+  auto& histogram =
+      m_currentLatency[std::make_pair(handle, static_cast<int>(stage))];
+  if (histogram.count == 0 || time < histogram.min) {
+    histogram.min = time;
+  }
+  histogram.max = (std::max)(histogram.max, time);
+  ++histogram.count;
+  histogram.total += time;
+
+  // bucket i counts times under 2^i
+  int bucket = 0;
+  while (bucket < CS_LATENCY_HISTOGRAM_BUCKETS - 1 && (time >> bucket) != 0) {
+    ++bucket;
+  }
+  ++histogram.buckets[bucket];
+}
+
 Telemetry::~Telemetry() = default;
 
 void Telemetry::Start() {
@@ -78,6 +104,8 @@ void Telemetry::Thread::Main() {
     // move to user and clear current, as we don't keep around old values
     m_user = std::move(m_current);
     m_current.clear();
+    m_userLatency = std::move(m_currentLatency);
+    m_currentLatency.clear();
     auto curTime = std::chrono::steady_clock::now();
     m_elapsed = std::chrono::duration<double>(curTime - prevTime).count();
     prevTime = curTime;
@@ -131,24 +159,89 @@ double Telemetry::GetAverageValue(CS_Handle handle, CS_TelemetryKind kind,
   return thr->GetValue(handle, kind, status) / thr->m_elapsed;
 }
 
+CS_LatencyHistogram Telemetry::GetLatency(CS_Handle handle,
+                                          CS_LatencyStage stage,
+                                          CS_Status* status) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    *status = CS_TELEMETRY_NOT_ENABLED;
+    return {};
+  }
+  auto it =
+      thr->m_userLatency.find(std::make_pair(handle, static_cast<int>(stage)));
+  if (it == thr->m_userLatency.end()) {
+    *status = CS_EMPTY_VALUE;
+    return {};
+  }
+  return it->getSecond();
+}
+
 void Telemetry::RecordSourceBytes(const SourceImpl& source, int quantity) {
+  RecordSource(source, CS_SOURCE_BYTES_RECEIVED, quantity);
+}
+
+void Telemetry::RecordSourceFrames(const SourceImpl& source, int quantity) {
+  RecordSource(source, CS_SOURCE_FRAMES_RECEIVED, quantity);
+}
+
+void Telemetry::RecordSourceJpegCacheHits(const SourceImpl& source,
+                                          int quantity) {
+  RecordSource(source, CS_SOURCE_JPEG_CACHE_HITS, quantity);
+}
+
+void Telemetry::RecordSourceJpegEncode(const SourceImpl& source,
+                                       int64_t time) {
   auto thr = m_owner.GetThread();
   if (!thr) {
     return;
   }
-  auto handleData = Instance::GetInstance().FindSource(source);
-  thr->m_current[std::make_pair(Handle{handleData.first, Handle::kSource},
-                                static_cast<int>(CS_SOURCE_BYTES_RECEIVED))] +=
-      quantity;
+  Handle handle{Instance::GetInstance().FindSource(source).first,
+                Handle::kSource};
+  ++thr->m_current[std::make_pair(handle,
+                                  static_cast<int>(CS_SOURCE_JPEG_ENCODES))];
+  thr->m_current[std::make_pair(
+      handle, static_cast<int>(CS_SOURCE_JPEG_ENCODE_TIME))] += time;
+  thr->AddLatency(handle, CS_LATENCY_ENCODE, time);
 }
 
-void Telemetry::RecordSourceFrames(const SourceImpl& source, int quantity) {
+void Telemetry::RecordSourceLatency(const SourceImpl& source,
+                                    CS_LatencyStage stage, int64_t time) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  thr->AddLatency(Handle{Instance::GetInstance().FindSource(source).first,
+                         Handle::kSource},
+                  stage, time);
+}
+
+void Telemetry::RecordSinkLatency(const SinkImpl& sink, CS_LatencyStage stage,
+                                  int64_t time) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  thr->AddLatency(
+      Handle{Instance::GetInstance().FindSink(sink).first, Handle::kSink},
+      stage, time);
+}
+
+void Telemetry::RecordLatency(CS_Handle handle, CS_LatencyStage stage,
+                              int64_t time) {
+  auto thr = m_owner.GetThread();
+  if (!thr) {
+    return;
+  }
+  thr->AddLatency(handle, stage, time);
+}
+
+void Telemetry::RecordSource(const SourceImpl& source, CS_TelemetryKind kind,
+                             int64_t quantity) {
   auto thr = m_owner.GetThread();
   if (!thr) {
     return;
   }
   auto handleData = Instance::GetInstance().FindSource(source);
   thr->m_current[std::make_pair(Handle{handleData.first, Handle::kSource},
-                                static_cast<int>(CS_SOURCE_FRAMES_RECEIVED))] +=
-      quantity;
+                                static_cast<int>(kind))] += quantity;
 }
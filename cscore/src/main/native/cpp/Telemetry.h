@@ -12,6 +12,7 @@
 namespace cs {
 
 class Notifier;
+class SinkImpl;
 class SourceImpl;
 
 class Telemetry {
@@ -30,12 +31,26 @@ class Telemetry {
   int64_t GetValue(CS_Handle handle, CS_TelemetryKind kind, CS_Status* status);
   double GetAverageValue(CS_Handle handle, CS_TelemetryKind kind,
                          CS_Status* status);
+  CS_LatencyHistogram GetLatency(CS_Handle handle, CS_LatencyStage stage,
+                                 CS_Status* status);
 
   // Telemetry events
   void RecordSourceBytes(const SourceImpl& source, int quantity);
   void RecordSourceFrames(const SourceImpl& source, int quantity);
+  void RecordSourceJpegCacheHits(const SourceImpl& source, int quantity);
+  void RecordSourceJpegEncode(const SourceImpl& source, int64_t time);
+
+  // Latency events; times are in microseconds
+  void RecordSourceLatency(const SourceImpl& source, CS_LatencyStage stage,
+                           int64_t time);
+  void RecordSinkLatency(const SinkImpl& sink, CS_LatencyStage stage,
+                         int64_t time);
+  void RecordLatency(CS_Handle handle, CS_LatencyStage stage, int64_t time);
 
  private:
+  void RecordSource(const SourceImpl& source, CS_TelemetryKind kind,
+                    int64_t quantity);
+
   Notifier& m_notifier;
 
   class Thread;
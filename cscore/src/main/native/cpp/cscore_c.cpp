@@ -436,6 +436,16 @@ double CS_GetTelemetryAverageValue(CS_Handle handle, CS_TelemetryKind kind,
   return cs::GetTelemetryAverageValue(handle, kind, status);
 }
 
+void CS_GetTelemetryLatency(CS_Handle handle, CS_LatencyStage stage,
+                            CS_LatencyHistogram* histogram, CS_Status* status) {
+  *histogram = cs::GetTelemetryLatency(handle, stage, status);
+}
+
+double CS_GetLatencyPercentile(const CS_LatencyHistogram* histogram,
+                               double percentile) {
+  return cs::GetLatencyPercentile(*histogram, percentile);
+}
+
 void CS_SetLogger(CS_LogFunc func, unsigned int min_level) {
   cs::SetLogger(func, min_level);
 }
@@ -4,6 +4,8 @@
 
 #include "cscore_cpp.h"
 
+#include <algorithm>
+
 #include <wpi/SmallString.h>
 #include <wpi/json.h>
 #include <wpinet/hostname.h>
@@ -839,6 +841,31 @@ double GetTelemetryAverageValue(CS_Handle handle, CS_TelemetryKind kind,
                                                            status);
 }
 
+CS_LatencyHistogram GetTelemetryLatency(CS_Handle handle,
+                                        CS_LatencyStage stage,
+                                        CS_Status* status) {
+  return Instance::GetInstance().telemetry.GetLatency(handle, stage, status);
+}
+
+double GetLatencyPercentile(const CS_LatencyHistogram& histogram,
+                            double percentile) {
+  if (histogram.count == 0) {
+    return 0;
+  }
+  double rank = std::clamp(percentile, 0.0, 100.0) / 100 * histogram.count;
+  int64_t seen = 0;
+  for (int i = 0; i < CS_LATENCY_HISTOGRAM_BUCKETS; ++i) {
+    seen += histogram.buckets[i];
+    if (histogram.buckets[i] != 0 && seen >= rank) {
+      // the bucket's upper bound, within the range of recorded times
+      return std::clamp(static_cast<double>(int64_t{1} << i),
+                        static_cast<double>(histogram.min),
+                        static_cast<double>(histogram.max));
+    }
+  }
+  return histogram.max;
+}
+
 //
 // Logging Functions
 //
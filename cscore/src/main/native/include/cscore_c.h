@@ -179,9 +179,53 @@ enum CS_EventKind {
  */
 enum CS_TelemetryKind {
   CS_SOURCE_BYTES_RECEIVED = 1,
-  CS_SOURCE_FRAMES_RECEIVED = 2
+  CS_SOURCE_FRAMES_RECEIVED = 2,
+  /** JPEG requests served by a previously compressed image of the frame */
+  CS_SOURCE_JPEG_CACHE_HITS = 3,
+  /** Number of JPEG compressions of source frames */
+  CS_SOURCE_JPEG_ENCODES = 4,
+  /** Time spent compressing source frames to JPEG, in microseconds */
+  CS_SOURCE_JPEG_ENCODE_TIME = 5
 };
 
+/**
+ * Latency telemetry stages.  Source stages are recorded for the source
+ * handle, and sink stages for the sink handle.
+ */
+enum CS_LatencyStage {
+  /** Source: from the capture time of a frame until it is put to the source */
+  CS_LATENCY_CAPTURE_TO_PUT = 0,
+  /** Source: each decode, resize, or color conversion of a frame's image */
+  CS_LATENCY_CONVERT = 1,
+  /** Source: each JPEG compression of a frame's image */
+  CS_LATENCY_ENCODE = 2,
+  /** Sink: time spent waiting for the next frame from the source */
+  CS_LATENCY_SINK_WAIT = 3,
+  /**
+   * Sink: from the capture time of a frame until the sink has it (when it is
+   * returned by a grab, or has been sent to an MJPEG client)
+   */
+  CS_LATENCY_CAPTURE_TO_SINK = 4,
+  /** Sink: time to send a frame to an MJPEG client */
+  CS_LATENCY_SEND = 5
+};
+
+/** Number of buckets in a latency histogram */
+#define CS_LATENCY_HISTOGRAM_BUCKETS 24
+
+/**
+ * Latency histogram over a telemetry period, in microseconds.  Bucket 0
+ * counts times under 1 us, and bucket i counts times of at least 2^(i-1) us
+ * and under 2^i us; the last bucket also counts all longer times.
+ */
+typedef struct CS_LatencyHistogram {
+  int64_t count;
+  int64_t total;
+  int64_t min;
+  int64_t max;
+  int64_t buckets[CS_LATENCY_HISTOGRAM_BUCKETS];
+} CS_LatencyHistogram;
+
 /** Connection strategy */
 enum CS_ConnectionStrategy {
   /**
@@ -461,6 +505,10 @@ int64_t CS_GetTelemetryValue(CS_Handle handle, enum CS_TelemetryKind kind,
                              CS_Status* status);
 double CS_GetTelemetryAverageValue(CS_Handle handle, enum CS_TelemetryKind kind,
                                    CS_Status* status);
+void CS_GetTelemetryLatency(CS_Handle handle, enum CS_LatencyStage stage,
+                            CS_LatencyHistogram* histogram, CS_Status* status);
+double CS_GetLatencyPercentile(const CS_LatencyHistogram* histogram,
+                               double percentile);
 /** @} */
 
 /**
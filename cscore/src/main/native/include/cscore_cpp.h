@@ -405,6 +405,15 @@ int64_t GetTelemetryValue(CS_Handle handle, CS_TelemetryKind kind,
                           CS_Status* status);
 double GetTelemetryAverageValue(CS_Handle handle, CS_TelemetryKind kind,
                                 CS_Status* status);
+CS_LatencyHistogram GetTelemetryLatency(CS_Handle handle,
+                                        CS_LatencyStage stage,
+                                        CS_Status* status);
+/**
+ * Estimates a percentile (0-100) of the times in a latency histogram, in
+ * microseconds, from the upper bound of the bucket it falls in.
+ */
+double GetLatencyPercentile(const CS_LatencyHistogram& histogram,
+                            double percentile);
 /** @} */
 
 /**
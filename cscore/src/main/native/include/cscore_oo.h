@@ -321,6 +321,17 @@ class VideoSource {
    */
   double GetActualDataRate() const;
 
+  /**
+   * Get the latency histogram of a source stage (capture to put, convert, or
+   * encode).
+   *
+   * <p>SetTelemetryPeriod() must be called for this to be valid.
+   *
+   * @param stage Latency stage
+   * @return Latency histogram over the telemetry period.
+   */
+  CS_LatencyHistogram GetLatency(CS_LatencyStage stage) const;
+
   /**
    * Enumerate all known video modes for this source.
    */
@@ -465,6 +476,15 @@ class UsbCamera : public VideoCamera {
    * @param level 0=don't display Connecting message, 1=do display message
    */
   void SetConnectVerbose(int level);
+
+  /**
+   * Set whether frames reference the camera's capture buffers instead of
+   * copying them (zero copy).  A few buffers are lent at a time; when they are
+   * all held by frames, further frames are copied.  Only supported on Linux.
+   *
+   * @param enabled true to enable zero copy
+   */
+  void SetZeroCopy(bool enabled);
 };
 
 /**
@@ -837,6 +857,17 @@ class VideoSink {
    */
   VideoProperty GetSourceProperty(std::string_view name);
 
+  /**
+   * Get the latency histogram of a sink stage (sink wait, capture to sink, or
+   * send).
+   *
+   * <p>SetTelemetryPeriod() must be called for this to be valid.
+   *
+   * @param stage Latency stage
+   * @return Latency histogram over the telemetry period.
+   */
+  CS_LatencyHistogram GetLatency(CS_LatencyStage stage) const;
+
   CS_Status GetLastStatus() const { return m_status; }
 
   /**
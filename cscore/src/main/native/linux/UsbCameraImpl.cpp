@@ -17,6 +17,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -56,6 +57,8 @@ static constexpr char const* kPropExValue = "exposure_absolute";
 static constexpr char const* kPropBrValue = "brightness";
 static constexpr char const* kPropConnectVerbose = "connect_verbose";
 static constexpr unsigned kPropConnectVerboseId = 0;
+static constexpr char const* kPropZeroCopy = "zero_copy";
+static constexpr unsigned kPropZeroCopyId = 1;
 
 // Conversions v4l2_fract time per frame from/to frames per second (fps)
 static inline int FractToFPS(const struct v4l2_fract& timeperframe) {
@@ -69,6 +72,27 @@ static inline struct v4l2_fract FPSToFract(int fps) {
   return timeperframe;
 }
 
+// Converts the capture time of a buffer to the wpi::Now() time base.  Falls
+// back to the current time if the driver doesn't provide a monotonic
+// timestamp, or the timestamp is implausible.
+static Frame::Time GetBufferTime(const struct v4l2_buffer& buf) {
+  Frame::Time now = wpi::Now();
+  if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) !=
+      V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+    return now;
+  }
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+    return now;
+  }
+  int64_t age = (ts.tv_sec - buf.timestamp.tv_sec) * 1000000ll +
+                ts.tv_nsec / 1000 - buf.timestamp.tv_usec;
+  if (age < 0 || age > 1000000 || static_cast<Frame::Time>(age) > now) {
+    return now;
+  }
+  return now - age;
+}
+
 // Conversion from v4l2_format pixelformat to VideoMode::PixelFormat
 static VideoMode::PixelFormat ToPixelFormat(__u32 pixelFormat) {
   switch (pixelFormat) {
@@ -324,6 +348,10 @@ UsbCameraImpl::UsbCameraImpl(std::string_view name, wpi::Logger& logger,
                                                kPropConnectVerboseId,
                                                CS_PROP_INTEGER, 0, 1, 1, 1, 1);
   });
+  CreateProperty(kPropZeroCopy, [] {
+    return std::make_unique<UsbCameraProperty>(kPropZeroCopy, kPropZeroCopyId,
+                                               CS_PROP_BOOLEAN, 0, 1, 1, 0, 0);
+  });
 }
 
 UsbCameraImpl::~UsbCameraImpl() {
@@ -512,13 +540,14 @@ void UsbCameraImpl::CameraThreadMain() {
       if ((buf.flags & V4L2_BUF_FLAG_ERROR) == 0) {
         SDEBUG4("got image size={} index={}", buf.bytesused, buf.index);
 
-        if (buf.index >= kNumBuffers || !m_buffers[buf.index].m_data) {
+        if (buf.index >= kNumBuffers || !m_buffers[buf.index] ||
+            !m_buffers[buf.index]->m_data) {
           SWARNING("invalid buffer {}", buf.index);
           continue;
         }
 
         std::string_view image{
-            static_cast<const char*>(m_buffers[buf.index].m_data),
+            static_cast<const char*>(m_buffers[buf.index]->m_data),
             static_cast<size_t>(buf.bytesused)};
         int width = m_mode.width;
         int height = m_mode.height;
@@ -529,8 +558,12 @@ void UsbCameraImpl::CameraThreadMain() {
           good = false;
         }
         if (good) {
+          Frame::Time time = GetBufferTime(buf);
+          if (m_zeroCopy && DeviceLendBuffer(buf, width, height, time)) {
+            continue;  // requeued when the frame is released
+          }
           PutFrame(static_cast<VideoMode::PixelFormat>(m_mode.pixelFormat),
-                   width, height, image, wpi::Now());  // TODO: time
+                   width, height, image, time);
         }
       }
 
@@ -557,9 +590,16 @@ void UsbCameraImpl::DeviceDisconnect() {
     return;  // already disconnected
   }
 
-  // Unmap buffers
+  // Stop requeuing lent buffers
+  if (m_lentBuffers) {
+    std::scoped_lock lock(m_lentBuffers->mutex);
+    m_lentBuffers->fd = -1;
+  }
+  m_lentBuffers.reset();
+
+  // Unmap buffers (lent buffers are unmapped when released)
   for (int i = 0; i < kNumBuffers; ++i) {
-    m_buffers[i] = UsbCameraBuffer{};
+    m_buffers[i].reset();
   }
 
   // Close device
@@ -654,20 +694,22 @@ void UsbCameraImpl::DeviceConnect() {
     }
     SDEBUG4("buf {} length={} offset={}", i, buf.length, buf.m.offset);
 
-    m_buffers[i] = UsbCameraBuffer(fd, buf.length, buf.m.offset);
-    if (!m_buffers[i].m_data) {
+    m_buffers[i] =
+        std::make_shared<UsbCameraBuffer>(fd, buf.length, buf.m.offset);
+    if (!m_buffers[i]->m_data) {
       SWARNING("could not map buffer {}", i);
       // release other buffers
-      for (int j = 0; j < i; ++j) {
-        m_buffers[j] = UsbCameraBuffer{};
+      for (int j = 0; j <= i; ++j) {
+        m_buffers[j].reset();
       }
       close(fd);
       m_fd = -1;
       return;
     }
 
-    SDEBUG4("buf {} address={}", i, m_buffers[i].m_data);
+    SDEBUG4("buf {} address={}", i, m_buffers[i]->m_data);
   }
+  m_lentBuffers = std::make_shared<LentBuffers>();
 
   // Update description (as it may have changed)
   SetDescription(GetDescriptionImpl(m_path.c_str()));
@@ -688,9 +730,13 @@ bool UsbCameraImpl::DeviceStreamOn() {
     return false;
   }
 
-  // Queue buffers
+  // Queue buffers; lent buffers are queued when their frames are released
   SDEBUG3("{}", "queuing buffers");
+  std::scoped_lock lock(m_lentBuffers->mutex);
   for (int i = 0; i < kNumBuffers; ++i) {
+    if (m_lentBuffers->lent[i]) {
+      continue;
+    }
     struct v4l2_buffer buf;
     std::memset(&buf, 0, sizeof(buf));
     buf.index = i;
@@ -719,6 +765,7 @@ bool UsbCameraImpl::DeviceStreamOn() {
     return false;
   }
   SDEBUG4("{}", "enabled streaming");
+  m_lentBuffers->fd = fd;
   m_streaming = true;
   return true;
 }
@@ -731,15 +778,54 @@ bool UsbCameraImpl::DeviceStreamOff() {
   if (fd < 0) {
     return false;
   }
+  std::scoped_lock lock(m_lentBuffers->mutex);
   int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
   if (DoIoctl(fd, VIDIOC_STREAMOFF, &type) != 0) {
     return false;
   }
+  m_lentBuffers->fd = -1;
   SDEBUG4("{}", "disabled streaming");
   m_streaming = false;
   return true;
 }
 
+// Puts a frame that references a dequeued buffer instead of copying it; the
+// buffer is requeued when the frame is released.  Returns false (without
+// putting a frame) if too many buffers are already lent.
+bool UsbCameraImpl::DeviceLendBuffer(const struct v4l2_buffer& buf, int width,
+                                     int height, Frame::Time time) {
+  {
+    std::scoped_lock lock(m_lentBuffers->mutex);
+    if (m_lentBuffers->count >= kMaxLentBuffers) {
+      return false;
+    }
+    m_lentBuffers->lent[buf.index] = true;
+    ++m_lentBuffers->count;
+  }
+
+  auto& buffer = m_buffers[buf.index];
+  auto image = std::make_unique<Image>(
+      static_cast<uchar*>(buffer->m_data), buf.bytesused,
+      [lentBuffers = m_lentBuffers, buffer, index = buf.index] {
+        std::scoped_lock lock(lentBuffers->mutex);
+        lentBuffers->lent[index] = false;
+        --lentBuffers->count;
+        if (lentBuffers->fd >= 0) {
+          struct v4l2_buffer buf;
+          std::memset(&buf, 0, sizeof(buf));
+          buf.index = index;
+          buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+          buf.memory = V4L2_MEMORY_MMAP;
+          DoIoctl(lentBuffers->fd, VIDIOC_QBUF, &buf);
+        }
+      });
+  image->pixelFormat = static_cast<VideoMode::PixelFormat>(m_mode.pixelFormat);
+  image->width = width;
+  image->height = height;
+  PutFrame(std::move(image), time);
+  return true;
+}
+
 CS_StatusValue UsbCameraImpl::DeviceCmdSetMode(
     std::unique_lock<wpi::mutex>& lock, const Message& msg) {
   VideoMode newMode;
@@ -850,6 +936,8 @@ CS_StatusValue UsbCameraImpl::DeviceCmdSetProperty(
   if (!prop->device) {
     if (prop->id == kPropConnectVerboseId) {
       m_connectVerbose = value;
+    } else if (prop->id == kPropZeroCopyId) {
+      m_zeroCopy = value != 0;
     }
   } else {
     if (!prop->DeviceSet(lock, m_fd, value, valueStr)) {
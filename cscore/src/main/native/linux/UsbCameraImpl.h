@@ -7,6 +7,7 @@
 
 #include <linux/videodev2.h>
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <string>
@@ -115,6 +116,8 @@ class UsbCameraImpl : public SourceImpl {
   void DeviceConnect();
   bool DeviceStreamOn();
   bool DeviceStreamOff();
+  bool DeviceLendBuffer(const struct v4l2_buffer& buf, int width, int height,
+                        Frame::Time time);
   void DeviceProcessCommands();
   void DeviceSetMode();
   void DeviceSetFPS();
@@ -147,10 +150,26 @@ class UsbCameraImpl : public SourceImpl {
   bool m_modeSetResolution{false};
   bool m_modeSetFPS{false};
   int m_connectVerbose{1};
+  bool m_zeroCopy{false};
   unsigned m_capabilities = 0;
   // Number of buffers to ask OS for
   static constexpr int kNumBuffers = 4;
-  std::array<UsbCameraBuffer, kNumBuffers> m_buffers;
+  // Maximum number of buffers lent to frames; the rest stay queued so the
+  // driver always has buffers to fill
+  static constexpr int kMaxLentBuffers = kNumBuffers - 2;
+  // Shared so that lent buffers stay mapped until their frames are released
+  std::array<std::shared_ptr<UsbCameraBuffer>, kNumBuffers> m_buffers;
+
+  // Buffers of the current connection lent to frames instead of being copied
+  // (zero copy).  Shared with the images referencing them, which requeue them
+  // when released (from any thread).  Protected by its mutex.
+  struct LentBuffers {
+    wpi::mutex mutex;
+    int fd{-1};  // set while streaming
+    std::array<bool, kNumBuffers> lent{};
+    int count{0};
+  };
+  std::shared_ptr<LentBuffers> m_lentBuffers;
 
   std::atomic_int m_fd;
   std::atomic_int m_command_fd;  // for command eventfd
@@ -0,0 +1,86 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <opencv2/core/core.hpp>
+
+#include "cscore_cv.h"
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// Three 640x480 BGR sources, each grabbed by two CvSinks; reports grabbed
+// frames per second and bytes copied into the grabbed images, for GrabFrame()
+// (which copies each image) and GrabFrameDirect() (which doesn't).
+TEST(CvSinkBenchTest, DISABLED_GrabFrame) {
+  static constexpr int kNumSources = 3;
+  static constexpr int kNumSinksPerSource = 2;
+  static constexpr int kNumFrames = 300;
+
+  for (bool direct : {false, true}) {
+    std::vector<CvSource> sources;
+    std::vector<CvSink> sinks;
+    for (int i = 0; i < kNumSources; ++i) {
+      sources.emplace_back(fmt::format("source{}", i), VideoMode::kBGR, 640,
+                           480, 30);
+      for (int j = 0; j < kNumSinksPerSource; ++j) {
+        sinks.emplace_back(fmt::format("sink{}_{}", i, j));
+        sinks.back().SetSource(sources.back());
+      }
+    }
+
+    std::atomic_bool done{false};
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kNumSources; ++i) {
+      producers.emplace_back([&, i] {
+        cv::Mat frame{480, 640, CV_8UC3, cv::Scalar{i * 50.0, 100, 200}};
+        while (!done) {
+          sources[i].PutFrame(frame);
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      });
+    }
+
+    std::atomic<uint64_t> copied{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> consumers;
+    for (size_t i = 0; i < sinks.size(); ++i) {
+      consumers.emplace_back([&, i] {
+        cv::Mat image;
+        for (int n = 0; n < kNumFrames;) {
+          uint64_t time = direct ? sinks[i].GrabFrameDirect(image, 1.0)
+                                 : sinks[i].GrabFrame(image, 1.0);
+          if (time == 0) {
+            continue;
+          }
+          ++n;
+          if (!direct) {
+            copied += image.total() * image.elemSize();
+          }
+        }
+      });
+    }
+    for (auto&& consumer : consumers) {
+      consumer.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    done = true;
+    for (auto&& producer : producers) {
+      producer.join();
+    }
+
+    fmt::print(
+        "{}: {:.1f} frames/s per sink, {} bytes copied\n",
+        direct ? "GrabFrameDirect" : "GrabFrame",
+        kNumFrames / std::chrono::duration<double>(elapsed).count(),
+        copied.load());
+  }
+}
+
+}  // namespace cs
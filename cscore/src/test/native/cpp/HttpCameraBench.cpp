@@ -0,0 +1,129 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <wpi/Logger.h>
+#include <wpinet/NetworkStream.h>
+#include <wpinet/TCPAcceptor.h>
+
+#include "cscore_cv.h"
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// Stand-in for an MJPEG camera: streams the same 640x480 JPEG to each client
+// as fast as the client receives it, counting the frames sent.
+class MjpegStandIn {
+ public:
+  MjpegStandIn(int port, std::string_view jpeg)
+      : m_acceptor{port, "127.0.0.1", m_logger} {
+    m_part = fmt::format(
+        "--boundary\r\nContent-Type: image/jpeg\r\nContent-Length: {}\r\n\r\n",
+        jpeg.size());
+    m_part += jpeg;
+    m_part += "\r\n";
+    m_acceptor.start();
+    m_acceptThread = std::thread([this] {
+      while (auto stream = m_acceptor.accept()) {
+        m_clients.emplace_back(&MjpegStandIn::Serve, this, std::move(stream));
+      }
+    });
+  }
+
+  ~MjpegStandIn() {
+    m_done = true;
+    m_acceptor.shutdown();
+    m_acceptThread.join();
+    for (auto&& client : m_clients) {
+      client.join();
+    }
+  }
+
+  std::atomic_int frames{0};
+
+ private:
+  void Serve(std::unique_ptr<wpi::NetworkStream> stream) {
+    // the request isn't checked
+    char buf[1024];
+    wpi::NetworkStream::Error err;
+    stream->receive(buf, sizeof(buf), &err);
+    std::string_view header =
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: multipart/x-mixed-replace;boundary=boundary\r\n\r\n";
+    stream->send(header.data(), header.size(), &err);
+    while (!m_done) {
+      if (stream->send(m_part.data(), m_part.size(), &err) != m_part.size()) {
+        break;
+      }
+      ++frames;
+    }
+  }
+
+  wpi::Logger m_logger;
+  wpi::TCPAcceptor m_acceptor;
+  std::string m_part;
+  std::atomic_bool m_done{false};
+  std::thread m_acceptThread;
+  std::vector<std::thread> m_clients;
+};
+
+// An increasing number of HTTP cameras streaming from a local stand-in server;
+// reports the process CPU use (which includes the server threads) and the
+// frames received per second by each camera.
+TEST(HttpCameraBenchTest, DISABLED_Cameras) {
+  static constexpr int kPort = 11812;
+  static constexpr std::chrono::seconds kDuration{3};
+
+  cv::Mat frame{480, 640, CV_8UC3};
+  cv::randu(frame, 0, 256);
+  std::vector<uchar> jpeg;
+  cv::imencode(".jpg", frame, jpeg, {cv::IMWRITE_JPEG_QUALITY, 80});
+
+  for (int numCameras : {1, 2, 4}) {
+    MjpegStandIn server{
+        kPort, {reinterpret_cast<const char*>(jpeg.data()), jpeg.size()}};
+
+    std::vector<HttpCamera> cameras;
+    std::vector<CvSink> sinks;
+    for (int i = 0; i < numCameras; ++i) {
+      cameras.emplace_back(fmt::format("camera{}", i),
+                           fmt::format("http://127.0.0.1:{}/", kPort));
+      sinks.emplace_back(fmt::format("sink{}", i));
+      sinks.back().SetSource(cameras.back());
+      sinks.back().SetEnabled(true);
+    }
+
+    // let the cameras connect
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    int startFrames = server.frames;
+    auto start = std::chrono::steady_clock::now();
+    auto startCpu = std::clock();
+    std::this_thread::sleep_for(kDuration);
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    double cpu = static_cast<double>(std::clock() - startCpu) / CLOCKS_PER_SEC;
+    int frames = server.frames - startFrames;
+
+    fmt::print("{} cameras: {:.1f}% CPU, {:.1f} frames/s per camera\n",
+               numCameras, 100.0 * cpu / elapsed,
+               frames / elapsed / numCameras);
+
+    sinks.clear();
+    cameras.clear();
+  }
+}
+
+}  // namespace cs
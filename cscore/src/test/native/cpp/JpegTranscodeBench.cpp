@@ -0,0 +1,83 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <chrono>
+#include <functional>
+#include <tuple>
+#include <vector>
+
+#include <fmt/format.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// returns the average time of a transcode, in microseconds
+static double TimeTranscode(const std::function<void()>& transcode) {
+  static constexpr int kNumIterations = 50;
+  transcode();  // warm up
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumIterations; ++i) {
+    transcode();
+  }
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         kNumIterations;
+}
+
+// Times the re-encoding of a 1280x720 camera JPEG done by
+// Frame::GetImageMJPEG() for a stream with the resolution and compression
+// parameters set, decoding at a reduced scale against decoding at full size,
+// for each combination of resolution and quality.
+TEST(JpegTranscodeBenchTest, DISABLED_Transcode) {
+  // a smooth image with some noise, closer to a camera image than pure noise
+  cv::Mat frame{720, 1280, CV_8UC3};
+  cv::randu(frame, 0, 64);
+  for (int y = 0; y < frame.rows; ++y) {
+    for (int x = 0; x < frame.cols; ++x) {
+      auto& pixel = frame.at<cv::Vec3b>(y, x);
+      pixel[0] += x / 8;
+      pixel[1] += y / 4;
+      pixel[2] += (x + y) / 12;
+    }
+  }
+  std::vector<uchar> jpeg;
+  cv::imencode(".jpg", frame, jpeg, {cv::IMWRITE_JPEG_QUALITY, 90});
+
+  for (auto [width, height, scale] :
+       {std::tuple{640, 360, 2}, std::tuple{320, 180, 4},
+        std::tuple{160, 90, 8}, std::tuple{400, 300, 2}}) {
+    for (int quality : {30, 50, 80}) {
+      std::vector<int> params{cv::IMWRITE_JPEG_QUALITY, quality};
+      std::vector<uchar> out;
+      cv::Mat decoded;
+      cv::Mat resized{height, width, CV_8UC3};
+      auto transcode = [&](int flags) {
+        cv::imdecode(jpeg, flags, &decoded);
+        if (decoded.cols != width || decoded.rows != height) {
+          cv::resize(decoded, resized, resized.size(), 0, 0);
+          cv::imencode(".jpg", resized, out, params);
+        } else {
+          cv::imencode(".jpg", decoded, out, params);
+        }
+      };
+      int reduced = scale == 2   ? cv::IMREAD_REDUCED_COLOR_2
+                    : scale == 4 ? cv::IMREAD_REDUCED_COLOR_4
+                                 : cv::IMREAD_REDUCED_COLOR_8;
+
+      double fast = TimeTranscode([&] { transcode(reduced); });
+      size_t size = out.size();
+      double full = TimeTranscode([&] { transcode(cv::IMREAD_COLOR); });
+      fmt::print(
+          "{}x{} quality {}: {:.0f} us (full decode: {:.0f} us), {} bytes\n",
+          width, height, quality, fast, full, size);
+    }
+  }
+}
+
+}  // namespace cs
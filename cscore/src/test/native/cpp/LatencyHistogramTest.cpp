@@ -0,0 +1,40 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "cscore_cpp.h"
+#include "gtest/gtest.h"
+
+namespace cs {
+
+TEST(LatencyHistogramTest, Empty) {
+  CS_LatencyHistogram histogram{};
+  EXPECT_EQ(GetLatencyPercentile(histogram, 50), 0.0);
+}
+
+TEST(LatencyHistogramTest, Percentile) {
+  // 90 times of 100-127 us (bucket 7), and 10 of 3000-4095 us (bucket 12)
+  CS_LatencyHistogram histogram{};
+  histogram.count = 100;
+  histogram.min = 100;
+  histogram.max = 3500;
+  histogram.buckets[7] = 90;
+  histogram.buckets[12] = 10;
+  EXPECT_EQ(GetLatencyPercentile(histogram, 0), 128.0);
+  EXPECT_EQ(GetLatencyPercentile(histogram, 50), 128.0);
+  EXPECT_EQ(GetLatencyPercentile(histogram, 90), 128.0);
+  // within the recorded range
+  EXPECT_EQ(GetLatencyPercentile(histogram, 95), 3500.0);
+  EXPECT_EQ(GetLatencyPercentile(histogram, 100), 3500.0);
+}
+
+TEST(LatencyHistogramTest, SingleValue) {
+  CS_LatencyHistogram histogram{};
+  histogram.count = 1;
+  histogram.min = 5;
+  histogram.max = 5;
+  histogram.buckets[3] = 1;
+  EXPECT_EQ(GetLatencyPercentile(histogram, 50), 5.0);
+}
+
+}  // namespace cs
@@ -0,0 +1,104 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <opencv2/core/core.hpp>
+#include <wpi/Logger.h>
+#include <wpi/SmallString.h>
+#include <wpi/StringExtras.h>
+#include <wpinet/TCPConnector.h>
+#include <wpinet/raw_socket_istream.h>
+#include <wpinet/raw_socket_ostream.h>
+
+#include "cscore_cv.h"
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// A 640x480 30 fps source streamed to an increasing number of clients;
+// reports the process CPU use (which includes the client threads, which only
+// parse the stream) and the frames received per second by each client.
+TEST(MjpegServerBenchTest, DISABLED_Clients) {
+  static constexpr int kPort = 11811;
+  static constexpr std::chrono::seconds kDuration{3};
+
+  CvSource source{"source", VideoMode::kBGR, 640, 480, 30};
+  MjpegServer server{"server", kPort};
+  server.SetSource(source);
+
+  std::atomic_bool done{false};
+  std::thread producer([&] {
+    cv::Mat frame{480, 640, CV_8UC3};
+    cv::randu(frame, 0, 256);
+    while (!done) {
+      source.PutFrame(frame);
+      std::this_thread::sleep_for(std::chrono::milliseconds(33));
+    }
+  });
+
+  wpi::Logger logger;
+  for (int numClients : {1, 2, 5, 10}) {
+    std::atomic_bool stop{false};
+    std::atomic_int frames{0};
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    auto startCpu = std::clock();
+    for (int i = 0; i < numClients; ++i) {
+      clients.emplace_back([&] {
+        auto stream =
+            wpi::TCPConnector::connect("127.0.0.1", kPort, logger, 1);
+        if (!stream) {
+          return;
+        }
+        wpi::raw_socket_ostream os{*stream, true};
+        os << "GET /stream.mjpg HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        os.flush();
+
+        wpi::raw_socket_istream is{*stream};
+        wpi::SmallString<128> lineBuf;
+        std::vector<char> image;
+        size_t size = 0;
+        while (!stop && !is.has_error()) {
+          std::string_view line = is.getline(lineBuf, 4096);
+          if (wpi::starts_with(line, "Content-Length: ")) {
+            size = wpi::parse_integer<size_t>(wpi::trim(line.substr(16)), 10)
+                       .value_or(0);
+          } else if (line == "\n" && size != 0) {
+            image.resize(size);
+            is.read(image.data(), size);
+            size = 0;
+            ++frames;
+          }
+        }
+      });
+    }
+    std::this_thread::sleep_for(kDuration);
+    stop = true;
+    for (auto&& client : clients) {
+      client.join();
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    double cpu = static_cast<double>(std::clock() - startCpu) / CLOCKS_PER_SEC;
+
+    fmt::print("{} clients: {:.1f}% CPU, {:.1f} frames/s per client\n",
+               numClients, 100.0 * cpu / elapsed,
+               frames / elapsed / numClients);
+
+    // let the server notice the closed connections
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  done = true;
+  producer.join();
+}
+
+}  // namespace cs
@@ -0,0 +1,162 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "MjpegStreamParser.h"  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "gtest/gtest.h"
+
+namespace cs {
+
+class MjpegStreamParserTest : public ::testing::Test {
+ protected:
+  MjpegStreamParserTest()
+      : parser{[](size_t size) {
+                 auto image = std::make_unique<Image>(size);
+                 image->SetSize(size);
+                 return image;
+               },
+               [this](auto image) {
+                 images.emplace_back(image->str());
+                 sizes.emplace_back(image->width, image->height);
+               },
+               [this](auto msg) { errors.emplace_back(msg); }} {
+    parser.Reset("boundary");
+  }
+
+  // a minimal image with a SOF giving its size, padded to a length
+  static std::string MakeJpeg(int width, int height, size_t len) {
+    std::string jpeg{"\xff\xd8\xff\xc0\x00\x0b\x08", 7};
+    jpeg += static_cast<char>(height >> 8);
+    jpeg += static_cast<char>(height & 0xff);
+    jpeg += static_cast<char>(width >> 8);
+    jpeg += static_cast<char>(width & 0xff);
+    jpeg.append("\x01\x01\x11\x00", 4);
+    jpeg.resize(len - 2, '\x55');
+    jpeg.append("\xff\xd9", 2);
+    return jpeg;
+  }
+
+  // feeds data in pieces of a size, reading into GetBuffer() when it's not
+  // empty as a socket would
+  void Feed(std::string_view data, size_t pieceSize) {
+    while (!data.empty()) {
+      auto buf = parser.GetBuffer();
+      if (buf.empty()) {
+        size_t len = (std::min)(pieceSize, data.size());
+        parser.Execute(data.substr(0, len));
+        data.remove_prefix(len);
+      } else {
+        size_t len = (std::min)({pieceSize, data.size(), buf.size()});
+        std::memcpy(buf.data(), data.data(), len);
+        parser.Filled(len);
+        data.remove_prefix(len);
+      }
+    }
+  }
+
+  MjpegStreamParser parser;
+  std::vector<std::string> images;
+  std::vector<std::pair<int, int>> sizes;
+  std::vector<std::string> errors;
+};
+
+TEST_F(MjpegStreamParserTest, ContentLength) {
+  auto jpeg1 = MakeJpeg(320, 240, 1000);
+  auto jpeg2 = MakeJpeg(640, 480, 3000);
+  std::string stream;
+  for (auto&& jpeg : {jpeg1, jpeg2, jpeg1}) {
+    stream += fmt::format(
+        "--boundary\r\nContent-Type: image/jpeg\r\nContent-Length: {}\r\n\r\n",
+        jpeg.size());
+    stream += jpeg;
+    stream += "\r\n";
+  }
+
+  for (size_t pieceSize : {1, 7, 100, 100000}) {
+    images.clear();
+    parser.Reset("boundary");
+    Feed(stream, pieceSize);
+    ASSERT_EQ(images.size(), 3u);
+    EXPECT_EQ(images[0], jpeg1);
+    EXPECT_EQ(images[1], jpeg2);
+    EXPECT_EQ(images[2], jpeg1);
+    EXPECT_EQ(sizes[1], std::make_pair(640, 480));
+  }
+  EXPECT_TRUE(errors.empty());
+}
+
+TEST_F(MjpegStreamParserTest, NoContentLength) {
+  auto jpeg1 = MakeJpeg(320, 240, 1000);
+  auto jpeg2 = MakeJpeg(640, 480, 3000);
+  std::string stream;
+  for (auto&& jpeg : {jpeg1, jpeg2}) {
+    stream += "--boundary\nContent-Type: image/jpeg\n\n";
+    stream += jpeg;
+    stream += "\r\n";
+  }
+  stream += "--boundary\r\n";
+
+  for (size_t pieceSize : {1, 13, 100000}) {
+    images.clear();
+    parser.Reset("boundary");
+    Feed(stream, pieceSize);
+    ASSERT_EQ(images.size(), 2u);
+    EXPECT_EQ(images[0], jpeg1);
+    EXPECT_EQ(images[1], jpeg2);
+  }
+  EXPECT_TRUE(errors.empty());
+}
+
+TEST_F(MjpegStreamParserTest, BadParts) {
+  auto jpeg = MakeJpeg(320, 240, 100);
+  std::string stream =
+      "--boundary\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\n"
+      "hello\r\n"
+      "--boundary\r\nContent-Length: 5\r\n\r\n"
+      "hello\r\n";
+  stream +=
+      fmt::format("--boundary\r\nContent-Length: {}\r\n\r\n", jpeg.size());
+  stream += jpeg;
+  Feed(stream, 10);
+  ASSERT_EQ(errors.size(), 2u);
+  EXPECT_EQ(errors[0], "received unknown Content-Type \"text/plain\"");
+  EXPECT_EQ(errors[1], "did not receive a JPEG image");
+  ASSERT_EQ(images.size(), 1u);
+  EXPECT_EQ(images[0], jpeg);
+}
+
+TEST_F(MjpegStreamParserTest, TooLarge) {
+  auto jpeg = MakeJpeg(320, 240, 100);
+  std::string stream =
+      "--boundary\r\nContent-Length: 4000000000\r\n\r\n"
+      "hello\r\n"
+      "--boundary\r\nContent-Length: 100000000\r\n\r\n"
+      "hello\r\n";
+  // no Content-Length, so only the boundary ends it
+  stream += "--boundary\r\n\r\n";
+  stream.append(40 * 1024 * 1024, 'x');
+  stream +=
+      fmt::format("\r\n--boundary\r\nContent-Length: {}\r\n\r\n",
+                  jpeg.size());
+  stream += jpeg;
+  Feed(stream, 65536);
+  ASSERT_EQ(errors.size(), 3u);
+  EXPECT_EQ(errors[0], "Content-Length 4000000000 too large");
+  EXPECT_EQ(errors[1], "Content-Length 100000000 too large");
+  EXPECT_EQ(errors[2], "image too large");
+  ASSERT_EQ(images.size(), 1u);
+  EXPECT_EQ(images[0], jpeg);
+}
+
+}  // namespace cs
@@ -0,0 +1,87 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "PixelUtil.h"  // NOLINT(build/include_order)
+
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// returns the average time of a conversion, in microseconds
+static double TimeConversion(const std::function<void()>& convert) {
+  static constexpr int kNumIterations = 100;
+  convert();  // warm up
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kNumIterations; ++i) {
+    convert();
+  }
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - start)
+             .count() /
+         kNumIterations;
+}
+
+// Times each direct conversion done by Frame::ConvertImpl() against the
+// conversion through an intermediate BGR image it replaced, at common camera
+// resolutions.
+TEST(PixelUtilBenchTest, DISABLED_Convert) {
+  for (auto [width, height] : {std::pair{320, 240}, std::pair{640, 480},
+                               std::pair{1280, 720}}) {
+    size_t numPixels = width * height;
+    cv::Mat yuyv{height, width, CV_8UC2};
+    cv::randu(yuyv, 0, 256);
+    cv::Mat rgb565{height, width, CV_8UC2};
+    cv::randu(rgb565, 0, 256);
+    cv::Mat gray{height, width, CV_8UC1};
+    cv::randu(gray, 0, 256);
+    cv::Mat bgr{height, width, CV_8UC3};
+    cv::Mat out1{height, width, CV_8UC1};
+    cv::Mat out2{height, width, CV_8UC2};
+
+    auto report = [&](const char* name, double direct, double viaBGR) {
+      fmt::print("{}x{} {}: {:.0f} us (via BGR: {:.0f} us)\n", width, height,
+                 name, direct, viaBGR);
+    };
+
+    report("YUYV->Gray", TimeConversion([&] {
+             cv::cvtColor(yuyv, out1, cv::COLOR_YUV2GRAY_YUYV);
+           }),
+           TimeConversion([&] {
+             cv::cvtColor(yuyv, bgr, cv::COLOR_YUV2BGR_YUYV);
+             cv::cvtColor(bgr, out1, cv::COLOR_BGR2GRAY);
+           }));
+    report("YUYV->RGB565", TimeConversion([&] {
+             ConvertYUYVToRGB565(yuyv.data, out2.data, numPixels);
+           }),
+           TimeConversion([&] {
+             cv::cvtColor(yuyv, bgr, cv::COLOR_YUV2BGR_YUYV);
+             cv::cvtColor(bgr, out2, cv::COLOR_RGB2BGR565);
+           }));
+    report("RGB565->Gray", TimeConversion([&] {
+             ConvertRGB565ToGray(rgb565.data, out1.data, numPixels);
+           }),
+           TimeConversion([&] {
+             cv::cvtColor(rgb565, bgr, cv::COLOR_BGR5652RGB);
+             cv::cvtColor(bgr, out1, cv::COLOR_BGR2GRAY);
+           }));
+    report("Gray->RGB565", TimeConversion([&] {
+             cv::cvtColor(gray, out2, cv::COLOR_GRAY2BGR565);
+           }),
+           TimeConversion([&] {
+             cv::cvtColor(gray, bgr, cv::COLOR_GRAY2BGR);
+             cv::cvtColor(bgr, out2, cv::COLOR_RGB2BGR565);
+           }));
+  }
+}
+
+}  // namespace cs
@@ -0,0 +1,39 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "PixelUtil.h"  // NOLINT(build/include_order)
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "gtest/gtest.h"
+
+namespace cs {
+
+// The direct conversions match the conversions through BGR (to within
+// rounding).
+TEST(PixelUtilTest, MatchesViaBGR) {
+  cv::Mat yuyv{48, 64, CV_8UC2};
+  cv::randu(yuyv, 0, 256);
+  cv::Mat bgr;
+  cv::cvtColor(yuyv, bgr, cv::COLOR_YUV2BGR_YUYV);
+
+  cv::Mat expected;
+  cv::cvtColor(bgr, expected, cv::COLOR_RGB2BGR565);
+  cv::Mat rgb565{48, 64, CV_8UC2};
+  ConvertYUYVToRGB565(yuyv.data, rgb565.data, yuyv.total());
+  cv::Mat expectedBGR;
+  cv::Mat actualBGR;
+  cv::cvtColor(expected, expectedBGR, cv::COLOR_BGR5652RGB);
+  cv::cvtColor(rgb565, actualBGR, cv::COLOR_BGR5652RGB);
+  EXPECT_LE(cv::norm(expectedBGR, actualBGR, cv::NORM_INF), 8);
+
+  cv::cvtColor(rgb565, bgr, cv::COLOR_BGR5652RGB);
+  cv::cvtColor(bgr, expected, cv::COLOR_BGR2GRAY);
+  cv::Mat gray{48, 64, CV_8UC1};
+  ConvertRGB565ToGray(rgb565.data, gray.data, rgb565.total());
+  EXPECT_LE(cv::norm(expected, gray, cv::NORM_INF), 1);
+}
+
+}  // namespace cs
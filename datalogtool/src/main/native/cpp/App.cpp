@@ -113,7 +113,7 @@ static void DisplayMainMenu() {
 
 static void DisplayGui() {
   DisplayMainMenu();
-  DisplayInputFiles();
+  DisplayInputFiles(glass::GetStorageRoot().GetChild("input"));
   DisplayEntries();
   DisplayOutput(glass::GetStorageRoot().GetChild("output"));
   DisplayDownload();
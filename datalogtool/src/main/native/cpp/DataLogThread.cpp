@@ -4,6 +4,8 @@
 
 #include "DataLogThread.h"
 
+#include <string>
+
 #include <fmt/format.h>
 
 DataLogThread::~DataLogThread() {
@@ -14,57 +16,43 @@ DataLogThread::~DataLogThread() {
 }
 
 void DataLogThread::ReadMain() {
-  for (auto record : m_reader) {
-    if (!m_active) {
-      break;
-    }
-    ++m_numRecords;
-    if (record.IsStart()) {
-      wpi::log::StartRecordData data;
-      if (record.GetStartData(&data)) {
-        std::scoped_lock lock{m_mutex};
-        if (m_entries.find(data.entry) != m_entries.end()) {
-          fmt::print("...DUPLICATE entry ID, overriding\n");
-        }
-        m_entries[data.entry] = data;
-        m_entryNames.emplace(data.name, data);
-        sigEntryAdded(data);
-      } else {
-        fmt::print("Start(INVALID)\n");
-      }
-    } else if (record.IsFinish()) {
-      int entry;
-      if (record.GetFinishEntry(&entry)) {
-        std::scoped_lock lock{m_mutex};
-        auto it = m_entries.find(entry);
-        if (it == m_entries.end()) {
-          fmt::print("...ID not found\n");
-        } else {
-          m_entries.erase(it);
+  // a saved index is reused if it matches the log; otherwise the log is
+  // indexed in chunks so entries show up as they are found (and the index is
+  // saved only if requested)
+  std::error_code ec;
+  std::string indexFilename =
+      fmt::format("{}idx", m_reader.GetBufferIdentifier());
+  bool loaded = m_index.Load(indexFilename, ec);
+
+  size_t numEntries = 0;
+  for (;;) {
+    bool complete = m_index.IndexRecords(kIndexChunkSize);
+    m_numRecords = m_index.GetNumRecords();
+    auto entries = m_index.GetEntries();
+    {
+      std::scoped_lock lock{m_mutex};
+      for (; numEntries < entries.size(); ++numEntries) {
+        auto& data = entries[numEntries].data;
+        if (m_entryNames.emplace(data.name, data).second) {
+          sigEntryAdded(data);
         }
-      } else {
-        fmt::print("Finish(INVALID)\n");
       }
-    } else if (record.IsSetMetadata()) {
-      wpi::log::MetadataRecordData data;
-      if (record.GetSetMetadataData(&data)) {
-        std::scoped_lock lock{m_mutex};
-        auto it = m_entries.find(data.entry);
-        if (it == m_entries.end()) {
-          fmt::print("...ID not found\n");
-        } else {
-          it->second.metadata = data.metadata;
-          auto nameIt = m_entryNames.find(it->second.name);
-          if (nameIt != m_entryNames.end()) {
-            nameIt->second.metadata = data.metadata;
-          }
+      // metadata may have been changed by later records
+      for (auto&& entry : entries) {
+        auto it = m_entryNames.find(entry.data.name);
+        if (it != m_entryNames.end() && it->second.entry == entry.data.entry) {
+          it->second.metadata = entry.data.metadata;
         }
-      } else {
-        fmt::print("SetMetadata(INVALID)\n");
       }
-    } else if (record.IsControl()) {
-      fmt::print("Unrecognized control record\n");
     }
+    if (complete || !m_active) {
+      break;
+    }
+  }
+
+  if (m_saveIndex && m_index.IsComplete() && !loaded) {
+    // errors are ignored (e.g. read-only directory); the index is rebuilt
+    m_index.Save(indexFilename, ec);
   }
 
   sigDone();
@@ -12,15 +12,20 @@
 #include <thread>
 #include <utility>
 
+#include <wpi/DataLogIndex.h>
 #include <wpi/DataLogReader.h>
-#include <wpi/DenseMap.h>
 #include <wpi/Signal.h>
 #include <wpi/mutex.h>
 
 class DataLogThread {
  public:
-  explicit DataLogThread(wpi::log::DataLogReader reader)
-      : m_reader{std::move(reader)}, m_thread{[=] { ReadMain(); }} {}
+  // if saveIndex is true, the index is saved next to the log (as "<log>idx")
+  // once built, so it opens faster the next time
+  explicit DataLogThread(wpi::log::DataLogReader reader, bool saveIndex = false)
+      : m_reader{std::move(reader)},
+        m_index{m_reader},
+        m_saveIndex{saveIndex},
+        m_thread{[=] { ReadMain(); }} {}
   ~DataLogThread();
 
   bool IsDone() const { return m_done; }
@@ -53,19 +58,26 @@ class DataLogThread {
 
   const wpi::log::DataLogReader& GetReader() const { return m_reader; }
 
+  // only valid once IsDone() returns true
+  const wpi::log::DataLogIndex& GetIndex() const { return m_index; }
+
   // note: these are called on separate thread
   wpi::sig::Signal_mt<const wpi::log::StartRecordData&> sigEntryAdded;
   wpi::sig::Signal_mt<> sigDone;
 
  private:
+  // number of records indexed between entry list updates
+  static constexpr size_t kIndexChunkSize = 10000;
+
   void ReadMain();
 
   wpi::log::DataLogReader m_reader;
+  wpi::log::DataLogIndex m_index;
+  bool m_saveIndex;
   mutable wpi::mutex m_mutex;
   std::atomic_bool m_active{true};
   std::atomic_bool m_done{false};
   std::atomic<unsigned int> m_numRecords{0};
   std::map<std::string, wpi::log::StartRecordData, std::less<>> m_entryNames;
-  wpi::DenseMap<int, wpi::log::StartRecordData> m_entries;
   std::thread m_thread;
 };
@@ -4,14 +4,19 @@
 
 #include "Exporter.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <ctime>
 #include <future>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <fmt/chrono.h>
@@ -22,6 +27,7 @@
 #include <imgui_stdlib.h>
 #include <portable-file-dialogs.h>
 #include <wpi/DenseMap.h>
+#include <wpi/Endian.h>
 #include <wpi/MemoryBuffer.h>
 #include <wpi/SmallVector.h>
 #include <wpi/SpanExtras.h>
@@ -63,9 +69,6 @@ struct Entry {
   bool typeConflict = false;
   bool metadataConflict = false;
   bool selected = true;
-
-  // used only during export
-  int column = -1;
 };
 
 struct EntryTreeNode {
@@ -177,7 +180,8 @@ InputFile::~InputFile() {
   }
 }
 
-static std::unique_ptr<InputFile> LoadDataLog(std::string_view filename) {
+static std::unique_ptr<InputFile> LoadDataLog(std::string_view filename,
+                                              bool saveIndex) {
   std::error_code ec;
   auto buf = wpi::MemoryBuffer::GetFile(filename, ec);
   std::string fn{filename};
@@ -192,10 +196,11 @@ static std::unique_ptr<InputFile> LoadDataLog(std::string_view filename) {
   }
 
   return std::make_unique<InputFile>(
-      std::make_unique<DataLogThread>(std::move(reader)));
+      std::make_unique<DataLogThread>(std::move(reader), saveIndex));
 }
 
-void DisplayInputFiles() {
+void DisplayInputFiles(glass::Storage& storage) {
+  static bool& saveIndex = storage.GetBool("saveIndex", false);
   static std::unique_ptr<pfd::open_file> dataFileSelector;
 
   SetNextWindowPos(ImVec2{0, 20}, ImGuiCond_FirstUseEver);
@@ -207,6 +212,13 @@ void DisplayInputFiles() {
           std::vector<std::string>{"DataLog Files", "*.wpilog"},
           pfd::opt::multiselect);
     }
+    ImGui::SameLine();
+    ImGui::Checkbox("Save Index Files", &saveIndex);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip(
+          "Save the index of each opened log next to it (as <log>idx),\n"
+          "so the log opens faster the next time");
+    }
     ImGui::BeginTable(
         "Input Files", 3,
         ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp);
@@ -261,7 +273,7 @@ void DisplayInputFiles() {
       std::string stem = fs::path{filename}.stem().string();
       auto it = gInputFiles.find(stem);
       if (it == gInputFiles.end()) {
-        gInputFiles.emplace(std::move(stem), LoadDataLog(filename));
+        gInputFiles.emplace(std::move(stem), LoadDataLog(filename, saveIndex));
         gExportCount = 0;
       }
     }
@@ -456,7 +468,7 @@ static void ValueToCsv(wpi::raw_ostream& os, const Entry& entry,
     int64_t val;
     if (record.GetInteger(&val)) {
       std::time_t timeval = val / 1000000;
-      fmt::print(os, "{:%Y-%m-%d %H:%M:%S}.{:06}", *std::localtime(&timeval),
+      fmt::print(os, "{:%Y-%m-%d %H:%M:%S}.{:06}", fmt::localtime(timeval),
                  val % 1000000);
       return;
     }
@@ -528,8 +540,66 @@ static void ValueToCsv(wpi::raw_ostream& os, const Entry& entry,
   fmt::print(os, "<invalid>");
 }
 
-static void ExportCsvFile(InputFile& f, wpi::raw_ostream& os, int style) {
-  // header
+namespace {
+// a data record to export, with its column for the table style
+struct ExportRecord {
+  uint64_t pos;
+  const Entry* entry;
+  int column;
+};
+}  // namespace
+
+// number of records formatted by each export task
+static constexpr size_t kExportChunkSize = 65536;
+// output buffer size for exported files
+static constexpr size_t kExportBufferSize = 1024 * 1024;
+
+static void AddExportError(std::string_view name, std::string_view msg) {
+  std::scoped_lock lock{gExportMutex};
+  gExportErrors.emplace_back(fmt::format("{}: {}", name, msg));
+}
+
+// calls func(i) for i in [0, count) on up to numThreads threads
+template <typename F>
+static void ParallelFor(size_t count, unsigned int numThreads, F&& func) {
+  std::atomic<size_t> next{0};
+  auto worker = [&] {
+    for (size_t i; (i = next++) < count;) {
+      func(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < (std::min)(count, size_t{numThreads}); ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto&& thread : threads) {
+    thread.join();
+  }
+}
+
+static void PrintCsvRecord(wpi::raw_ostream& os, int style, const Entry& entry,
+                           int column, const wpi::log::DataLogRecord& record) {
+  if (style == 0) {
+    fmt::print(os, "{},\"", record.GetTimestamp() / 1000000.0);
+    PrintEscapedCsvString(os, entry.name);
+    os << '"' << ',';
+    ValueToCsv(os, entry, record);
+    os << '\n';
+  } else if (style == 1 && column != -1) {
+    fmt::print(os, "{},", record.GetTimestamp() / 1000000.0);
+    for (int i = 0; i < column; ++i) {
+      os << ',';
+    }
+    ValueToCsv(os, entry, record);
+    os << '\n';
+  }
+}
+
+static void ExportCsvFile(InputFile& f, wpi::raw_ostream& os, int style,
+                          unsigned int numThreads) {
+  // header; columns are assigned per file
+  wpi::DenseMap<const Entry*, int> columns;
   if (style == 0) {
     os << "Timestamp,Name,Value\n";
   } else if (style == 1) {
@@ -542,74 +612,284 @@ static void ExportCsvFile(InputFile& f, wpi::raw_ostream& os, int style) {
         os << ',' << '"';
         PrintEscapedCsvString(os, entry.first);
         os << '"';
-        entry.second->column = columnNum++;
-      } else {
-        entry.second->column = -1;
+        columns[entry.second.get()] = columnNum++;
       }
     }
     os << '\n';
   }
-
-  wpi::DenseMap<int, Entry*> nameMap;
-  for (auto&& record : f.datalog->GetReader()) {
-    if (record.IsStart()) {
-      wpi::log::StartRecordData data;
-      if (record.GetStartData(&data)) {
-        auto it = gEntries.find(data.name);
-        if (it != gEntries.end() && it->second->selected) {
-          nameMap[data.entry] = it->second.get();
+  auto getColumn = [&](const Entry* entry) {
+    auto it = columns.find(entry);
+    return it == columns.end() ? -1 : it->second;
+  };
+
+  if (!f.datalog->IsDone()) {
+    // not indexed yet; read serially
+    wpi::DenseMap<int, Entry*> nameMap;
+    for (auto&& record : f.datalog->GetReader()) {
+      if (record.IsStart()) {
+        wpi::log::StartRecordData data;
+        if (record.GetStartData(&data)) {
+          auto it = gEntries.find(data.name);
+          if (it != gEntries.end() && it->second->selected) {
+            nameMap[data.entry] = it->second.get();
+          }
+        }
+      } else if (record.IsFinish()) {
+        int entry;
+        if (record.GetFinishEntry(&entry)) {
+          nameMap.erase(entry);
+        }
+      } else if (!record.IsControl()) {
+        auto entryIt = nameMap.find(record.GetEntry());
+        if (entryIt != nameMap.end()) {
+          PrintCsvRecord(os, style, *entryIt->second,
+                         getColumn(entryIt->second), record);
         }
       }
-    } else if (record.IsFinish()) {
-      int entry;
-      if (record.GetFinishEntry(&entry)) {
-        nameMap.erase(entry);
-      }
-    } else if (!record.IsControl()) {
-      auto entryIt = nameMap.find(record.GetEntry());
-      if (entryIt == nameMap.end()) {
-        continue;
+    }
+    return;
+  }
+
+  // use the index to read only the records of selected entries
+  auto& index = f.datalog->GetIndex();
+  std::vector<ExportRecord> records;
+  for (auto&& indexEntry : index.GetEntries()) {
+    auto it = gEntries.find(indexEntry.data.name);
+    if (it != gEntries.end() && it->second->selected) {
+      int column = getColumn(it->second.get());
+      for (auto pos : indexEntry.records) {
+        records.push_back({pos, it->second.get(), column});
       }
-      Entry* entry = entryIt->second;
-
-      if (style == 0) {
-        fmt::print(os, "{},\"", record.GetTimestamp() / 1000000.0);
-        PrintEscapedCsvString(os, entry->name);
-        os << '"' << ',';
-        ValueToCsv(os, *entry, record);
-        os << '\n';
-      } else if (style == 1 && entry->column != -1) {
-        fmt::print(os, "{},", record.GetTimestamp() / 1000000.0);
-        for (int i = 0; i < entry->column; ++i) {
-          os << ',';
-        }
-        ValueToCsv(os, *entry, record);
-        os << '\n';
+    }
+  }
+  std::sort(records.begin(), records.end(),
+            [](const auto& a, const auto& b) { return a.pos < b.pos; });
+
+  // format chunks of records in parallel, and write them in order
+  std::vector<std::string> chunks(numThreads);
+  for (size_t start = 0; start < records.size();
+       start += numThreads * kExportChunkSize) {
+    ParallelFor(numThreads, numThreads, [&](size_t i) {
+      size_t begin = (std::min)(start + i * kExportChunkSize, records.size());
+      size_t end = (std::min)(begin + kExportChunkSize, records.size());
+      chunks[i].clear();
+      wpi::raw_string_ostream chunkOs{chunks[i]};
+      for (size_t j = begin; j < end; ++j) {
+        PrintCsvRecord(chunkOs, style, *records[j].entry, records[j].column,
+                       index.GetRecord(records[j].pos));
       }
+      chunkOs.flush();
+    });
+    for (auto&& chunk : chunks) {
+      os << chunk;
+    }
+  }
+}
+
+// writes a NumPy .npy file header for a structured array of timestamp and
+// value pairs; see the NumPy format.npy documentation
+static void WriteNpyHeader(wpi::raw_ostream& os, std::string_view valueType,
+                           size_t count) {
+  std::string header = fmt::format(
+      "{{'descr': [('timestamp', '<i8'), ('value', '{}')], "
+      "'fortran_order': False, 'shape': ({},), }}",
+      valueType, count);
+  // pad with spaces and end with a newline so the data is 64-byte aligned
+  size_t len = 10 + header.size() + 1;
+  header.append((len + 63) / 64 * 64 - len, ' ');
+  header.push_back('\n');
+  const uint8_t magic[8] = {0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0};
+  uint8_t headerLen[2];
+  wpi::support::endian::write16le(headerLen, header.size());
+  os << wpi::span<const uint8_t>{magic} << wpi::span<const uint8_t>{headerLen}
+     << header;
+}
+
+// returns NumPy type of the value, or empty if not a numeric scalar type
+static std::string_view GetNpyType(std::string_view type) {
+  if (type == "double") {
+    return "<f8";
+  } else if (type == "float") {
+    return "<f4";
+  } else if (type == "int64") {
+    return "<i8";
+  } else if (type == "boolean") {
+    return "|b1";
+  } else {
+    return {};
+  }
+}
+
+static void WriteNpyValue(wpi::raw_ostream& os, std::string_view type,
+                          const wpi::log::DataLogRecord& record) {
+  uint8_t buf[16];
+  wpi::support::endian::write64le(buf, record.GetTimestamp());
+  size_t size = 8;
+  if (type == "double") {
+    double val = std::numeric_limits<double>::quiet_NaN();
+    record.GetDouble(&val);
+    uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    wpi::support::endian::write64le(buf + 8, bits);
+    size += 8;
+  } else if (type == "float") {
+    float val = std::numeric_limits<float>::quiet_NaN();
+    record.GetFloat(&val);
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    wpi::support::endian::write32le(buf + 8, bits);
+    size += 4;
+  } else if (type == "int64") {
+    int64_t val = 0;
+    record.GetInteger(&val);
+    wpi::support::endian::write64le(buf + 8, val);
+    size += 8;
+  } else if (type == "boolean") {
+    bool val = false;
+    record.GetBoolean(&val);
+    buf[8] = val ? 1 : 0;
+    size += 1;
+  }
+  os << wpi::span<const uint8_t>{buf, size};
+}
+
+// exports each selected numeric entry to a .npy file in a folder named after
+// the input file, with an entries.csv file listing the entry for each file
+static void ExportNpyFile(InputFile& f, const fs::path& outPath,
+                          std::string_view name, unsigned int numThreads) {
+  if (!f.datalog->IsDone()) {
+    AddExportError(name, "still loading");
+    return;
+  }
+  std::error_code ec;
+  fs::path dir = outPath / fs::path{name};
+  if (!fs::create_directory(dir, ec) && !ec) {
+    ec = std::make_error_code(std::errc::file_exists);
+  }
+  if (ec) {
+    AddExportError(name, ec.message());
+    return;
+  }
+
+  // gather records by name, as an entry may be started more than once
+  struct NpyEntry {
+    std::string_view name;
+    std::string_view type;
+    std::string filename;
+    std::vector<uint64_t> records;
+  };
+  std::map<std::string_view, NpyEntry> npyEntries;
+  auto& index = f.datalog->GetIndex();
+  for (auto&& indexEntry : index.GetEntries()) {
+    auto it = gEntries.find(indexEntry.data.name);
+    if (it == gEntries.end() || !it->second->selected ||
+        GetNpyType(indexEntry.data.type).empty()) {
+      continue;
+    }
+    auto& npyEntry = npyEntries[indexEntry.data.name];
+    if (npyEntry.type.empty()) {
+      npyEntry.name = indexEntry.data.name;
+      npyEntry.type = indexEntry.data.type;
+    } else if (npyEntry.type != indexEntry.data.type) {
+      continue;
+    }
+    npyEntry.records.insert(npyEntry.records.end(),
+                            indexEntry.records.begin(),
+                            indexEntry.records.end());
+  }
+
+  // make unique filenames from the entry names
+  std::vector<NpyEntry*> entries;
+  std::set<std::string, std::less<>> filenames;
+  for (auto&& kv : npyEntries) {
+    std::string base;
+    for (char ch : wpi::ltrim(kv.first, '/')) {
+      base.push_back(wpi::isAlnum(ch) || ch == '-' || ch == '.' ? ch : '_');
+    }
+    auto filename = fmt::format("{}.npy", base);
+    for (int i = 2; filenames.find(filename) != filenames.end(); ++i) {
+      filename = fmt::format("{}_{}.npy", base, i);
+    }
+    kv.second.filename = *filenames.emplace(std::move(filename)).first;
+    entries.push_back(&kv.second);
+  }
+
+  {
+    wpi::raw_fd_ostream os{(dir / "entries.csv").string(), ec, fs::OF_Text};
+    if (ec) {
+      AddExportError(name, ec.message());
+      return;
     }
+    os << "File,Name,Type\n";
+    for (auto entry : entries) {
+      fmt::print(os, "{},\"", entry->filename);
+      PrintEscapedCsvString(os, entry->name);
+      fmt::print(os, "\",{}\n", entry->type);
+    }
+  }
+
+  ParallelFor(entries.size(), numThreads, [&](size_t i) {
+    auto& entry = *entries[i];
+    std::sort(entry.records.begin(), entry.records.end());
+    std::error_code fileEc;
+    wpi::raw_fd_ostream os{(dir / entry.filename).string(), fileEc,
+                           fs::OF_None};
+    if (fileEc) {
+      AddExportError(name,
+                     fmt::format("{}: {}", entry.filename, fileEc.message()));
+      return;
+    }
+    os.SetBufferSize(kExportBufferSize);
+    WriteNpyHeader(os, GetNpyType(entry.type), entry.records.size());
+    for (auto pos : entry.records) {
+      WriteNpyValue(os, entry.type, index.GetRecord(pos));
+    }
+  });
+}
+
+static void ExportFile(InputFile& f, const fs::path& outPath,
+                       std::string_view name, int style,
+                       unsigned int numThreads) {
+  if (style == 2) {
+    ExportNpyFile(f, outPath, name, numThreads);
+    return;
+  }
+  std::error_code ec;
+  auto of = fs::OpenFileForWrite(
+      outPath / fs::path{name}.replace_extension("csv"), ec, fs::CD_CreateNew,
+      fs::OF_Text);
+  if (ec) {
+    AddExportError(name, ec.message());
+    return;
   }
+  wpi::raw_fd_ostream os{fs::FileToFd(of, ec, fs::OF_Text), true};
+  os.SetBufferSize(kExportBufferSize);
+  ExportCsvFile(f, os, style, numThreads);
 }
 
-static void ExportCsv(std::string_view outputFolder, int style) {
+static void Export(std::string_view outputFolder, int style) {
   fs::path outPath{outputFolder};
+  std::vector<std::pair<std::string_view, InputFile*>> files;
   for (auto&& f : gInputFiles) {
     if (f.second->datalog) {
-      std::error_code ec;
-      auto of = fs::OpenFileForWrite(
-          outPath / fs::path{f.first}.replace_extension("csv"), ec,
-          fs::CD_CreateNew, fs::OF_Text);
-      if (ec) {
-        std::scoped_lock lock{gExportMutex};
-        gExportErrors.emplace_back(
-            fmt::format("{}: {}", f.first, ec.message()));
-        ++gExportCount;
-        continue;
-      }
-      wpi::raw_fd_ostream os{fs::FileToFd(of, ec, fs::OF_Text), true};
-      ExportCsvFile(*f.second, os, style);
+      files.emplace_back(f.first, f.second.get());
+    } else {
+      ++gExportCount;
     }
-    ++gExportCount;
   }
+  if (files.empty()) {
+    return;
+  }
+
+  // export files in parallel, and split the remaining threads between them
+  unsigned int numThreads = (std::max)(std::thread::hardware_concurrency(), 1u);
+  unsigned int numFileThreads =
+      (std::min)(numThreads, static_cast<unsigned int>(files.size()));
+  ParallelFor(files.size(), numFileThreads, [&](size_t i) {
+    ExportFile(*files[i].second, outPath, files[i].first, style,
+               (std::max)(numThreads / numFileThreads, 1u));
+    ++gExportCount;
+  });
 }
 
 void DisplayOutput(glass::Storage& storage) {
@@ -625,7 +905,8 @@ void DisplayOutput(glass::Storage& storage) {
     }
     ImGui::TextUnformatted(outputFolder.c_str());
 
-    static const char* const options[] = {"List", "Table"};
+    static const char* const options[] = {"List (CSV)", "Table (CSV)",
+                                          "Columns (NumPy)"};
     static int style = 0;
     ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8);
     ImGui::Combo("Style", &style, options,
@@ -633,12 +914,12 @@ void DisplayOutput(glass::Storage& storage) {
 
     static std::future<void> exporter;
     if (!gInputFiles.empty() && !outputFolder.empty() &&
-        ImGui::Button("Export CSV") &&
+        ImGui::Button("Export") &&
         (gExportCount == 0 ||
          gExportCount == static_cast<int>(gInputFiles.size()))) {
       gExportCount = 0;
       gExportErrors.clear();
-      exporter = std::async(std::launch::async, ExportCsv, outputFolder, style);
+      exporter = std::async(std::launch::async, Export, outputFolder, style);
     }
     if (exporter.valid()) {
       ImGui::SameLine();
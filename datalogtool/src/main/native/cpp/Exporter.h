@@ -8,7 +8,7 @@ namespace glass {
 class Storage;
 }  // namespace glass
 
-void DisplayInputFiles();
+void DisplayInputFiles(glass::Storage& storage);
 void DisplayEntries();
 void DisplayOutput(glass::Storage& storage);
 
@@ -35,6 +35,17 @@ public final class ConnectionInfo {
   @SuppressWarnings("MemberName")
   public final int protocol_version;
 
+  /**
+   * The number of outgoing message batches waiting to be sent to the remote node. While this is
+   * high, updates are merged rather than queued.
+   */
+  @SuppressWarnings("MemberName")
+  public final int outgoing_queue_depth;
+
+  /** The total number of bytes sent to the remote node. */
+  @SuppressWarnings("MemberName")
+  public final long bytes_sent;
+
   /**
    * Constructor. This should generally only be used internally to NetworkTables.
    *
@@ -46,10 +57,34 @@ public final class ConnectionInfo {
    */
   public ConnectionInfo(
       String remoteId, String remoteIp, int remotePort, long lastUpdate, int protocolVersion) {
+    this(remoteId, remoteIp, remotePort, lastUpdate, protocolVersion, 0, 0);
+  }
+
+  /**
+   * Constructor. This should generally only be used internally to NetworkTables.
+   *
+   * @param remoteId Remote identifier
+   * @param remoteIp Remote IP address
+   * @param remotePort Remote port number
+   * @param lastUpdate Last time an update was received
+   * @param protocolVersion The protocol version used for the connection
+   * @param outgoingQueueDepth Number of outgoing batches waiting to be sent
+   * @param bytesSent Total number of bytes sent
+   */
+  public ConnectionInfo(
+      String remoteId,
+      String remoteIp,
+      int remotePort,
+      long lastUpdate,
+      int protocolVersion,
+      int outgoingQueueDepth,
+      long bytesSent) {
     remote_id = remoteId;
     remote_ip = remoteIp;
     remote_port = remotePort;
     last_update = lastUpdate;
     protocol_version = protocolVersion;
+    outgoing_queue_depth = outgoingQueueDepth;
+    bytes_sent = bytesSent;
   }
 }
@@ -63,4 +63,14 @@ public interface EntryListenerFlags {
    * <p>Set this flag to receive a notification when an entry's flags value changes.
    */
   int kFlags = 0x20;
+
+  /**
+   * Coalesce queued notifications.
+   *
+   * <p>Set this flag on a polled listener to keep at most one queued value change notification per
+   * entry; later value and flags changes are merged into a notification that has not been polled
+   * yet, so only the latest value is delivered. Creation and deletion notifications are never
+   * merged.
+   */
+  int kCoalesce = 0x40;
 }
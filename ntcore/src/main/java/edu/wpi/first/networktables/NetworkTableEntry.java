@@ -12,6 +12,12 @@ public final class NetworkTableEntry {
   /** Flag values (as returned by {@link #getFlags()}). */
   public static final int kPersistent = 0x01;
 
+  /**
+   * Flag value for entries whose updates are sent to the network right away rather than at the
+   * next periodic update or flush.
+   */
+  public static final int kImmediate = 0x02;
+
   /**
    * Construct from native handle.
    *
@@ -925,6 +925,29 @@ public final class NetworkTableInstance implements AutoCloseable {
     NetworkTablesJNI.setUpdateRate(m_handle, interval);
   }
 
+  /**
+   * Set the outgoing bandwidth limit for each network connection. When a connection reaches its
+   * limit (or falls behind sending), further updates to each entry are merged and only the latest
+   * value is sent once the connection catches up.
+   *
+   * @param bytesPerSec limit in bytes per second (0 for unlimited)
+   */
+  public void setNetworkBandwidthLimit(int bytesPerSec) {
+    NetworkTablesJNI.setNetworkBandwidthLimit(m_handle, bytesPerSec);
+  }
+
+  /**
+   * Selects the server network backend. By default, the server uses a read thread and a write
+   * thread per client connection. When enabled, all client connections are instead serviced by a
+   * single event loop thread, which scales better to many clients. This must be called before
+   * starting the server; it has no effect on a server that is already running.
+   *
+   * @param enabled true to use the event loop backend
+   */
+  public void setServerEventLoop(boolean enabled) {
+    NetworkTablesJNI.setServerEventLoop(m_handle, enabled);
+  }
+
   /**
    * Flushes all updated values immediately to the network. Note: This is rate-limited to protect
    * the network from flooding. This is primarily useful for synchronizing network updates with user
@@ -974,6 +997,19 @@ public final class NetworkTableInstance implements AutoCloseable {
     return NetworkTablesJNI.loadPersistent(m_handle, filename);
   }
 
+  /**
+   * Selects the file format used for saving persistent values. The binary format is faster to save
+   * and load and smaller for array values. With it, the server's periodic saves append just the
+   * changed values to the file (rewriting the whole file once these grow larger than the file
+   * itself). Loading detects the format of the file, so either format can be loaded regardless of
+   * this setting.
+   *
+   * @param binary true to save in the binary format, false for text
+   */
+  public void setPersistentBinary(boolean binary) {
+    NetworkTablesJNI.setPersistentBinary(m_handle, binary);
+  }
+
   /**
    * Save table values to a file. The file format used is identical to that used for SavePersistent.
    *
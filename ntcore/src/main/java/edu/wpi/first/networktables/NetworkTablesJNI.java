@@ -237,6 +237,10 @@ public final class NetworkTablesJNI {
 
   public static native void setUpdateRate(int inst, double interval);
 
+  public static native void setNetworkBandwidthLimit(int inst, int bytesPerSec);
+
+  public static native void setServerEventLoop(int inst, boolean enabled);
+
   public static native void flush(int inst);
 
   public static native ConnectionInfo[] getConnections(int inst);
@@ -248,6 +252,8 @@ public final class NetworkTablesJNI {
   public static native String[] loadPersistent(int inst, String filename)
       throws PersistentException; // returns warnings
 
+  public static native void setPersistentBinary(int inst, boolean binary);
+
   public static native void saveEntries(int inst, String filename, String prefix)
       throws PersistentException;
 
@@ -12,13 +12,16 @@
 #include <wpi/json_serializer.h>
 #include <wpi/raw_ostream.h>
 #include <wpi/timestamp.h>
+#include <wpinet/EventLoopRunner.h>
 #include <wpinet/TCPAcceptor.h>
 #include <wpinet/TCPConnector.h>
+#include <wpinet/uv/Tcp.h>
 
 #include "IConnectionNotifier.h"
 #include "IStorage.h"
 #include "Log.h"
 #include "NetworkConnection.h"
+#include "UvNetworkConnection.h"
 
 using namespace nt;
 
@@ -43,6 +46,10 @@ static std::string ConnInfoToJson(bool connected, const ConnectionInfo& info) {
 void Dispatcher::StartServer(std::string_view persist_filename,
                              const char* listen_address, unsigned int port) {
   std::string listen_address_copy(wpi::trim(listen_address));
+  if (m_server_event_loop) {
+    StartServerEventLoop(persist_filename, listen_address_copy, port);
+    return;
+  }
   DispatcherBase::StartServer(
       persist_filename,
       std::unique_ptr<wpi::NetworkAcceptor>(new wpi::TCPAcceptor(
@@ -146,19 +153,16 @@ void DispatcherBase::StartLocal() {
   m_storage.SetDispatcher(this, false);
 }
 
-void DispatcherBase::StartServer(
-    std::string_view persist_filename,
-    std::unique_ptr<wpi::NetworkAcceptor> acceptor) {
+bool DispatcherBase::StartServerCommon(std::string_view persist_filename) {
   {
     std::scoped_lock lock(m_user_mutex);
     if (m_active) {
-      return;
+      return false;
     }
     m_active = true;
   }
   m_networkMode = NT_NET_MODE_SERVER | NT_NET_MODE_STARTING;
   m_persist_filename = persist_filename;
-  m_server_acceptor = std::move(acceptor);
 
   // Load persistent file.  Ignore errors, but pass along warnings.
   if (!persist_filename.empty()) {
@@ -177,9 +181,57 @@ void DispatcherBase::StartServer(
   m_storage.SetDispatcher(this, true);
 
   m_dispatch_thread = std::thread(&Dispatcher::DispatchThreadMain, this);
+  return true;
+}
+
+void DispatcherBase::StartServer(
+    std::string_view persist_filename,
+    std::unique_ptr<wpi::NetworkAcceptor> acceptor) {
+  if (!StartServerCommon(persist_filename)) {
+    return;
+  }
+  m_server_acceptor = std::move(acceptor);
   m_clientserver_thread = std::thread(&Dispatcher::ServerThreadMain, this);
 }
 
+void DispatcherBase::StartServerEventLoop(std::string_view persist_filename,
+                                          std::string_view listen_address,
+                                          unsigned int port) {
+  if (!StartServerCommon(persist_filename)) {
+    return;
+  }
+  m_server_loop = std::make_unique<wpi::EventLoopRunner>();
+  m_server_loop->ExecSync([&](wpi::uv::Loop& loop) {
+    auto server = wpi::uv::Tcp::Create(loop);
+    if (!server) {
+      m_active = false;
+      m_networkMode = NT_NET_MODE_SERVER | NT_NET_MODE_FAILURE;
+      return;
+    }
+
+    // bind and listen errors are reported through the error signal
+    bool failed = false;
+    auto errConn = server->error.connect_connection([&](wpi::uv::Error err) {
+      ERROR("server: could not listen on port {}: {}", port, err.str());
+      failed = true;
+    });
+    server->Bind(listen_address, port);
+    if (!failed) {
+      server->Listen();
+    }
+    errConn.disconnect();
+    if (failed) {
+      server->Close();
+      m_active = false;
+      m_networkMode = NT_NET_MODE_SERVER | NT_NET_MODE_FAILURE;
+      return;
+    }
+
+    server->connection.connect([this, s = server.get()] { ServerAccept(*s); });
+    m_networkMode = NT_NET_MODE_SERVER;
+  });
+}
+
 void DispatcherBase::StartClient() {
   {
     std::scoped_lock lock(m_user_mutex);
@@ -213,6 +265,12 @@ void DispatcherBase::Stop() {
     m_server_acceptor->shutdown();
   }
 
+  // stop the server event loop; this closes all of its connections' sockets
+  if (m_server_loop) {
+    m_server_loop->Stop();
+    m_networkMode = NT_NET_MODE_NONE;
+  }
+
   // join threads, with timeout
   if (m_dispatch_thread.joinable()) {
     m_dispatch_thread.join();
@@ -229,6 +287,7 @@ void DispatcherBase::Stop() {
 
   // close all connections
   conns.resize(0);
+  m_server_loop.reset();
 }
 
 void DispatcherBase::SetUpdateRate(double interval) {
@@ -241,6 +300,14 @@ void DispatcherBase::SetUpdateRate(double interval) {
   m_update_rate = static_cast<unsigned int>(interval * 1000);
 }
 
+void DispatcherBase::SetBandwidthLimit(unsigned int bytes_per_sec) {
+  std::scoped_lock lock(m_user_mutex);
+  m_bandwidth_limit = bytes_per_sec;
+  for (auto& conn : m_connections) {
+    conn->set_bandwidth_limit(bytes_per_sec);
+  }
+}
+
 void DispatcherBase::SetIdentity(std::string_view name) {
   std::scoped_lock lock(m_user_mutex);
   m_identity = name;
@@ -462,6 +529,32 @@ void DispatcherBase::QueueOutgoing(std::shared_ptr<Message> msg,
   }
 }
 
+void DispatcherBase::QueueOutgoingImmediate(std::shared_ptr<Message> msg,
+                                            INetworkConnection* only,
+                                            INetworkConnection* except) {
+  std::scoped_lock user_lock(m_user_mutex);
+  for (auto& conn : m_connections) {
+    if (conn.get() == except) {
+      continue;
+    }
+    if (only && conn.get() != only) {
+      continue;
+    }
+    auto state = conn->state();
+    if (state != NetworkConnection::kSynchronized &&
+        state != NetworkConnection::kActive) {
+      continue;
+    }
+    conn->QueueOutgoing(msg);
+    // Post whatever is pending along with it so messages stay in order (e.g.
+    // an assignment queued earlier must go out before this update).  This
+    // still honors the connection's backpressure and bandwidth limit.
+    if (state == NetworkConnection::kActive) {
+      conn->PostOutgoing(false);
+    }
+  }
+}
+
 void DispatcherBase::ServerThreadMain() {
   if (m_server_acceptor->start() != 0) {
     m_active = false;
@@ -493,6 +586,7 @@ void DispatcherBase::ServerThreadMain() {
                   std::weak_ptr<NetworkConnection>(conn)));
     {
       std::scoped_lock lock(m_user_mutex);
+      conn->set_bandwidth_limit(m_bandwidth_limit);
       // reuse dead connection slots
       bool placed = false;
       for (auto& c : m_connections) {
@@ -511,6 +605,45 @@ void DispatcherBase::ServerThreadMain() {
   m_networkMode = NT_NET_MODE_NONE;
 }
 
+void DispatcherBase::ServerAccept(wpi::uv::Tcp& server) {
+  auto stream = server.Accept();
+  if (!stream) {
+    return;
+  }
+  if (!m_active) {
+    stream->Close();
+    return;
+  }
+
+  // add to connections list
+  using namespace std::placeholders;
+  auto conn = std::make_shared<UvNetworkConnection>(
+      ++m_connections_uid, stream, *m_server_loop, m_notifier, m_logger,
+      std::bind(&Dispatcher::ServerHandshakeHello, this, _1, _2, _3),  // NOLINT
+      std::bind(&Dispatcher::ServerHandshakeDone, this, _1, _2),       // NOLINT
+      std::bind(&IStorage::GetMessageEntryType, &m_storage, _1));      // NOLINT
+  conn->set_process_incoming(
+      std::bind(&IStorage::ProcessIncoming, &m_storage, _1, _2,  // NOLINT
+                std::weak_ptr<UvNetworkConnection>(conn)));
+  {
+    std::scoped_lock lock(m_user_mutex);
+    conn->set_bandwidth_limit(m_bandwidth_limit);
+    // reuse dead connection slots
+    bool placed = false;
+    for (auto& c : m_connections) {
+      if (c->state() == NetworkConnection::kDead) {
+        c = conn;
+        placed = true;
+        break;
+      }
+    }
+    if (!placed) {
+      m_connections.emplace_back(conn);
+    }
+    conn->Start();
+  }
+}
+
 void DispatcherBase::ClientThreadMain() {
   while (m_active) {
     // sleep between retries
@@ -550,6 +683,7 @@ void DispatcherBase::ClientThreadMain() {
     conn->set_process_incoming(
         std::bind(&IStorage::ProcessIncoming, &m_storage, _1, _2,  // NOLINT
                   std::weak_ptr<NetworkConnection>(conn)));
+    conn->set_bandwidth_limit(m_bandwidth_limit);
     m_connections.resize(0);  // disconnect any current
     m_connections.emplace_back(conn);
     conn->set_proto_rev(m_reconnect_proto_rev);
@@ -667,6 +801,55 @@ bool DispatcherBase::ServerHandshake(
     DEBUG0("{}", "server: client disconnected before sending hello");
     return false;
   }
+  if (!ServerHandshakeHello(conn, msg, send_msgs)) {
+    return false;
+  }
+
+  // In proto rev 3.0 and later, the handshake concludes with a client hello
+  // done message, so we can batch the assigns before marking the connection
+  // active.  In pre-3.0, we need to just immediately mark it active and hand
+  // off control to the dispatcher to assign them as they arrive.
+  if (conn.proto_rev() >= 0x0300) {
+    // receive client initial assignments
+    std::vector<std::shared_ptr<Message>> incoming;
+    msg = get_msg();
+    for (;;) {
+      if (!msg) {
+        // disconnected, retry
+        DEBUG0("{}", "server: disconnected waiting for initial entries");
+        return false;
+      }
+      if (msg->Is(Message::kClientHelloDone)) {
+        break;
+      }
+      // shouldn't receive a keep alive, but handle gracefully
+      if (msg->Is(Message::kKeepAlive)) {
+        msg = get_msg();
+        continue;
+      }
+      if (!msg->Is(Message::kEntryAssign)) {
+        // unexpected message
+        DEBUG0(
+            "server: received message ({}) other than entry assignment during "
+            "initial handshake",
+            static_cast<int>(msg->type()));
+        return false;
+      }
+      incoming.push_back(msg);
+      // get the next message (blocks)
+      msg = get_msg();
+    }
+    ServerHandshakeDone(conn, incoming);
+  }
+
+  INFO("server: client CONNECTED: {} port {}", conn.stream().getPeerIP(),
+       conn.stream().getPeerPort());
+  return true;
+}
+
+bool DispatcherBase::ServerHandshakeHello(
+    INetworkConnection& conn, const std::shared_ptr<Message>& msg,
+    std::function<void(wpi::span<std::shared_ptr<Message>>)> send_msgs) {
   if (!msg->Is(Message::kClientHello)) {
     DEBUG0("{}", "server: client initial message was not client hello");
     return false;
@@ -707,49 +890,14 @@ bool DispatcherBase::ServerHandshake(
   // Batch transmit
   DEBUG0("{}", "server: sending initial assignments");
   send_msgs(outgoing);
+  return true;
+}
 
-  // In proto rev 3.0 and later, the handshake concludes with a client hello
-  // done message, so we can batch the assigns before marking the connection
-  // active.  In pre-3.0, we need to just immediately mark it active and hand
-  // off control to the dispatcher to assign them as they arrive.
-  if (proto_rev >= 0x0300) {
-    // receive client initial assignments
-    std::vector<std::shared_ptr<Message>> incoming;
-    msg = get_msg();
-    for (;;) {
-      if (!msg) {
-        // disconnected, retry
-        DEBUG0("{}", "server: disconnected waiting for initial entries");
-        return false;
-      }
-      if (msg->Is(Message::kClientHelloDone)) {
-        break;
-      }
-      // shouldn't receive a keep alive, but handle gracefully
-      if (msg->Is(Message::kKeepAlive)) {
-        msg = get_msg();
-        continue;
-      }
-      if (!msg->Is(Message::kEntryAssign)) {
-        // unexpected message
-        DEBUG0(
-            "server: received message ({}) other than entry assignment during "
-            "initial handshake",
-            static_cast<int>(msg->type()));
-        return false;
-      }
-      incoming.push_back(msg);
-      // get the next message (blocks)
-      msg = get_msg();
-    }
-    for (auto& msg : incoming) {
-      m_storage.ProcessIncoming(msg, &conn, std::weak_ptr<NetworkConnection>());
-    }
+void DispatcherBase::ServerHandshakeDone(
+    INetworkConnection& conn, wpi::span<std::shared_ptr<Message>> incoming) {
+  for (auto& msg : incoming) {
+    m_storage.ProcessIncoming(msg, &conn, std::weak_ptr<NetworkConnection>());
   }
-
-  INFO("server: client CONNECTED: {} port {}", conn.stream().getPeerIP(),
-       conn.stream().getPeerPort());
-  return true;
 }
 
 void DispatcherBase::ClientReconnect(unsigned int proto_rev) {
@@ -24,9 +24,13 @@
 #include "INetworkConnection.h"
 
 namespace wpi {
+class EventLoopRunner;
 class Logger;
 class NetworkAcceptor;
 class NetworkStream;
+namespace uv {
+class Tcp;
+}  // namespace uv
 }  // namespace wpi
 
 namespace nt {
@@ -49,9 +53,14 @@ class DispatcherBase : public IDispatcher {
   void StartLocal();
   void StartServer(std::string_view persist_filename,
                    std::unique_ptr<wpi::NetworkAcceptor> acceptor);
+  void StartServerEventLoop(std::string_view persist_filename,
+                            std::string_view listen_address,
+                            unsigned int port);
   void StartClient();
   void Stop();
   void SetUpdateRate(double interval);
+  void SetBandwidthLimit(unsigned int bytes_per_sec);
+  void SetServerEventLoop(bool enabled) { m_server_event_loop = enabled; }
   void SetIdentity(std::string_view name);
   void Flush();
   std::vector<ConnectionInfo> GetConnections() const;
@@ -76,8 +85,11 @@ class DispatcherBase : public IDispatcher {
   DispatcherBase& operator=(const DispatcherBase&) = delete;
 
  private:
+  bool StartServerCommon(std::string_view persist_filename);
+
   void DispatchThreadMain();
   void ServerThreadMain();
+  void ServerAccept(wpi::uv::Tcp& server);
   void ClientThreadMain();
 
   bool ClientHandshake(
@@ -88,11 +100,19 @@ class DispatcherBase : public IDispatcher {
       NetworkConnection& conn,
       std::function<std::shared_ptr<Message>()> get_msg,
       std::function<void(wpi::span<std::shared_ptr<Message>>)> send_msgs);
+  bool ServerHandshakeHello(
+      INetworkConnection& conn, const std::shared_ptr<Message>& msg,
+      std::function<void(wpi::span<std::shared_ptr<Message>>)> send_msgs);
+  void ServerHandshakeDone(INetworkConnection& conn,
+                           wpi::span<std::shared_ptr<Message>> incoming);
 
   void ClientReconnect(unsigned int proto_rev = 0x0300);
 
   void QueueOutgoing(std::shared_ptr<Message> msg, INetworkConnection* only,
                      INetworkConnection* except) override;
+  void QueueOutgoingImmediate(std::shared_ptr<Message> msg,
+                              INetworkConnection* only,
+                              INetworkConnection* except) override;
 
   IStorage& m_storage;
   IConnectionNotifier& m_notifier;
@@ -102,6 +122,8 @@ class DispatcherBase : public IDispatcher {
   std::thread m_clientserver_thread;
 
   std::unique_ptr<wpi::NetworkAcceptor> m_server_acceptor;
+  // Services all server connections when the event loop backend is used
+  std::unique_ptr<wpi::EventLoopRunner> m_server_loop;
   Connector m_client_connector_override;
   Connector m_client_connector;
   uint8_t m_connections_uid = 0;
@@ -113,6 +135,7 @@ class DispatcherBase : public IDispatcher {
 
   std::atomic_bool m_active;       // set to false to terminate threads
   std::atomic_uint m_update_rate;  // periodic dispatch update rate, in ms
+  std::atomic_uint m_bandwidth_limit{0};  // per connection, in bytes/s
 
   // Condition variable for forced dispatch wakeup (flush)
   wpi::mutex m_flush_mutex;
@@ -141,6 +164,7 @@ class DispatcherBase : public IDispatcher {
 
  protected:
   wpi::Logger& m_logger;
+  std::atomic_bool m_server_event_loop{false};
 };
 
 class Dispatcher : public DispatcherBase {
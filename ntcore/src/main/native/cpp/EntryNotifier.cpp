@@ -4,6 +4,8 @@
 
 #include "EntryNotifier.h"
 
+#include <algorithm>
+
 #include <wpi/StringExtras.h>
 
 #include "Log.h"
@@ -58,6 +60,70 @@ bool impl::EntryNotifierThread::Matches(const EntryListenerData& listener,
   return true;
 }
 
+void impl::EntryNotifierThread::ListenerAdded(unsigned int listener_uid) {
+  auto& listener = m_listeners[listener_uid];
+  if (listener.entry != 0) {
+    m_entry_listeners[listener.entry].push_back(listener_uid);
+  } else {
+    m_prefix_listeners.Insert(listener.prefix, listener_uid);
+  }
+}
+
+void impl::EntryNotifierThread::ListenerRemoved(unsigned int listener_uid) {
+  auto& listener = m_listeners[listener_uid];
+  if (listener.entry != 0) {
+    auto it = m_entry_listeners.find(listener.entry);
+    if (it == m_entry_listeners.end()) {
+      return;
+    }
+    auto& uids = it->second;
+    uids.erase(std::remove(uids.begin(), uids.end(), listener_uid),
+               uids.end());
+    if (uids.empty()) {
+      m_entry_listeners.erase(it);
+    }
+  } else {
+    m_prefix_listeners.Remove(listener.prefix, listener_uid);
+  }
+}
+
+bool impl::EntryNotifierThread::GetListeners(
+    const EntryNotification& data,
+    wpi::SmallVectorImpl<unsigned int>& listener_uids) {
+  auto it = m_entry_listeners.find(data.entry);
+  if (it != m_entry_listeners.end()) {
+    listener_uids.append(it->second.begin(), it->second.end());
+  }
+  m_prefix_listeners.ForEachPrefixOf(
+      data.name, [&](unsigned int uid) { listener_uids.push_back(uid); });
+  // preserve listener registration order
+  std::sort(listener_uids.begin(), listener_uids.end());
+  return true;
+}
+
+bool impl::EntryNotifierThread::GetCoalesceKey(
+    const EntryListenerData& listener, const EntryNotification& data,
+    unsigned int* key) {
+  if ((listener.flags & NT_NOTIFY_COALESCE) == 0) {
+    return false;
+  }
+  *key = data.entry;
+  return true;
+}
+
+bool impl::EntryNotifierThread::Coalesce(EntryNotification* pending,
+                                         const EntryNotification& data) {
+  // Only value and flags changes can be merged; creation and deletion are
+  // always delivered, and nothing is merged into a pending deletion.
+  if ((data.flags & (NT_NOTIFY_NEW | NT_NOTIFY_DELETE)) != 0 ||
+      (pending->flags & NT_NOTIFY_DELETE) != 0) {
+    return false;
+  }
+  pending->value = data.value;
+  pending->flags |= data.flags;
+  return true;
+}
+
 unsigned int EntryNotifier::Add(
     std::function<void(const EntryNotification& event)> callback,
     std::string_view prefix, unsigned int flags) {
@@ -12,9 +12,12 @@
 #include <utility>
 
 #include <wpi/CallbackManager.h>
+#include <wpi/DenseMap.h>
+#include <wpi/SmallVector.h>
 
 #include "Handle.h"
 #include "IEntryNotifier.h"
+#include "PrefixTrie.h"
 #include "ntcore_cpp.h"
 
 namespace wpi {
@@ -60,6 +63,19 @@ class EntryNotifierThread
   bool Matches(const EntryListenerData& listener,
                const EntryNotification& data);
 
+  // Listeners are indexed by entry and by prefix so that each notification
+  // only visits listeners that can match it.
+  void ListenerAdded(unsigned int listener_uid);
+  void ListenerRemoved(unsigned int listener_uid);
+  bool GetListeners(const EntryNotification& data,
+                    wpi::SmallVectorImpl<unsigned int>& listener_uids);
+
+  // Polled listeners with NT_NOTIFY_COALESCE only keep the latest queued
+  // value per entry.
+  bool GetCoalesceKey(const EntryListenerData& listener,
+                      const EntryNotification& data, unsigned int* key);
+  bool Coalesce(EntryNotification* pending, const EntryNotification& data);
+
   void SetListener(EntryNotification* data, unsigned int listener_uid) {
     data->listener =
         Handle(m_inst, listener_uid, Handle::kEntryListener).handle();
@@ -71,6 +87,8 @@ class EntryNotifierThread
   }
 
   int m_inst;
+  wpi::DenseMap<NT_Entry, wpi::SmallVector<unsigned int, 1>> m_entry_listeners;
+  PrefixTrie<unsigned int> m_prefix_listeners;
 };
 
 }  // namespace impl
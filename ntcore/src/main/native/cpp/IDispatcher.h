@@ -24,6 +24,11 @@ class IDispatcher {
   virtual void QueueOutgoing(std::shared_ptr<Message> msg,
                              INetworkConnection* only,
                              INetworkConnection* except) = 0;
+  // Queues a message and posts it to the connections right away, bypassing
+  // the periodic update.
+  virtual void QueueOutgoingImmediate(std::shared_ptr<Message> msg,
+                                      INetworkConnection* only,
+                                      INetworkConnection* except) = 0;
 };
 
 }  // namespace nt
@@ -6,6 +6,7 @@
 #define NTCORE_INETWORKCONNECTION_H_
 
 #include <memory>
+#include <string_view>
 
 #include "Message.h"
 #include "ntcore_cpp.h"
@@ -31,6 +32,11 @@ class INetworkConnection {
 
   virtual State state() const = 0;
   virtual void set_state(State state) = 0;
+
+  virtual void set_remote_id(std::string_view remote_id) = 0;
+
+  // Limit outgoing bandwidth, in bytes per second (0 for unlimited)
+  virtual void set_bandwidth_limit(unsigned int bytes_per_sec) = 0;
 };
 
 }  // namespace nt
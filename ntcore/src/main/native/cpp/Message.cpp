@@ -6,7 +6,10 @@
 
 #include <stdint.h>
 
+#include <atomic>
+
 #include "Log.h"
+#include "PoolAllocator.h"
 #include "WireDecoder.h"
 #include "WireEncoder.h"
 
@@ -20,8 +23,9 @@ std::shared_ptr<Message> Message::Read(WireDecoder& decoder,
   if (!decoder.Read8(&msg_type)) {
     return nullptr;
   }
-  auto msg =
-      std::make_shared<Message>(static_cast<MsgType>(msg_type), private_init());
+  // decoded messages are usually short-lived, so recycle their memory
+  auto msg = std::allocate_shared<Message>(
+      PoolAllocator<Message>{}, static_cast<MsgType>(msg_type), private_init());
   switch (msg_type) {
     case kKeepAlive:
       break;
@@ -275,6 +279,21 @@ std::shared_ptr<Message> Message::RpcResponse(unsigned int id, unsigned int uid,
   return msg;
 }
 
+std::shared_ptr<const std::string> Message::GetEncoded(
+    unsigned int proto_rev) const {
+  auto& cache = m_encoded[proto_rev >= 0x0300u ? 1 : 0];
+  auto encoded = std::atomic_load(&cache);
+  if (!encoded) {
+    // If multiple threads race here, each encodes the same bytes; the last
+    // store wins and all results remain valid.
+    WireEncoder encoder(proto_rev);
+    Write(encoder);
+    encoded = std::make_shared<const std::string>(encoder.ToStringView());
+    std::atomic_store(&cache, encoded);
+  }
+  return encoded;
+}
+
 void Message::Write(WireEncoder& encoder) const {
   switch (m_type) {
     case kKeepAlive:
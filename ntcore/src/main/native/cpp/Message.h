@@ -55,6 +55,11 @@ class Message {
 
   // Read and write from wire representation
   void Write(WireEncoder& encoder) const;
+
+  // Get the wire representation for a protocol revision.  This is encoded
+  // only once per revision and then shared, so a message broadcast to many
+  // connections is not re-encoded (and its value not re-copied) for each one.
+  std::shared_ptr<const std::string> GetEncoded(unsigned int proto_rev) const;
   static std::shared_ptr<Message> Read(WireDecoder& decoder,
                                        GetEntryTypeFunc get_entry_type);
 
@@ -107,6 +112,9 @@ class Message {
   unsigned int m_id{0};  // also used for proto_rev
   unsigned int m_flags{0};
   unsigned int m_seq_num_uid{0};
+
+  // Cached wire representations (2.0 and 3.0), accessed atomically
+  mutable std::shared_ptr<const std::string> m_encoded[2];
 };
 
 }  // namespace nt
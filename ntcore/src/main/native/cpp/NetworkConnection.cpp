@@ -4,6 +4,7 @@
 
 #include "NetworkConnection.h"
 
+#include <string>
 #include <utility>
 
 #include <wpi/timestamp.h>
@@ -12,8 +13,8 @@
 
 #include "IConnectionNotifier.h"
 #include "Log.h"
+#include "OutgoingBatch.h"
 #include "WireDecoder.h"
-#include "WireEncoder.h"
 
 using namespace nt;
 
@@ -52,6 +53,7 @@ void NetworkConnection::Start() {
   while (!m_outgoing.empty()) {
     m_outgoing.pop();
   }
+  m_outgoing_depth = 0;
   // reset shutdown flags
   {
     std::scoped_lock lock(m_shutdown_mutex);
@@ -103,9 +105,18 @@ void NetworkConnection::Stop() {
 }
 
 ConnectionInfo NetworkConnection::info() const {
-  return ConnectionInfo{remote_id(), std::string{m_stream->getPeerIP()},
+  return ConnectionInfo{remote_id(),
+                        std::string{m_stream->getPeerIP()},
                         static_cast<unsigned int>(m_stream->getPeerPort()),
-                        m_last_update, m_proto_rev};
+                        m_last_update,
+                        m_proto_rev,
+                        m_outgoing_depth,
+                        m_bytes_sent};
+}
+
+void NetworkConnection::EnqueueOutgoing(Outgoing&& msgs) {
+  ++m_outgoing_depth;
+  m_outgoing.emplace(std::move(msgs));
 }
 
 unsigned int NetworkConnection::proto_rev() const {
@@ -163,8 +174,7 @@ void NetworkConnection::ReadThreadMain() {
             return msg;
           },
           [&](auto msgs) {
-            m_outgoing.emplace(std::vector<std::shared_ptr<Message>>(
-                msgs.begin(), msgs.end()));
+            EnqueueOutgoing(Outgoing(msgs.begin(), msgs.end()));
           })) {
     set_state(kDead);
     m_active = false;
@@ -210,7 +220,7 @@ done:
 }
 
 void NetworkConnection::WriteThreadMain() {
-  WireEncoder encoder(m_proto_rev);
+  EncodedBatch batch(m_proto_rev);
 
   while (m_active) {
     auto msgs = m_outgoing.pop();
@@ -218,28 +228,33 @@ void NetworkConnection::WriteThreadMain() {
     if (msgs.empty()) {
       continue;
     }
-    encoder.set_proto_rev(m_proto_rev);
-    encoder.Reset();
     DEBUG3("sending {} messages", msgs.size());
     for (auto& msg : msgs) {
       if (msg) {
         DEBUG3("sending type={} with str={} id={} seq_num={}",
                static_cast<int>(msg->type()), msg->str(), msg->id(),
                msg->seq_num_uid());
-        msg->Write(encoder);
       }
     }
+    batch.Encode(msgs, m_proto_rev);
     wpi::NetworkStream::Error err;
     if (!m_stream) {
       break;
     }
-    if (encoder.size() == 0) {
+    if (batch.size() == 0) {
+      --m_outgoing_depth;
       continue;
     }
-    if (m_stream->send(encoder.data(), encoder.size(), &err) == 0) {
+    auto bufs = batch.buffers();
+    size_t sent = bufs.size() == 1
+                      ? m_stream->send(bufs[0].data(), bufs[0].size(), &err)
+                      : m_stream->sendv(bufs, &err);
+    if (sent == 0) {
       break;
     }
-    DEBUG4("sent {} bytes", encoder.size());
+    m_bytes_sent += sent;
+    --m_outgoing_depth;
+    DEBUG4("sent {} bytes", batch.size());
   }
   DEBUG2("write thread died ({})", fmt::ptr(this));
   set_state(kDead);
@@ -258,111 +273,22 @@ void NetworkConnection::WriteThreadMain() {
 
 void NetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
   std::scoped_lock lock(m_pending_mutex);
-
-  // Merge with previous.  One case we don't combine: delete/assign loop.
-  switch (msg->type()) {
-    case Message::kEntryAssign:
-    case Message::kEntryUpdate: {
-      // don't do this for unassigned id's
-      unsigned int id = msg->id();
-      if (id == 0xffff) {
-        m_pending_outgoing.push_back(msg);
-        break;
-      }
-      if (id < m_pending_update.size() && m_pending_update[id].first != 0) {
-        // overwrite the previous one for this id
-        auto& oldmsg = m_pending_outgoing[m_pending_update[id].first - 1];
-        if (oldmsg && oldmsg->Is(Message::kEntryAssign) &&
-            msg->Is(Message::kEntryUpdate)) {
-          // need to update assignment with new seq_num and value
-          oldmsg = Message::EntryAssign(oldmsg->str(), id, msg->seq_num_uid(),
-                                        msg->value(), oldmsg->flags());
-        } else {
-          oldmsg = msg;  // easy update
-        }
-      } else {
-        // new, but remember it
-        size_t pos = m_pending_outgoing.size();
-        m_pending_outgoing.push_back(msg);
-        if (id >= m_pending_update.size()) {
-          m_pending_update.resize(id + 1);
-        }
-        m_pending_update[id].first = pos + 1;
-      }
-      break;
-    }
-    case Message::kEntryDelete: {
-      // don't do this for unassigned id's
-      unsigned int id = msg->id();
-      if (id == 0xffff) {
-        m_pending_outgoing.push_back(msg);
-        break;
-      }
-
-      // clear previous updates
-      if (id < m_pending_update.size()) {
-        if (m_pending_update[id].first != 0) {
-          m_pending_outgoing[m_pending_update[id].first - 1].reset();
-          m_pending_update[id].first = 0;
-        }
-        if (m_pending_update[id].second != 0) {
-          m_pending_outgoing[m_pending_update[id].second - 1].reset();
-          m_pending_update[id].second = 0;
-        }
-      }
-
-      // add deletion
-      m_pending_outgoing.push_back(msg);
-      break;
-    }
-    case Message::kFlagsUpdate: {
-      // don't do this for unassigned id's
-      unsigned int id = msg->id();
-      if (id == 0xffff) {
-        m_pending_outgoing.push_back(msg);
-        break;
-      }
-      if (id < m_pending_update.size() && m_pending_update[id].second != 0) {
-        // overwrite the previous one for this id
-        m_pending_outgoing[m_pending_update[id].second - 1] = msg;
-      } else {
-        // new, but remember it
-        size_t pos = m_pending_outgoing.size();
-        m_pending_outgoing.push_back(msg);
-        if (id >= m_pending_update.size()) {
-          m_pending_update.resize(id + 1);
-        }
-        m_pending_update[id].second = pos + 1;
-      }
-      break;
-    }
-    case Message::kClearEntries: {
-      // knock out all previous assigns/updates!
-      for (auto& i : m_pending_outgoing) {
-        if (!i) {
-          continue;
-        }
-        auto t = i->type();
-        if (t == Message::kEntryAssign || t == Message::kEntryUpdate ||
-            t == Message::kFlagsUpdate || t == Message::kEntryDelete ||
-            t == Message::kClearEntries) {
-          i.reset();
-        }
-      }
-      m_pending_update.resize(0);
-      m_pending_outgoing.push_back(msg);
-      break;
-    }
-    default:
-      m_pending_outgoing.push_back(msg);
-      break;
-  }
+  m_pending.Add(std::move(msg));
 }
 
 void NetworkConnection::PostOutgoing(bool keep_alive) {
   std::scoped_lock lock(m_pending_mutex);
   auto now = std::chrono::steady_clock::now();
-  if (m_pending_outgoing.empty()) {
+
+  // If the write thread is behind (or the budget is used up), hold on to the
+  // pending messages; updates to the same entry keep being merged into them
+  // until the write thread catches up.
+  if (!m_pending.CanPost(now, m_outgoing_depth, m_bytes_sent,
+                         m_bandwidth_limit)) {
+    return;
+  }
+
+  if (m_pending.empty()) {
     if (!keep_alive) {
       return;
     }
@@ -370,11 +296,9 @@ void NetworkConnection::PostOutgoing(bool keep_alive) {
     if ((now - m_last_post) < std::chrono::seconds(1)) {
       return;
     }
-    m_outgoing.emplace(Outgoing{Message::KeepAlive()});
+    EnqueueOutgoing(Outgoing{Message::KeepAlive()});
   } else {
-    m_outgoing.emplace(std::move(m_pending_outgoing));
-    m_pending_outgoing.resize(0);
-    m_pending_update.resize(0);
+    EnqueueOutgoing(m_pending.Take());
   }
   m_last_post = now;
 }  // NOLINT
@@ -23,6 +23,7 @@
 
 #include "INetworkConnection.h"
 #include "Message.h"
+#include "OutgoingBatch.h"
 #include "ntcore_cpp.h"
 
 namespace wpi {
@@ -42,7 +43,7 @@ class NetworkConnection : public INetworkConnection {
       std::function<void(wpi::span<std::shared_ptr<Message>>)> send_msgs)>;
   using ProcessIncomingFunc =
       std::function<void(std::shared_ptr<Message>, NetworkConnection*)>;
-  using Outgoing = std::vector<std::shared_ptr<Message>>;
+  using Outgoing = OutgoingBatcher::Outgoing;
   using OutgoingQueue = wpi::ConcurrentQueue<Outgoing>;
 
   NetworkConnection(unsigned int uid,
@@ -76,8 +77,12 @@ class NetworkConnection : public INetworkConnection {
   State state() const final;
   void set_state(State state) final;
 
+  void set_bandwidth_limit(unsigned int bytes_per_sec) final {
+    m_bandwidth_limit = bytes_per_sec;
+  }
+
   std::string remote_id() const;
-  void set_remote_id(std::string_view remote_id);
+  void set_remote_id(std::string_view remote_id) final;
 
   uint64_t last_update() const { return m_last_update; }
 
@@ -87,6 +92,7 @@ class NetworkConnection : public INetworkConnection {
  private:
   void ReadThreadMain();
   void WriteThreadMain();
+  void EnqueueOutgoing(Outgoing&& msgs);
 
   unsigned int m_uid;
   std::unique_ptr<wpi::NetworkStream> m_stream;
@@ -107,9 +113,13 @@ class NetworkConnection : public INetworkConnection {
   std::atomic_ullong m_last_update;
   std::chrono::steady_clock::time_point m_last_post;
 
+  // Outgoing batches queued or being written, and total bytes written
+  std::atomic_uint m_outgoing_depth{0};
+  std::atomic_ullong m_bytes_sent{0};
+  std::atomic_uint m_bandwidth_limit{0};
+
   wpi::mutex m_pending_mutex;
-  Outgoing m_pending_outgoing;
-  std::vector<std::pair<size_t, size_t>> m_pending_update;
+  OutgoingBatcher m_pending;
 
   // Condition variables for shutdown
   wpi::mutex m_shutdown_mutex;
@@ -0,0 +1,173 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "OutgoingBatch.h"
+
+#include <algorithm>
+
+using namespace nt;
+
+void OutgoingBatcher::Add(std::shared_ptr<Message> msg) {
+  // Merge with previous.  One case we don't combine: delete/assign loop.
+  switch (msg->type()) {
+    case Message::kEntryAssign:
+    case Message::kEntryUpdate: {
+      // don't do this for unassigned id's
+      unsigned int id = msg->id();
+      if (id == 0xffff) {
+        m_pending.push_back(msg);
+        break;
+      }
+      if (id < m_update.size() && m_update[id].first != 0) {
+        // overwrite the previous one for this id
+        auto& oldmsg = m_pending[m_update[id].first - 1];
+        if (oldmsg && oldmsg->Is(Message::kEntryAssign) &&
+            msg->Is(Message::kEntryUpdate)) {
+          // need to update assignment with new seq_num and value
+          oldmsg = Message::EntryAssign(oldmsg->str(), id, msg->seq_num_uid(),
+                                        msg->value(), oldmsg->flags());
+        } else {
+          oldmsg = msg;  // easy update
+        }
+      } else {
+        // new, but remember it
+        size_t pos = m_pending.size();
+        m_pending.push_back(msg);
+        if (id >= m_update.size()) {
+          m_update.resize(id + 1);
+        }
+        m_update[id].first = pos + 1;
+      }
+      break;
+    }
+    case Message::kEntryDelete: {
+      // don't do this for unassigned id's
+      unsigned int id = msg->id();
+      if (id == 0xffff) {
+        m_pending.push_back(msg);
+        break;
+      }
+
+      // clear previous updates
+      if (id < m_update.size()) {
+        if (m_update[id].first != 0) {
+          m_pending[m_update[id].first - 1].reset();
+          m_update[id].first = 0;
+        }
+        if (m_update[id].second != 0) {
+          m_pending[m_update[id].second - 1].reset();
+          m_update[id].second = 0;
+        }
+      }
+
+      // add deletion
+      m_pending.push_back(msg);
+      break;
+    }
+    case Message::kFlagsUpdate: {
+      // don't do this for unassigned id's
+      unsigned int id = msg->id();
+      if (id == 0xffff) {
+        m_pending.push_back(msg);
+        break;
+      }
+      if (id < m_update.size() && m_update[id].second != 0) {
+        // overwrite the previous one for this id
+        m_pending[m_update[id].second - 1] = msg;
+      } else {
+        // new, but remember it
+        size_t pos = m_pending.size();
+        m_pending.push_back(msg);
+        if (id >= m_update.size()) {
+          m_update.resize(id + 1);
+        }
+        m_update[id].second = pos + 1;
+      }
+      break;
+    }
+    case Message::kClearEntries: {
+      // knock out all previous assigns/updates!
+      for (auto& i : m_pending) {
+        if (!i) {
+          continue;
+        }
+        auto t = i->type();
+        if (t == Message::kEntryAssign || t == Message::kEntryUpdate ||
+            t == Message::kFlagsUpdate || t == Message::kEntryDelete ||
+            t == Message::kClearEntries) {
+          i.reset();
+        }
+      }
+      m_update.resize(0);
+      m_pending.push_back(msg);
+      break;
+    }
+    default:
+      m_pending.push_back(msg);
+      break;
+  }
+}
+
+OutgoingBatcher::Outgoing OutgoingBatcher::Take() {
+  Outgoing rv;
+  rv.swap(m_pending);
+  m_update.resize(0);
+  return rv;
+}
+
+bool OutgoingBatcher::CanPost(std::chrono::steady_clock::time_point now,
+                              unsigned int depth, uint64_t bytes_sent,
+                              unsigned int limit) {
+  // Refill the bandwidth budget, allowing at most a one second burst.
+  if (limit != 0) {
+    m_budget +=
+        limit * std::chrono::duration<double>(now - m_budget_time).count() -
+        static_cast<double>(bytes_sent - m_budget_bytes_sent);
+    m_budget = (std::min)(m_budget, static_cast<double>(limit));
+    m_budget_bytes_sent = bytes_sent;
+  }
+  m_budget_time = now;
+
+  return depth < kMaxOutgoingDepth && (limit == 0 || m_budget >= 0);
+}
+
+void EncodedBatch::Encode(wpi::span<const std::shared_ptr<Message>> msgs,
+                          unsigned int proto_rev) {
+  // Values at least this large are sent from the message's shared encoding
+  // rather than being copied into the encoder.
+  static constexpr size_t kMinSharedValueSize = 256;
+
+  m_encoder.set_proto_rev(proto_rev);
+  m_encoder.Reset();
+  m_shared.clear();
+  m_bufs.clear();
+  m_size = 0;
+  for (auto& msg : msgs) {
+    if (!msg) {
+      continue;
+    }
+    auto value = msg->value();
+    if (value && m_encoder.GetValueSize(*value) >= kMinSharedValueSize) {
+      auto& buf =
+          m_shared.emplace_back(m_encoder.size(), msg->GetEncoded(proto_rev));
+      m_size += buf.second->size();
+    } else {
+      msg->Write(m_encoder);
+    }
+  }
+  m_size += m_encoder.size();
+
+  // interleave the encoder contents with the shared encodings
+  size_t pos = 0;
+  for (auto&& [offset, buf] : m_shared) {
+    if (offset > pos) {
+      m_bufs.emplace_back(m_encoder.data() + pos, offset - pos);
+      pos = offset;
+    }
+    m_bufs.emplace_back(*buf);
+  }
+  if (m_encoder.size() > pos) {
+    m_bufs.emplace_back(m_encoder.data() + pos, m_encoder.size() - pos);
+  }
+}
@@ -0,0 +1,97 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef NTCORE_OUTGOINGBATCH_H_
+#define NTCORE_OUTGOINGBATCH_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <wpi/span.h>
+
+#include "Message.h"
+#include "WireEncoder.h"
+
+namespace nt {
+
+/**
+ * Outgoing messages collected for a connection between posts.  Updates to
+ * the same entry are merged so only the latest is sent.  This also tracks the
+ * connection's bandwidth budget.
+ *
+ * This class is not thread-safe; callers must provide locking.
+ */
+class OutgoingBatcher {
+ public:
+  using Outgoing = std::vector<std::shared_ptr<Message>>;
+
+  // Maximum number of batches queued to (or being sent by) a connection
+  // before further updates are held back and merged
+  static constexpr unsigned int kMaxOutgoingDepth = 2;
+
+  void Add(std::shared_ptr<Message> msg);
+
+  bool empty() const { return m_pending.empty(); }
+
+  Outgoing Take();
+
+  /**
+   * Determines whether a batch may be posted now.  Returns false if the
+   * connection is behind (too many batches outstanding) or has used up its
+   * bandwidth budget.
+   *
+   * @param now         current time
+   * @param depth       number of batches outstanding
+   * @param bytes_sent  total bytes sent by the connection
+   * @param limit       bandwidth limit in bytes per second (0 for unlimited)
+   */
+  bool CanPost(std::chrono::steady_clock::time_point now, unsigned int depth,
+               uint64_t bytes_sent, unsigned int limit);
+
+ private:
+  Outgoing m_pending;
+  // positions + 1 in m_pending of the value and flags updates for each id
+  std::vector<std::pair<size_t, size_t>> m_update;
+
+  // Bandwidth budget (token bucket, in bytes)
+  double m_budget = 0;
+  uint64_t m_budget_bytes_sent = 0;
+  std::chrono::steady_clock::time_point m_budget_time;
+};
+
+/**
+ * Wire encoding of a batch of messages.  Small messages are copied into a
+ * local buffer; large values are referenced from the message's shared
+ * encoding (see Message::GetEncoded()) rather than copied.
+ */
+class EncodedBatch {
+ public:
+  explicit EncodedBatch(unsigned int proto_rev) : m_encoder(proto_rev) {}
+
+  void Encode(wpi::span<const std::shared_ptr<Message>> msgs,
+              unsigned int proto_rev);
+
+  /** Buffers to send, in order. */
+  wpi::span<const std::string_view> buffers() const { return m_bufs; }
+
+  /** Total size of all buffers. */
+  size_t size() const { return m_size; }
+
+ private:
+  WireEncoder m_encoder;
+  // shared encodings and the encoder offset they are sent at
+  std::vector<std::pair<size_t, std::shared_ptr<const std::string>>> m_shared;
+  std::vector<std::string_view> m_bufs;
+  size_t m_size = 0;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_OUTGOINGBATCH_H_
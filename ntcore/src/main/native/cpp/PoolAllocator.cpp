@@ -0,0 +1,112 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "PoolAllocator.h"
+
+#include <array>
+#include <atomic>
+#include <new>
+
+using namespace nt;
+
+namespace {
+
+// Size classes are multiples of kGranularity up to kNumClasses *
+// kGranularity bytes; larger blocks always go to operator new.
+constexpr size_t kGranularity = 64;
+constexpr size_t kNumClasses = 16;
+// Maximum bytes cached per size class per thread
+constexpr size_t kMaxCachedBytes = 8192;
+
+// Maximum number of blocks cached per size class per thread
+constexpr auto kMaxCached = [] {
+  std::array<size_t, kNumClasses> counts{};
+  for (size_t i = 0; i < kNumClasses; ++i) {
+    counts[i] = kMaxCachedBytes / ((i + 1) * kGranularity);
+  }
+  return counts;
+}();
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+enum CacheState { kUnused = 0, kAlive, kDead };
+
+// This is trivially constructible and destructible so accessing it needs no
+// initialization check.  Values are commonly destroyed during thread exit
+// (e.g. when a thread's last reference goes away), after the cache has been
+// released, so the state also needs to stay valid then.
+struct ThreadCache {
+  FreeBlock* free[kNumClasses];
+  size_t count[kNumClasses];
+  CacheState state;
+};
+
+// Releases the cache at thread exit; registered on first use
+struct CacheCleanup {
+  ~CacheCleanup();
+  bool registered = false;
+};
+
+thread_local ThreadCache gCache;
+thread_local CacheCleanup gCacheCleanup;
+
+std::atomic<size_t> gUpstreamAllocations{0};
+
+}  // namespace
+
+CacheCleanup::~CacheCleanup() {
+  gCache.state = kDead;
+  for (auto head : gCache.free) {
+    while (head) {
+      auto next = head->next;
+      ::operator delete(head);
+      head = next;
+    }
+  }
+}
+
+static size_t GetSizeClass(size_t size) {
+  return size == 0 ? 0 : (size - 1) / kGranularity;
+}
+
+void* pool::Allocate(size_t size) {
+  size_t cls = GetSizeClass(size);
+  if (cls >= kNumClasses) {
+    gUpstreamAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+  auto& cache = gCache;
+  if (auto block = cache.free[cls]) {
+    cache.free[cls] = block->next;
+    --cache.count[cls];
+    return block;
+  }
+  gUpstreamAllocations.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new((cls + 1) * kGranularity);
+}
+
+void pool::Deallocate(void* ptr, size_t size) {
+  size_t cls = GetSizeClass(size);
+  if (cls < kNumClasses) {
+    auto& cache = gCache;
+    if (cache.state != kDead && cache.count[cls] < kMaxCached[cls]) {
+      if (cache.state == kUnused) {
+        cache.state = kAlive;
+        gCacheCleanup.registered = true;
+      }
+      auto block = static_cast<FreeBlock*>(ptr);
+      block->next = cache.free[cls];
+      cache.free[cls] = block;
+      ++cache.count[cls];
+      return;
+    }
+  }
+  ::operator delete(ptr);
+}
+
+size_t pool::GetNumUpstreamAllocations() {
+  return gUpstreamAllocations.load(std::memory_order_relaxed);
+}
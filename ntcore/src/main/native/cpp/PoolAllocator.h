@@ -0,0 +1,87 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef NTCORE_POOLALLOCATOR_H_
+#define NTCORE_POOLALLOCATOR_H_
+
+#include <cstddef>
+
+namespace nt {
+
+namespace pool {
+
+/**
+ * Allocates a block of memory from the calling thread's cache of freed
+ * blocks, falling back to operator new.  Small blocks are rounded up to a
+ * size class, so the same size must be passed to Deallocate().
+ *
+ * Each network connection decodes on its own thread (or on the server event
+ * loop), so this recycles the memory of values replaced by later updates
+ * without any locking.  Blocks may be freed on a different thread than
+ * they were allocated on; each thread caches only a bounded amount.
+ */
+void* Allocate(size_t size);
+void Deallocate(void* ptr, size_t size);
+
+/** Number of blocks requested from operator new (for testing). */
+size_t GetNumUpstreamAllocations();
+
+}  // namespace pool
+
+/**
+ * Allocator for std::allocate_shared() that uses the pool, optionally
+ * reserving extra bytes after the object in the same block.  The address of
+ * the extra bytes is stored to *extra_ptr when allocating.
+ */
+template <typename T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+
+  PoolAllocator() = default;
+  PoolAllocator(size_t extra, void** extra_ptr)
+      : m_extra{extra}, m_extra_ptr{extra_ptr} {}
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& other)  // NOLINT
+      : m_extra{other.m_extra}, m_extra_ptr{other.m_extra_ptr} {}
+
+  T* allocate(size_t n) {
+    size_t base = BaseSize(n);
+    char* ptr = static_cast<char*>(pool::Allocate(base + m_extra));
+    if (m_extra_ptr) {
+      *m_extra_ptr = ptr + base;
+    }
+    return reinterpret_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    pool::Deallocate(ptr, BaseSize(n) + m_extra);
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>& other) const {
+    return m_extra == other.m_extra;
+  }
+  template <typename U>
+  bool operator!=(const PoolAllocator<U>& other) const {
+    return m_extra != other.m_extra;
+  }
+
+ private:
+  template <typename U>
+  friend class PoolAllocator;
+
+  // keep the extra bytes aligned for any element type
+  static size_t BaseSize(size_t n) {
+    constexpr size_t kAlign = alignof(std::max_align_t);
+    return (n * sizeof(T) + kAlign - 1) & ~(kAlign - 1);
+  }
+
+  size_t m_extra = 0;
+  void** m_extra_ptr = nullptr;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_POOLALLOCATOR_H_
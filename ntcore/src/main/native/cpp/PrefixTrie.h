@@ -0,0 +1,207 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef NTCORE_PREFIXTRIE_H_
+#define NTCORE_PREFIXTRIE_H_
+
+#include <algorithm>
+#include <memory>
+#include <string_view>
+
+#include <wpi/SmallVector.h>
+#include <wpi/StringExtras.h>
+#include <wpi/StringMap.h>
+
+namespace nt {
+
+/**
+ * Trie of values keyed by '/'-separated path, supporting fast prefix queries.
+ *
+ * Keys are split after each '/' character, so "/a/bc" is stored as the
+ * segments "/", "a/", and "bc".  Because prefixes used by NetworkTables are
+ * plain string prefixes rather than path prefixes (e.g. "/Smart" matches
+ * "/SmartDashboard/x"), each node keeps segments ending in '/' (which have
+ * children) separately from the final unterminated segment of a key (which
+ * never has children).  This allows both directions of prefix matching to be
+ * answered without visiting unrelated keys:
+ * - ForEachWithPrefix() visits all keys starting with a prefix
+ * - ForEachPrefixOf() visits all keys that are a prefix of a name
+ *
+ * Multiple values may be stored for the same key.
+ */
+template <typename T>
+class PrefixTrie {
+ public:
+  void Insert(std::string_view key, T value) {
+    Node* node = &m_root;
+    for (;;) {
+      auto [seg, rest] = Split(key);
+      if (seg.empty()) {
+        break;
+      }
+      auto& map = rest.empty() && seg.back() != '/' ? node->leaves
+                                                    : node->children;
+      auto& child = map[seg];
+      if (!child) {
+        child = std::make_unique<Node>();
+      }
+      node = child.get();
+      key = rest;
+    }
+    node->values.emplace_back(std::move(value));
+  }
+
+  /**
+   * Removes a value from a key.
+   *
+   * @return True if the value was found and removed.
+   */
+  bool Remove(std::string_view key, const T& value) {
+    return RemoveImpl(&m_root, key, value);
+  }
+
+  void Clear() { m_root = Node{}; }
+
+  /**
+   * Calls func(value) for every value whose key starts with prefix.
+   */
+  template <typename F>
+  void ForEachWithPrefix(std::string_view prefix, F&& func) const {
+    const Node* node = &m_root;
+    for (;;) {
+      auto [seg, rest] = Split(prefix);
+      if (seg.empty()) {
+        VisitAll(*node, func);
+        return;
+      }
+      if (seg.back() != '/') {
+        // partial segment: matches any leaf or child starting with it
+        for (auto&& leaf : node->leaves) {
+          if (wpi::starts_with(leaf.getKey(), seg)) {
+            VisitAll(*leaf.getValue(), func);
+          }
+        }
+        for (auto&& child : node->children) {
+          if (wpi::starts_with(child.getKey(), seg)) {
+            VisitAll(*child.getValue(), func);
+          }
+        }
+        return;
+      }
+      auto it = node->children.find(seg);
+      if (it == node->children.end()) {
+        return;
+      }
+      node = it->getValue().get();
+      prefix = rest;
+    }
+  }
+
+  /**
+   * Calls func(value) for every value whose key is a prefix of name
+   * (including an exact match).
+   */
+  template <typename F>
+  void ForEachPrefixOf(std::string_view name, F&& func) const {
+    const Node* node = &m_root;
+    for (;;) {
+      for (auto&& value : node->values) {
+        func(value);
+      }
+      auto [seg, rest] = Split(name);
+      if (seg.empty()) {
+        return;
+      }
+      // leaves are unterminated segments, so any prefix of this segment
+      // (up to its full length excluding a trailing '/') may match
+      if (!node->leaves.empty()) {
+        size_t maxLen = seg.back() == '/' ? seg.size() - 1 : seg.size();
+        for (size_t len = 1; len <= maxLen; ++len) {
+          auto it = node->leaves.find(seg.substr(0, len));
+          if (it != node->leaves.end()) {
+            for (auto&& value : it->getValue()->values) {
+              func(value);
+            }
+          }
+        }
+      }
+      if (seg.back() != '/') {
+        return;
+      }
+      auto it = node->children.find(seg);
+      if (it == node->children.end()) {
+        return;
+      }
+      node = it->getValue().get();
+      name = rest;
+    }
+  }
+
+ private:
+  struct Node {
+    wpi::SmallVector<T, 1> values;
+    // segments ending in '/'
+    wpi::StringMap<std::unique_ptr<Node>> children;
+    // final segments not ending in '/' (these never have children)
+    wpi::StringMap<std::unique_ptr<Node>> leaves;
+
+    bool empty() const {
+      return values.empty() && children.empty() && leaves.empty();
+    }
+  };
+
+  // Splits off the first segment (including its trailing '/', if any).
+  static std::pair<std::string_view, std::string_view> Split(
+      std::string_view str) {
+    auto pos = str.find('/');
+    if (pos == std::string_view::npos) {
+      return {str, {}};
+    }
+    return {str.substr(0, pos + 1), str.substr(pos + 1)};
+  }
+
+  template <typename F>
+  static void VisitAll(const Node& node, F& func) {
+    for (auto&& value : node.values) {
+      func(value);
+    }
+    for (auto&& leaf : node.leaves) {
+      for (auto&& value : leaf.getValue()->values) {
+        func(value);
+      }
+    }
+    for (auto&& child : node.children) {
+      VisitAll(*child.getValue(), func);
+    }
+  }
+
+  static bool RemoveImpl(Node* node, std::string_view key, const T& value) {
+    auto [seg, rest] = Split(key);
+    if (seg.empty()) {
+      auto it = std::find(node->values.begin(), node->values.end(), value);
+      if (it == node->values.end()) {
+        return false;
+      }
+      node->values.erase(it);
+      return true;
+    }
+    auto& map = rest.empty() && seg.back() != '/' ? node->leaves
+                                                  : node->children;
+    auto it = map.find(seg);
+    if (it == map.end() || !RemoveImpl(it->getValue().get(), rest, value)) {
+      return false;
+    }
+    // prune empty nodes
+    if (it->getValue()->empty()) {
+      map.erase(it);
+    }
+    return true;
+  }
+
+  Node m_root;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_PREFIXTRIE_H_
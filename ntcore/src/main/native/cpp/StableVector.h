@@ -0,0 +1,94 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef NTCORE_STABLEVECTOR_H_
+#define NTCORE_STABLEVECTOR_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include <wpi/MathExtras.h>
+
+namespace nt {
+
+/**
+ * Append-only vector of owned objects whose elements never move once added.
+ *
+ * Storage is allocated in chunks that double in size, so growing the vector
+ * never relocates existing elements.  As a result, size() and operator[] may
+ * be called concurrently with emplace_back() without any locking; only
+ * emplace_back() itself needs to be externally serialized.
+ */
+template <typename T, size_t kFirstChunkSize = 64>
+class StableVector {
+  static_assert((kFirstChunkSize & (kFirstChunkSize - 1)) == 0,
+                "kFirstChunkSize must be a power of 2");
+
+ public:
+  using value_type = std::unique_ptr<T>;
+
+  StableVector() = default;
+  StableVector(const StableVector&) = delete;
+  StableVector& operator=(const StableVector&) = delete;
+
+  ~StableVector() {
+    for (auto&& chunk : m_chunks) {
+      delete[] chunk.load(std::memory_order_relaxed);
+    }
+  }
+
+  size_t size() const { return m_size.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Gets an element.  The index must be less than a value previously
+   * returned by size().
+   */
+  const value_type& operator[](size_t i) const {
+    size_t chunk = ChunkIndex(i);
+    return m_chunks[chunk].load(std::memory_order_acquire)
+        [i - ChunkStart(chunk)];
+  }
+
+  const value_type& back() const { return (*this)[size() - 1]; }
+
+  /**
+   * Adds an element to the end of the vector.  Calls to this function must be
+   * serialized by the caller.  The new element becomes visible to concurrent
+   * readers only after it is fully constructed.
+   */
+  void emplace_back(T* elem) {
+    size_t i = m_size.load(std::memory_order_relaxed);
+    size_t chunk = ChunkIndex(i);
+    value_type* storage = m_chunks[chunk].load(std::memory_order_relaxed);
+    if (!storage) {
+      storage = new value_type[ChunkSize(chunk)];
+      m_chunks[chunk].store(storage, std::memory_order_release);
+    }
+    storage[i - ChunkStart(chunk)].reset(elem);
+    m_size.store(i + 1, std::memory_order_release);
+  }
+
+ private:
+  static constexpr size_t kMaxChunks = 32;
+
+  static size_t ChunkIndex(size_t i) {
+    return wpi::Log2_64(i / kFirstChunkSize + 1);
+  }
+  static size_t ChunkStart(size_t chunk) {
+    return kFirstChunkSize * ((size_t{1} << chunk) - 1);
+  }
+  static size_t ChunkSize(size_t chunk) { return kFirstChunkSize << chunk; }
+
+  std::array<std::atomic<value_type*>, kMaxChunks> m_chunks{};
+  std::atomic<size_t> m_size{0};
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_STABLEVECTOR_H_
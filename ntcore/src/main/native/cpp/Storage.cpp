@@ -18,6 +18,21 @@
 
 using namespace nt;
 
+// Minimum number of journal records before a binary persistent file is
+// rewritten in full
+static constexpr size_t kMinJournalRecords = 64;
+
+// Queues a value message; updates to immediate entries are sent right away.
+static void QueueValueOutgoing(IDispatcher* dispatcher, bool immediate,
+                               std::shared_ptr<Message> msg,
+                               INetworkConnection* except) {
+  if (immediate) {
+    dispatcher->QueueOutgoingImmediate(std::move(msg), nullptr, except);
+  } else {
+    dispatcher->QueueOutgoing(std::move(msg), nullptr, except);
+  }
+}
+
 Storage::Storage(IEntryNotifier& notifier, IRpcServer& rpc_server,
                  wpi::Logger& logger)
     : m_notifier(notifier), m_rpc_server(rpc_server), m_logger(logger) {
@@ -141,7 +156,7 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
       if (!entry->value) {
         // didn't exist at all (rather than just being a response to a
         // id assignment request)
-        entry->value = msg->value();
+        entry->StoreValue(msg->value());
         entry->flags = msg->flags();
         entry->seq_num = seq_num;
 
@@ -191,7 +206,7 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
   if (!may_need_update && conn->proto_rev() >= 0x0300) {
     // update persistent dirty flag if persistent flag changed
     if ((entry->flags & NT_PERSISTENT) != (msg->flags() & NT_PERSISTENT)) {
-      m_persistent_dirty = true;
+      MarkPersistentDirty(entry);
     }
     if (entry->flags != msg->flags()) {
       notify_flags |= NT_NOTIFY_FLAGS;
@@ -201,11 +216,11 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
 
   // update persistent dirty flag if the value changed and it's persistent
   if (entry->IsPersistent() && *entry->value != *msg->value()) {
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
   }
 
   // update local
-  entry->value = msg->value();
+  entry->StoreValue(msg->value());
   entry->seq_num = seq_num;
 
   // notify
@@ -217,8 +232,9 @@ void Storage::ProcessIncomingEntryAssign(std::shared_ptr<Message> msg,
     auto dispatcher = m_dispatcher;
     auto outmsg = Message::EntryAssign(entry->name, id, msg->seq_num_uid(),
                                        msg->value(), entry->flags);
+    bool immediate = entry->IsImmediate();
     lock.unlock();
-    dispatcher->QueueOutgoing(outmsg, nullptr, conn);
+    QueueValueOutgoing(dispatcher, immediate, outmsg, conn);
   }
 }
 
@@ -242,12 +258,12 @@ void Storage::ProcessIncomingEntryUpdate(std::shared_ptr<Message> msg,
   }
 
   // update local
-  entry->value = msg->value();
+  entry->StoreValue(msg->value());
   entry->seq_num = seq_num;
 
   // update persistent dirty flag if it's a persistent value
   if (entry->IsPersistent()) {
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
   }
 
   // notify
@@ -257,8 +273,9 @@ void Storage::ProcessIncomingEntryUpdate(std::shared_ptr<Message> msg,
   // be any other connections, so don't bother)
   if (m_server && m_dispatcher) {
     auto dispatcher = m_dispatcher;
+    bool immediate = entry->IsImmediate();
     lock.unlock();
-    dispatcher->QueueOutgoing(msg, nullptr, conn);
+    QueueValueOutgoing(dispatcher, immediate, msg, conn);
   }
 }
 
@@ -450,7 +467,7 @@ void Storage::ApplyInitialAssignments(
     entry->id = id;
     if (!entry->value) {
       // doesn't currently exist
-      entry->value = msg->value();
+      entry->StoreValue(msg->value());
       entry->flags = msg->flags();
       // notify
       Notify(entry, NT_NOTIFY_NEW, false);
@@ -463,7 +480,7 @@ void Storage::ApplyInitialAssignments(
         update_msgs.emplace_back(Message::EntryUpdate(
             entry->id, entry->seq_num.value(), entry->value));
       } else {
-        entry->value = msg->value();
+        entry->StoreValue(msg->value());
         unsigned int notify_flags = NT_NOTIFY_UPDATE;
         // don't update flags from a <3.0 remote (not part of message)
         if (conn.proto_rev() >= 0x0300) {
@@ -518,11 +535,10 @@ std::shared_ptr<Value> Storage::GetEntryValue(std::string_view name) const {
 }
 
 std::shared_ptr<Value> Storage::GetEntryValue(unsigned int local_id) const {
-  std::scoped_lock lock(m_mutex);
   if (local_id >= m_localmap.size()) {
     return nullptr;
   }
-  return m_localmap[local_id]->value;
+  return m_localmap[local_id]->LoadValue();
 }
 
 bool Storage::SetDefaultEntryValue(std::string_view name,
@@ -610,7 +626,7 @@ void Storage::SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
     return;
   }
   auto old_value = entry->value;
-  entry->value = value;
+  entry->StoreValue(value);
 
   // if we're the server, assign an id if it doesn't have one
   if (m_server && entry->id == 0xffff) {
@@ -621,7 +637,7 @@ void Storage::SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
 
   // update persistent dirty flag if value changed and it's persistent
   if (entry->IsPersistent() && (!old_value || *old_value != *value)) {
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
   }
 
   // notify
@@ -647,8 +663,9 @@ void Storage::SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
     }
     auto msg = Message::EntryAssign(
         entry->name, entry->id, entry->seq_num.value(), value, entry->flags);
+    bool immediate = entry->IsImmediate();
     lock.unlock();
-    dispatcher->QueueOutgoing(msg, nullptr, nullptr);
+    QueueValueOutgoing(dispatcher, immediate, msg, nullptr);
   } else if (*old_value != *value) {
     if (local) {
       ++entry->seq_num;
@@ -656,8 +673,9 @@ void Storage::SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
     // don't send an update if we don't have an assigned id yet
     if (entry->id != 0xffff) {
       auto msg = Message::EntryUpdate(entry->id, entry->seq_num.value(), value);
+      bool immediate = entry->IsImmediate();
       lock.unlock();
-      dispatcher->QueueOutgoing(msg, nullptr, nullptr);
+      QueueValueOutgoing(dispatcher, immediate, msg, nullptr);
     }
   }
 }
@@ -722,7 +740,7 @@ void Storage::SetEntryFlagsImpl(Entry* entry, unsigned int flags,
 
   // update persistent dirty flag if persistent flag changed
   if ((entry->flags & NT_PERSISTENT) != (flags & NT_PERSISTENT)) {
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
   }
 
   entry->flags = flags;
@@ -788,8 +806,8 @@ void Storage::DeleteEntryImpl(Entry* entry, std::unique_lock<wpi::mutex>& lock,
   }
 
   // empty the value and reset id and local_write flag
-  std::shared_ptr<Value> old_value;
-  old_value.swap(entry->value);
+  std::shared_ptr<Value> old_value = entry->value;
+  entry->StoreValue(nullptr);
   entry->id = 0xffff;
   entry->local_write = false;
 
@@ -801,7 +819,7 @@ void Storage::DeleteEntryImpl(Entry* entry, std::unique_lock<wpi::mutex>& lock,
 
   // update persistent dirty flag if it's a persistent value
   if (entry->IsPersistent()) {
-    m_persistent_dirty = true;
+    MarkPersistentDirty(entry);
   }
 
   // reset flags
@@ -986,7 +1004,7 @@ void Storage::DeleteAllEntriesImpl(bool local, F should_delete) {
       }
       entry->id = 0xffff;
       entry->local_write = false;
-      entry->value.reset();
+      entry->StoreValue(nullptr);
       continue;
     }
   }
@@ -1018,9 +1036,10 @@ void Storage::DeleteAllEntries() {
 Storage::Entry* Storage::GetOrNew(std::string_view name) {
   auto& entry = m_entries[name];
   if (!entry) {
-    m_localmap.emplace_back(new Entry(name));
-    entry = m_localmap.back().get();
-    entry->local_id = m_localmap.size() - 1;
+    entry = new Entry(name);
+    entry->local_id = m_localmap.size();
+    m_localmap.emplace_back(entry);
+    m_entry_trie.Insert(name, entry);
   }
   return entry;
 }
@@ -1037,17 +1056,16 @@ std::vector<unsigned int> Storage::GetEntries(std::string_view prefix,
                                               unsigned int types) {
   std::scoped_lock lock(m_mutex);
   std::vector<unsigned int> ids;
-  for (auto& i : m_entries) {
-    Entry* entry = i.getValue();
+  m_entry_trie.ForEachWithPrefix(prefix, [&](Entry* entry) {
     auto value = entry->value.get();
-    if (!value || !wpi::starts_with(i.getKey(), prefix)) {
-      continue;
+    if (!value) {
+      return;
     }
     if (types != 0 && (types & value->type()) == 0) {
-      continue;
+      return;
     }
     ids.push_back(entry->local_id);
-  }
+  });
   return ids;
 }
 
@@ -1084,50 +1102,47 @@ std::string Storage::GetEntryName(unsigned int local_id) const {
 }
 
 NT_Type Storage::GetEntryType(unsigned int local_id) const {
-  std::unique_lock lock(m_mutex);
   if (local_id >= m_localmap.size()) {
     return NT_UNASSIGNED;
   }
-  Entry* entry = m_localmap[local_id].get();
-  if (!entry->value) {
+  auto value = m_localmap[local_id]->LoadValue();
+  if (!value) {
     return NT_UNASSIGNED;
   }
-  return entry->value->type();
+  return value->type();
 }
 
 uint64_t Storage::GetEntryLastChange(unsigned int local_id) const {
-  std::unique_lock lock(m_mutex);
   if (local_id >= m_localmap.size()) {
     return 0;
   }
-  Entry* entry = m_localmap[local_id].get();
-  if (!entry->value) {
+  auto value = m_localmap[local_id]->LoadValue();
+  if (!value) {
     return 0;
   }
-  return entry->value->last_change();
+  return value->last_change();
 }
 
 std::vector<EntryInfo> Storage::GetEntryInfo(int inst, std::string_view prefix,
                                              unsigned int types) {
   std::scoped_lock lock(m_mutex);
   std::vector<EntryInfo> infos;
-  for (auto& i : m_entries) {
-    Entry* entry = i.getValue();
+  m_entry_trie.ForEachWithPrefix(prefix, [&](Entry* entry) {
     auto value = entry->value.get();
-    if (!value || !wpi::starts_with(i.getKey(), prefix)) {
-      continue;
+    if (!value) {
+      return;
     }
     if (types != 0 && (types & value->type()) == 0) {
-      continue;
+      return;
     }
     EntryInfo info;
     info.entry = Handle(inst, entry->local_id, Handle::kEntry);
-    info.name = i.getKey();
+    info.name = entry->name;
     info.type = value->type();
     info.flags = entry->flags;
     info.last_change = value->last_change();
     infos.push_back(std::move(info));
-  }
+  });
   return infos;
 }
 
@@ -1139,14 +1154,13 @@ unsigned int Storage::AddListener(
   unsigned int uid = m_notifier.Add(callback, prefix, flags);
   // perform immediate notifications
   if ((flags & NT_NOTIFY_IMMEDIATE) != 0 && (flags & NT_NOTIFY_NEW) != 0) {
-    for (auto& i : m_entries) {
-      Entry* entry = i.getValue();
-      if (!entry->value || !wpi::starts_with(i.getKey(), prefix)) {
-        continue;
+    m_entry_trie.ForEachWithPrefix(prefix, [&](Entry* entry) {
+      if (!entry->value) {
+        return;
       }
-      m_notifier.NotifyEntry(entry->local_id, i.getKey(), entry->value,
+      m_notifier.NotifyEntry(entry->local_id, entry->name, entry->value,
                              NT_NOTIFY_IMMEDIATE | NT_NOTIFY_NEW, uid);
-    }
+    });
   }
   return uid;
 }
@@ -1176,17 +1190,13 @@ unsigned int Storage::AddPolledListener(unsigned int poller,
   unsigned int uid = m_notifier.AddPolled(poller, prefix, flags);
   // perform immediate notifications
   if ((flags & NT_NOTIFY_IMMEDIATE) != 0 && (flags & NT_NOTIFY_NEW) != 0) {
-    for (auto& i : m_entries) {
-      if (!wpi::starts_with(i.getKey(), prefix)) {
-        continue;
-      }
-      Entry* entry = i.getValue();
+    m_entry_trie.ForEachWithPrefix(prefix, [&](Entry* entry) {
       if (!entry->value) {
-        continue;
+        return;
       }
-      m_notifier.NotifyEntry(entry->local_id, i.getKey(), entry->value,
+      m_notifier.NotifyEntry(entry->local_id, entry->name, entry->value,
                              NT_NOTIFY_IMMEDIATE | NT_NOTIFY_NEW, uid);
-    }
+    });
   }
   return uid;
 }
@@ -1220,23 +1230,22 @@ unsigned int Storage::StartDataLog(wpi::log::DataLog& log,
 
   // start logging any matching entries
   auto now = nt::Now();
-  for (auto&& entry : m_entries) {
-    if (!entry.second || !wpi::starts_with(entry.second->name, prefix) ||
-        !entry.second->value) {
-      continue;
+  m_entry_trie.ForEachWithPrefix(prefix, [&](Entry* entry) {
+    if (!entry->value) {
+      return;
     }
-    auto type = GetStorageTypeStr(entry.second->value->type());
+    auto type = GetStorageTypeStr(entry->value->type());
     if (type.empty()) {
-      continue;  // not a type we're going to log
+      return;  // not a type we're going to log
     }
-    int logentry = log.Start(
-        fmt::format("{}{}", log_prefix,
-                    wpi::drop_front(entry.second->name, prefix.size())),
-        type, "{\"source\":\"NT\"}", now);
-    entry.second->datalogs.emplace_back(&log, logentry, uid);
+    int logentry =
+        log.Start(fmt::format("{}{}", log_prefix,
+                              wpi::drop_front(entry->name, prefix.size())),
+                  type, "{\"source\":\"NT\"}", now);
+    entry->datalogs.emplace_back(&log, logentry, uid);
     // log current value
-    auto& v = *entry.second->value;
-    entry.second->datalog_type = v.type();
+    auto& v = *entry->value;
+    entry->datalog_type = v.type();
     auto time = v.time();
     switch (v.type()) {
       case NT_BOOLEAN:
@@ -1267,7 +1276,7 @@ unsigned int Storage::StartDataLog(wpi::log::DataLog& log,
       default:
         break;
     }
-  }
+  });
 
   return uid;
 }
@@ -1309,6 +1318,9 @@ bool Storage::GetPersistentEntries(
       return false;
     }
     m_persistent_dirty = false;
+    // this is a full save, so a binary journal can't continue from it
+    m_persistent_changed.clear();
+    m_journal_filename.clear();
     entries->reserve(m_entries.size());
     for (auto& i : m_entries) {
       Entry* entry = i.getValue();
@@ -1329,6 +1341,82 @@ bool Storage::GetPersistentEntries(
   return true;
 }
 
+bool Storage::GetPersistentChanges(
+    std::string_view filename, bool periodic, bool* full,
+    std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries)
+    const {
+  // copy values out of storage as quickly as possible so lock isn't held;
+  // when journaling this is just the changed entries
+  {
+    std::scoped_lock lock(m_mutex);
+    // for periodic, don't re-save unless something has changed
+    if (periodic && !m_persistent_dirty) {
+      return false;
+    }
+    m_persistent_dirty = false;
+
+    // Rewrite the whole file once the journal is larger than the last full
+    // save (with a minimum so small files aren't rewritten on every change)
+    *full = !periodic || filename != m_journal_filename ||
+            (m_journal_records + m_persistent_changed.size()) >
+                std::max(m_journal_base, kMinJournalRecords);
+    if (*full) {
+      entries->reserve(m_entries.size());
+      for (auto& i : m_entries) {
+        Entry* entry = i.getValue();
+        // only write persistent-flagged values
+        if (!entry->value || !entry->IsPersistent()) {
+          continue;
+        }
+        entries->emplace_back(i.getKey(), entry->value);
+      }
+      m_journal_filename = filename;
+      m_journal_base = entries->size();
+      m_journal_records = 0;
+    } else {
+      entries->reserve(m_persistent_changed.size());
+      for (auto& i : m_persistent_changed) {
+        auto it = m_entries.find(i.getKey());
+        std::shared_ptr<Value> value;
+        if (it != m_entries.end() && it->getValue()->IsPersistent()) {
+          value = it->getValue()->value;
+        }
+        // null values are written as deletes
+        entries->emplace_back(i.getKey(), std::move(value));
+      }
+      m_journal_records += entries->size();
+    }
+    m_persistent_changed.clear();
+  }
+
+  // sort in name order
+  std::sort(entries->begin(), entries->end(),
+            [](const std::pair<std::string, std::shared_ptr<Value>>& a,
+               const std::pair<std::string, std::shared_ptr<Value>>& b) {
+              return a.first < b.first;
+            });
+  return true;
+}
+
+void Storage::MarkPersistentDirty(const Entry* entry) {
+  m_persistent_dirty = true;
+  if (m_persistent_binary) {
+    m_persistent_changed.try_emplace(entry->name, true);
+  }
+}
+
+void Storage::SetPersistentBinary(bool binary) {
+  std::scoped_lock lock(m_mutex);
+  if (m_persistent_binary == binary) {
+    return;
+  }
+  m_persistent_binary = binary;
+  // next save needs to rewrite the file in the new format
+  m_persistent_dirty = true;
+  m_persistent_changed.clear();
+  m_journal_filename.clear();
+}
+
 bool Storage::GetEntries(
     std::string_view prefix,
     std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries)
@@ -1336,15 +1424,11 @@ bool Storage::GetEntries(
   // copy values out of storage as quickly as possible so lock isn't held
   {
     std::scoped_lock lock(m_mutex);
-    entries->reserve(m_entries.size());
-    for (auto& i : m_entries) {
-      Entry* entry = i.getValue();
-      // only write values with given prefix
-      if (!entry->value || !wpi::starts_with(i.getKey(), prefix)) {
-        continue;
+    m_entry_trie.ForEachWithPrefix(prefix, [&](Entry* entry) {
+      if (entry->value) {
+        entries->emplace_back(entry->name, entry->value);
       }
-      entries->emplace_back(i.getKey(), entry->value);
-    }
+    });
   }
 
   // sort in name order
@@ -1366,7 +1450,7 @@ void Storage::CreateRpc(unsigned int local_id, std::string_view def,
 
   auto old_value = entry->value;
   auto value = Value::MakeRpc(def);
-  entry->value = value;
+  entry->StoreValue(value);
 
   // set up the RPC info
   entry->rpc_uid = rpc_uid;
@@ -27,7 +27,9 @@
 
 #include "IStorage.h"
 #include "Message.h"
+#include "PrefixTrie.h"
 #include "SequenceNumber.h"
+#include "StableVector.h"
 #include "ntcore_cpp.h"
 
 namespace wpi {
@@ -77,6 +79,7 @@ class Storage : public IStorage {
   // User functions.  These are the actual implementations of the corresponding
   // user API functions in ntcore_cpp.
   std::shared_ptr<Value> GetEntryValue(std::string_view name) const;
+  // Does not take m_mutex; see Entry::LoadValue().
   std::shared_ptr<Value> GetEntryValue(unsigned int local_id) const;
 
   bool SetDefaultEntryValue(std::string_view name,
@@ -129,6 +132,7 @@ class Storage : public IStorage {
                                        unsigned int types);
   EntryInfo GetEntryInfo(int inst, unsigned int local_id) const;
   std::string GetEntryName(unsigned int local_id) const;
+  // These do not take m_mutex; see Entry::LoadValue().
   NT_Type GetEntryType(unsigned int local_id) const;
   uint64_t GetEntryLastChange(unsigned int local_id) const;
 
@@ -146,6 +150,14 @@ class Storage : public IStorage {
       std::string_view filename, std::string_view prefix,
       std::function<void(size_t line, const char* msg)> warn);
 
+  // Selects the binary format for persistent saves.  Loads detect the format
+  // from the file contents.
+  void SetPersistentBinary(bool binary);
+
+  // Leading string of binary format files
+  static constexpr std::string_view kBinaryHeader =
+      "NetworkTables Storage Binary 1";
+
   // Stream-based save/load functions (exposed for testing purposes).  These
   // implement the guts of the filename-based functions.
   void SavePersistent(wpi::raw_ostream& os, bool periodic) const;
@@ -155,6 +167,13 @@ class Storage : public IStorage {
 
   void SaveEntries(wpi::raw_ostream& os, std::string_view prefix) const;
 
+  // Binary format equivalents.  As a journal may have been appended to a
+  // binary file, loading takes the complete file contents.
+  void SavePersistentBinary(wpi::raw_ostream& os, bool periodic) const;
+  bool LoadEntriesBinary(
+      std::string_view data, std::string_view prefix, bool persistent,
+      std::function<void(size_t line, const char* msg)> warn);
+
   // RPC configuration needs to come through here as RPC definitions are
   // actually special Storage value types.
   void CreateRpc(unsigned int local_id, std::string_view def,
@@ -194,12 +213,24 @@ class Storage : public IStorage {
   struct Entry {
     explicit Entry(std::string_view name_) : name(name_) {}
     bool IsPersistent() const { return (flags & NT_PERSISTENT) != 0; }
+    bool IsImmediate() const { return (flags & NT_IMMEDIATE) != 0; }
+
+    // Values are immutable, so readers only need a consistent snapshot of
+    // the pointer.  All writes must go through StoreValue() (with m_mutex
+    // held); code holding m_mutex may read value directly, while lock-free
+    // readers must use LoadValue().
+    std::shared_ptr<Value> LoadValue() const {
+      return std::atomic_load(&value);
+    }
+    void StoreValue(std::shared_ptr<Value> v) {
+      std::atomic_store(&value, std::move(v));
+    }
 
     // We redundantly store the name so that it's available when accessing the
     // raw Entry* via the ID map.
     std::string name;
 
-    // The current value and flags.
+    // The current value and flags.  See LoadValue() and StoreValue().
     std::shared_ptr<Value> value;
     unsigned int flags{0};
 
@@ -232,13 +263,17 @@ class Storage : public IStorage {
 
   using EntriesMap = wpi::StringMap<Entry*>;
   using IdMap = std::vector<Entry*>;
-  using LocalMap = std::vector<std::unique_ptr<Entry>>;
+  // Entries are never destroyed once created, so local ids can be resolved
+  // without holding m_mutex.
+  using LocalMap = StableVector<Entry>;
   using RpcIdPair = std::pair<unsigned int, unsigned int>;
   using RpcResultMap = wpi::DenseMap<RpcIdPair, std::string>;
   using RpcBlockingCallSet = wpi::SmallSet<RpcIdPair, 12>;
 
   mutable wpi::mutex m_mutex;
   EntriesMap m_entries;
+  // Index of m_entries by name for prefix queries
+  PrefixTrie<Entry*> m_entry_trie;
   IdMap m_idmap;
   LocalMap m_localmap;
   RpcResultMap m_rpc_results;
@@ -247,6 +282,18 @@ class Storage : public IStorage {
   // If any persistent values have changed
   mutable bool m_persistent_dirty = false;
 
+  // Binary persistent format state.  Periodic binary saves append just the
+  // changed entries to the last file written (the journal) until the journal
+  // grows larger than the full snapshot it follows.
+  std::atomic_bool m_persistent_binary{false};
+  // Names of persistent entries changed since the last binary save
+  mutable wpi::StringMap<bool> m_persistent_changed;
+  // File the journal is being appended to; empty forces a full save
+  mutable std::string m_journal_filename;
+  // Number of records in the last full save and in the journal since
+  mutable size_t m_journal_base = 0;
+  mutable size_t m_journal_records = 0;
+
   // condition variable and termination flag for blocking on a RPC result
   std::atomic_bool m_terminating;
   wpi::condition_variable m_rpc_results_cond;
@@ -282,6 +329,23 @@ class Storage : public IStorage {
   bool GetEntries(std::string_view prefix,
                   std::vector<std::pair<std::string, std::shared_ptr<Value>>>*
                       entries) const;
+  // Gets either all persistent entries (sets *full) or only those changed
+  // since the last binary save to filename.  Deleted or no longer persistent
+  // entries are returned with a null value.
+  bool GetPersistentChanges(
+      std::string_view filename, bool periodic, bool* full,
+      std::vector<std::pair<std::string, std::shared_ptr<Value>>>* entries)
+      const;
+  const char* SavePersistentBinary(std::string_view filename,
+                                   bool periodic) const;
+  const char* LoadEntries(
+      std::string_view filename, std::string_view prefix,
+      std::function<void(size_t line, const char* msg)> warn, bool persistent);
+  void ApplyLoadedEntries(
+      wpi::span<const std::pair<std::string, std::shared_ptr<Value>>> entries,
+      bool persistent);
+  // Must be called with m_mutex held
+  void MarkPersistentDirty(const Entry* entry);
   void SetEntryValueImpl(Entry* entry, std::shared_ptr<Value> value,
                          std::unique_lock<wpi::mutex>& lock, bool local);
   void SetEntryFlagsImpl(Entry* entry, unsigned int flags,
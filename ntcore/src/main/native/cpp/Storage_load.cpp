@@ -2,6 +2,7 @@
 // Open Source Software; you can modify and/or share it under the terms of
 // the WPILib BSD license file in the root directory of this project.
 
+#include <algorithm>
 #include <cctype>
 #include <string>
 #include <utility>
@@ -9,6 +10,8 @@
 #include <wpi/Base64.h>
 #include <wpi/SmallString.h>
 #include <wpi/StringExtras.h>
+#include <wpi/StringMap.h>
+#include <wpi/mpack.h>
 #include <wpi/raw_istream.h>
 
 #include "IDispatcher.h"
@@ -61,6 +64,36 @@ class LoadPersistentImpl {
   std::vector<std::string> m_buf_string_array;
 };
 
+// See SaveBinaryImpl for the format.  Warnings are reported with the record
+// number in place of the line number.
+class LoadBinaryImpl {
+ public:
+  using Entry = std::pair<std::string, std::shared_ptr<Value>>;
+  using WarnFunc = std::function<void(size_t, const char*)>;
+
+  LoadBinaryImpl(std::string_view data, WarnFunc warn)
+      : m_warn(std::move(warn)) {
+    mpack::mpack_reader_init_data(&m_reader, data.data(), data.size());
+  }
+  ~LoadBinaryImpl() { mpack::mpack_reader_destroy(&m_reader); }
+
+  bool Load(std::string_view prefix, std::vector<Entry>* entries);
+
+ private:
+  std::string_view ReadString();
+  std::shared_ptr<Value> ReadValue(NT_Type type);
+
+  void Warn(const char* msg) {
+    if (m_warn) {
+      m_warn(m_record_num, msg);
+    }
+  }
+
+  mpack::mpack_reader_t m_reader;
+  WarnFunc m_warn;
+  size_t m_record_num = 0;
+};
+
 }  // namespace
 
 /* Extracts an escaped string token.  Does not unescape the string.
@@ -375,6 +408,129 @@ std::shared_ptr<Value> LoadPersistentImpl::ReadStringArrayValue() {
   return Value::MakeStringArray(std::move(m_buf_string_array));
 }
 
+std::string_view LoadBinaryImpl::ReadString() {
+  uint32_t len = mpack::mpack_expect_str(&m_reader);
+  const char* data = mpack::mpack_read_bytes_inplace(&m_reader, len);
+  mpack::mpack_done_str(&m_reader);
+  if (mpack::mpack_reader_error(&m_reader) != mpack::mpack_ok) {
+    return {};
+  }
+  return {data, len};
+}
+
+std::shared_ptr<Value> LoadBinaryImpl::ReadValue(NT_Type type) {
+  switch (type) {
+    case NT_UNASSIGNED:
+      mpack::mpack_expect_nil(&m_reader);
+      return nullptr;
+    case NT_BOOLEAN:
+      return Value::MakeBoolean(mpack::mpack_expect_bool(&m_reader));
+    case NT_DOUBLE:
+      return Value::MakeDouble(mpack::mpack_expect_double(&m_reader));
+    case NT_STRING:
+      return Value::MakeString(ReadString());
+    case NT_RAW: {
+      uint32_t len = mpack::mpack_expect_bin(&m_reader);
+      const char* data = mpack::mpack_read_bytes_inplace(&m_reader, len);
+      mpack::mpack_done_bin(&m_reader);
+      if (mpack::mpack_reader_error(&m_reader) != mpack::mpack_ok) {
+        return nullptr;
+      }
+      return Value::MakeRaw(std::string_view{data, len});
+    }
+    default:
+      break;
+  }
+
+  // Arrays.  Every element takes at least one byte, so this bounds the
+  // allocation for a corrupted count.
+  uint32_t size = mpack::mpack_expect_array(&m_reader);
+  size_t reserve =
+      (std::min)(static_cast<size_t>(size),
+                 mpack::mpack_reader_remaining(&m_reader, nullptr));
+  std::shared_ptr<Value> value;
+  switch (type) {
+    case NT_BOOLEAN_ARRAY: {
+      std::vector<int> arr;
+      arr.reserve(reserve);
+      for (uint32_t i = 0;
+           i < size && mpack::mpack_reader_error(&m_reader) == mpack::mpack_ok;
+           ++i) {
+        arr.push_back(mpack::mpack_expect_bool(&m_reader));
+      }
+      value = Value::MakeBooleanArray(arr);
+      break;
+    }
+    case NT_DOUBLE_ARRAY: {
+      std::vector<double> arr;
+      arr.reserve(reserve);
+      for (uint32_t i = 0;
+           i < size && mpack::mpack_reader_error(&m_reader) == mpack::mpack_ok;
+           ++i) {
+        arr.push_back(mpack::mpack_expect_double(&m_reader));
+      }
+      value = Value::MakeDoubleArray(arr);
+      break;
+    }
+    case NT_STRING_ARRAY: {
+      std::vector<std::string> arr;
+      arr.reserve(reserve);
+      for (uint32_t i = 0;
+           i < size && mpack::mpack_reader_error(&m_reader) == mpack::mpack_ok;
+           ++i) {
+        arr.emplace_back(ReadString());
+      }
+      value = Value::MakeStringArray(std::move(arr));
+      break;
+    }
+    default:
+      mpack::mpack_reader_flag_error(&m_reader, mpack::mpack_error_data);
+      return nullptr;
+  }
+  mpack::mpack_done_array(&m_reader);
+  return value;
+}
+
+bool LoadBinaryImpl::Load(std::string_view prefix,
+                          std::vector<Entry>* entries) {
+  if (ReadString() != Storage::kBinaryHeader) {
+    Warn("header mismatch, ignoring rest of file");
+    return false;
+  }
+
+  // later records replace earlier ones
+  wpi::StringMap<std::shared_ptr<Value>> values;
+  while (mpack::mpack_reader_remaining(&m_reader, nullptr) > 0) {
+    ++m_record_num;
+    mpack::mpack_expect_array_match(&m_reader, 3);
+    auto name = ReadString();
+    auto type = static_cast<NT_Type>(mpack::mpack_expect_u32(&m_reader));
+    auto value = ReadValue(type);
+    mpack::mpack_done_array(&m_reader);
+    if (mpack::mpack_reader_error(&m_reader) != mpack::mpack_ok) {
+      // this is expected if a save was interrupted while appending
+      Warn("incomplete or invalid record, ignoring rest of file");
+      break;
+    }
+    if (!wpi::starts_with(name, prefix)) {
+      continue;
+    }
+    if (value) {
+      values[name] = std::move(value);
+    } else {
+      values.erase(name);
+    }
+  }
+
+  entries->reserve(values.size());
+  for (auto& i : values) {
+    entries->emplace_back(i.getKey(), std::move(i.getValue()));
+  }
+  std::sort(entries->begin(), entries->end(),
+            [](const Entry& a, const Entry& b) { return a.first < b.first; });
+  return true;
+}
+
 bool Storage::LoadEntries(
     wpi::raw_istream& is, std::string_view prefix, bool persistent,
     std::function<void(size_t line, const char* msg)> warn) {
@@ -386,13 +542,35 @@ bool Storage::LoadEntries(
     return false;
   }
 
+  ApplyLoadedEntries(entries, persistent);
+  return true;
+}
+
+bool Storage::LoadEntriesBinary(
+    std::string_view data, std::string_view prefix, bool persistent,
+    std::function<void(size_t line, const char* msg)> warn) {
+  // entries to add
+  std::vector<LoadBinaryImpl::Entry> entries;
+
+  // load file
+  if (!LoadBinaryImpl(data, warn).Load(prefix, &entries)) {
+    return false;
+  }
+
+  ApplyLoadedEntries(entries, persistent);
+  return true;
+}
+
+void Storage::ApplyLoadedEntries(
+    wpi::span<const std::pair<std::string, std::shared_ptr<Value>>> entries,
+    bool persistent) {
   // copy values into storage as quickly as possible so lock isn't held
   std::vector<std::shared_ptr<Message>> msgs;
   std::unique_lock lock(m_mutex);
   for (auto& i : entries) {
     Entry* entry = GetOrNew(i.first);
     auto old_value = entry->value;
-    entry->value = i.second;
+    entry->StoreValue(i.second);
     bool was_persist = entry->IsPersistent();
     if (!was_persist && persistent) {
       entry->flags |= NT_PERSISTENT;
@@ -451,33 +629,44 @@ bool Storage::LoadEntries(
       dispatcher->QueueOutgoing(std::move(msg), nullptr, nullptr);
     }
   }
-
-  return true;
 }
 
 const char* Storage::LoadPersistent(
     std::string_view filename,
     std::function<void(size_t line, const char* msg)> warn) {
-  std::error_code ec;
-  wpi::raw_fd_istream is(filename, ec);
-  if (ec.value() != 0) {
-    return "could not open file";
-  }
-  if (!LoadEntries(is, "", true, warn)) {
-    return "error reading file";
-  }
-  return nullptr;
+  return LoadEntries(filename, "", warn, true);
 }
 
 const char* Storage::LoadEntries(
     std::string_view filename, std::string_view prefix,
     std::function<void(size_t line, const char* msg)> warn) {
+  return LoadEntries(filename, prefix, warn, false);
+}
+
+const char* Storage::LoadEntries(
+    std::string_view filename, std::string_view prefix,
+    std::function<void(size_t line, const char* msg)> warn, bool persistent) {
   std::error_code ec;
   wpi::raw_fd_istream is(filename, ec);
   if (ec.value() != 0) {
     return "could not open file";
   }
-  if (!LoadEntries(is, prefix, false, warn)) {
+
+  // read the whole file to detect the format
+  std::string contents;
+  while (!is.has_error()) {
+    is.readinto(contents, 65536);
+  }
+
+  // binary files start with the header as a MessagePack string
+  bool ok;
+  if (wpi::starts_with(wpi::substr(contents, 1), kBinaryHeader)) {
+    ok = LoadEntriesBinary(contents, prefix, persistent, warn);
+  } else {
+    wpi::raw_mem_istream mem(contents.data(), contents.size());
+    ok = LoadEntries(mem, prefix, persistent, warn);
+  }
+  if (!ok) {
     return "error reading file";
   }
   return nullptr;
@@ -3,6 +3,7 @@
 // the WPILib BSD license file in the root directory of this project.
 
 #include <cctype>
+#include <limits>
 #include <string>
 
 #include <fmt/format.h>
@@ -10,6 +11,7 @@
 #include <wpi/SmallString.h>
 #include <wpi/StringExtras.h>
 #include <wpi/fs.h>
+#include <wpi/mpack.h>
 #include <wpi/raw_ostream.h>
 
 #include "Log.h"
@@ -38,6 +40,53 @@ class SavePersistentImpl {
   wpi::raw_ostream& m_os;
 };
 
+// Binary (MessagePack) persistent format.  The file starts with a header
+// string, followed by a sequence of [name, type, value] records.  Later
+// records for the same name replace earlier ones, so changes can be appended
+// to an existing file; a record with type NT_UNASSIGNED and a nil value
+// deletes the entry.
+class SaveBinaryImpl {
+ public:
+  using Entry = std::pair<std::string, std::shared_ptr<Value>>;
+
+  explicit SaveBinaryImpl(wpi::raw_ostream& os) : m_os(os) {
+    mpack::mpack_writer_init(&m_writer, m_buf, sizeof(m_buf));
+    mpack::mpack_writer_set_context(&m_writer, &m_os);
+    mpack::mpack_writer_set_flush(
+        &m_writer,
+        [](mpack::mpack_writer_t* writer, const char* buffer, size_t count) {
+          static_cast<wpi::raw_ostream*>(writer->context)->write(buffer, count);
+        });
+  }
+  ~SaveBinaryImpl() { mpack::mpack_writer_destroy(&m_writer); }
+
+  // Writes header and entries
+  bool Save(wpi::span<const Entry> entries);
+  // Writes entries only (for appending to an existing file)
+  bool Append(wpi::span<const Entry> entries);
+
+ private:
+  void WriteString(std::string_view str) {
+    mpack::mpack_write_str(&m_writer, str.data(), str.size());
+  }
+  void WriteDouble(double value) {
+    // use the shorter encoding when it's exact; any number reads as a double
+    constexpr double kMax = std::numeric_limits<float>::max();
+    if (value >= -kMax && value <= kMax &&
+        static_cast<float>(value) == value) {
+      mpack::mpack_write_float(&m_writer, static_cast<float>(value));
+    } else {
+      mpack::mpack_write_double(&m_writer, value);
+    }
+  }
+  void WriteEntry(std::string_view name, const Value* value);
+  void WriteValue(const Value& value);
+
+  wpi::raw_ostream& m_os;
+  mpack::mpack_writer_t m_writer;
+  char m_buf[4096];
+};
+
 }  // namespace
 
 /* Escapes and writes a string, including start and end double quotes */
@@ -182,6 +231,93 @@ void SavePersistentImpl::WriteValue(const Value& value) {
   }
 }
 
+bool SaveBinaryImpl::Save(wpi::span<const Entry> entries) {
+  WriteString(Storage::kBinaryHeader);
+  return Append(entries);
+}
+
+bool SaveBinaryImpl::Append(wpi::span<const Entry> entries) {
+  for (auto& i : entries) {
+    WriteEntry(i.first, i.second.get());
+  }
+  mpack::mpack_writer_flush_message(&m_writer);
+  return mpack::mpack_writer_error(&m_writer) == mpack::mpack_ok;
+}
+
+void SaveBinaryImpl::WriteEntry(std::string_view name, const Value* value) {
+  switch (value ? value->type() : NT_UNASSIGNED) {
+    case NT_UNASSIGNED:
+    case NT_BOOLEAN:
+    case NT_DOUBLE:
+    case NT_STRING:
+    case NT_RAW:
+    case NT_BOOLEAN_ARRAY:
+    case NT_DOUBLE_ARRAY:
+    case NT_STRING_ARRAY:
+      break;
+    default:
+      return;  // not persistable (e.g. RPC)
+  }
+  mpack::mpack_start_array(&m_writer, 3);
+  WriteString(name);
+  if (value) {
+    mpack::mpack_write_u32(&m_writer, value->type());
+    WriteValue(*value);
+  } else {
+    mpack::mpack_write_u32(&m_writer, NT_UNASSIGNED);
+    mpack::mpack_write_nil(&m_writer);
+  }
+  mpack::mpack_finish_array(&m_writer);
+}
+
+void SaveBinaryImpl::WriteValue(const Value& value) {
+  switch (value.type()) {
+    case NT_BOOLEAN:
+      mpack::mpack_write_bool(&m_writer, value.GetBoolean());
+      break;
+    case NT_DOUBLE:
+      WriteDouble(value.GetDouble());
+      break;
+    case NT_STRING:
+      WriteString(value.GetString());
+      break;
+    case NT_RAW: {
+      auto raw = value.GetRaw();
+      mpack::mpack_write_bin(&m_writer, raw.data(), raw.size());
+      break;
+    }
+    case NT_BOOLEAN_ARRAY: {
+      auto arr = value.GetBooleanArray();
+      mpack::mpack_start_array(&m_writer, arr.size());
+      for (auto elem : arr) {
+        mpack::mpack_write_bool(&m_writer, elem);
+      }
+      mpack::mpack_finish_array(&m_writer);
+      break;
+    }
+    case NT_DOUBLE_ARRAY: {
+      auto arr = value.GetDoubleArray();
+      mpack::mpack_start_array(&m_writer, arr.size());
+      for (auto elem : arr) {
+        WriteDouble(elem);
+      }
+      mpack::mpack_finish_array(&m_writer);
+      break;
+    }
+    case NT_STRING_ARRAY: {
+      auto arr = value.GetStringArray();
+      mpack::mpack_start_array(&m_writer, arr.size());
+      for (auto& elem : arr) {
+        WriteString(elem);
+      }
+      mpack::mpack_finish_array(&m_writer);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
 void Storage::SavePersistent(wpi::raw_ostream& os, bool periodic) const {
   std::vector<SavePersistentImpl::Entry> entries;
   if (!GetPersistentEntries(periodic, &entries)) {
@@ -192,6 +328,10 @@ void Storage::SavePersistent(wpi::raw_ostream& os, bool periodic) const {
 
 const char* Storage::SavePersistent(std::string_view filename,
                                     bool periodic) const {
+  if (m_persistent_binary) {
+    return SavePersistentBinary(filename, periodic);
+  }
+
   std::string fn{filename};
   auto tmp = fmt::format("{}.tmp", filename);
   auto bak = fmt::format("{}.bak", filename);
@@ -237,6 +377,91 @@ done:
   return err;
 }
 
+void Storage::SavePersistentBinary(wpi::raw_ostream& os,
+                                   bool periodic) const {
+  std::vector<SaveBinaryImpl::Entry> entries;
+  if (!GetPersistentEntries(periodic, &entries)) {
+    return;
+  }
+  SaveBinaryImpl(os).Save(entries);
+}
+
+const char* Storage::SavePersistentBinary(std::string_view filename,
+                                          bool periodic) const {
+  std::string fn{filename};
+  auto tmp = fmt::format("{}.tmp", filename);
+  auto bak = fmt::format("{}.bak", filename);
+
+  // Get entries (or just the changed ones) before opening file
+  bool full;
+  std::vector<SaveBinaryImpl::Entry> entries;
+  if (!GetPersistentChanges(filename, periodic, &full, &entries)) {
+    return nullptr;
+  }
+
+  const char* err = nullptr;
+  std::error_code ec;
+
+  if (!full) {
+    // append changes to the existing file
+    if (entries.empty()) {
+      return nullptr;
+    }
+    wpi::raw_fd_ostream os(fn, ec, fs::CD_OpenExisting, fs::FA_Write,
+                           fs::OF_Append);
+    if (ec.value() != 0) {
+      err = "could not open file";
+      goto done;
+    }
+    DEBUG0("appending {} changes to persistent file '{}'", entries.size(),
+           filename);
+    bool ok = SaveBinaryImpl(os).Append(entries);
+    os.close();
+    if (!ok || os.has_error()) {
+      err = "error saving file";
+    }
+    goto done;
+  }
+
+  {
+    // start by writing to temporary file
+    wpi::raw_fd_ostream os(tmp, ec, fs::OF_None);
+    if (ec.value() != 0) {
+      err = "could not open file";
+      goto done;
+    }
+    DEBUG0("saving persistent file '{}'", filename);
+    bool ok = SaveBinaryImpl(os).Save(entries);
+    os.close();
+    if (!ok || os.has_error()) {
+      std::remove(tmp.c_str());
+      err = "error saving file";
+      goto done;
+    }
+  }
+
+  // Safely move to real file.  We ignore any failures related to the backup.
+  std::remove(bak.c_str());
+  std::rename(fn.c_str(), bak.c_str());
+  if (std::rename(tmp.c_str(), fn.c_str()) != 0) {
+    std::rename(bak.c_str(), fn.c_str());  // attempt to restore backup
+    err = "could not rename temp file to real file";
+    goto done;
+  }
+
+done:
+  if (err) {
+    // the file may be incomplete; rewrite all of it next time
+    std::scoped_lock lock(m_mutex);
+    m_journal_filename.clear();
+    // try again if there was an error
+    if (periodic) {
+      m_persistent_dirty = true;
+    }
+  }
+  return err;
+}
+
 void Storage::SaveEntries(wpi::raw_ostream& os, std::string_view prefix) const {
   std::vector<SavePersistentImpl::Entry> entries;
   if (!GetEntries(prefix, &entries)) {
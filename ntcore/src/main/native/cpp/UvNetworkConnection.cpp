@@ -0,0 +1,312 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "UvNetworkConnection.h"
+
+#include <cstring>
+#include <utility>
+
+#include <wpi/SmallVector.h>
+#include <wpi/raw_istream.h>
+#include <wpinet/EventLoopRunner.h>
+#include <wpinet/uv/Tcp.h>
+#include <wpinet/uv/util.h>
+
+#include "IConnectionNotifier.h"
+#include "Log.h"
+#include "WireDecoder.h"
+
+using namespace nt;
+
+namespace {
+
+// Reads from the buffered data.  When a read is cut off by the end of the
+// data, records how many more bytes it needed.
+class BufferStream final : public wpi::raw_istream {
+ public:
+  BufferStream(const char* mem, size_t len) : m_cur{mem}, m_left{len} {}
+
+  void close() override {}
+  size_t in_avail() const override { return m_left; }
+
+  size_t short_by() const { return m_short_by; }
+
+ private:
+  void read_impl(void* data, size_t len) override {
+    if (len > m_left) {
+      error_detected();
+      m_short_by = len - m_left;
+      len = m_left;
+    }
+    std::memcpy(data, m_cur, len);
+    m_cur += len;
+    m_left -= len;
+    set_read_count(len);
+  }
+
+  const char* m_cur;
+  size_t m_left;
+  size_t m_short_by = 0;
+};
+
+}  // namespace
+
+UvNetworkConnection::UvNetworkConnection(
+    unsigned int uid, std::shared_ptr<wpi::uv::Tcp> stream,
+    wpi::EventLoopRunner& loop_runner, IConnectionNotifier& notifier,
+    wpi::Logger& logger, HandshakeHelloFunc handshake_hello,
+    HandshakeDoneFunc handshake_done, Message::GetEntryTypeFunc get_entry_type)
+    : m_uid(uid),
+      m_stream(stream),
+      m_loop_runner(loop_runner),
+      m_notifier(notifier),
+      m_logger(logger),
+      m_handshake_hello(std::move(handshake_hello)),
+      m_handshake_done(std::move(handshake_done)),
+      m_get_entry_type(std::move(get_entry_type)) {}
+
+UvNetworkConnection::~UvNetworkConnection() {
+  set_state(kDead);
+}
+
+void UvNetworkConnection::Start() {
+  auto stream = m_stream.lock();
+  if (!stream) {
+    return;
+  }
+
+  // turn off Nagle algorithm; we bundle packets for transmission
+  stream->SetNoDelay(true);
+  wpi::uv::AddrToName(stream->GetPeer(), &m_remote_ip, &m_remote_port);
+
+  set_state(kHandshake);
+
+  // The stream's signals hold a reference to this connection, so it stays
+  // alive until the stream is closed.
+  auto self = shared_from_this();
+  stream->data.connect([self](wpi::uv::Buffer& buf, size_t len) {
+    self->ProcessData({buf.base, len});
+  });
+  stream->end.connect([self, s = stream.get()] {
+    self->set_state(kDead);
+    s->Close();
+  });
+  stream->error.connect([self, s = stream.get()](wpi::uv::Error) {
+    self->set_state(kDead);
+    s->Close();
+  });
+  stream->StartRead();
+}
+
+ConnectionInfo UvNetworkConnection::info() const {
+  return ConnectionInfo{remote_id(),  m_remote_ip,    m_remote_port,
+                        m_last_update, m_proto_rev,   m_outgoing_depth,
+                        m_bytes_sent};
+}
+
+UvNetworkConnection::State UvNetworkConnection::state() const {
+  std::scoped_lock lock(m_state_mutex);
+  return m_state;
+}
+
+void UvNetworkConnection::set_state(State state) {
+  std::scoped_lock lock(m_state_mutex);
+  // Don't update state any more once we've died
+  if (m_state == kDead) {
+    return;
+  }
+  // One-shot notify state changes
+  if (m_state != kActive && state == kActive) {
+    m_notifier.NotifyConnection(true, info());
+  }
+  if (m_state != kDead && state == kDead) {
+    m_notifier.NotifyConnection(false, info());
+  }
+  m_state = state;
+}
+
+std::string UvNetworkConnection::remote_id() const {
+  std::scoped_lock lock(m_remote_id_mutex);
+  return m_remote_id;
+}
+
+void UvNetworkConnection::set_remote_id(std::string_view remote_id) {
+  std::scoped_lock lock(m_remote_id_mutex);
+  m_remote_id = remote_id;
+}
+
+void UvNetworkConnection::ProcessData(std::string_view data) {
+  m_read_buf.append(data);
+  if (m_read_buf.size() < m_read_needed) {
+    return;
+  }
+
+  // Decode as many complete messages as are buffered.  A message that is
+  // cut off fails to read without setting a decoder error; it's decoded
+  // again from the start once at least as many bytes as the cut-off read
+  // needed have arrived, so a large value (whose length comes first) is
+  // only decoded again once all of it is buffered.
+  BufferStream is(m_read_buf.data(), m_read_buf.size());
+  WireDecoder decoder(is, m_proto_rev, m_logger);
+  size_t consumed = 0;
+  while (consumed < m_read_buf.size()) {
+    decoder.set_proto_rev(m_proto_rev);
+    decoder.Reset();
+    auto msg = Message::Read(decoder, m_get_entry_type);
+    if (!msg) {
+      if (decoder.error()) {
+        INFO("read error: {}", decoder.error());
+        // terminate connection on bad message
+        Close();
+        return;
+      }
+      m_read_needed = m_read_buf.size() - consumed + is.short_by();
+      break;
+    }
+    m_read_needed = 0;
+    consumed = m_read_buf.size() - is.in_avail();
+    ProcessMessage(std::move(msg));
+    if (state() == kDead) {
+      return;
+    }
+  }
+  m_read_buf.erase(0, consumed);
+}
+
+void UvNetworkConnection::ProcessMessage(std::shared_ptr<Message> msg) {
+  switch (m_handshake_step) {
+    case kWaitHello:
+      if (!m_handshake_hello(*this, msg,
+                             [this](auto msgs) { Write(msgs, false); })) {
+        Close();
+        return;
+      }
+      // In proto rev 3.0 and later, the handshake concludes with a client
+      // hello done message, so we can batch the assigns before marking the
+      // connection active.
+      if (m_proto_rev >= 0x0300) {
+        m_handshake_step = kWaitHelloDone;
+        return;
+      }
+      break;
+    case kWaitHelloDone:
+      if (msg->Is(Message::kClientHelloDone)) {
+        m_handshake_done(*this, m_handshake_incoming);
+        m_handshake_incoming.clear();
+        break;
+      }
+      // shouldn't receive a keep alive, but handle gracefully
+      if (msg->Is(Message::kKeepAlive)) {
+        return;
+      }
+      if (!msg->Is(Message::kEntryAssign)) {
+        // unexpected message
+        DEBUG0(
+            "server: received message ({}) other than entry assignment during "
+            "initial handshake",
+            static_cast<int>(msg->type()));
+        Close();
+        return;
+      }
+      m_handshake_incoming.emplace_back(std::move(msg));
+      return;
+    case kHandshakeDone:
+      DEBUG3("received type={} with str={} id={} seq_num={}",
+             static_cast<int>(msg->type()), msg->str(), msg->id(),
+             msg->seq_num_uid());
+      m_last_update = Now();
+      m_process_incoming(std::move(msg), this);
+      return;
+  }
+
+  INFO("server: client CONNECTED: {} port {}", m_remote_ip, m_remote_port);
+  m_handshake_step = kHandshakeDone;
+  m_last_update = Now();
+  set_state(kActive);
+}
+
+void UvNetworkConnection::Write(wpi::span<const std::shared_ptr<Message>> msgs,
+                                bool posted) {
+  auto stream = m_stream.lock();
+  if (!stream || stream->IsClosing()) {
+    if (posted) {
+      --m_outgoing_depth;
+    }
+    return;
+  }
+
+  DEBUG3("sending {} messages", msgs.size());
+  auto batch = std::make_shared<EncodedBatch>(m_proto_rev);
+  batch->Encode(msgs, m_proto_rev);
+  if (batch->size() == 0) {
+    if (posted) {
+      --m_outgoing_depth;
+    }
+    return;
+  }
+
+  // the batch owns the data until the write completes
+  wpi::SmallVector<wpi::uv::Buffer, 4> bufs;
+  for (auto&& buf : batch->buffers()) {
+    bufs.emplace_back(buf);
+  }
+  stream->Write(bufs, [self = shared_from_this(), batch, posted](
+                          auto bufs, wpi::uv::Error err) {
+    if (!err) {
+      self->m_bytes_sent += batch->size();
+    }
+    if (posted) {
+      --self->m_outgoing_depth;
+    }
+  });
+}
+
+void UvNetworkConnection::Close() {
+  set_state(kDead);
+  auto stream = m_stream.lock();
+  if (!stream || stream->IsClosing()) {
+    return;
+  }
+  // let any queued writes (e.g. a protocol unsupported message) finish first
+  stream->Shutdown([s = stream.get()] { s->Close(); });
+}
+
+void UvNetworkConnection::QueueOutgoing(std::shared_ptr<Message> msg) {
+  std::scoped_lock lock(m_pending_mutex);
+  m_pending.Add(std::move(msg));
+}
+
+void UvNetworkConnection::PostOutgoing(bool keep_alive) {
+  std::scoped_lock lock(m_pending_mutex);
+  auto now = std::chrono::steady_clock::now();
+
+  // If the connection is behind (or the budget is used up), hold on to the
+  // pending messages; see NetworkConnection::PostOutgoing().
+  if (!m_pending.CanPost(now, m_outgoing_depth, m_bytes_sent,
+                         m_bandwidth_limit)) {
+    return;
+  }
+
+  Outgoing msgs;
+  if (m_pending.empty()) {
+    if (!keep_alive) {
+      return;
+    }
+    // send keep-alives once a second (if no other messages have been sent)
+    if ((now - m_last_post) < std::chrono::seconds(1)) {
+      return;
+    }
+    msgs.emplace_back(Message::KeepAlive());
+  } else {
+    msgs = m_pending.Take();
+  }
+  m_last_post = now;
+
+  // encoding and writing happens on the loop
+  ++m_outgoing_depth;
+  m_loop_runner.ExecAsync(
+      [self = shared_from_this(), msgs = std::move(msgs)](wpi::uv::Loop&) {
+        self->Write(msgs, true);
+      });
+}
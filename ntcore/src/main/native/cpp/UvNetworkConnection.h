@@ -0,0 +1,150 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#ifndef NTCORE_UVNETWORKCONNECTION_H_
+#define NTCORE_UVNETWORKCONNECTION_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <wpi/mutex.h>
+#include <wpi/span.h>
+
+#include "INetworkConnection.h"
+#include "Message.h"
+#include "OutgoingBatch.h"
+#include "ntcore_cpp.h"
+
+namespace wpi {
+class EventLoopRunner;
+class Logger;
+namespace uv {
+class Tcp;
+}  // namespace uv
+}  // namespace wpi
+
+namespace nt {
+
+class IConnectionNotifier;
+
+/**
+ * Server-side network connection serviced by an event loop.
+ *
+ * Unlike NetworkConnection, which uses a blocking read thread and write
+ * thread per connection, all reads and writes happen on the event loop
+ * thread.  Incoming data is buffered and decoded incrementally as complete
+ * messages arrive, and the server handshake is run as a state machine.
+ */
+class UvNetworkConnection
+    : public INetworkConnection,
+      public std::enable_shared_from_this<UvNetworkConnection> {
+ public:
+  using SendMsgsFunc =
+      std::function<void(wpi::span<std::shared_ptr<Message>>)>;
+  // Handles the client hello; returns false to close the connection.
+  using HandshakeHelloFunc = std::function<bool(
+      INetworkConnection& conn, const std::shared_ptr<Message>& msg,
+      SendMsgsFunc send_msgs)>;
+  // Handles the client's initial assignments (protocol 3.0 and later).
+  using HandshakeDoneFunc =
+      std::function<void(INetworkConnection& conn,
+                         wpi::span<std::shared_ptr<Message>> incoming)>;
+  using ProcessIncomingFunc =
+      std::function<void(std::shared_ptr<Message>, UvNetworkConnection*)>;
+  using Outgoing = OutgoingBatcher::Outgoing;
+
+  UvNetworkConnection(unsigned int uid, std::shared_ptr<wpi::uv::Tcp> stream,
+                      wpi::EventLoopRunner& loop_runner,
+                      IConnectionNotifier& notifier, wpi::Logger& logger,
+                      HandshakeHelloFunc handshake_hello,
+                      HandshakeDoneFunc handshake_done,
+                      Message::GetEntryTypeFunc get_entry_type);
+  ~UvNetworkConnection() override;
+
+  // Set the input processor function.  This must be called before Start().
+  void set_process_incoming(ProcessIncomingFunc func) {
+    m_process_incoming = func;
+  }
+
+  // Starts reading.  Must be called from the event loop thread.
+  void Start();
+
+  ConnectionInfo info() const final;
+
+  void QueueOutgoing(std::shared_ptr<Message> msg) final;
+  void PostOutgoing(bool keep_alive) final;
+
+  unsigned int uid() const { return m_uid; }
+
+  unsigned int proto_rev() const final { return m_proto_rev; }
+  void set_proto_rev(unsigned int proto_rev) final { m_proto_rev = proto_rev; }
+
+  State state() const final;
+  void set_state(State state) final;
+
+  std::string remote_id() const;
+  void set_remote_id(std::string_view remote_id) final;
+
+  void set_bandwidth_limit(unsigned int bytes_per_sec) final {
+    m_bandwidth_limit = bytes_per_sec;
+  }
+
+  UvNetworkConnection(const UvNetworkConnection&) = delete;
+  UvNetworkConnection& operator=(const UvNetworkConnection&) = delete;
+
+ private:
+  enum HandshakeStep { kWaitHello, kWaitHelloDone, kHandshakeDone };
+
+  // These are only called from the event loop thread.
+  void ProcessData(std::string_view data);
+  void ProcessMessage(std::shared_ptr<Message> msg);
+  void Write(wpi::span<const std::shared_ptr<Message>> msgs, bool posted);
+  void Close();
+
+  unsigned int m_uid;
+  std::weak_ptr<wpi::uv::Tcp> m_stream;
+  wpi::EventLoopRunner& m_loop_runner;
+  IConnectionNotifier& m_notifier;
+  wpi::Logger& m_logger;
+  HandshakeHelloFunc m_handshake_hello;
+  HandshakeDoneFunc m_handshake_done;
+  Message::GetEntryTypeFunc m_get_entry_type;
+  ProcessIncomingFunc m_process_incoming;
+  std::string m_remote_ip;
+  unsigned int m_remote_port = 0;
+
+  std::atomic_uint m_proto_rev{0x0300};
+  mutable wpi::mutex m_state_mutex;
+  State m_state = kCreated;
+  mutable wpi::mutex m_remote_id_mutex;
+  std::string m_remote_id;
+  std::atomic_ullong m_last_update{0};
+
+  // Outgoing batches being written, and total bytes written
+  std::atomic_uint m_outgoing_depth{0};
+  std::atomic_ullong m_bytes_sent{0};
+  std::atomic_uint m_bandwidth_limit{0};
+
+  wpi::mutex m_pending_mutex;
+  OutgoingBatcher m_pending;
+  std::chrono::steady_clock::time_point m_last_post;
+
+  // Event loop state
+  std::string m_read_buf;
+  // m_read_buf size needed before decoding the cut-off message again
+  size_t m_read_needed = 0;
+  HandshakeStep m_handshake_step = kWaitHello;
+  std::vector<std::shared_ptr<Message>> m_handshake_incoming;
+};
+
+}  // namespace nt
+
+#endif  // NTCORE_UVNETWORKCONNECTION_H_
@@ -4,11 +4,13 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <cstring>
 
 #include <wpi/MemAlloc.h>
 #include <wpi/timestamp.h>
 
+#include "PoolAllocator.h"
 #include "Value_internal.h"
 #include "networktables/NetworkTableValue.h"
 
@@ -35,20 +37,19 @@ Value::Value(NT_Type type, uint64_t time, const private_init&) {
   }
 }
 
-Value::~Value() {
-  if (m_val.type == NT_BOOLEAN_ARRAY) {
-    delete[] m_val.data.arr_boolean.arr;
-  } else if (m_val.type == NT_DOUBLE_ARRAY) {
-    delete[] m_val.data.arr_double.arr;
-  } else if (m_val.type == NT_STRING_ARRAY) {
-    delete[] m_val.data.arr_string.arr;
-  }
+Value::~Value() = default;
+
+std::shared_ptr<Value> Value::Alloc(NT_Type type, uint64_t time, size_t extra,
+                                    void** extra_ptr) {
+  return std::allocate_shared<Value>(PoolAllocator<Value>{extra, extra_ptr},
+                                     type, time, private_init());
 }
 
 std::shared_ptr<Value> Value::MakeBooleanArray(wpi::span<const bool> value,
                                                uint64_t time) {
-  auto val = std::make_shared<Value>(NT_BOOLEAN_ARRAY, time, private_init());
-  val->m_val.data.arr_boolean.arr = new int[value.size()];
+  void* data;
+  auto val = Alloc(NT_BOOLEAN_ARRAY, time, value.size() * sizeof(int), &data);
+  val->m_val.data.arr_boolean.arr = static_cast<int*>(data);
   val->m_val.data.arr_boolean.size = value.size();
   std::copy(value.begin(), value.end(), val->m_val.data.arr_boolean.arr);
   return val;
@@ -56,8 +57,9 @@ std::shared_ptr<Value> Value::MakeBooleanArray(wpi::span<const bool> value,
 
 std::shared_ptr<Value> Value::MakeBooleanArray(wpi::span<const int> value,
                                                uint64_t time) {
-  auto val = std::make_shared<Value>(NT_BOOLEAN_ARRAY, time, private_init());
-  val->m_val.data.arr_boolean.arr = new int[value.size()];
+  void* data;
+  auto val = Alloc(NT_BOOLEAN_ARRAY, time, value.size() * sizeof(int), &data);
+  val->m_val.data.arr_boolean.arr = static_cast<int*>(data);
   val->m_val.data.arr_boolean.size = value.size();
   std::copy(value.begin(), value.end(), val->m_val.data.arr_boolean.arr);
   return val;
@@ -65,8 +67,10 @@ std::shared_ptr<Value> Value::MakeBooleanArray(wpi::span<const int> value,
 
 std::shared_ptr<Value> Value::MakeDoubleArray(wpi::span<const double> value,
                                               uint64_t time) {
-  auto val = std::make_shared<Value>(NT_DOUBLE_ARRAY, time, private_init());
-  val->m_val.data.arr_double.arr = new double[value.size()];
+  void* data;
+  auto val =
+      Alloc(NT_DOUBLE_ARRAY, time, value.size() * sizeof(double), &data);
+  val->m_val.data.arr_double.arr = static_cast<double*>(data);
   val->m_val.data.arr_double.size = value.size();
   std::copy(value.begin(), value.end(), val->m_val.data.arr_double.arr);
   return val;
@@ -74,25 +78,19 @@ std::shared_ptr<Value> Value::MakeDoubleArray(wpi::span<const double> value,
 
 std::shared_ptr<Value> Value::MakeStringArray(
     wpi::span<const std::string> value, uint64_t time) {
-  auto val = std::make_shared<Value>(NT_STRING_ARRAY, time, private_init());
-  val->m_string_array.assign(value.begin(), value.end());
-  // point NT_Value to the contents in the vector.
-  val->m_val.data.arr_string.arr = new NT_String[value.size()];
-  val->m_val.data.arr_string.size = val->m_string_array.size();
-  for (size_t i = 0; i < value.size(); ++i) {
-    val->m_val.data.arr_string.arr[i].str = const_cast<char*>(value[i].c_str());
-    val->m_val.data.arr_string.arr[i].len = value[i].size();
-  }
-  return val;
+  return MakeStringArray(std::vector<std::string>(value.begin(), value.end()),
+                         time);
 }
 
 std::shared_ptr<Value> Value::MakeStringArray(std::vector<std::string>&& value,
                                               uint64_t time) {
-  auto val = std::make_shared<Value>(NT_STRING_ARRAY, time, private_init());
+  void* data;
+  auto val =
+      Alloc(NT_STRING_ARRAY, time, value.size() * sizeof(NT_String), &data);
   val->m_string_array = std::move(value);
   value.clear();
   // point NT_Value to the contents in the vector.
-  val->m_val.data.arr_string.arr = new NT_String[val->m_string_array.size()];
+  val->m_val.data.arr_string.arr = static_cast<NT_String*>(data);
   val->m_val.data.arr_string.size = val->m_string_array.size();
   for (size_t i = 0; i < val->m_string_array.size(); ++i) {
     val->m_val.data.arr_string.arr[i].str =
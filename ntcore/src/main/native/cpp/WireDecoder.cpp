@@ -12,6 +12,7 @@
 
 #include <wpi/MathExtras.h>
 #include <wpi/MemAlloc.h>
+#include <wpi/SmallVector.h>
 #include <wpi/leb128.h>
 
 using namespace nt;
@@ -177,11 +178,12 @@ std::shared_ptr<Value> WireDecoder::ReadValue(NT_Type type) {
       if (!Read(&buf, size)) {
         return nullptr;
       }
-      std::vector<int> v(size);
+      // the value holds its own copy, so typical sizes convert on the stack
+      wpi::SmallVector<int, 64> v(size);
       for (unsigned int i = 0; i < size; ++i) {
         v[i] = buf[i] ? 1 : 0;
       }
-      return Value::MakeBooleanArray(std::move(v));
+      return Value::MakeBooleanArray(v);
     }
     case NT_DOUBLE_ARRAY: {
       // size
@@ -195,11 +197,11 @@ std::shared_ptr<Value> WireDecoder::ReadValue(NT_Type type) {
       if (!Read(&buf, size * 8)) {
         return nullptr;
       }
-      std::vector<double> v(size);
+      wpi::SmallVector<double, 32> v(size);
       for (unsigned int i = 0; i < size; ++i) {
         v[i] = ::ReadDouble(buf);
       }
-      return Value::MakeDoubleArray(std::move(v));
+      return Value::MakeDoubleArray(v);
     }
     case NT_STRING_ARRAY: {
       // size
@@ -229,13 +229,15 @@ static jobject MakeJValue(JNIEnv* env, const nt::Value* value) {
 static jobject MakeJObject(JNIEnv* env, const nt::ConnectionInfo& info) {
   static jmethodID constructor =
       env->GetMethodID(connectionInfoCls, "<init>",
-                       "(Ljava/lang/String;Ljava/lang/String;IJI)V");
+                       "(Ljava/lang/String;Ljava/lang/String;IJIIJ)V");
   JLocal<jstring> remote_id{env, MakeJString(env, info.remote_id)};
   JLocal<jstring> remote_ip{env, MakeJString(env, info.remote_ip)};
   return env->NewObject(connectionInfoCls, constructor, remote_id.obj(),
                         remote_ip.obj(), static_cast<jint>(info.remote_port),
                         static_cast<jlong>(info.last_update),
-                        static_cast<jint>(info.protocol_version));
+                        static_cast<jint>(info.protocol_version),
+                        static_cast<jint>(info.outgoing_queue_depth),
+                        static_cast<jlong>(info.bytes_sent));
 }
 
 static jobject MakeJObject(JNIEnv* env, jobject inst,
@@ -1703,6 +1705,30 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_setUpdateRate
   nt::SetUpdateRate(inst, interval);
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setNetworkBandwidthLimit
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setNetworkBandwidthLimit
+  (JNIEnv*, jclass, jint inst, jint bytesPerSec)
+{
+  nt::SetNetworkBandwidthLimit(inst, bytesPerSec < 0 ? 0 : bytesPerSec);
+}
+
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setServerEventLoop
+ * Signature: (IZ)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setServerEventLoop
+  (JNIEnv*, jclass, jint inst, jboolean enabled)
+{
+  nt::SetServerEventLoop(inst, enabled);
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    flush
@@ -1793,6 +1819,18 @@ Java_edu_wpi_first_networktables_NetworkTablesJNI_loadPersistent
   return MakeJStringArray(env, warns);
 }
 
+/*
+ * Class:     edu_wpi_first_networktables_NetworkTablesJNI
+ * Method:    setPersistentBinary
+ * Signature: (IZ)V
+ */
+JNIEXPORT void JNICALL
+Java_edu_wpi_first_networktables_NetworkTablesJNI_setPersistentBinary
+  (JNIEnv*, jclass, jint inst, jboolean binary)
+{
+  nt::SetPersistentBinary(inst, binary);
+}
+
 /*
  * Class:     edu_wpi_first_networktables_NetworkTablesJNI
  * Method:    saveEntries
@@ -39,6 +39,8 @@ static void ConvertToC(const ConnectionInfo& in, NT_ConnectionInfo* out) {
   out->remote_port = in.remote_port;
   out->last_update = in.last_update;
   out->protocol_version = in.protocol_version;
+  out->outgoing_queue_depth = in.outgoing_queue_depth;
+  out->bytes_sent = in.bytes_sent;
 }
 
 static void ConvertToC(const RpcParamDef& in, NT_RpcParamDef* out) {
@@ -354,6 +356,19 @@ void NT_CancelPollEntryListener(NT_EntryListenerPoller poller) {
   nt::CancelPollEntryListener(poller);
 }
 
+void NT_SetEntryListenerPollerQueueLimit(NT_EntryListenerPoller poller,
+                                         size_t limit) {
+  nt::SetEntryListenerPollerQueueLimit(poller, limit);
+}
+
+void NT_GetEntryListenerPollerStats(NT_EntryListenerPoller poller,
+                                    struct NT_EntryListenerPollerStats* stats) {
+  auto stats_cpp = nt::GetEntryListenerPollerStats(poller);
+  stats->queued = stats_cpp.queued;
+  stats->coalesced = stats_cpp.coalesced;
+  stats->dropped = stats_cpp.dropped;
+}
+
 void NT_RemoveEntryListener(NT_EntryListener entry_listener) {
   nt::RemoveEntryListener(entry_listener);
 }
@@ -651,6 +666,14 @@ void NT_SetUpdateRate(NT_Inst inst, double interval) {
   nt::SetUpdateRate(inst, interval);
 }
 
+void NT_SetNetworkBandwidthLimit(NT_Inst inst, unsigned int bytes_per_sec) {
+  nt::SetNetworkBandwidthLimit(inst, bytes_per_sec);
+}
+
+void NT_SetServerEventLoop(NT_Inst inst, NT_Bool enabled) {
+  nt::SetServerEventLoop(inst, enabled);
+}
+
 void NT_Flush(NT_Inst inst) {
   nt::Flush(inst);
 }
@@ -677,6 +700,10 @@ const char* NT_LoadPersistent(NT_Inst inst, const char* filename,
   return nt::LoadPersistent(inst, filename, warn);
 }
 
+void NT_SetPersistentBinary(NT_Inst inst, NT_Bool binary) {
+  nt::SetPersistentBinary(inst, binary);
+}
+
 const char* NT_SaveEntries(NT_Inst inst, const char* filename,
                            const char* prefix, size_t prefix_len) {
   return nt::SaveEntries(inst, filename, {prefix, prefix_len});
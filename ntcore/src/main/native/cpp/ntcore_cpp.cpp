@@ -363,6 +363,31 @@ void CancelPollEntryListener(NT_EntryListenerPoller poller) {
   ii->entry_notifier.CancelPoll(id);
 }
 
+void SetEntryListenerPollerQueueLimit(NT_EntryListenerPoller poller,
+                                      size_t limit) {
+  Handle handle{poller};
+  int id = handle.GetTypedIndex(Handle::kEntryListenerPoller);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (id < 0 || !ii) {
+    return;
+  }
+
+  ii->entry_notifier.SetPollerQueueLimit(id, limit);
+}
+
+EntryListenerPollerStats GetEntryListenerPollerStats(
+    NT_EntryListenerPoller poller) {
+  Handle handle{poller};
+  int id = handle.GetTypedIndex(Handle::kEntryListenerPoller);
+  auto ii = InstanceImpl::Get(handle.GetInst());
+  if (id < 0 || !ii) {
+    return {};
+  }
+
+  auto stats = ii->entry_notifier.GetPollerStats(id);
+  return {stats.queued, stats.coalesced, stats.dropped};
+}
+
 void RemoveEntryListener(NT_EntryListener entry_listener) {
   Handle handle{entry_listener};
   int uid = handle.GetTypedIndex(Handle::kEntryListener);
@@ -1036,6 +1061,24 @@ void SetUpdateRate(NT_Inst inst, double interval) {
   ii->dispatcher.SetUpdateRate(interval);
 }
 
+void SetNetworkBandwidthLimit(NT_Inst inst, unsigned int bytes_per_sec) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) {
+    return;
+  }
+
+  ii->dispatcher.SetBandwidthLimit(bytes_per_sec);
+}
+
+void SetServerEventLoop(NT_Inst inst, bool enabled) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) {
+    return;
+  }
+
+  ii->dispatcher.SetServerEventLoop(enabled);
+}
+
 void Flush(NT_Inst inst) {
   auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
   if (!ii) {
@@ -1087,6 +1130,15 @@ const char* LoadPersistent(
   return ii->storage.LoadPersistent(filename, warn);
 }
 
+void SetPersistentBinary(NT_Inst inst, bool binary) {
+  auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
+  if (!ii) {
+    return;
+  }
+
+  ii->storage.SetPersistentBinary(binary);
+}
+
 const char* SaveEntries(NT_Inst inst, std::string_view filename,
                         std::string_view prefix) {
   auto ii = InstanceImpl::Get(Handle{inst}.GetTypedInst(Handle::kInstance));
@@ -67,7 +67,17 @@ enum {
    * Set this flag to receive a notification when an entry's flags value
    * changes.
    */
-  kFlags = NT_NOTIFY_FLAGS
+  kFlags = NT_NOTIFY_FLAGS,
+
+  /**
+   * Coalesce queued notifications.
+   * Set this flag on a polled listener to keep at most one queued value
+   * change notification per entry; if a notification for an entry is already
+   * waiting to be polled, later value and flags changes are merged into it
+   * and only the latest value is delivered.  Creation and deletion
+   * notifications are never merged.  Has no effect on callback listeners.
+   */
+  kCoalesce = NT_NOTIFY_COALESCE
 };
 
 }  // namespace nt::EntryListenerFlags
@@ -34,7 +34,7 @@ class NetworkTableEntry final {
   /**
    * Flag values (as returned by GetFlags()).
    */
-  enum Flags { kPersistent = NT_PERSISTENT };
+  enum Flags { kPersistent = NT_PERSISTENT, kImmediate = NT_IMMEDIATE };
 
   /**
    * Construct invalid instance.
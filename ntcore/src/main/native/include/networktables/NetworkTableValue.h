@@ -233,7 +233,7 @@ class Value final {
    * @return The entry value
    */
   static std::shared_ptr<Value> MakeBoolean(bool value, uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_BOOLEAN, time, private_init());
+    auto val = Alloc(NT_BOOLEAN, time);
     val->m_val.data.v_boolean = value;
     return val;
   }
@@ -247,7 +247,7 @@ class Value final {
    * @return The entry value
    */
   static std::shared_ptr<Value> MakeDouble(double value, uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_DOUBLE, time, private_init());
+    auto val = Alloc(NT_DOUBLE, time);
     val->m_val.data.v_double = value;
     return val;
   }
@@ -262,7 +262,7 @@ class Value final {
    */
   static std::shared_ptr<Value> MakeString(std::string_view value,
                                            uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_STRING, time, private_init());
+    auto val = Alloc(NT_STRING, time);
     val->m_string = value;
     val->m_val.data.v_string.str = const_cast<char*>(val->m_string.c_str());
     val->m_val.data.v_string.len = val->m_string.size();
@@ -278,9 +278,9 @@ class Value final {
    * @return The entry value
    */
   template <typename T,
-            typename std::enable_if<std::is_same<T, std::string>::value>::type>
+            typename = std::enable_if_t<std::is_same_v<T, std::string>>>
   static std::shared_ptr<Value> MakeString(T&& value, uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_STRING, time, private_init());
+    auto val = Alloc(NT_STRING, time);
     val->m_string = std::forward<T>(value);
     val->m_val.data.v_string.str = const_cast<char*>(val->m_string.c_str());
     val->m_val.data.v_string.len = val->m_string.size();
@@ -297,7 +297,7 @@ class Value final {
    */
   static std::shared_ptr<Value> MakeRaw(std::string_view value,
                                         uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_RAW, time, private_init());
+    auto val = Alloc(NT_RAW, time);
     val->m_string = value;
     val->m_val.data.v_raw.str = const_cast<char*>(val->m_string.c_str());
     val->m_val.data.v_raw.len = val->m_string.size();
@@ -313,9 +313,9 @@ class Value final {
    * @return The entry value
    */
   template <typename T,
-            typename std::enable_if<std::is_same<T, std::string>::value>::type>
+            typename = std::enable_if_t<std::is_same_v<T, std::string>>>
   static std::shared_ptr<Value> MakeRaw(T&& value, uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_RAW, time, private_init());
+    auto val = Alloc(NT_RAW, time);
     val->m_string = std::forward<T>(value);
     val->m_val.data.v_raw.str = const_cast<char*>(val->m_string.c_str());
     val->m_val.data.v_raw.len = val->m_string.size();
@@ -332,7 +332,7 @@ class Value final {
    */
   static std::shared_ptr<Value> MakeRpc(std::string_view value,
                                         uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_RPC, time, private_init());
+    auto val = Alloc(NT_RPC, time);
     val->m_string = value;
     val->m_val.data.v_raw.str = const_cast<char*>(val->m_string.c_str());
     val->m_val.data.v_raw.len = val->m_string.size();
@@ -349,7 +349,7 @@ class Value final {
    */
   template <typename T>
   static std::shared_ptr<Value> MakeRpc(T&& value, uint64_t time = 0) {
-    auto val = std::make_shared<Value>(NT_RPC, time, private_init());
+    auto val = Alloc(NT_RPC, time);
     val->m_string = std::forward<T>(value);
     val->m_val.data.v_raw.str = const_cast<char*>(val->m_string.c_str());
     val->m_val.data.v_raw.len = val->m_string.size();
@@ -472,6 +472,13 @@ class Value final {
   friend bool operator==(const Value& lhs, const Value& rhs);
 
  private:
+  // Allocates a value (and optionally extra bytes for array storage, whose
+  // address is stored to *extra_ptr) in a single block from a per-thread
+  // pool.
+  static std::shared_ptr<Value> Alloc(NT_Type type, uint64_t time,
+                                      size_t extra = 0,
+                                      void** extra_ptr = nullptr);
+
   NT_Value m_val;
   std::string m_string;
   std::vector<std::string> m_string_array;
@@ -58,8 +58,13 @@ enum NT_Type {
   NT_RPC = 0x80
 };
 
-/** NetworkTables entry flags. */
-enum NT_EntryFlags { NT_PERSISTENT = 0x01 };
+/**
+ * NetworkTables entry flags.
+ *
+ * Updates to NT_IMMEDIATE entries are sent to the network right away rather
+ * than at the next periodic update or flush.
+ */
+enum NT_EntryFlags { NT_PERSISTENT = 0x01, NT_IMMEDIATE = 0x02 };
 
 /** NetworkTables logging levels. */
 enum NT_LogLevel {
@@ -82,7 +87,8 @@ enum NT_NotifyKind {
   NT_NOTIFY_NEW = 0x04,       /* newly created entry */
   NT_NOTIFY_DELETE = 0x08,    /* deleted */
   NT_NOTIFY_UPDATE = 0x10,    /* value changed */
-  NT_NOTIFY_FLAGS = 0x20      /* flags changed */
+  NT_NOTIFY_FLAGS = 0x20,     /* flags changed */
+  NT_NOTIFY_COALESCE = 0x40   /* polled: only latest queued value per entry */
 };
 
 /** Client/server modes */
@@ -183,6 +189,30 @@ struct NT_ConnectionInfo {
    * layer format, so 0x0200 = 2.0, 0x0300 = 3.0).
    */
   unsigned int protocol_version;
+
+  /**
+   * The number of outgoing message batches waiting to be sent to the remote
+   * node.  While this is high, updates are merged rather than queued.
+   */
+  unsigned int outgoing_queue_depth;
+
+  /** The total number of bytes sent to the remote node. */
+  uint64_t bytes_sent;
+};
+
+/** NetworkTables Entry Listener Poller Statistics */
+struct NT_EntryListenerPollerStats {
+  /** Number of notifications waiting to be polled. */
+  size_t queued;
+
+  /**
+   * Number of notifications merged into an already queued notification
+   * (see NT_NOTIFY_COALESCE).
+   */
+  uint64_t coalesced;
+
+  /** Number of notifications discarded because the queue limit was reached. */
+  uint64_t dropped;
 };
 
 /** NetworkTables RPC Version 1 Definition Parameter */
@@ -638,6 +668,26 @@ struct NT_EntryNotification* NT_PollEntryListenerTimeout(
  */
 void NT_CancelPollEntryListener(NT_EntryListenerPoller poller);
 
+/**
+ * Limit the number of notifications queued for an entry listener poller.
+ * When the limit is reached, the oldest queued notification is discarded to
+ * make room for each new one.  By default the queue is unbounded.
+ *
+ * @param poller  poller handle
+ * @param limit   maximum number of queued notifications (0 for unlimited)
+ */
+void NT_SetEntryListenerPollerQueueLimit(NT_EntryListenerPoller poller,
+                                         size_t limit);
+
+/**
+ * Get queue statistics for an entry listener poller.
+ *
+ * @param poller  poller handle
+ * @param stats   statistics (output; all zero if the poller is invalid)
+ */
+void NT_GetEntryListenerPollerStats(NT_EntryListenerPoller poller,
+                                    struct NT_EntryListenerPollerStats* stats);
+
 /**
  * Remove an entry listener.
  *
@@ -1174,6 +1224,29 @@ void NT_StopDSClient(NT_Inst inst);
  */
 void NT_SetUpdateRate(NT_Inst inst, double interval);
 
+/**
+ * Set the outgoing bandwidth limit for each network connection.
+ * When a connection reaches its limit (or falls behind sending), further
+ * updates to each entry are merged and only the latest value is sent once
+ * the connection catches up.
+ *
+ * @param inst           instance handle
+ * @param bytes_per_sec  limit in bytes per second (0 for unlimited)
+ */
+void NT_SetNetworkBandwidthLimit(NT_Inst inst, unsigned int bytes_per_sec);
+
+/**
+ * Selects the server network backend.  By default, the server uses a read
+ * thread and a write thread per client connection.  When enabled, all client
+ * connections are instead serviced by a single event loop thread, which
+ * scales better to many clients.  This must be called before starting the
+ * server; it has no effect on a server that is already running.
+ *
+ * @param inst     instance handle
+ * @param enabled  true to use the event loop backend
+ */
+void NT_SetServerEventLoop(NT_Inst inst, NT_Bool enabled);
+
 /**
  * Flush Entries.
  *
@@ -1241,6 +1314,19 @@ const char* NT_SavePersistent(NT_Inst inst, const char* filename);
 const char* NT_LoadPersistent(NT_Inst inst, const char* filename,
                               void (*warn)(size_t line, const char* msg));
 
+/**
+ * Selects the file format used for saving persistent values.  The binary
+ * format is faster to save and load and smaller for array values.  With it,
+ * the server's periodic saves append just the changed values to the file
+ * (rewriting the whole file once these grow larger than the file itself).
+ * Loading detects the format of the file, so either format can be loaded
+ * regardless of this setting.
+ *
+ * @param inst    instance handle
+ * @param binary  true to save in the binary format, false for text
+ */
+void NT_SetPersistentBinary(NT_Inst inst, NT_Bool binary);
+
 /**
  * Save table values to a file.  The file format used is identical to
  * that used for SavePersistent.
@@ -88,6 +88,15 @@ struct ConnectionInfo {
    */
   unsigned int protocol_version{0};
 
+  /**
+   * The number of outgoing message batches waiting to be sent to the remote
+   * node.  While this is high, updates are merged rather than queued.
+   */
+  unsigned int outgoing_queue_depth{0};
+
+  /** The total number of bytes sent to the remote node. */
+  uint64_t bytes_sent{0};
+
   friend void swap(ConnectionInfo& first, ConnectionInfo& second) {
     using std::swap;
     swap(first.remote_id, second.remote_id);
@@ -95,9 +104,26 @@ struct ConnectionInfo {
     swap(first.remote_port, second.remote_port);
     swap(first.last_update, second.last_update);
     swap(first.protocol_version, second.protocol_version);
+    swap(first.outgoing_queue_depth, second.outgoing_queue_depth);
+    swap(first.bytes_sent, second.bytes_sent);
   }
 };
 
+/** NetworkTables Entry Listener Poller Statistics */
+struct EntryListenerPollerStats {
+  /** Number of notifications waiting to be polled. */
+  size_t queued{0};
+
+  /**
+   * Number of notifications merged into an already queued notification
+   * (see EntryListenerFlags::kCoalesce).
+   */
+  uint64_t coalesced{0};
+
+  /** Number of notifications discarded because the queue limit was reached. */
+  uint64_t dropped{0};
+};
+
 /** NetworkTables RPC Version 1 Definition Parameter */
 struct RpcParamDef {
   RpcParamDef() = default;
@@ -633,6 +659,26 @@ std::vector<EntryNotification> PollEntryListener(NT_EntryListenerPoller poller,
  */
 void CancelPollEntryListener(NT_EntryListenerPoller poller);
 
+/**
+ * Limit the number of notifications queued for an entry listener poller.
+ * When the limit is reached, the oldest queued notification is discarded to
+ * make room for each new one.  By default the queue is unbounded.
+ *
+ * @param poller  poller handle
+ * @param limit   maximum number of queued notifications (0 for unlimited)
+ */
+void SetEntryListenerPollerQueueLimit(NT_EntryListenerPoller poller,
+                                      size_t limit);
+
+/**
+ * Get queue statistics for an entry listener poller.
+ *
+ * @param poller  poller handle
+ * @return Statistics (all zero if the poller is invalid)
+ */
+EntryListenerPollerStats GetEntryListenerPollerStats(
+    NT_EntryListenerPoller poller);
+
 /**
  * Remove an entry listener.
  *
@@ -1129,6 +1175,29 @@ void StopDSClient(NT_Inst inst);
  */
 void SetUpdateRate(NT_Inst inst, double interval);
 
+/**
+ * Set the outgoing bandwidth limit for each network connection.
+ * When a connection reaches its limit (or falls behind sending), further
+ * updates to each entry are merged and only the latest value is sent once
+ * the connection catches up.
+ *
+ * @param inst           instance handle
+ * @param bytes_per_sec  limit in bytes per second (0 for unlimited)
+ */
+void SetNetworkBandwidthLimit(NT_Inst inst, unsigned int bytes_per_sec);
+
+/**
+ * Selects the server network backend.  By default, the server uses a read
+ * thread and a write thread per client connection.  When enabled, all client
+ * connections are instead serviced by a single event loop thread, which
+ * scales better to many clients.  This must be called before starting the
+ * server; it has no effect on a server that is already running.
+ *
+ * @param inst     instance handle
+ * @param enabled  true to use the event loop backend
+ */
+void SetServerEventLoop(NT_Inst inst, bool enabled);
+
 /**
  * Flush Entries.
  *
@@ -1193,6 +1262,19 @@ const char* LoadPersistent(
     NT_Inst inst, std::string_view filename,
     std::function<void(size_t line, const char* msg)> warn);
 
+/**
+ * Selects the file format used for saving persistent values.  The binary
+ * format is faster to save and load and smaller for array values.  With it,
+ * the server's periodic saves append just the changed values to the file
+ * (rewriting the whole file once these grow larger than the file itself).
+ * Loading detects the format of the file, so either format can be loaded
+ * regardless of this setting.
+ *
+ * @param inst    instance handle
+ * @param binary  true to save in the binary format, false for text
+ */
+void SetPersistentBinary(NT_Inst inst, bool binary);
+
 /**
  * Save table values to a file.  The file format used is identical to
  * that used for SavePersistent.
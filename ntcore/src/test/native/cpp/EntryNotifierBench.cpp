@@ -0,0 +1,59 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <wpi/Logger.h>
+
+#include "EntryNotifier.h"
+#include "gtest/gtest.h"
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+namespace nt {
+
+TEST(EntryNotifierBenchTest, DISABLED_EventsPerSecond) {
+  static constexpr int kNumEvents = 20000;
+  auto val = Value::MakeDouble(1);
+
+  for (int numListeners : {1, 10, 100, 1000}) {
+    wpi::Logger logger;
+    EntryNotifier notifier(1, logger);
+    notifier.Start();
+
+    // Each listener is on a separate table or entry, as with one listener
+    // per NetworkTableEntry or dashboard widget; only one of them matches.
+    auto poller = notifier.CreatePoller();
+    for (int i = 0; i < numListeners; ++i) {
+      if (i % 2 == 0) {
+        notifier.AddPolled(poller, fmt::format("/table{}/", i), NT_NOTIFY_NEW);
+      } else {
+        notifier.AddPolled(poller, i + 100, NT_NOTIFY_NEW);
+      }
+    }
+    std::vector<std::string> names;
+    for (int i = 0; i < 100; ++i) {
+      names.emplace_back(fmt::format("/table0/entry{}", i));
+    }
+
+    auto start = high_resolution_clock::now();
+    for (int i = 0; i < kNumEvents; ++i) {
+      notifier.NotifyEntry(i % 100, names[i % 100], val, NT_NOTIFY_NEW);
+    }
+    ASSERT_TRUE(notifier.WaitForQueue(10.0));
+    auto stop = high_resolution_clock::now();
+
+    bool timed_out = false;
+    ASSERT_EQ(notifier.Poll(poller, 0, &timed_out).size(),
+              static_cast<size_t>(kNumEvents));
+    fmt::print("listeners: {} events/sec: {:.0f}\n", numListeners,
+               kNumEvents / duration<double>(stop - start).count());
+  }
+}
+
+}  // namespace nt
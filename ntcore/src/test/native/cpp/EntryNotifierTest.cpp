@@ -309,4 +309,74 @@ TEST_F(EntryNotifierTest, PollPrefixLocal) {
   ASSERT_EQ(results.size(), 6u);
 }
 
+TEST_F(EntryNotifierTest, PollCoalesce) {
+  auto poller = notifier.CreatePoller();
+  notifier.AddPolled(poller, "/foo",
+                     NT_NOTIFY_NEW | NT_NOTIFY_DELETE | NT_NOTIFY_UPDATE |
+                         NT_NOTIFY_FLAGS | NT_NOTIFY_COALESCE);
+
+  notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(0), NT_NOTIFY_NEW);
+  for (int i = 1; i <= 10; ++i) {
+    notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(i), NT_NOTIFY_UPDATE);
+    notifier.NotifyEntry(6, "/foo/b", Value::MakeDouble(i), NT_NOTIFY_UPDATE);
+  }
+  notifier.NotifyEntry(6, "/foo/b", Value::MakeDouble(20), NT_NOTIFY_FLAGS);
+  notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(10), NT_NOTIFY_DELETE);
+  notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(11), NT_NOTIFY_UPDATE);
+
+  ASSERT_TRUE(notifier.WaitForQueue(1.0));
+  bool timed_out = false;
+  auto results = notifier.Poll(poller, 0, &timed_out);
+  ASSERT_FALSE(timed_out);
+  SCOPED_TRACE(::testing::PrintToString(results));
+  ASSERT_EQ(results.size(), 4u);
+
+  // updates are merged into the pending new notification
+  EXPECT_EQ(Handle(results[0].entry).GetIndex(), 5);
+  EXPECT_EQ(results[0].flags, NT_NOTIFY_NEW | NT_NOTIFY_UPDATE);
+  EXPECT_EQ(*results[0].value, *Value::MakeDouble(10));
+  EXPECT_EQ(Handle(results[1].entry).GetIndex(), 6);
+  EXPECT_EQ(results[1].flags, NT_NOTIFY_UPDATE | NT_NOTIFY_FLAGS);
+  EXPECT_EQ(*results[1].value, *Value::MakeDouble(20));
+  // nothing is merged into a deletion
+  EXPECT_EQ(results[2].flags, NT_NOTIFY_DELETE);
+  EXPECT_EQ(results[3].flags, NT_NOTIFY_UPDATE);
+  EXPECT_EQ(*results[3].value, *Value::MakeDouble(11));
+
+  auto stats = notifier.GetPollerStats(poller);
+  EXPECT_EQ(stats.queued, 0u);
+  EXPECT_EQ(stats.coalesced, 20u);
+  EXPECT_EQ(stats.dropped, 0u);
+
+  // once polled, a new notification is queued
+  notifier.NotifyEntry(6, "/foo/b", Value::MakeDouble(21), NT_NOTIFY_UPDATE);
+  ASSERT_TRUE(notifier.WaitForQueue(1.0));
+  results = notifier.Poll(poller, 0, &timed_out);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(*results[0].value, *Value::MakeDouble(21));
+}
+
+TEST_F(EntryNotifierTest, PollQueueLimit) {
+  auto poller = notifier.CreatePoller();
+  notifier.SetPollerQueueLimit(poller, 3);
+  notifier.AddPolled(poller, "/foo", NT_NOTIFY_UPDATE);
+
+  for (int i = 0; i < 10; ++i) {
+    notifier.NotifyEntry(5, "/foo/a", Value::MakeDouble(i), NT_NOTIFY_UPDATE);
+  }
+
+  ASSERT_TRUE(notifier.WaitForQueue(1.0));
+  auto stats = notifier.GetPollerStats(poller);
+  EXPECT_EQ(stats.queued, 3u);
+  EXPECT_EQ(stats.dropped, 7u);
+
+  // the oldest notifications are dropped
+  bool timed_out = false;
+  auto results = notifier.Poll(poller, 0, &timed_out);
+  ASSERT_FALSE(timed_out);
+  ASSERT_EQ(results.size(), 3u);
+  EXPECT_EQ(*results[0].value, *Value::MakeDouble(7));
+  EXPECT_EQ(*results[2].value, *Value::MakeDouble(9));
+}
+
 }  // namespace nt
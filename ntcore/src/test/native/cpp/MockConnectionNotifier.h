@@ -17,6 +17,7 @@ class MockConnectionNotifier : public IConnectionNotifier {
       unsigned int(
           std::function<void(const ConnectionNotification& event)> callback));
   MOCK_METHOD1(AddPolled, unsigned int(unsigned int poller_uid));
+  MOCK_METHOD1(Remove, void(unsigned int uid));
   MOCK_METHOD3(NotifyConnection,
                void(bool connected, const ConnectionInfo& conn_info,
                     unsigned int only_listener));
@@ -17,6 +17,9 @@ class MockDispatcher : public IDispatcher {
   MOCK_METHOD3(QueueOutgoing,
                void(std::shared_ptr<Message> msg, INetworkConnection* only,
                     INetworkConnection* except));
+  MOCK_METHOD3(QueueOutgoingImmediate,
+               void(std::shared_ptr<Message> msg, INetworkConnection* only,
+                    INetworkConnection* except));
 };
 
 }  // namespace nt
@@ -24,6 +24,10 @@ class MockNetworkConnection : public INetworkConnection {
 
   MOCK_CONST_METHOD0(state, State());
   MOCK_METHOD1(set_state, void(State state));
+
+  MOCK_METHOD1(set_remote_id, void(std::string_view remote_id));
+
+  MOCK_METHOD1(set_bandwidth_limit, void(unsigned int bytes_per_sec));
 };
 
 }  // namespace nt
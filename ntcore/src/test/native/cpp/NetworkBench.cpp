@@ -0,0 +1,181 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "gtest/gtest.h"
+#include "ntcore_cpp.h"
+
+namespace nt {
+
+// Measures update latency from a server to many clients, with the server
+// using either the threaded or the event loop connection backend.  The
+// number of clients is limited by the number of instances ntcore supports.
+static void RunFanOut(bool event_loop, unsigned int port) {
+  static constexpr int kNumClients = 12;
+  static constexpr int kNumUpdates = 50;
+
+  NT_Inst server = CreateInstance();
+  SetNetworkIdentity(server, "server");
+  SetServerEventLoop(server, event_loop);
+  StartServer(server, "", "127.0.0.1", port);
+  NT_Entry server_entry = GetEntry(server, "/bench/value");
+
+  std::vector<NT_Inst> clients;
+  std::vector<NT_EntryListenerPoller> pollers;
+  for (int i = 0; i < kNumClients; ++i) {
+    NT_Inst client = CreateInstance();
+    SetNetworkIdentity(client, fmt::format("client{}", i));
+    auto poller = CreateEntryListenerPoller(client);
+    AddPolledEntryListener(poller, "/bench/",
+                           NT_NOTIFY_NEW | NT_NOTIFY_UPDATE);
+    StartClient(client, "127.0.0.1", port);
+    clients.emplace_back(client);
+    pollers.emplace_back(poller);
+  }
+
+  // wait for all clients to connect
+  auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (GetConnections(server).size() < kNumClients &&
+         std::chrono::steady_clock::now() < timeout) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(GetConnections(server).size(), static_cast<size_t>(kNumClients));
+
+  std::vector<uint64_t> latencies;
+  std::clock_t cpu_start = std::clock();
+  for (int i = 1; i <= kNumUpdates; ++i) {
+    uint64_t sent = Now();
+    SetEntryValue(server_entry, Value::MakeDouble(i));
+    Flush(server);
+    for (auto poller : pollers) {
+      // wait for this update to arrive (skipping any earlier ones)
+      bool received = false;
+      while (!received) {
+        bool timed_out = false;
+        auto events = PollEntryListener(poller, 1.0, &timed_out);
+        ASSERT_FALSE(timed_out);
+        for (auto&& event : events) {
+          if (event.value->GetDouble() == i) {
+            latencies.emplace_back(event.value->last_change() - sent);
+            received = true;
+          }
+        }
+      }
+    }
+    // let flushes through (these are rate limited)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::clock_t cpu_stop = std::clock();
+
+  std::sort(latencies.begin(), latencies.end());
+  fmt::print("{} server, {} clients: p50 {} us p99 {} us cpu {:.0f} ms\n",
+             event_loop ? "event loop" : "threaded", kNumClients,
+             latencies[latencies.size() / 2],
+             latencies[latencies.size() * 99 / 100],
+             1000.0 * (cpu_stop - cpu_start) / CLOCKS_PER_SEC);
+
+  for (auto client : clients) {
+    DestroyInstance(client);
+  }
+  DestroyInstance(server);
+}
+
+// Measures update latency from a client to the server, with and without the
+// immediate flag.  No explicit flushes are done, so updates without the flag
+// wait for the periodic update.
+static void RunImmediate(bool immediate, unsigned int port) {
+  static constexpr int kNumUpdates = 20;
+
+  NT_Inst server = CreateInstance();
+  NT_Inst client = CreateInstance();
+  StartServer(server, "", "127.0.0.1", port);
+  StartClient(client, "127.0.0.1", port);
+  auto poller = CreateEntryListenerPoller(server);
+  AddPolledEntryListener(poller, "/bench/", NT_NOTIFY_NEW | NT_NOTIFY_UPDATE);
+
+  NT_Entry client_entry = GetEntry(client, "/bench/setpoint");
+  SetEntryValue(client_entry, Value::MakeDouble(0));
+  SetEntryFlags(client_entry, immediate ? NT_IMMEDIATE : 0);
+  Flush(client);
+
+  // wait for the server to have the entry
+  bool timed_out = false;
+  auto events = PollEntryListener(poller, 5.0, &timed_out);
+  ASSERT_FALSE(timed_out);
+  // and for the client to get the server's id assignment for it
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  std::vector<uint64_t> latencies;
+  for (int i = 1; i <= kNumUpdates; ++i) {
+    uint64_t sent = Now();
+    SetEntryValue(client_entry, Value::MakeDouble(i));
+    bool received = false;
+    while (!received) {
+      events = PollEntryListener(poller, 1.0, &timed_out);
+      ASSERT_FALSE(timed_out);
+      for (auto&& event : events) {
+        if (event.value->GetDouble() == i) {
+          latencies.emplace_back(event.value->last_change() - sent);
+          received = true;
+        }
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+
+  // histogram, in microseconds
+  static constexpr uint64_t kBuckets[] = {500, 1000, 2000, 5000, 20000, 100000};
+  std::vector<int> counts(std::size(kBuckets) + 1);
+  for (auto latency : latencies) {
+    counts[std::upper_bound(std::begin(kBuckets), std::end(kBuckets),
+                            latency) -
+           std::begin(kBuckets)]++;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  fmt::print("{}: p50 {} us p99 {} us\n",
+             immediate ? "immediate" : "periodic",
+             latencies[latencies.size() / 2],
+             latencies[latencies.size() * 99 / 100]);
+  for (size_t i = 0; i < counts.size(); ++i) {
+    if (i < std::size(kBuckets)) {
+      fmt::print("  < {:6} us: {}\n", kBuckets[i], counts[i]);
+    } else {
+      fmt::print("  >={:6} us: {}\n", kBuckets[i - 1], counts[i]);
+    }
+  }
+
+  if (immediate) {
+    // these should not wait for the (100 ms) periodic update
+    EXPECT_LT(latencies[latencies.size() / 2], 50000u);
+  }
+
+  DestroyInstance(client);
+  DestroyInstance(server);
+}
+
+TEST(NetworkBenchTest, DISABLED_FanOutThreaded) {
+  RunFanOut(false, 10570);
+}
+
+TEST(NetworkBenchTest, DISABLED_FanOutEventLoop) {
+  RunFanOut(true, 10571);
+}
+
+TEST(NetworkBenchTest, DISABLED_LatencyPeriodic) {
+  RunImmediate(false, 10572);
+}
+
+TEST(NetworkBenchTest, DISABLED_LatencyImmediate) {
+  RunImmediate(true, 10573);
+}
+
+}  // namespace nt
@@ -0,0 +1,166 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "NetworkConnection.h"  // NOLINT(build/include_order)
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <wpi/Logger.h>
+#include <wpi/condition_variable.h>
+#include <wpi/mutex.h>
+#include <wpinet/NetworkStream.h>
+
+#include "MockConnectionNotifier.h"
+#include "WireEncoder.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace nt {
+
+namespace {
+
+// Stream whose sends block until unblocked, and whose receives block until
+// closed.
+class FakeNetworkStream : public wpi::NetworkStream {
+ public:
+  size_t send(const char* buffer, size_t len, Error* err) override {
+    std::unique_lock lock(m_mutex);
+    m_cv.wait(lock, [&] { return !m_blocked || m_closed; });
+    if (m_closed) {
+      *err = kConnectionClosed;
+      return 0;
+    }
+    return len;
+  }
+
+  size_t receive(char* buffer, size_t len, Error* err,
+                 int timeout = 0) override {
+    std::unique_lock lock(m_mutex);
+    m_cv.wait(lock, [&] { return m_closed; });
+    *err = kConnectionClosed;
+    return 0;
+  }
+
+  void close() override {
+    {
+      std::scoped_lock lock(m_mutex);
+      m_closed = true;
+    }
+    m_cv.notify_all();
+  }
+
+  std::string_view getPeerIP() const override { return "127.0.0.1"; }
+  int getPeerPort() const override { return 1735; }
+  void setNoDelay() override {}
+  bool setBlocking(bool enabled) override { return true; }
+  int getNativeHandle() const override { return -1; }
+
+  void SetBlocked(bool blocked) {
+    {
+      std::scoped_lock lock(m_mutex);
+      m_blocked = blocked;
+    }
+    m_cv.notify_all();
+  }
+
+ private:
+  wpi::mutex m_mutex;
+  wpi::condition_variable m_cv;
+  bool m_blocked = false;
+  bool m_closed = false;
+};
+
+}  // namespace
+
+class NetworkConnectionTest : public ::testing::Test {
+ public:
+  NetworkConnectionTest() {
+    auto stream = std::make_unique<FakeNetworkStream>();
+    this->stream = stream.get();
+    conn = std::make_unique<NetworkConnection>(
+        1, std::move(stream), notifier, logger,
+        [](auto&, auto, auto) { return true; },
+        [](unsigned int) { return NT_DOUBLE; });
+    conn->Start();
+    WaitFor([&] { return conn->state() == NetworkConnection::kActive; });
+  }
+
+  ~NetworkConnectionTest() override { conn->Stop(); }
+
+  template <typename F>
+  void WaitFor(F&& cond) {
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!cond() && std::chrono::steady_clock::now() < timeout) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(cond());
+  }
+
+  void QueueUpdate(double value) {
+    conn->QueueOutgoing(Message::EntryUpdate(1, 1, Value::MakeDouble(value)));
+  }
+
+  static size_t UpdateSize() {
+    WireEncoder encoder(0x0300u);
+    Message::EntryUpdate(1, 1, Value::MakeDouble(0))->Write(encoder);
+    return encoder.size();
+  }
+
+ protected:
+  wpi::Logger logger;
+  ::testing::NiceMock<MockConnectionNotifier> notifier;
+  FakeNetworkStream* stream;
+  std::unique_ptr<NetworkConnection> conn;
+};
+
+TEST_F(NetworkConnectionTest, Backpressure) {
+  stream->SetBlocked(true);
+
+  // the first batch is being written, the second is queued
+  QueueUpdate(1);
+  conn->PostOutgoing(false);
+  QueueUpdate(2);
+  conn->PostOutgoing(false);
+  EXPECT_EQ(conn->info().outgoing_queue_depth, 2u);
+
+  // further updates are held and merged
+  for (int i = 3; i <= 10; ++i) {
+    QueueUpdate(i);
+    conn->PostOutgoing(false);
+  }
+  EXPECT_EQ(conn->info().outgoing_queue_depth, 2u);
+
+  stream->SetBlocked(false);
+  WaitFor([&] { return conn->info().outgoing_queue_depth == 0; });
+  EXPECT_EQ(conn->info().bytes_sent, 2 * UpdateSize());
+
+  // the merged update is sent once the write thread catches up
+  conn->PostOutgoing(false);
+  WaitFor([&] { return conn->info().bytes_sent == 3 * UpdateSize(); });
+  EXPECT_EQ(conn->info().outgoing_queue_depth, 0u);
+}
+
+TEST_F(NetworkConnectionTest, BandwidthLimit) {
+  conn->set_bandwidth_limit(1);
+
+  QueueUpdate(1);
+  conn->PostOutgoing(false);
+  WaitFor([&] { return conn->info().bytes_sent == UpdateSize(); });
+
+  // budget is exhausted, so this is held
+  QueueUpdate(2);
+  conn->PostOutgoing(false);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(conn->info().outgoing_queue_depth, 0u);
+  EXPECT_EQ(conn->info().bytes_sent, UpdateSize());
+
+  // removing the limit releases it
+  conn->set_bandwidth_limit(0);
+  conn->PostOutgoing(false);
+  WaitFor([&] { return conn->info().bytes_sent == 2 * UpdateSize(); });
+}
+
+}  // namespace nt
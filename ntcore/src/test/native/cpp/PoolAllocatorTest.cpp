@@ -0,0 +1,55 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "PoolAllocator.h"
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace nt {
+
+TEST(PoolAllocatorTest, ReusesFreedBlock) {
+  void* a = pool::Allocate(100);
+  pool::Deallocate(a, 100);
+  // same size class
+  void* b = pool::Allocate(120);
+  EXPECT_EQ(a, b);
+  pool::Deallocate(b, 120);
+}
+
+TEST(PoolAllocatorTest, LargeBlocksNotCached) {
+  size_t upstream = pool::GetNumUpstreamAllocations();
+  void* a = pool::Allocate(100000);
+  pool::Deallocate(a, 100000);
+  void* b = pool::Allocate(100000);
+  pool::Deallocate(b, 100000);
+  EXPECT_EQ(upstream + 2, pool::GetNumUpstreamAllocations());
+}
+
+TEST(PoolAllocatorTest, FreeOnOtherThread) {
+  void* a = pool::Allocate(64);
+  // thread exit releases its cache
+  std::thread{[&] { pool::Deallocate(a, 64); }}.join();
+  void* b = pool::Allocate(64);
+  pool::Deallocate(b, 64);
+}
+
+TEST(PoolAllocatorTest, ExtraBytes) {
+  void* extra = nullptr;
+  auto ptr = std::allocate_shared<double>(
+      PoolAllocator<double>{10 * sizeof(int), &extra}, 1.5);
+  ASSERT_NE(nullptr, extra);
+  EXPECT_GT(static_cast<char*>(extra), reinterpret_cast<char*>(ptr.get()));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(extra) % alignof(double));
+  // extra bytes are writable
+  auto ints = static_cast<int*>(extra);
+  for (int i = 0; i < 10; ++i) {
+    ints[i] = i;
+  }
+  EXPECT_EQ(1.5, *ptr);
+}
+
+}  // namespace nt
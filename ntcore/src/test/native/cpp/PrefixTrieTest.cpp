@@ -0,0 +1,102 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "PrefixTrie.h"  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+namespace nt {
+
+class PrefixTrieTest : public ::testing::Test {
+ public:
+  PrefixTrieTest() {
+    for (std::string_view name :
+         {"", "/", "/a", "/a/", "/a/b", "/ab", "/ab/c", "/b/c/d", "a//b"}) {
+      Insert(name);
+    }
+  }
+
+  void Insert(std::string_view name) { trie.Insert(name, std::string{name}); }
+
+  std::vector<std::string> WithPrefix(std::string_view prefix) {
+    std::vector<std::string> rv;
+    trie.ForEachWithPrefix(prefix,
+                           [&](const std::string& v) { rv.emplace_back(v); });
+    return rv;
+  }
+
+  std::vector<std::string> PrefixOf(std::string_view name) {
+    std::vector<std::string> rv;
+    trie.ForEachPrefixOf(name,
+                         [&](const std::string& v) { rv.emplace_back(v); });
+    return rv;
+  }
+
+  PrefixTrie<std::string> trie;
+};
+
+TEST_F(PrefixTrieTest, WithPrefixEmpty) {
+  EXPECT_THAT(WithPrefix(""),
+              UnorderedElementsAre("", "/", "/a", "/a/", "/a/b", "/ab", "/ab/c",
+                                   "/b/c/d", "a//b"));
+}
+
+TEST_F(PrefixTrieTest, WithPrefixSegment) {
+  EXPECT_THAT(WithPrefix("/a/"), UnorderedElementsAre("/a/", "/a/b"));
+  EXPECT_THAT(WithPrefix("/b/c/"), UnorderedElementsAre("/b/c/d"));
+}
+
+TEST_F(PrefixTrieTest, WithPrefixPartial) {
+  EXPECT_THAT(WithPrefix("/a"),
+              UnorderedElementsAre("/a", "/a/", "/a/b", "/ab", "/ab/c"));
+  EXPECT_THAT(WithPrefix("/ab"), UnorderedElementsAre("/ab", "/ab/c"));
+  EXPECT_THAT(WithPrefix("a/"), UnorderedElementsAre("a//b"));
+  EXPECT_THAT(WithPrefix("/a/b"), UnorderedElementsAre("/a/b"));
+}
+
+TEST_F(PrefixTrieTest, WithPrefixNone) {
+  EXPECT_THAT(WithPrefix("/c"), IsEmpty());
+  EXPECT_THAT(WithPrefix("/a/bc"), IsEmpty());
+  EXPECT_THAT(WithPrefix("/b/d/"), IsEmpty());
+}
+
+TEST_F(PrefixTrieTest, PrefixOf) {
+  EXPECT_THAT(PrefixOf("/ab/cd"),
+              UnorderedElementsAre("", "/", "/a", "/ab", "/ab/c"));
+  EXPECT_THAT(PrefixOf("/a/b"),
+              UnorderedElementsAre("", "/", "/a", "/a/", "/a/b"));
+  EXPECT_THAT(PrefixOf("a//b"), UnorderedElementsAre("", "a//b"));
+  EXPECT_THAT(PrefixOf("x"), ElementsAre(""));
+}
+
+TEST_F(PrefixTrieTest, Duplicates) {
+  Insert("/a");
+  EXPECT_THAT(PrefixOf("/a"), UnorderedElementsAre("", "/", "/a", "/a"));
+}
+
+TEST_F(PrefixTrieTest, Remove) {
+  EXPECT_TRUE(trie.Remove("/ab/c", "/ab/c"));
+  EXPECT_FALSE(trie.Remove("/ab/c", "/ab/c"));
+  EXPECT_FALSE(trie.Remove("/a", "/b"));
+  EXPECT_TRUE(trie.Remove("/a", "/a"));
+  EXPECT_THAT(WithPrefix("/a"), UnorderedElementsAre("/a/", "/a/b", "/ab"));
+  EXPECT_THAT(PrefixOf("/ab/c"), UnorderedElementsAre("", "/", "/ab"));
+}
+
+TEST_F(PrefixTrieTest, Clear) {
+  trie.Clear();
+  EXPECT_THAT(WithPrefix(""), IsEmpty());
+}
+
+}  // namespace nt
@@ -0,0 +1,225 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+#include <wpi/Logger.h>
+#include <wpi/StringExtras.h>
+#include <wpi/StringMap.h>
+#include <wpi/fs.h>
+
+#include "MockEntryNotifier.h"
+#include "MockRpcServer.h"
+#include "PrefixTrie.h"
+#include "Storage.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ntcore_cpp.h"
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+namespace {
+constexpr int kNumReads = 100000;
+constexpr int kNumPrefixQueries = 1000;
+
+template <typename F>
+void MeasureReads(std::string_view name, int numWriters, F&& read) {
+  std::vector<int64_t> latencies;
+  latencies.reserve(kNumReads);
+  for (int i = 0; i < kNumReads; ++i) {
+    auto start = high_resolution_clock::now();
+    read();
+    auto stop = high_resolution_clock::now();
+    latencies.push_back(duration_cast<nanoseconds>(stop - start).count());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  fmt::print("{} writers: {} p50: {}ns p99: {}ns max: {}ns\n", name, numWriters,
+             latencies[kNumReads / 2], latencies[kNumReads * 99 / 100],
+             latencies.back());
+}
+
+// ~8k names shaped like a typical robot: per-module telemetry, vision
+// targets, and dashboard layouts
+std::vector<std::string> MakeNames() {
+  std::vector<std::string> names;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 500; ++j) {
+      names.emplace_back(fmt::format("/Swerve/Module{}/signal{}", i, j));
+    }
+  }
+  for (int i = 0; i < 40; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      names.emplace_back(fmt::format("/photonvision/cam{}/target{}", i, j));
+    }
+  }
+  for (int i = 0; i < 2000; ++i) {
+    names.emplace_back(fmt::format("/Shuffleboard/Tab{}/widget", i));
+  }
+  return names;
+}
+
+template <typename F>
+void MeasurePrefix(std::string_view name, F&& query) {
+  size_t count = 0;
+  auto start = high_resolution_clock::now();
+  for (int i = 0; i < kNumPrefixQueries; ++i) {
+    count += query();
+  }
+  auto stop = high_resolution_clock::now();
+  fmt::print("{}: {}ns/query ({} matches)\n", name,
+             duration_cast<nanoseconds>(stop - start).count() /
+                 kNumPrefixQueries,
+             count / kNumPrefixQueries);
+}
+}  // namespace
+
+TEST(StorageBenchTest, DISABLED_ReadLatencyUnderWriters) {
+  auto inst = nt::CreateInstance();
+  auto readEntry = nt::GetEntry(inst, "/bench/read");
+  nt::SetEntryValue(readEntry, nt::Value::MakeDouble(0));
+
+  for (int numWriters : {0, 1, 4}) {
+    std::atomic_bool done{false};
+    std::vector<std::thread> writers;
+    for (int i = 0; i < numWriters; ++i) {
+      auto entry = nt::GetEntry(inst, fmt::format("/bench/write{}", i));
+      writers.emplace_back([&, entry] {
+        double val = 0;
+        while (!done) {
+          nt::SetEntryValue(entry, nt::Value::MakeDouble(val++));
+        }
+      });
+    }
+
+    // by handle; does not take the storage lock
+    MeasureReads("GetEntryValue", numWriters, [&] {
+      auto value = nt::GetEntryValue(readEntry);
+      ASSERT_TRUE(value);
+    });
+    // by handle through the storage lock, for comparison
+    MeasureReads("GetEntryInfo", numWriters, [&] {
+      auto info = nt::GetEntryInfo(readEntry);
+      ASSERT_EQ(NT_DOUBLE, info.type);
+    });
+
+    done = true;
+    for (auto&& writer : writers) {
+      writer.join();
+    }
+  }
+
+  nt::DestroyInstance(inst);
+}
+
+TEST(StorageBenchTest, DISABLED_PrefixQuery) {
+  auto names = MakeNames();
+  wpi::StringMap<int> map;
+  nt::PrefixTrie<int> trie;
+  for (auto&& name : names) {
+    map[name] = 0;
+    trie.Insert(name, 0);
+  }
+
+  for (std::string_view prefix : {"/Swerve/Module2/", "/photonvision/cam3"}) {
+    fmt::print("prefix '{}' of {} entries\n", prefix, names.size());
+    MeasurePrefix("  StringMap scan", [&] {
+      size_t count = 0;
+      for (auto&& i : map) {
+        if (wpi::starts_with(i.getKey(), prefix)) {
+          ++count;
+        }
+      }
+      return count;
+    });
+    MeasurePrefix("  PrefixTrie", [&] {
+      size_t count = 0;
+      trie.ForEachWithPrefix(prefix, [&](int) { ++count; });
+      return count;
+    });
+  }
+
+  auto inst = nt::CreateInstance();
+  for (auto&& name : names) {
+    nt::SetEntryValue(nt::GetEntry(inst, name), nt::Value::MakeDouble(0));
+  }
+  MeasurePrefix("GetEntryInfo(\"/Swerve/Module2/\")", [&] {
+    return nt::GetEntryInfo(inst, "/Swerve/Module2/", 0).size();
+  });
+  nt::DestroyInstance(inst);
+}
+
+TEST(StorageBenchTest, DISABLED_PersistentSaveLoad) {
+  ::testing::NiceMock<nt::MockEntryNotifier> notifier;
+  ::testing::NiceMock<nt::MockRpcServer> rpc_server;
+  wpi::Logger logger;
+  nt::Storage storage(notifier, rpc_server, logger);
+
+  // a mix of scalars, strings, and arrays
+  auto names = MakeNames();
+  std::vector<double> arr(64, 0.125);
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::shared_ptr<nt::Value> value;
+    switch (i % 3) {
+      case 0:
+        value = nt::Value::MakeDouble(i * 0.1);
+        break;
+      case 1:
+        value = nt::Value::MakeDoubleArray(arr);
+        break;
+      default:
+        value = nt::Value::MakeString(names[i]);
+        break;
+    }
+    storage.SetEntryValue(names[i], value);
+    storage.SetEntryFlags(names[i], NT_PERSISTENT);
+  }
+
+  auto fn =
+      (fs::temp_directory_path() / "ntcore_persistent_bench.dat").string();
+  for (bool binary : {false, true}) {
+    storage.SetPersistentBinary(binary);
+
+    auto start = high_resolution_clock::now();
+    ASSERT_EQ(nullptr, storage.SavePersistent(fn, false));
+    auto save_time = high_resolution_clock::now() - start;
+    auto size = fs::file_size(fn);
+
+    ::testing::NiceMock<nt::MockEntryNotifier> notifier2;
+    ::testing::NiceMock<nt::MockRpcServer> rpc_server2;
+    nt::Storage storage2(notifier2, rpc_server2, logger);
+    start = high_resolution_clock::now();
+    ASSERT_EQ(nullptr, storage2.LoadPersistent(fn, nullptr));
+    auto load_time = high_resolution_clock::now() - start;
+
+    // periodic save of a few changes (appended in the binary format)
+    for (int i = 0; i < 10; ++i) {
+      storage.SetEntryValue(names[i * 3],
+                            nt::Value::MakeDouble(binary ? -i : i + 1));
+    }
+    start = high_resolution_clock::now();
+    ASSERT_EQ(nullptr, storage.SavePersistent(fn, true));
+    auto periodic_time = high_resolution_clock::now() - start;
+
+    fmt::print(
+        "{} entries {}: {} bytes, save {} us, load {} us, save 10 changes {} "
+        "us (now {} bytes)\n",
+        names.size(), binary ? "binary" : "text", size,
+        duration_cast<microseconds>(save_time).count(),
+        duration_cast<microseconds>(load_time).count(),
+        duration_cast<microseconds>(periodic_time).count(),
+        fs::file_size(fn));
+  }
+
+  std::remove(fn.c_str());
+  std::remove(fmt::format("{}.bak", fn).c_str());
+}
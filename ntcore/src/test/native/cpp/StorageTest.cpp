@@ -4,8 +4,12 @@
 
 #include "StorageTest.h"
 
+#include <cstdio>
+
+#include <fmt/format.h>
 #include <wpi/SmallString.h>
 #include <wpi/StringExtras.h>
+#include <wpi/fs.h>
 #include <wpi/raw_istream.h>
 #include <wpi/raw_ostream.h>
 
@@ -299,6 +303,24 @@ TEST_P(StoragePopulatedTest, SetEntryValueDifferentValue) {
   }
 }
 
+TEST_P(StoragePopulatedTest, SetEntryValueImmediate) {
+  // updates to immediate entries are posted right away
+  GetEntry("foo2")->flags = NT_IMMEDIATE;
+  auto value = Value::MakeDouble(1.0);
+
+  // client shouldn't send an update as id not assigned yet
+  if (GetParam()) {
+    EXPECT_CALL(dispatcher, QueueOutgoingImmediate(
+                                MessageEq(Message::EntryUpdate(1, 2, value)),
+                                IsNull(), IsNull()));
+  }
+  EXPECT_CALL(notifier,
+              NotifyEntry(1, std::string_view("foo2"), value,
+                          NT_NOTIFY_UPDATE | NT_NOTIFY_LOCAL, UINT_MAX));
+
+  EXPECT_TRUE(storage.SetEntryValue("foo2", value));
+}
+
 TEST_P(StorageEmptyTest, SetEntryValueEmptyName) {
   auto value = Value::MakeBoolean(true);
   EXPECT_TRUE(storage.SetEntryValue("", value));
@@ -869,6 +891,98 @@ TEST_P(StorageEmptyTest, LoadPersistentWarn) {
   EXPECT_TRUE(idmap().empty());
 }
 
+TEST_P(StoragePersistentTest, SavePersistentBinary) {
+  for (auto& i : entries()) {
+    i.getValue()->flags = NT_PERSISTENT;
+  }
+  wpi::SmallString<256> text;
+  wpi::raw_svector_ostream text_os(text);
+  storage.SavePersistent(text_os, false);
+  wpi::SmallString<256> binary;
+  wpi::raw_svector_ostream binary_os(binary);
+  storage.SavePersistentBinary(binary_os, false);
+
+  // load into another storage and check it saves the same text
+  ::testing::NiceMock<MockEntryNotifier> notifier2;
+  ::testing::NiceMock<MockRpcServer> rpc_server2;
+  Storage storage2(notifier2, rpc_server2, logger);
+  EXPECT_TRUE(storage2.LoadEntriesBinary(binary.str(), "", true, nullptr));
+  wpi::SmallString<256> text2;
+  wpi::raw_svector_ostream text2_os(text2);
+  storage2.SavePersistent(text2_os, false);
+  EXPECT_EQ(text.str(), text2.str());
+}
+
+TEST_P(StoragePersistentTest, LoadPersistentBinaryTruncated) {
+  for (auto& i : entries()) {
+    i.getValue()->flags = NT_PERSISTENT;
+  }
+  wpi::SmallString<256> binary;
+  wpi::raw_svector_ostream binary_os(binary);
+  storage.SavePersistentBinary(binary_os, false);
+
+  // an interrupted append loses only the last record
+  MockLoadWarn warn;
+  auto warn_func = [&](size_t line, const char* msg) { warn.Warn(line, msg); };
+  EXPECT_CALL(warn, Warn(23, std::string_view("incomplete or invalid record, "
+                                              "ignoring rest of file")));
+  ::testing::NiceMock<MockEntryNotifier> notifier2;
+  ::testing::NiceMock<MockRpcServer> rpc_server2;
+  Storage storage2(notifier2, rpc_server2, logger);
+  std::string_view data = binary.str();
+  data.remove_suffix(1);
+  EXPECT_TRUE(storage2.LoadEntriesBinary(data, "", true, warn_func));
+  EXPECT_EQ(22u, storage2.GetEntryInfo(0, "", 0).size());
+  EXPECT_FALSE(storage2.GetEntryValue("stringarr/two"));
+}
+
+TEST_P(StoragePersistentTest, SavePersistentBinaryJournal) {
+  EXPECT_CALL(dispatcher, QueueOutgoing(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(dispatcher, QueueOutgoingImmediate(_, _, _)).Times(AnyNumber());
+  EXPECT_CALL(notifier, NotifyEntry(_, _, _, _, _)).Times(AnyNumber());
+  for (auto& i : entries()) {
+    i.getValue()->flags = NT_PERSISTENT;
+  }
+  auto fn = (fs::temp_directory_path() /
+             fmt::format("ntcore_journal_test_{}.dat", GetParam()))
+                .string();
+  storage.SetPersistentBinary(true);
+
+  // first periodic save writes the whole file
+  ASSERT_EQ(nullptr, storage.SavePersistent(fn, true));
+  auto full_size = fs::file_size(fn);
+
+  // nothing changed, so nothing written
+  ASSERT_EQ(nullptr, storage.SavePersistent(fn, true));
+  EXPECT_EQ(full_size, fs::file_size(fn));
+
+  // changes are appended
+  storage.SetEntryValue("double/neg", Value::MakeDouble(2.5));
+  storage.DeleteEntry("string/normal");
+  storage.SetEntryTypeValue("new", Value::MakeDouble(1.0));
+  storage.SetEntryFlags("new", NT_PERSISTENT);
+  ASSERT_EQ(nullptr, storage.SavePersistent(fn, true));
+  auto journal_size = fs::file_size(fn);
+  EXPECT_GT(journal_size, full_size);
+  EXPECT_LT(journal_size - full_size, full_size / 4);
+
+  ::testing::NiceMock<MockEntryNotifier> notifier2;
+  ::testing::NiceMock<MockRpcServer> rpc_server2;
+  Storage storage2(notifier2, rpc_server2, logger);
+  ASSERT_EQ(nullptr, storage2.LoadPersistent(fn, nullptr));
+  EXPECT_EQ(*Value::MakeDouble(2.5), *storage2.GetEntryValue("double/neg"));
+  EXPECT_EQ(*Value::MakeDouble(1.0), *storage2.GetEntryValue("new"));
+  EXPECT_FALSE(storage2.GetEntryValue("string/normal"));
+  EXPECT_EQ(23u, storage2.GetEntryInfo(0, "", 0).size());
+
+  // a non-periodic save rewrites the whole file
+  ASSERT_EQ(nullptr, storage.SavePersistent(fn, false));
+  EXPECT_LT(fs::file_size(fn), journal_size);
+
+  std::remove(fn.c_str());
+  std::remove(fmt::format("{}.bak", fn).c_str());
+}
+
 TEST_P(StorageEmptyTest, ProcessIncomingEntryAssign) {
   auto conn = std::make_shared<MockNetworkConnection>();
   auto value = Value::MakeDouble(1.0);
@@ -917,11 +1031,12 @@ TEST_P(StoragePopulateOneTest, ProcessIncomingEntryAssignWithFlags) {
   auto value = Value::MakeDouble(1.0);
   EXPECT_CALL(*conn, proto_rev()).WillRepeatedly(Return(0x0300u));
   if (GetParam()) {
-    // server broadcasts new value/flags to all *other* connections
-    EXPECT_CALL(
-        dispatcher,
-        QueueOutgoing(MessageEq(Message::EntryAssign("foo", 0, 1, value, 0x2)),
-                      IsNull(), conn.get()));
+    // server broadcasts new value/flags to all *other* connections (right
+    // away, as 0x2 is NT_IMMEDIATE)
+    EXPECT_CALL(dispatcher, QueueOutgoingImmediate(
+                                MessageEq(Message::EntryAssign("foo", 0, 1,
+                                                               value, 0x2)),
+                                IsNull(), conn.get()));
     EXPECT_CALL(notifier,
                 NotifyEntry(0, std::string_view("foo"), ValueEq(value),
                             NT_NOTIFY_UPDATE | NT_NOTIFY_FLAGS, UINT_MAX));
@@ -0,0 +1,135 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <wpi/Logger.h>
+#include <wpi/raw_istream.h>
+
+#include "IDispatcher.h"
+#include "IEntryNotifier.h"
+#include "Message.h"
+#include "MockNetworkConnection.h"
+#include "MockRpcServer.h"
+#include "PoolAllocator.h"
+#include "Storage.h"
+#include "WireDecoder.h"
+#include "WireEncoder.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::nanoseconds;
+
+namespace nt {
+
+namespace {
+
+class NullDispatcher : public IDispatcher {
+ public:
+  void QueueOutgoing(std::shared_ptr<Message> msg, INetworkConnection* only,
+                     INetworkConnection* except) override {}
+  void QueueOutgoingImmediate(std::shared_ptr<Message> msg,
+                              INetworkConnection* only,
+                              INetworkConnection* except) override {}
+};
+
+class NullNotifier : public IEntryNotifier {
+ public:
+  bool local_notifiers() const override { return false; }
+  unsigned int Add(std::function<void(const EntryNotification& event)>,
+                   std::string_view, unsigned int) override {
+    return 0;
+  }
+  unsigned int Add(std::function<void(const EntryNotification& event)>,
+                   unsigned int, unsigned int) override {
+    return 0;
+  }
+  unsigned int AddPolled(unsigned int, std::string_view,
+                         unsigned int) override {
+    return 0;
+  }
+  unsigned int AddPolled(unsigned int, unsigned int, unsigned int) override {
+    return 0;
+  }
+  void NotifyEntry(unsigned int, std::string_view, std::shared_ptr<Value>,
+                   unsigned int, unsigned int) override {}
+};
+
+}  // namespace
+
+// Counts value pool misses per incoming update on the server, from decoding
+// the wire data through storing the value.
+TEST(ValueBenchTest, DISABLED_Decode) {
+  static constexpr int kNumUpdates = 10000;
+
+  wpi::Logger logger;
+  NullDispatcher dispatcher;
+  NullNotifier notifier;
+  ::testing::NiceMock<MockRpcServer> rpc_server;
+  Storage storage(notifier, rpc_server, logger);
+  storage.SetDispatcher(&dispatcher, true);
+  auto conn = std::make_shared<::testing::NiceMock<MockNetworkConnection>>();
+  ON_CALL(*conn, proto_rev()).WillByDefault(::testing::Return(0x0300));
+
+  struct Case {
+    const char* name;
+    std::shared_ptr<Value> value;
+  };
+  std::vector<Case> cases{
+      {"double", Value::MakeDouble(1.5)},
+      {"boolean[8]", Value::MakeBooleanArray(std::vector<int>(8, 1))},
+      {"double[12]", Value::MakeDoubleArray(std::vector<double>(12, 0.5))},
+      {"string", Value::MakeString("longer than the small string buffer")},
+  };
+
+  // the server assigns ids in order
+  for (auto&& c : cases) {
+    storage.ProcessIncoming(
+        Message::EntryAssign(fmt::format("/bench/{}", c.name), 0xffff, 1,
+                             c.value, 0),
+        conn.get(), conn);
+  }
+
+  Message::GetEntryTypeFunc get_entry_type = [](unsigned int) {
+    return NT_UNASSIGNED;
+  };
+  for (unsigned int id = 0; id < cases.size(); ++id) {
+    WireEncoder encoder(0x0300);
+    for (int i = 0; i < 2 * kNumUpdates; ++i) {
+      Message::EntryUpdate(id, i + 2, cases[id].value)->Write(encoder);
+    }
+    wpi::raw_mem_istream is(encoder.data(), encoder.size());
+    WireDecoder decoder(is, 0x0300, logger);
+
+    // warm up the allocator with the first half
+    for (int i = 0; i < kNumUpdates; ++i) {
+      storage.ProcessIncoming(Message::Read(decoder, get_entry_type),
+                              conn.get(), conn);
+    }
+
+    size_t upstream = pool::GetNumUpstreamAllocations();
+    auto start = high_resolution_clock::now();
+    for (int i = 0; i < kNumUpdates; ++i) {
+      auto msg = Message::Read(decoder, get_entry_type);
+      ASSERT_TRUE(msg);
+      storage.ProcessIncoming(std::move(msg), conn.get(), conn);
+    }
+    auto stop = high_resolution_clock::now();
+    upstream = pool::GetNumUpstreamAllocations() - upstream;
+
+    EXPECT_EQ(*cases[id].value,
+              *storage.GetEntryValue(fmt::format("/bench/{}", cases[id].name)));
+    fmt::print("{}: {:.2f} pool misses/update, {} ns/update\n", cases[id].name,
+               static_cast<double>(upstream) / kNumUpdates,
+        duration_cast<nanoseconds>(stop - start).count() / kNumUpdates);
+  }
+}
+
+}  // namespace nt
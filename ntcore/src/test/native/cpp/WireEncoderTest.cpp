@@ -9,6 +9,7 @@
 
 #include <wpi/StringExtras.h>
 
+#include "Message.h"
 #include "TestPrinters.h"
 #include "WireEncoder.h"
 #include "gtest/gtest.h"
@@ -497,4 +498,18 @@ TEST_F(WireEncoderTest, WriteString3) {
   EXPECT_EQ('x', e.data()[65539]);
 }
 
+TEST_F(WireEncoderTest, MessageGetEncoded) {
+  auto msg = Message::EntryAssign("foo", 5, 1, v_string_array_big, 0);
+  for (unsigned int proto_rev : {0x0200u, 0x0300u}) {
+    WireEncoder e(proto_rev);
+    msg->Write(e);
+    auto encoded = msg->GetEncoded(proto_rev);
+    ASSERT_TRUE(encoded);
+    EXPECT_EQ(e.ToStringView(), *encoded);
+    // encoded only once
+    EXPECT_EQ(encoded, msg->GetEncoded(proto_rev));
+  }
+  EXPECT_NE(*msg->GetEncoded(0x0200u), *msg->GetEncoded(0x0300u));
+}
+
 }  // namespace nt
@@ -8,6 +8,8 @@
 #include <cstddef>
 #include <string_view>
 
+#include <wpi/span.h>
+
 namespace wpi {
 
 class NetworkStream {
@@ -23,6 +25,31 @@ class NetworkStream {
   };
 
   virtual size_t send(const char* buffer, size_t len, Error* err) = 0;
+
+  /**
+   * Sends multiple buffers as if they were a single contiguous buffer.
+   * The default implementation calls send() for each buffer; implementations
+   * may override this to use scatter-gather I/O instead.
+   *
+   * @return total number of bytes sent, or 0 on error (err is set) or if all
+   *         buffers are empty (err is not set); if an error occurs after some
+   *         bytes were sent, the number sent is returned and the error is
+   *         reported by the next call
+   */
+  virtual size_t sendv(span<const std::string_view> bufs, Error* err) {
+    size_t total = 0;
+    for (auto&& buf : bufs) {
+      if (buf.empty()) {
+        continue;
+      }
+      size_t sent = send(buf.data(), buf.size(), err);
+      total += sent;
+      if (sent < buf.size()) {
+        break;
+      }
+    }
+    return total;
+  }
   virtual size_t receive(char* buffer, size_t len, Error* err,
                          int timeout = 0) = 0;
   virtual void close() = 0;
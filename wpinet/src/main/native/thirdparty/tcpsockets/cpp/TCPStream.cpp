@@ -30,12 +30,22 @@
 #include <ws2tcpip.h>
 #else
 #include <arpa/inet.h>
+#include <limits.h>
 #include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 
+#include <algorithm>
 #include <cerrno>
 
+#include <wpi/SmallVector.h>
+
+#if !defined(_WIN32) && !defined(IOV_MAX)
+#define IOV_MAX 16
+#endif
+
 using namespace wpi;
 
 TCPStream::TCPStream(int sd, sockaddr_in* address)
@@ -114,6 +124,99 @@ size_t TCPStream::send(const char* buffer, size_t len, Error* err) {
   return static_cast<size_t>(rv);
 }
 
+size_t TCPStream::sendv(span<const std::string_view> bufs, Error* err) {
+  if (m_sd < 0) {
+    *err = kConnectionClosed;
+    return 0;
+  }
+#ifdef _WIN32
+  SmallVector<WSABUF, 16> wsaBufs;
+  for (auto&& buf : bufs) {
+    if (!buf.empty()) {
+      wsaBufs.push_back({static_cast<ULONG>(buf.size()),
+                         const_cast<char*>(buf.data())});
+    }
+  }
+  // nothing to send; as on other platforms, not an error
+  if (wsaBufs.empty()) {
+    return 0;
+  }
+  DWORD rv;
+  bool result = true;
+  while (WSASend(m_sd, wsaBufs.data(), static_cast<DWORD>(wsaBufs.size()), &rv,
+                 0, nullptr, nullptr) == SOCKET_ERROR) {
+    if (WSAGetLastError() != WSAEWOULDBLOCK) {
+      result = false;
+      break;
+    }
+    if (!m_blocking) {
+      *err = kWouldBlock;
+      return 0;
+    }
+    Sleep(1);
+  }
+  if (!result) {
+    char Buffer[128];
+#ifdef _MSC_VER
+    sprintf_s(Buffer, "Send() failed: WSA error=%d\n", WSAGetLastError());
+#else
+    std::snprintf(Buffer, sizeof(Buffer), "Send() failed: WSA error=%d\n",
+                  WSAGetLastError());
+#endif
+    OutputDebugStringA(Buffer);
+    *err = kConnectionReset;
+    return 0;
+  }
+  return static_cast<size_t>(rv);
+#else
+  SmallVector<iovec, 16> iovs;
+  for (auto&& buf : bufs) {
+    if (!buf.empty()) {
+      iovs.push_back({const_cast<char*>(buf.data()), buf.size()});
+    }
+  }
+  // sendmsg() accepts at most IOV_MAX buffers and may send only part of them
+  size_t total = 0;
+  size_t i = 0;
+  while (i < iovs.size()) {
+    msghdr msg{};
+    msg.msg_iov = &iovs[i];
+    msg.msg_iovlen = std::min<size_t>(iovs.size() - i, IOV_MAX);
+#ifdef MSG_NOSIGNAL
+    // disable SIGPIPE on Linux
+    ssize_t rv = ::sendmsg(m_sd, &msg, MSG_NOSIGNAL);
+#else
+    ssize_t rv = ::sendmsg(m_sd, &msg, 0);
+#endif
+    if (rv < 0) {
+      // report what was sent; the error shows up on the next call
+      if (total > 0) {
+        return total;
+      }
+      if (!m_blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        *err = kWouldBlock;
+      } else {
+        *err = kConnectionReset;
+      }
+      return 0;
+    }
+    total += rv;
+    // skip fully sent buffers and trim a partially sent one
+    size_t n = rv;
+    while (i < iovs.size() && n >= iovs[i].iov_len) {
+      n -= iovs[i].iov_len;
+      ++i;
+    }
+    if (n > 0) {
+      iovs[i].iov_base = static_cast<char*>(iovs[i].iov_base) + n;
+      iovs[i].iov_len -= n;
+    }
+  }
+  // nothing to send if all buffers were empty; not an error
+  return total;
+#endif
+}
+
 size_t TCPStream::receive(char* buffer, size_t len, Error* err, int timeout) {
   if (m_sd < 0) {
     *err = kConnectionClosed;
@@ -208,6 +311,7 @@ bool TCPStream::setBlocking(bool enabled) {
     return false;
   }
 #endif
+  m_blocking = enabled;
   return true;
 }
 
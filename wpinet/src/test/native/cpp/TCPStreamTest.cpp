@@ -0,0 +1,72 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpinet/TCPStream.h"  // NOLINT(build/include_order)
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <wpi/Logger.h>
+
+#include "gtest/gtest.h"
+#include "wpinet/TCPAcceptor.h"
+#include "wpinet/TCPConnector.h"
+
+namespace wpi {
+
+class TCPStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(acceptor.start(), 0);
+    client = TCPConnector::connect("127.0.0.1", kPort, logger, 1);
+    ASSERT_TRUE(client);
+    server = acceptor.accept();
+    ASSERT_TRUE(server);
+  }
+
+  static constexpr int kPort = 37215;
+  Logger logger;
+  TCPAcceptor acceptor{kPort, "127.0.0.1", logger};
+  std::unique_ptr<NetworkStream> client;
+  std::unique_ptr<NetworkStream> server;
+};
+
+TEST_F(TCPStreamTest, SendvEmpty) {
+  std::string_view bufs[] = {{}, {}};
+  NetworkStream::Error err = NetworkStream::kConnectionClosed;
+  EXPECT_EQ(client->sendv(bufs, &err), 0u);
+  EXPECT_EQ(err, NetworkStream::kConnectionClosed);  // not set
+}
+
+TEST_F(TCPStreamTest, SendvPartialNonBlocking) {
+  ASSERT_TRUE(client->setBlocking(false));
+
+  // far more than the socket buffers hold, so the send is cut off
+  std::string a(16 * 1024 * 1024, 'a');
+  std::string b(16 * 1024 * 1024, 'b');
+  std::string_view bufs[] = {a, b};
+  NetworkStream::Error err = NetworkStream::kConnectionClosed;
+  size_t sent = client->sendv(bufs, &err);
+  EXPECT_GT(sent, 0u);
+  EXPECT_LT(sent, a.size() + b.size());
+  EXPECT_EQ(err, NetworkStream::kConnectionClosed);  // not set
+
+  // nothing has been read, so nothing more can be sent
+  EXPECT_EQ(client->sendv(bufs, &err), 0u);
+  EXPECT_EQ(err, NetworkStream::kWouldBlock);
+
+  // what was sent arrives intact
+  char buf[4096];
+  size_t received = 0;
+  while (received < sent) {
+    size_t len = server->receive(buf, sizeof(buf), &err, 1);
+    ASSERT_GT(len, 0u);
+    for (size_t i = 0; i < len; ++i, ++received) {
+      ASSERT_EQ(buf[i], received < a.size() ? 'a' : 'b');
+    }
+  }
+}
+
+}  // namespace wpi
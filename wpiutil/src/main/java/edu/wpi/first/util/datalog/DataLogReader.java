@@ -15,16 +15,23 @@ import java.nio.charset.StandardCharsets;
 import java.util.NoSuchElementException;
 import java.util.function.Consumer;
 
-/** Data log reader (reads logs written by the DataLog class). */
+/**
+ * Data log reader (reads logs written by the DataLog class).
+ *
+ * <p>Compressed logs are decompressed into memory when the reader is constructed.
+ */
 public class DataLogReader implements Iterable<DataLogRecord> {
+  // Extra header prefix marking a log whose records are stored in compressed frames
+  private static final String kCompressedHeader = "compression=lz4\n";
+
   /**
    * Constructs from a byte buffer.
    *
    * @param buffer byte buffer
    */
   public DataLogReader(ByteBuffer buffer) {
-    m_buf = buffer;
-    m_buf.order(ByteOrder.LITTLE_ENDIAN);
+    buffer.order(ByteOrder.LITTLE_ENDIAN);
+    m_buf = decompress(buffer);
   }
 
   /**
@@ -37,8 +44,8 @@ public class DataLogReader implements Iterable<DataLogRecord> {
     RandomAccessFile f = new RandomAccessFile(filename, "r");
     FileChannel channel = f.getChannel();
     MappedByteBuffer buf = channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
-    m_buf = buf;
-    m_buf.order(ByteOrder.LITTLE_ENDIAN);
+    buf.order(ByteOrder.LITTLE_ENDIAN);
+    m_buf = decompress(buf);
     channel.close();
     f.close();
   }
@@ -49,14 +56,18 @@ public class DataLogReader implements Iterable<DataLogRecord> {
    * @return True if valid, false otherwise
    */
   public boolean isValid() {
-    return m_buf.remaining() >= 12
-        && m_buf.get(0) == 'W'
-        && m_buf.get(1) == 'P'
-        && m_buf.get(2) == 'I'
-        && m_buf.get(3) == 'L'
-        && m_buf.get(4) == 'O'
-        && m_buf.get(5) == 'G'
-        && m_buf.getShort(6) >= 0x0100;
+    return isValid(m_buf);
+  }
+
+  private static boolean isValid(ByteBuffer buf) {
+    return buf.remaining() >= 12
+        && buf.get(0) == 'W'
+        && buf.get(1) == 'P'
+        && buf.get(2) == 'I'
+        && buf.get(3) == 'L'
+        && buf.get(4) == 'O'
+        && buf.get(5) == 'G'
+        && buf.getShort(6) >= 0x0100;
   }
 
   /**
@@ -73,20 +84,176 @@ public class DataLogReader implements Iterable<DataLogRecord> {
   }
 
   /**
-   * Gets the extra header data.
+   * Gets the extra header data. For compressed logs, this does not include the compression
+   * marker.
    *
    * @return Extra header data
    */
   public String getExtraHeader() {
-    ByteBuffer buf = m_buf.duplicate();
-    buf.order(ByteOrder.LITTLE_ENDIAN);
-    buf.position(8);
-    int size = buf.getInt();
+    String header = getRawExtraHeader(m_buf);
+    if (header.startsWith(kCompressedHeader)) {
+      return header.substring(kCompressedHeader.length());
+    }
+    return header;
+  }
+
+  /**
+   * Returns true if the data log was written compressed.
+   *
+   * @return True if compressed
+   */
+  public boolean isCompressed() {
+    return getRawExtraHeader(m_buf).startsWith(kCompressedHeader);
+  }
+
+  private static String getRawExtraHeader(ByteBuffer buf) {
+    if (buf.remaining() < 12) {
+      return "";
+    }
+    ByteBuffer dup = buf.duplicate();
+    dup.order(ByteOrder.LITTLE_ENDIAN);
+    dup.position(8);
+    int size = dup.getInt();
+    if (size < 0 || size > dup.remaining()) {
+      return "";
+    }
     byte[] arr = new byte[size];
-    buf.get(arr);
+    dup.get(arr);
     return new String(arr, StandardCharsets.UTF_8);
   }
 
+  // Returns the buffer with any compressed frames decompressed.  A truncated or corrupt log is
+  // read up to the last good frame.
+  private static ByteBuffer decompress(ByteBuffer buf) {
+    if (!isValid(buf) || !getRawExtraHeader(buf).startsWith(kCompressedHeader)) {
+      return buf;
+    }
+    int headerSize = 12 + buf.getInt(8);
+    int end = buf.remaining();
+
+    // total size of the complete frames; LZ4 can't compress better than 255:1, so larger sizes
+    // are corrupt
+    long size = headerSize;
+    for (int pos = headerSize; end - pos >= 8; ) {
+      long frameSize = buf.getInt(pos) & 0xffffffffL;
+      long compressedSize = buf.getInt(pos + 4) & 0xffffffffL;
+      if (compressedSize > end - pos - 8
+          || compressedSize > frameSize
+          || frameSize / 256 > compressedSize
+          || size + frameSize > Integer.MAX_VALUE) {
+        break;
+      }
+      size += frameSize;
+      pos += 8 + (int) compressedSize;
+    }
+
+    byte[] out = new byte[(int) size];
+    ByteBuffer in = buf.duplicate();
+    in.order(ByteOrder.LITTLE_ENDIAN);
+    in.get(out, 0, headerSize);
+    int outPos = headerSize;
+    while (outPos < size) {
+      int frameSize = in.getInt(in.position());
+      int compressedSize = in.getInt(in.position() + 4);
+      in.position(in.position() + 8);
+      if (compressedSize == frameSize) {
+        in.get(out, outPos, frameSize);
+      } else if (lz4Decompress(in, compressedSize, out, outPos, frameSize)) {
+        in.position(in.position() + compressedSize);
+      } else {
+        // keep the records before the corrupt frame
+        size = outPos;
+        break;
+      }
+      outPos += frameSize;
+    }
+    ByteBuffer rv = ByteBuffer.wrap(out, 0, (int) size).slice();
+    rv.order(ByteOrder.LITTLE_ENDIAN);
+    return rv;
+  }
+
+  // Decompresses a LZ4 block (the LZ4 block format, without the LZ4 frame format wrapper) of
+  // length len at the position of in.  Returns false if the block is malformed or does not
+  // decompress to exactly outLen bytes.  Does not change the position of in.
+  private static boolean lz4Decompress(
+      ByteBuffer in, int len, byte[] out, int outStart, int outLen) {
+    ByteBuffer src = in.duplicate();
+    int ip = src.position();
+    final int iend = ip + len;
+    int op = outStart;
+    final int oend = outStart + outLen;
+
+    while (ip < iend) {
+      int token = src.get(ip) & 0xff;
+      ip++;
+
+      // literals
+      int litLen = token >>> 4;
+      if (litLen == 15) {
+        int b;
+        do {
+          if (ip >= iend) {
+            return false;
+          }
+          b = src.get(ip) & 0xff;
+          ip++;
+          litLen += b;
+          if (litLen > oend - op) {
+            return false;
+          }
+        } while (b == 255);
+      }
+      if (litLen > iend - ip || litLen > oend - op) {
+        return false;
+      }
+      src.position(ip);
+      src.get(out, op, litLen);
+      ip += litLen;
+      op += litLen;
+
+      // the last sequence has no match
+      if (ip == iend) {
+        break;
+      }
+
+      // match
+      if (iend - ip < 2) {
+        return false;
+      }
+      int offset = (src.get(ip) & 0xff) | ((src.get(ip + 1) & 0xff) << 8);
+      ip += 2;
+      if (offset == 0 || offset > op - outStart) {
+        return false;
+      }
+      int matchLen = token & 0xf;
+      if (matchLen == 15) {
+        int b;
+        do {
+          if (ip >= iend) {
+            return false;
+          }
+          b = src.get(ip) & 0xff;
+          ip++;
+          matchLen += b;
+          if (matchLen > oend - op) {
+            return false;
+          }
+        } while (b == 255);
+      }
+      matchLen += 4; // minimum match length
+      if (matchLen > oend - op) {
+        return false;
+      }
+      // an overlapping match repeats the last offset bytes, so copy a byte at a time
+      for (int i = 0; i < matchLen; i++) {
+        out[op] = out[op - offset];
+        op++;
+      }
+    }
+
+    return op == oend;
+  }
+
   @Override
   public void forEach(Consumer<? super DataLogRecord> action) {
     int size = m_buf.remaining();
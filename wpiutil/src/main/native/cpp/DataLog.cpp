@@ -19,18 +19,24 @@
 
 #endif
 
+#include <algorithm>
 #include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "fmt/format.h"
+#include "wpi/DataLogStruct.h"
 #include "wpi/Endian.h"
 #include "wpi/Logger.h"
 #include "wpi/MathExtras.h"
+#include "wpi/SmallVector.h"
+#include "wpi/StringExtras.h"
 #include "wpi/fs.h"
+#include "wpi/lz4.h"
 #include "wpi/timestamp.h"
 
 using namespace wpi::log;
@@ -67,56 +73,319 @@ static unsigned int WriteRecordHeader(uint8_t* buf, uint32_t entry,
   return buf - origbuf;
 }
 
-class DataLog::Buffer {
+// Each thread appends records to its own chain of blocks, which the writer
+// thread drains (single producer, single consumer).  Every record in a chain
+// is prefixed by a 4-byte sequence number: for control records this is the
+// record's position in the sequence of control records, and for data records
+// it is the last control record that was complete when the record was
+// started.  The writer uses this to keep records that depend on a control
+// record (e.g. data following a start) after it when merging the chains.
+//
+// A record's prefix and header are always contiguous in one block; payloads
+// may be split across blocks.  The unused end of a block is skipped.
+class DataLog::ThreadBuffer {
  public:
-  explicit Buffer(size_t alloc = kBlockSize)
-      : m_buf{new uint8_t[alloc]}, m_maxLen{alloc} {}
-  ~Buffer() { delete[] m_buf; }
+  // numBlocks counts the blocks of the buffer holding or waiting for data,
+  // other than the one being appended to when all others have been read (so
+  // an idle buffer counts for nothing); blocks cached for reuse are not
+  // counted
+  explicit ThreadBuffer(std::atomic<size_t>& numBlocks)
+      : m_numBlocks{numBlocks}, m_tail{new Block}, m_head{m_tail} {}
+  ~ThreadBuffer();
+
+  ThreadBuffer(const ThreadBuffer&) = delete;
+  ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+
+  // producer side
+
+  uint8_t* Reserve(size_t size);
+  void Unreserve(size_t size) {
+    m_tailPos -= size;
+    m_written -= size;
+  }
+  void Append(wpi::span<const uint8_t> data);
+  void AppendString(std::string_view str);
+  // reserves the sequence number, record header, and reserveSize bytes of
+  // payload; returns a pointer to the payload
+  uint8_t* StartRecord(uint32_t seq, uint32_t entry, uint64_t timestamp,
+                       uint32_t payloadSize, size_t reserveSize);
+  // makes everything written so far visible to the writer thread
+  void Commit() { m_committed.store(m_written, std::memory_order_release); }
+  // returns the number of blocks that need to be added to append size bytes
+  // (conservatively, as payloads are split at block boundaries)
+  size_t GetNumNewBlocks(size_t size) const {
+    if (size <= kBlockSize - m_tailPos) {
+      return 0;
+    }
+    return size <= kBlockSize ? 1 : 2 + size / kBlockSize;
+  }
+
+  // consumer side
 
-  Buffer(const Buffer&) = delete;
-  Buffer& operator=(const Buffer&) = delete;
+  uint64_t GetCommitted() const {
+    return m_committed.load(std::memory_order_acquire);
+  }
+  uint64_t GetRead() const { return m_read; }
+  // returns the start of the next unread record
+  const uint8_t* Peek();
+  // consumes len bytes, appending them to out if not null
+  void Consume(size_t len, std::vector<uint8_t>* out);
+  // frees the blocks returned to the producer but not yet reused; returns the
+  // number of blocks freed
+  size_t FreeSpares();
+  // returns the number of blocks counted in numBlocks; only valid once
+  // orphaned
+  size_t GetNumBlocks() const;
+
+  // set when the owning thread exits
+  std::atomic_bool orphaned{false};
+  // set when the log is destroyed
+  std::atomic_bool closed{false};
+
+ private:
+  struct Block {
+    std::atomic<Block*> next{nullptr};
+    // number of bytes used; only valid once next is set
+    size_t size = 0;
+    uint8_t data[kBlockSize];
+  };
+
+  void TakeSpares();
+  void AdvanceHead();
+
+  std::atomic<size_t>& m_numBlocks;
+
+  // producer
+  Block* m_tail;
+  size_t m_tailPos = 0;
+  uint64_t m_written = 0;
+  Block* m_free = nullptr;
+
+  std::atomic<uint64_t> m_committed{0};
+  // blocks returned by the consumer
+  std::atomic<Block*> m_spare{nullptr};
+
+  // consumer
+  Block* m_head;
+  size_t m_headPos = 0;
+  uint64_t m_read = 0;
+};
 
-  Buffer(Buffer&& oth)
-      : m_buf{oth.m_buf}, m_len{oth.m_len}, m_maxLen{oth.m_maxLen} {
-    oth.m_buf = nullptr;
-    oth.m_len = 0;
-    oth.m_maxLen = 0;
+DataLog::ThreadBuffer::~ThreadBuffer() {
+  for (Block* list : {m_head, m_free, m_spare.load()}) {
+    while (list) {
+      Block* next = list->next.load(std::memory_order_relaxed);
+      delete list;
+      list = next;
+    }
   }
+}
 
-  Buffer& operator=(Buffer&& oth) {
-    if (m_buf) {
-      delete[] m_buf;
+uint8_t* DataLog::ThreadBuffer::Reserve(size_t size) {
+  assert(size <= kBlockSize);
+  if (size > kBlockSize - m_tailPos) {
+    if (!m_free) {
+      TakeSpares();
+    }
+    Block* block = m_free;
+    if (block) {
+      m_free = block->next.load(std::memory_order_relaxed);
+      block->next.store(nullptr, std::memory_order_relaxed);
+      block->size = 0;
+    } else {
+      block = new Block;
     }
-    m_buf = oth.m_buf;
-    m_len = oth.m_len;
-    m_maxLen = oth.m_maxLen;
-    oth.m_buf = nullptr;
-    oth.m_len = 0;
-    oth.m_maxLen = 0;
-    return *this;
+    m_numBlocks.fetch_add(1, std::memory_order_relaxed);
+    m_tail->size = m_tailPos;
+    m_tail->next.store(block, std::memory_order_release);
+    m_tail = block;
+    m_tailPos = 0;
   }
+  uint8_t* rv = m_tail->data + m_tailPos;
+  m_tailPos += size;
+  m_written += size;
+  return rv;
+}
 
-  uint8_t* Reserve(size_t size) {
-    assert(size <= GetRemaining());
-    uint8_t* rv = m_buf + m_len;
-    m_len += size;
-    return rv;
+void DataLog::ThreadBuffer::Append(wpi::span<const uint8_t> data) {
+  while (data.size() > kBlockSize) {
+    uint8_t* buf = Reserve(kBlockSize);
+    std::memcpy(buf, data.data(), kBlockSize);
+    data = data.subspan(kBlockSize);
   }
+  uint8_t* buf = Reserve(data.size());
+  std::memcpy(buf, data.data(), data.size());
+}
 
-  void Unreserve(size_t size) { m_len -= size; }
+void DataLog::ThreadBuffer::AppendString(std::string_view str) {
+  uint8_t* buf = Reserve(4);
+  wpi::support::endian::write32le(buf, str.size());
+  Append({reinterpret_cast<const uint8_t*>(str.data()), str.size()});
+}
 
-  void Clear() { m_len = 0; }
+void DataLog::ThreadBuffer::TakeSpares() {
+  Block* spare = m_spare.exchange(nullptr, std::memory_order_acquire);
+  while (spare) {
+    Block* next = spare->next.load(std::memory_order_relaxed);
+    spare->next.store(m_free, std::memory_order_relaxed);
+    m_free = spare;
+    spare = next;
+  }
+}
 
-  size_t GetRemaining() const { return m_maxLen - m_len; }
+size_t DataLog::ThreadBuffer::FreeSpares() {
+  Block* spare = m_spare.exchange(nullptr, std::memory_order_acquire);
+  size_t count = 0;
+  while (spare) {
+    Block* next = spare->next.load(std::memory_order_relaxed);
+    delete spare;
+    ++count;
+    spare = next;
+  }
+  return count;
+}
 
-  wpi::span<uint8_t> GetData() { return {m_buf, m_len}; }
-  wpi::span<const uint8_t> GetData() const { return {m_buf, m_len}; }
+size_t DataLog::ThreadBuffer::GetNumBlocks() const {
+  size_t count = 0;
+  for (Block* block = m_head->next.load(std::memory_order_relaxed); block;
+       block = block->next.load(std::memory_order_relaxed)) {
+    ++count;
+  }
+  return count;
+}
 
- private:
-  uint8_t* m_buf;
-  size_t m_len = 0;
-  size_t m_maxLen;
+void DataLog::ThreadBuffer::AdvanceHead() {
+  for (;;) {
+    Block* next = m_head->next.load(std::memory_order_acquire);
+    if (!next || m_headPos < m_head->size) {
+      return;
+    }
+    // return the finished block to the producer
+    Block* done = m_head;
+    m_head = next;
+    m_headPos = 0;
+    Block* spare = m_spare.load(std::memory_order_relaxed);
+    do {
+      done->next.store(spare, std::memory_order_relaxed);
+    } while (!m_spare.compare_exchange_weak(spare, done,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed));
+    m_numBlocks.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+const uint8_t* DataLog::ThreadBuffer::Peek() {
+  AdvanceHead();
+  return m_head->data + m_headPos;
+}
+
+void DataLog::ThreadBuffer::Consume(size_t len, std::vector<uint8_t>* out) {
+  m_read += len;
+  while (len > 0) {
+    AdvanceHead();
+    // if the block isn't finished, the committed bytes are all in it
+    size_t end = m_head->next.load(std::memory_order_acquire) ? m_head->size
+                                                              : kBlockSize;
+    size_t n = (std::min)(len, end - m_headPos);
+    if (out) {
+      out->insert(out->end(), m_head->data + m_headPos,
+                  m_head->data + m_headPos + n);
+    }
+    m_headPos += n;
+    len -= n;
+  }
+}
+
+namespace {
+struct RecordInfo {
+  uint32_t seq;
+  bool control;
+  uint64_t timestamp;
+  // including the sequence number prefix
+  size_t size;
 };
+}  // namespace
+
+static uint64_t ReadVarInt(const uint8_t* buf, unsigned int len) {
+  uint64_t val = 0;
+  for (unsigned int i = 0; i < len; ++i) {
+    val |= static_cast<uint64_t>(buf[i]) << (i * 8);
+  }
+  return val;
+}
+
+// size of a record as written to the log, including its header
+static size_t GetRecordSize(const uint8_t* buf) {
+  uint8_t lens = buf[0];
+  unsigned int entryLen = (lens & 0x3) + 1;
+  unsigned int payloadLen = ((lens >> 2) & 0x3) + 1;
+  unsigned int timestampLen = ((lens >> 4) & 0x7) + 1;
+  unsigned int headerLen = 1 + entryLen + payloadLen + timestampLen;
+  return headerLen + ReadVarInt(buf + 1 + entryLen, payloadLen);
+}
+
+// Splits records into frames of at most kCompressedFrameSize bytes (unless a
+// single record is larger) and compresses each frame independently.  Each
+// frame is its uncompressed size, its compressed size, and the compressed
+// data; frames that don't compress are stored as-is, with both sizes equal.
+static void CompressFrames(wpi::span<const uint8_t> records,
+                           std::vector<uint8_t>* out) {
+  while (!records.empty()) {
+    size_t size = 0;
+    do {
+      size += GetRecordSize(records.data() + size);
+    } while (size < records.size() &&
+             size + GetRecordSize(records.data() + size) <=
+                 impl::kCompressedFrameSize);
+    auto frame = records.subspan(0, size);
+    records = records.subspan(size);
+
+    size_t pos = out->size();
+    out->resize(pos + 8 + wpi::LZ4CompressBound(size));
+    uint8_t* header = out->data() + pos;
+    size_t compressedSize = wpi::LZ4Compress(
+        frame, {header + 8, wpi::LZ4CompressBound(size)});
+    if (compressedSize >= size) {
+      std::memcpy(header + 8, frame.data(), size);
+      compressedSize = size;
+    }
+    wpi::support::endian::write32le(header, size);
+    wpi::support::endian::write32le(header + 4, compressedSize);
+    out->resize(pos + 8 + compressedSize);
+  }
+}
+
+// returns the data to write for a flush of records
+static wpi::span<const uint8_t> EncodeRecords(
+    const std::vector<uint8_t>& records, bool compressed,
+    std::vector<uint8_t>* frames) {
+  if (!compressed) {
+    return records;
+  }
+  frames->clear();
+  CompressFrames(records, frames);
+  return *frames;
+}
+
+static RecordInfo ParseRecord(const uint8_t* buf) {
+  RecordInfo info;
+  info.seq = wpi::support::endian::read32le(buf);
+  uint8_t lens = buf[4];
+  unsigned int entryLen = (lens & 0x3) + 1;
+  unsigned int payloadLen = ((lens >> 2) & 0x3) + 1;
+  unsigned int timestampLen = ((lens >> 4) & 0x7) + 1;
+  const uint8_t* p = buf + 5;
+  info.control = ReadVarInt(p, entryLen) == 0;
+  p += entryLen;
+  uint64_t payloadSize = ReadVarInt(p, payloadLen);
+  p += payloadLen;
+  info.timestamp = ReadVarInt(p, timestampLen);
+  p += timestampLen;
+  info.size = (p - buf) + payloadSize;
+  return info;
+}
+
+static std::atomic<uint64_t> gNextLogId{1};
 
 static void DefaultLog(unsigned int level, const char* file, unsigned int line,
                        const char* msg) {
@@ -129,29 +398,44 @@ static void DefaultLog(unsigned int level, const char* file, unsigned int line,
 
 static wpi::Logger defaultMessageLog{DefaultLog};
 
+static std::string MakeExtraHeader(std::string_view extraHeader,
+                                   bool compressed) {
+  if (compressed) {
+    return fmt::format("{}{}", impl::kCompressedHeader, extraHeader);
+  } else {
+    return std::string{extraHeader};
+  }
+}
+
 DataLog::DataLog(std::string_view dir, std::string_view filename, double period,
-                 std::string_view extraHeader)
-    : DataLog{defaultMessageLog, dir, filename, period, extraHeader} {}
+                 std::string_view extraHeader, bool compressed)
+    : DataLog{defaultMessageLog, dir, filename, period, extraHeader,
+              compressed} {}
 
 DataLog::DataLog(wpi::Logger& msglog, std::string_view dir,
                  std::string_view filename, double period,
-                 std::string_view extraHeader)
+                 std::string_view extraHeader, bool compressed)
     : m_msglog{msglog},
       m_period{period},
-      m_extraHeader{extraHeader},
+      m_compressed{compressed},
+      m_extraHeader{MakeExtraHeader(extraHeader, compressed)},
       m_newFilename{filename},
+      m_id{gNextLogId++},
       m_thread{[this, dir = std::string{dir}] { WriterThreadMain(dir); }} {}
 
 DataLog::DataLog(std::function<void(wpi::span<const uint8_t> data)> write,
-                 double period, std::string_view extraHeader)
-    : DataLog{defaultMessageLog, std::move(write), period, extraHeader} {}
+                 double period, std::string_view extraHeader, bool compressed)
+    : DataLog{defaultMessageLog, std::move(write), period, extraHeader,
+              compressed} {}
 
 DataLog::DataLog(wpi::Logger& msglog,
                  std::function<void(wpi::span<const uint8_t> data)> write,
-                 double period, std::string_view extraHeader)
+                 double period, std::string_view extraHeader, bool compressed)
     : m_msglog{msglog},
       m_period{period},
-      m_extraHeader{extraHeader},
+      m_compressed{compressed},
+      m_extraHeader{MakeExtraHeader(extraHeader, compressed)},
+      m_id{gNextLogId++},
       m_thread{[this, write = std::move(write)] {
         WriterThreadMain(std::move(write));
       }} {}
@@ -163,7 +447,11 @@ DataLog::~DataLog() {
     m_doFlush = true;
   }
   m_cond.notify_all();
+  m_spaceCond.notify_all();
   m_thread.join();
+  for (auto&& buf : m_threadBuffers) {
+    buf->closed = true;
+  }
 }
 
 void DataLog::SetFilename(std::string_view filename) {
@@ -183,15 +471,39 @@ void DataLog::Flush() {
 }
 
 void DataLog::Pause() {
-  std::scoped_lock lock{m_mutex};
   m_paused = true;
 }
 
 void DataLog::Resume() {
-  std::scoped_lock lock{m_mutex};
   m_paused = false;
 }
 
+void DataLog::SetMemoryLimit(size_t bytes, LimitPolicy policy) {
+  m_limitPolicy = policy;
+  m_maxBlocks = (bytes + kBlockSize - 1) / kBlockSize;
+  // let blocked appends recheck
+  std::scoped_lock lock{m_mutex};
+  m_spaceCond.notify_all();
+}
+
+void DataLog::SetMinFreeSpace(uintmax_t bytes) {
+  m_minFreeSpace = bytes;
+}
+
+void DataLog::SetLowPriority(int entry, bool lowPriority) {
+  if (entry <= 0) {
+    return;
+  }
+  std::scoped_lock lock{m_mutex};
+  m_entryStats[entry].lowPriority = lowPriority;
+}
+
+uint64_t DataLog::GetDroppedCount(int entry) const {
+  std::scoped_lock lock{m_mutex};
+  auto it = m_entryStats.find(entry);
+  return it == m_entryStats.end() ? 0 : it->second.dropped;
+}
+
 static void WriteToFile(fs::file_t f, wpi::span<const uint8_t> data,
                         std::string_view filename, wpi::Logger& msglog) {
   do {
@@ -296,13 +608,41 @@ void DataLog::WriterThreadMain(std::string_view dir) {
     }
   }
 
-  std::vector<Buffer> toWrite;
+  // drops data records if the disk is low on space; called with m_mutex held
+  bool lowSpace = false;
+  auto checkSpace = [&](std::vector<uint8_t>* records) {
+    uintmax_t minFree = m_minFreeSpace.load(std::memory_order_relaxed);
+    if (minFree == 0 || f == fs::kInvalidFile) {
+      return;
+    }
+    std::error_code spaceEc;
+    auto space = fs::space(dirPath, spaceEc);
+    bool low = !spaceEc && space.available < minFree;
+    if (low != lowSpace) {
+      lowSpace = low;
+      if (low) {
+        WPI_WARNING(m_msglog,
+                    "Less than {} bytes free on disk, dropping data records",
+                    minFree);
+      } else {
+        WPI_INFO(m_msglog, "{}", "Disk space available, resuming data records");
+      }
+    }
+    if (low) {
+      DropRecords(records);
+    }
+  };
+
+  std::vector<uint8_t> toWrite;
+  std::vector<uint8_t> frames;
 
   std::unique_lock lock{m_mutex};
   while (m_active) {
     bool doFlush = false;
     auto timeoutTime = std::chrono::steady_clock::now() + periodTime;
-    if (m_cond.wait_until(lock, timeoutTime) == std::cv_status::timeout) {
+    // a flush may have been requested while writing
+    if (!m_doFlush &&
+        m_cond.wait_until(lock, timeoutTime) == std::cv_status::timeout) {
       doFlush = true;
     }
 
@@ -328,18 +668,17 @@ void DataLog::WriterThreadMain(std::string_view dir) {
     if (doFlush || m_doFlush) {
       // flush to file
       m_doFlush = false;
-      if (m_outgoing.empty()) {
+      LogDroppedCounts(lock);
+      CollectRecords(&toWrite, lock);
+      checkSpace(&toWrite);
+      if (toWrite.empty()) {
         continue;
       }
-      // swap outgoing with empty vector
-      toWrite.swap(m_outgoing);
 
       if (f != fs::kInvalidFile) {
         lock.unlock();
-        // write buffers to file
-        for (auto&& buf : toWrite) {
-          WriteToFile(f, buf.GetData(), filename, m_msglog);
-        }
+        WriteToFile(f, EncodeRecords(toWrite, m_compressed, &frames), filename,
+                    m_msglog);
 
         // sync to storage
 #if defined(__linux__)
@@ -349,17 +688,20 @@ void DataLog::WriterThreadMain(std::string_view dir) {
 #endif
         lock.lock();
       }
-
-      // release buffers back to free list
-      for (auto&& buf : toWrite) {
-        buf.Clear();
-        m_free.emplace_back(std::move(buf));
-      }
-      toWrite.resize(0);
+      toWrite.clear();
     }
   }
 
+  // write anything appended after the last flush
+  LogDroppedCounts(lock);
+  CollectRecords(&toWrite, lock);
+  checkSpace(&toWrite);
+  lock.unlock();
   if (f != fs::kInvalidFile) {
+    if (!toWrite.empty()) {
+      WriteToFile(f, EncodeRecords(toWrite, m_compressed, &frames), filename,
+                  m_msglog);
+    }
     fs::CloseFile(f);
   }
 }
@@ -381,44 +723,332 @@ void DataLog::WriterThreadMain(
     }
   }
 
-  std::vector<Buffer> toWrite;
+  std::vector<uint8_t> toWrite;
+  std::vector<uint8_t> frames;
 
   std::unique_lock lock{m_mutex};
   while (m_active) {
     bool doFlush = false;
     auto timeoutTime = std::chrono::steady_clock::now() + periodTime;
-    if (m_cond.wait_until(lock, timeoutTime) == std::cv_status::timeout) {
+    // a flush may have been requested while writing
+    if (!m_doFlush &&
+        m_cond.wait_until(lock, timeoutTime) == std::cv_status::timeout) {
       doFlush = true;
     }
 
     if (doFlush || m_doFlush) {
       // flush to file
       m_doFlush = false;
-      if (m_outgoing.empty()) {
+      LogDroppedCounts(lock);
+      CollectRecords(&toWrite, lock);
+      if (toWrite.empty()) {
         continue;
       }
-      // swap outgoing with empty vector
-      toWrite.swap(m_outgoing);
 
       lock.unlock();
-      // write buffers
-      for (auto&& buf : toWrite) {
-        if (!buf.GetData().empty()) {
-          write(buf.GetData());
+      write(EncodeRecords(toWrite, m_compressed, &frames));
+      lock.lock();
+      toWrite.clear();
+    }
+  }
+
+  // write anything appended after the last flush
+  LogDroppedCounts(lock);
+  CollectRecords(&toWrite, lock);
+  lock.unlock();
+  if (!toWrite.empty()) {
+    write(EncodeRecords(toWrite, m_compressed, &frames));
+  }
+
+  write({});  // indicate EOF
+}
+
+DataLog::ThreadBuffer& DataLog::GetThreadBuffer() {
+  // buffers of the calling thread, by log id; a thread usually only logs to
+  // one or two logs
+  thread_local bool exited = false;
+  struct ThreadBuffers {
+    ~ThreadBuffers() {
+      exited = true;
+      for (auto&& buf : buffers) {
+        buf.second->orphaned = true;
+      }
+    }
+    std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> buffers;
+  };
+  thread_local ThreadBuffers threadBuffers;
+  // used after threadBuffers is destroyed (e.g. logging from a static
+  // destructor); kept by the log until it is destroyed
+  thread_local std::pair<uint64_t, ThreadBuffer*> exitBuffer{0, nullptr};
+
+  if (exited) {
+    if (exitBuffer.first != m_id) {
+      auto buf = std::make_shared<ThreadBuffer>(m_numBlocks);
+      std::scoped_lock lock{m_mutex};
+      m_threadBuffers.emplace_back(buf);
+      exitBuffer = {m_id, buf.get()};
+    }
+    return *exitBuffer.second;
+  }
+
+  for (auto&& buf : threadBuffers.buffers) {
+    if (buf.first == m_id) {
+      return *buf.second;
+    }
+  }
+
+  // forget buffers of destroyed logs
+  auto& buffers = threadBuffers.buffers;
+  buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                               [](const auto& buf) {
+                                 return buf.second->closed.load();
+                               }),
+                buffers.end());
+
+  auto buf = std::make_shared<ThreadBuffer>(m_numBlocks);
+  {
+    std::scoped_lock lock{m_mutex};
+    m_threadBuffers.emplace_back(buf);
+  }
+  threadBuffers.buffers.emplace_back(m_id, buf);
+  return *buf;
+}
+
+uint8_t* DataLog::ThreadBuffer::StartRecord(uint32_t seq, uint32_t entry,
+                                            uint64_t timestamp,
+                                            uint32_t payloadSize,
+                                            size_t reserveSize) {
+  uint8_t* buf = Reserve(4 + kRecordMaxHeaderSize + reserveSize);
+  wpi::support::endian::write32le(buf, seq);
+  buf += 4;
+  auto headerLen = WriteRecordHeader(buf, entry, timestamp, payloadSize);
+  Unreserve(kRecordMaxHeaderSize - headerLen);
+  buf += headerLen;
+  return buf;
+}
+
+uint8_t* DataLog::StartRecord(ThreadBuffer& buf, uint32_t entry,
+                              uint64_t timestamp, uint32_t payloadSize,
+                              size_t reserveSize) {
+  if (m_maxBlocks.load(std::memory_order_relaxed) != 0 &&
+      !CheckMemoryLimit(buf, entry, 4 + kRecordMaxHeaderSize + payloadSize)) {
+    return nullptr;
+  }
+  return buf.StartRecord(m_controlSeq.load(std::memory_order_acquire), entry,
+                         timestamp, payloadSize, reserveSize);
+}
+
+uint8_t* DataLog::StartControlRecord(ThreadBuffer& buf, uint64_t timestamp,
+                                     uint32_t payloadSize,
+                                     size_t reserveSize) {
+  return buf.StartRecord(m_controlSeq.load(std::memory_order_relaxed) + 1, 0,
+                         timestamp, payloadSize, reserveSize);
+}
+
+bool DataLog::CheckMemoryLimit(ThreadBuffer& buf, int entry, size_t size) {
+  size_t newBlocks = buf.GetNumNewBlocks(size);
+  if (newBlocks == 0) {
+    return true;
+  }
+  size_t maxBlocks = m_maxBlocks.load(std::memory_order_relaxed);
+  auto policy = m_limitPolicy.load(std::memory_order_relaxed);
+  size_t numBlocks = m_numBlocks.load(std::memory_order_relaxed) + newBlocks;
+  if (numBlocks <= maxBlocks &&
+      (policy != LimitPolicy::kDropLowPriority || numBlocks <= maxBlocks / 2)) {
+    return true;
+  }
+
+  std::unique_lock lock{m_mutex};
+  if (policy == LimitPolicy::kDropLowPriority && numBlocks <= maxBlocks) {
+    auto it = m_entryStats.find(entry);
+    if (it == m_entryStats.end() || !it->second.lowPriority) {
+      return true;
+    }
+  }
+  if (policy == LimitPolicy::kBlock) {
+    uint64_t idleFlushes = m_idleFlushes;
+    while (m_active) {
+      // have the writer thread write out and release blocks now
+      m_limited = true;
+      m_doFlush = true;
+      m_cond.notify_all();
+      m_spaceCond.wait(lock);
+      maxBlocks = m_maxBlocks.load(std::memory_order_relaxed);
+      // a record larger than the limit is let through once nothing else is
+      // buffered, as waiting longer can't free more blocks
+      if (maxBlocks == 0 ||
+          m_numBlocks.load(std::memory_order_relaxed) + newBlocks <=
+              maxBlocks ||
+          m_idleFlushes != idleFlushes) {
+        break;
+      }
+    }
+    return true;
+  }
+  m_limited = true;
+  ++m_entryStats[entry].dropped;
+  return false;
+}
+
+void DataLog::FinishControlRecord(ThreadBuffer& buf) {
+  buf.Commit();
+  // records started after this depend on the control record
+  m_controlSeq.fetch_add(1, std::memory_order_release);
+}
+
+void DataLog::CollectRecords(std::vector<uint8_t>* out,
+                             std::unique_lock<wpi::mutex>& lock) {
+  // drop buffers of exited threads once they have been drained
+  m_threadBuffers.erase(
+      std::remove_if(m_threadBuffers.begin(), m_threadBuffers.end(),
+                     [&](const auto& buf) {
+                       if (buf->orphaned &&
+                           buf->GetRead() == buf->GetCommitted()) {
+                         m_numBlocks -= buf->GetNumBlocks();
+                         return true;
+                       }
+                       return false;
+                     }),
+      m_threadBuffers.end());
+
+  struct Stream {
+    ThreadBuffer* buf;
+    uint64_t end;
+    RecordInfo next;
+    bool hasNext;
+  };
+  wpi::SmallVector<Stream, 8> streams;
+  for (auto&& buf : m_threadBuffers) {
+    uint64_t end = buf->GetCommitted();
+    if (buf->GetRead() != end) {
+      streams.push_back({buf.get(), end, {}, false});
+    }
+  }
+  if (streams.empty()) {
+    ++m_idleFlushes;
+    ReleaseBlocks();
+    return;
+  }
+
+  // buffers are only removed by this thread, so they can be used unlocked
+  lock.unlock();
+  for (;;) {
+    // find the earliest record that can be written
+    Stream* earliest = nullptr;
+    for (auto&& stream : streams) {
+      if (!stream.hasNext) {
+        if (stream.buf->GetRead() == stream.end) {
+          continue;
         }
+        stream.next = ParseRecord(stream.buf->Peek());
+        stream.hasNext = true;
       }
-      lock.lock();
+      // a record that depends on a control record that isn't visible yet
+      // waits for the next flush
+      bool ready = stream.next.control
+                       ? stream.next.seq == m_controlWritten + 1
+                       : stream.next.seq <= m_controlWritten;
+      if (ready &&
+          (!earliest || stream.next.timestamp < earliest->next.timestamp)) {
+        earliest = &stream;
+      }
+    }
+    if (!earliest) {
+      break;
+    }
+
+    earliest->buf->Consume(4, nullptr);
+    earliest->buf->Consume(earliest->next.size - 4, out);
+    if (earliest->next.control) {
+      m_controlWritten = earliest->next.seq;
+    }
+    earliest->hasNext = false;
+  }
+  lock.lock();
+  ReleaseBlocks();
+}
 
-      // release buffers back to free list
-      for (auto&& buf : toWrite) {
-        buf.Clear();
-        m_free.emplace_back(std::move(buf));
+void DataLog::ReleaseBlocks() {
+  if (!m_limited) {
+    return;
+  }
+  m_limited = false;
+  // blocks recycled to one thread can't be used by others, so free them
+  for (auto&& buf : m_threadBuffers) {
+    buf->FreeSpares();
+  }
+  m_spaceCond.notify_all();
+}
+
+void DataLog::DropRecords(std::vector<uint8_t>* records) {
+  size_t outPos = 0;
+  for (size_t pos = 0; pos < records->size();) {
+    const uint8_t* record = records->data() + pos;
+    size_t size = GetRecordSize(record);
+    int entry = ReadVarInt(record + 1, (record[0] & 0x3) + 1);
+    auto it = entry == 0 ? m_entryStats.end() : m_entryStats.find(entry);
+    if (entry != 0 && (it == m_entryStats.end() || !it->second.stats)) {
+      ++m_entryStats[entry].dropped;
+    } else {
+      std::memmove(records->data() + outPos, record, size);
+      outPos += size;
+    }
+    pos += size;
+  }
+  records->resize(outPos);
+}
+
+void DataLog::LogDroppedCounts(std::unique_lock<wpi::mutex>& lock) {
+  struct Update {
+    int entry;
+    int statsEntry;
+    uint64_t count;
+    std::string name;
+  };
+  std::vector<Update> updates;
+  for (auto&& [entry, stats] : m_entryStats) {
+    if (stats.dropped != stats.droppedLogged) {
+      stats.droppedLogged = stats.dropped;
+      updates.push_back({entry, stats.statsEntry, stats.dropped, {}});
+    }
+  }
+  if (updates.empty()) {
+    return;
+  }
+  for (auto&& update : updates) {
+    if (update.statsEntry == 0) {
+      for (auto&& entry : m_entries) {
+        if (entry.second.id == update.entry) {
+          update.name = entry.first();
+          break;
+        }
       }
-      toWrite.resize(0);
     }
   }
 
-  write({});  // indicate EOF
+  lock.unlock();
+  for (auto&& update : updates) {
+    if (update.statsEntry == 0) {
+      update.statsEntry = Start(
+          fmt::format("DataLog/dropped/{}", wpi::ltrim(update.name, '/')),
+          "int64");
+    }
+  }
+  // bypasses the memory limit
+  auto& tbuf = GetThreadBuffer();
+  for (auto&& update : updates) {
+    uint8_t* buf =
+        tbuf.StartRecord(m_controlSeq.load(std::memory_order_acquire),
+                         update.statsEntry, 0, 8, 8);
+    wpi::support::endian::write64le(buf, update.count);
+    tbuf.Commit();
+  }
+  lock.lock();
+
+  for (auto&& update : updates) {
+    m_entryStats[update.entry].statsEntry = update.statsEntry;
+    m_entryStats[update.statsEntry].stats = true;
+  }
 }
 
 // Control records use the following format:
@@ -428,6 +1058,7 @@ void DataLog::WriterThreadMain(
 
 int DataLog::Start(std::string_view name, std::string_view type,
                    std::string_view metadata, int64_t timestamp) {
+  auto& tbuf = GetThreadBuffer();
   std::scoped_lock lock{m_mutex};
   auto& entryInfo = m_entries[name];
   if (entryInfo.id == 0) {
@@ -446,12 +1077,13 @@ int DataLog::Start(std::string_view name, std::string_view type,
   }
   entryInfo.type = type;
   size_t strsize = name.size() + type.size() + metadata.size();
-  uint8_t* buf = StartRecord(0, timestamp, 5 + 12 + strsize, 5);
+  uint8_t* buf = StartControlRecord(tbuf, timestamp, 5 + 12 + strsize, 5);
   *buf++ = impl::kControlStart;
   wpi::support::endian::write32le(buf, entryInfo.id);
-  AppendStringImpl(name);
-  AppendStringImpl(type);
-  AppendStringImpl(metadata);
+  tbuf.AppendString(name);
+  tbuf.AppendString(type);
+  tbuf.AppendString(metadata);
+  FinishControlRecord(tbuf);
 
   return entryInfo.id;
 }
@@ -460,6 +1092,7 @@ void DataLog::Finish(int entry, int64_t timestamp) {
   if (entry <= 0) {
     return;
   }
+  auto& tbuf = GetThreadBuffer();
   std::scoped_lock lock{m_mutex};
   auto& savedCount = m_entryCounts[entry];
   if (savedCount == 0) {
@@ -470,9 +1103,10 @@ void DataLog::Finish(int entry, int64_t timestamp) {
     return;
   }
   m_entryCounts.erase(entry);
-  uint8_t* buf = StartRecord(0, timestamp, 5, 5);
+  uint8_t* buf = StartControlRecord(tbuf, timestamp, 5, 5);
   *buf++ = impl::kControlFinish;
   wpi::support::endian::write32le(buf, entry);
+  FinishControlRecord(tbuf);
 }
 
 void DataLog::SetMetadata(int entry, std::string_view metadata,
@@ -480,140 +1114,138 @@ void DataLog::SetMetadata(int entry, std::string_view metadata,
   if (entry <= 0) {
     return;
   }
+  auto& tbuf = GetThreadBuffer();
   std::scoped_lock lock{m_mutex};
-  uint8_t* buf = StartRecord(entry, timestamp, 5 + 4 + metadata.size(), 5);
+  uint8_t* buf =
+      StartControlRecord(tbuf, timestamp, 5 + 4 + metadata.size(), 5);
   *buf++ = impl::kControlSetMetadata;
   wpi::support::endian::write32le(buf, entry);
-  AppendStringImpl(metadata);
-}
-
-uint8_t* DataLog::Reserve(size_t size) {
-  assert(size <= kBlockSize);
-  if (m_outgoing.empty() || size > m_outgoing.back().GetRemaining()) {
-    if (m_free.empty()) {
-      m_outgoing.emplace_back();
-    } else {
-      m_outgoing.emplace_back(std::move(m_free.back()));
-      m_free.pop_back();
-    }
-  }
-  return m_outgoing.back().Reserve(size);
-}
-
-uint8_t* DataLog::StartRecord(uint32_t entry, uint64_t timestamp,
-                              uint32_t payloadSize, size_t reserveSize) {
-  uint8_t* buf = Reserve(kRecordMaxHeaderSize + reserveSize);
-  auto headerLen = WriteRecordHeader(buf, entry, timestamp, payloadSize);
-  m_outgoing.back().Unreserve(kRecordMaxHeaderSize - headerLen);
-  buf += headerLen;
-  return buf;
-}
-
-void DataLog::AppendImpl(wpi::span<const uint8_t> data) {
-  while (data.size() > kBlockSize) {
-    uint8_t* buf = Reserve(kBlockSize);
-    std::memcpy(buf, data.data(), kBlockSize);
-    data = data.subspan(kBlockSize);
-  }
-  uint8_t* buf = Reserve(data.size());
-  std::memcpy(buf, data.data(), data.size());
+  tbuf.AppendString(metadata);
+  FinishControlRecord(tbuf);
 }
 
-void DataLog::AppendStringImpl(std::string_view str) {
-  uint8_t* buf = Reserve(4);
-  wpi::support::endian::write32le(buf, str.size());
-  AppendImpl({reinterpret_cast<const uint8_t*>(str.data()), str.size()});
+std::string DataLog::AddStructSchema(std::string_view name,
+                                     std::string_view schema,
+                                     int64_t timestamp) {
+  auto type = fmt::format("{}{}", kStructTypePrefix, name);
+  Start(fmt::format("{}{}", kStructSchemaPrefix, type), kStructSchemaType,
+        schema, timestamp);
+  return type;
 }
 
 void DataLog::AppendRaw(int entry, wpi::span<const uint8_t> data,
                         int64_t timestamp) {
-  if (entry <= 0) {
+  if (entry <= 0 || m_paused) {
     return;
   }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
-    return;
-  }
-  StartRecord(entry, timestamp, data.size(), 0);
-  AppendImpl(data);
+  AppendRaw(GetThreadBuffer(), entry, data, timestamp);
 }
 
 void DataLog::AppendRaw2(int entry,
                          wpi::span<const wpi::span<const uint8_t>> data,
                          int64_t timestamp) {
-  if (entry <= 0) {
-    return;
-  }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
+  if (entry <= 0 || m_paused) {
     return;
   }
+  auto& tbuf = GetThreadBuffer();
   size_t size = 0;
   for (auto&& chunk : data) {
     size += chunk.size();
   }
-  StartRecord(entry, timestamp, size, 0);
+  if (!StartRecord(tbuf, entry, timestamp, size, 0)) {
+    return;
+  }
   for (auto chunk : data) {
-    AppendImpl(chunk);
+    tbuf.Append(chunk);
   }
+  tbuf.Commit();
 }
 
 void DataLog::AppendBoolean(int entry, bool value, int64_t timestamp) {
-  if (entry <= 0) {
+  if (entry <= 0 || m_paused) {
     return;
   }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
+  AppendBoolean(GetThreadBuffer(), entry, value, timestamp);
+}
+
+void DataLog::AppendInteger(int entry, int64_t value, int64_t timestamp) {
+  if (entry <= 0 || m_paused) {
     return;
   }
-  uint8_t* buf = StartRecord(entry, timestamp, 1, 1);
-  buf[0] = value ? 1 : 0;
+  AppendInteger(GetThreadBuffer(), entry, value, timestamp);
 }
 
-void DataLog::AppendInteger(int entry, int64_t value, int64_t timestamp) {
-  if (entry <= 0) {
+void DataLog::AppendFloat(int entry, float value, int64_t timestamp) {
+  if (entry <= 0 || m_paused) {
     return;
   }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
+  AppendFloat(GetThreadBuffer(), entry, value, timestamp);
+}
+
+void DataLog::AppendDouble(int entry, double value, int64_t timestamp) {
+  if (entry <= 0 || m_paused) {
     return;
   }
-  uint8_t* buf = StartRecord(entry, timestamp, 8, 8);
-  wpi::support::endian::write64le(buf, value);
+  AppendDouble(GetThreadBuffer(), entry, value, timestamp);
 }
 
-void DataLog::AppendFloat(int entry, float value, int64_t timestamp) {
-  if (entry <= 0) {
+void DataLog::AppendRaw(ThreadBuffer& tbuf, int entry,
+                        wpi::span<const uint8_t> data, int64_t timestamp) {
+  if (!StartRecord(tbuf, entry, timestamp, data.size(), 0)) {
     return;
   }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
+  tbuf.Append(data);
+  tbuf.Commit();
+}
+
+void DataLog::AppendBoolean(ThreadBuffer& tbuf, int entry, bool value,
+                            int64_t timestamp) {
+  uint8_t* buf = StartRecord(tbuf, entry, timestamp, 1, 1);
+  if (!buf) {
+    return;
+  }
+  buf[0] = value ? 1 : 0;
+  tbuf.Commit();
+}
+
+void DataLog::AppendInteger(ThreadBuffer& tbuf, int entry, int64_t value,
+                            int64_t timestamp) {
+  uint8_t* buf = StartRecord(tbuf, entry, timestamp, 8, 8);
+  if (!buf) {
+    return;
+  }
+  wpi::support::endian::write64le(buf, value);
+  tbuf.Commit();
+}
+
+void DataLog::AppendFloat(ThreadBuffer& tbuf, int entry, float value,
+                          int64_t timestamp) {
+  uint8_t* buf = StartRecord(tbuf, entry, timestamp, 4, 4);
+  if (!buf) {
     return;
   }
-  uint8_t* buf = StartRecord(entry, timestamp, 4, 4);
   if constexpr (wpi::support::endian::system_endianness() ==
                 wpi::support::little) {
     std::memcpy(buf, &value, 4);
   } else {
     wpi::support::endian::write32le(buf, wpi::FloatToBits(value));
   }
+  tbuf.Commit();
 }
 
-void DataLog::AppendDouble(int entry, double value, int64_t timestamp) {
-  if (entry <= 0) {
-    return;
-  }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
+void DataLog::AppendDouble(ThreadBuffer& tbuf, int entry, double value,
+                           int64_t timestamp) {
+  uint8_t* buf = StartRecord(tbuf, entry, timestamp, 8, 8);
+  if (!buf) {
     return;
   }
-  uint8_t* buf = StartRecord(entry, timestamp, 8, 8);
   if constexpr (wpi::support::endian::system_endianness() ==
                 wpi::support::little) {
     std::memcpy(buf, &value, 8);
   } else {
     wpi::support::endian::write64le(buf, wpi::DoubleToBits(value));
   }
+  tbuf.Commit();
 }
 
 void DataLog::AppendString(int entry, std::string_view value,
@@ -625,50 +1257,50 @@ void DataLog::AppendString(int entry, std::string_view value,
 
 void DataLog::AppendBooleanArray(int entry, wpi::span<const bool> arr,
                                  int64_t timestamp) {
-  if (entry <= 0) {
+  if (entry <= 0 || m_paused) {
     return;
   }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
+  auto& tbuf = GetThreadBuffer();
+  if (!StartRecord(tbuf, entry, timestamp, arr.size(), 0)) {
     return;
   }
-  StartRecord(entry, timestamp, arr.size(), 0);
   uint8_t* buf;
   while (arr.size() > kBlockSize) {
-    buf = Reserve(kBlockSize);
+    buf = tbuf.Reserve(kBlockSize);
     for (auto val : arr.subspan(0, kBlockSize)) {
       *buf++ = val ? 1 : 0;
     }
     arr = arr.subspan(kBlockSize);
   }
-  buf = Reserve(arr.size());
+  buf = tbuf.Reserve(arr.size());
   for (auto val : arr) {
     *buf++ = val ? 1 : 0;
   }
+  tbuf.Commit();
 }
 
 void DataLog::AppendBooleanArray(int entry, wpi::span<const int> arr,
                                  int64_t timestamp) {
-  if (entry <= 0) {
+  if (entry <= 0 || m_paused) {
     return;
   }
-  std::scoped_lock lock{m_mutex};
-  if (m_paused) {
+  auto& tbuf = GetThreadBuffer();
+  if (!StartRecord(tbuf, entry, timestamp, arr.size(), 0)) {
     return;
   }
-  StartRecord(entry, timestamp, arr.size(), 0);
   uint8_t* buf;
   while (arr.size() > kBlockSize) {
-    buf = Reserve(kBlockSize);
+    buf = tbuf.Reserve(kBlockSize);
     for (auto val : arr.subspan(0, kBlockSize)) {
       *buf++ = val & 1;
     }
     arr = arr.subspan(kBlockSize);
   }
-  buf = Reserve(arr.size());
+  buf = tbuf.Reserve(arr.size());
   for (auto val : arr) {
     *buf++ = val & 1;
   }
+  tbuf.Commit();
 }
 
 void DataLog::AppendBooleanArray(int entry, wpi::span<const uint8_t> arr,
@@ -684,28 +1316,28 @@ void DataLog::AppendIntegerArray(int entry, wpi::span<const int64_t> arr,
               {reinterpret_cast<const uint8_t*>(arr.data()), arr.size() * 8},
               timestamp);
   } else {
-    if (entry <= 0) {
+    if (entry <= 0 || m_paused) {
       return;
     }
-    std::scoped_lock lock{m_mutex};
-    if (m_paused) {
+    auto& tbuf = GetThreadBuffer();
+    if (!StartRecord(tbuf, entry, timestamp, arr.size() * 8, 0)) {
       return;
     }
-    StartRecord(entry, timestamp, arr.size() * 8, 0);
     uint8_t* buf;
     while ((arr.size() * 8) > kBlockSize) {
-      buf = Reserve(kBlockSize);
+      buf = tbuf.Reserve(kBlockSize);
       for (auto val : arr.subspan(0, kBlockSize / 8)) {
         wpi::support::endian::write64le(buf, val);
         buf += 8;
       }
       arr = arr.subspan(kBlockSize / 8);
     }
-    buf = Reserve(arr.size() * 8);
+    buf = tbuf.Reserve(arr.size() * 8);
     for (auto val : arr) {
       wpi::support::endian::write64le(buf, val);
       buf += 8;
     }
+    tbuf.Commit();
   }
 }
 
@@ -717,28 +1349,28 @@ void DataLog::AppendFloatArray(int entry, wpi::span<const float> arr,
               {reinterpret_cast<const uint8_t*>(arr.data()), arr.size() * 4},
               timestamp);
   } else {
-    if (entry <= 0) {
+    if (entry <= 0 || m_paused) {
       return;
     }
-    std::scoped_lock lock{m_mutex};
-    if (m_paused) {
+    auto& tbuf = GetThreadBuffer();
+    if (!StartRecord(tbuf, entry, timestamp, arr.size() * 4, 0)) {
       return;
     }
-    StartRecord(entry, timestamp, arr.size() * 4, 0);
     uint8_t* buf;
     while ((arr.size() * 4) > kBlockSize) {
-      buf = Reserve(kBlockSize);
+      buf = tbuf.Reserve(kBlockSize);
       for (auto val : arr.subspan(0, kBlockSize / 4)) {
         wpi::support::endian::write32le(buf, wpi::FloatToBits(val));
         buf += 4;
       }
       arr = arr.subspan(kBlockSize / 4);
     }
-    buf = Reserve(arr.size() * 4);
+    buf = tbuf.Reserve(arr.size() * 4);
     for (auto val : arr) {
       wpi::support::endian::write32le(buf, wpi::FloatToBits(val));
       buf += 4;
     }
+    tbuf.Commit();
   }
 }
 
@@ -750,28 +1382,28 @@ void DataLog::AppendDoubleArray(int entry, wpi::span<const double> arr,
               {reinterpret_cast<const uint8_t*>(arr.data()), arr.size() * 8},
               timestamp);
   } else {
-    if (entry <= 0) {
+    if (entry <= 0 || m_paused) {
       return;
     }
-    std::scoped_lock lock{m_mutex};
-    if (m_paused) {
+    auto& tbuf = GetThreadBuffer();
+    if (!StartRecord(tbuf, entry, timestamp, arr.size() * 8, 0)) {
       return;
     }
-    StartRecord(entry, timestamp, arr.size() * 8, 0);
     uint8_t* buf;
     while ((arr.size() * 8) > kBlockSize) {
-      buf = Reserve(kBlockSize);
+      buf = tbuf.Reserve(kBlockSize);
       for (auto val : arr.subspan(0, kBlockSize / 8)) {
         wpi::support::endian::write64le(buf, wpi::DoubleToBits(val));
         buf += 8;
       }
       arr = arr.subspan(kBlockSize / 8);
     }
-    buf = Reserve(arr.size() * 8);
+    buf = tbuf.Reserve(arr.size() * 8);
     for (auto val : arr) {
       wpi::support::endian::write64le(buf, wpi::DoubleToBits(val));
       buf += 8;
     }
+    tbuf.Commit();
   }
 }
 
@@ -786,15 +1418,19 @@ void DataLog::AppendStringArray(int entry, wpi::span<const std::string> arr,
   for (auto&& str : arr) {
     size += 4 + str.size();
   }
-  std::scoped_lock lock{m_mutex};
   if (m_paused) {
     return;
   }
-  uint8_t* buf = StartRecord(entry, timestamp, size, 4);
+  auto& tbuf = GetThreadBuffer();
+  uint8_t* buf = StartRecord(tbuf, entry, timestamp, size, 4);
+  if (!buf) {
+    return;
+  }
   wpi::support::endian::write32le(buf, arr.size());
   for (auto&& str : arr) {
-    AppendStringImpl(str);
+    tbuf.AppendString(str);
   }
+  tbuf.Commit();
 }
 
 void DataLog::AppendStringArray(int entry,
@@ -809,13 +1445,58 @@ void DataLog::AppendStringArray(int entry,
   for (auto&& str : arr) {
     size += 4 + str.size();
   }
-  std::scoped_lock lock{m_mutex};
   if (m_paused) {
     return;
   }
-  uint8_t* buf = StartRecord(entry, timestamp, size, 4);
+  auto& tbuf = GetThreadBuffer();
+  uint8_t* buf = StartRecord(tbuf, entry, timestamp, size, 4);
+  if (!buf) {
+    return;
+  }
   wpi::support::endian::write32le(buf, arr.size());
   for (auto sv : arr) {
-    AppendStringImpl(sv);
+    tbuf.AppendString(sv);
+  }
+  tbuf.Commit();
+}
+
+DataLogBatch::DataLogBatch(DataLog& log, int64_t timestamp)
+    : m_log{log},
+      m_buf{log.GetThreadBuffer()},
+      m_timestamp{timestamp == 0 ? static_cast<int64_t>(wpi::Now())
+                                 : timestamp} {}
+
+void DataLogBatch::AppendRaw(int entry, wpi::span<const uint8_t> data) {
+  if (entry <= 0 || m_log.m_paused) {
+    return;
+  }
+  m_log.AppendRaw(m_buf, entry, data, m_timestamp);
+}
+
+void DataLogBatch::AppendBoolean(int entry, bool value) {
+  if (entry <= 0 || m_log.m_paused) {
+    return;
+  }
+  m_log.AppendBoolean(m_buf, entry, value, m_timestamp);
+}
+
+void DataLogBatch::AppendInteger(int entry, int64_t value) {
+  if (entry <= 0 || m_log.m_paused) {
+    return;
+  }
+  m_log.AppendInteger(m_buf, entry, value, m_timestamp);
+}
+
+void DataLogBatch::AppendFloat(int entry, float value) {
+  if (entry <= 0 || m_log.m_paused) {
+    return;
+  }
+  m_log.AppendFloat(m_buf, entry, value, m_timestamp);
+}
+
+void DataLogBatch::AppendDouble(int entry, double value) {
+  if (entry <= 0 || m_log.m_paused) {
+    return;
   }
+  m_log.AppendDouble(m_buf, entry, value, m_timestamp);
 }
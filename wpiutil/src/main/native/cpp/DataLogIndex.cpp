@@ -0,0 +1,303 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/DataLogIndex.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include "wpi/Endian.h"
+#include "wpi/MemoryBuffer.h"
+#include "wpi/fs.h"
+#include "wpi/raw_ostream.h"
+
+using namespace wpi::log;
+
+// Index file format (all integers little endian):
+//   8 bytes "WPILOGIX", u16 version
+//   u64 log size, u64 log hash, u64 number of records
+//   u64 number of time points, then per point: u64 position, i64 timestamp
+//   u64 number of entries, then per entry: u64 start position, u64 metadata
+//     position, u64 finish position, u64 record count, u64 record positions
+static constexpr std::string_view kIndexMagic = "WPILOGIX";
+static constexpr uint16_t kIndexVersion = 0x0100;
+// amount of the start and end of the log hashed to detect a changed log
+static constexpr size_t kHashSize = 4096;
+
+static void Write64(wpi::raw_ostream& os, uint64_t val) {
+  uint8_t buf[8];
+  wpi::support::endian::write64le(buf, val);
+  os << wpi::span<const uint8_t>{buf};
+}
+
+static bool Read64(wpi::span<const uint8_t>* buf, uint64_t* val) {
+  if (buf->size() < 8) {
+    return false;
+  }
+  *val = wpi::support::endian::read64le(buf->data());
+  *buf = buf->subspan(8);
+  return true;
+}
+
+DataLogIndex::DataLogIndex(const DataLogReader& reader) : m_reader{reader} {
+  auto it = reader.begin();
+  if (it == reader.end()) {
+    m_pos = 0;
+    m_complete = true;
+  } else {
+    auto buf = reader.m_buf->GetBuffer();
+    m_pos = 12 + wpi::support::endian::read32le(&buf[8]);
+  }
+}
+
+bool DataLogIndex::IndexRecords(size_t count) {
+  DataLogRecord record;
+  for (; count > 0 && !m_complete; --count) {
+    uint64_t pos = m_pos;
+    size_t next = pos;
+    if (!m_reader.GetRecord(&next, &record)) {
+      m_complete = true;
+      break;
+    }
+    m_pos = next;
+
+    if (m_numRecords % kTimeIndexInterval == 0) {
+      m_timeIndex.push_back({pos, m_timeIndex.empty()
+                                      ? INT64_MIN
+                                      : m_timeIndex.back().maxTimestamp});
+    }
+    ++m_numRecords;
+    auto& maxTimestamp = m_timeIndex.back().maxTimestamp;
+    maxTimestamp = (std::max)(maxTimestamp, record.GetTimestamp());
+
+    if (!record.IsControl()) {
+      auto it = m_activeEntries.find(record.GetEntry());
+      if (it != m_activeEntries.end()) {
+        m_entries[it->second].records.push_back(pos);
+      }
+    } else if (record.IsStart()) {
+      StartRecordData data;
+      if (record.GetStartData(&data)) {
+        m_activeEntries[data.entry] = m_entries.size();
+        m_entryNames[data.name] = m_entries.size();
+        auto& entry = m_entries.emplace_back();
+        entry.data = data;
+        entry.startPos = pos;
+      }
+    } else if (record.IsFinish()) {
+      int id;
+      if (record.GetFinishEntry(&id)) {
+        auto it = m_activeEntries.find(id);
+        if (it != m_activeEntries.end()) {
+          m_entries[it->second].finishPos = pos;
+          m_activeEntries.erase(it);
+        }
+      }
+    } else if (record.IsSetMetadata()) {
+      MetadataRecordData data;
+      if (record.GetSetMetadataData(&data)) {
+        auto it = m_activeEntries.find(data.entry);
+        if (it != m_activeEntries.end()) {
+          auto& entry = m_entries[it->second];
+          entry.data.metadata = data.metadata;
+          entry.metadataPos = pos;
+        }
+      }
+    }
+  }
+  return m_complete;
+}
+
+const DataLogIndex::Entry* DataLogIndex::FindEntry(
+    std::string_view name) const {
+  auto it = m_entryNames.find(name);
+  if (it == m_entryNames.end()) {
+    return nullptr;
+  }
+  return &m_entries[it->second];
+}
+
+DataLogRecord DataLogIndex::GetRecord(uint64_t pos) const {
+  size_t p = pos;
+  DataLogRecord record;
+  if (p != pos || !m_reader.GetRecord(&p, &record)) {
+    return {};
+  }
+  return record;
+}
+
+uint64_t DataLogIndex::SeekPos(int64_t timestamp) const {
+  auto it = std::partition_point(
+      m_timeIndex.begin(), m_timeIndex.end(),
+      [&](const auto& point) { return point.maxTimestamp < timestamp; });
+  if (it == m_timeIndex.end()) {
+    // not yet indexed records may match
+    return m_complete ? UINT64_MAX : m_pos;
+  }
+  return it->pos;
+}
+
+DataLogIterator DataLogIndex::Seek(int64_t timestamp) const {
+  uint64_t pos = SeekPos(timestamp);
+  if (pos == UINT64_MAX) {
+    return m_reader.end();
+  }
+  return DataLogIterator{&m_reader, static_cast<size_t>(pos)};
+}
+
+wpi::span<const uint64_t> DataLogIndex::GetRecords(const Entry& entry,
+                                                   int64_t timestamp) const {
+  uint64_t pos = SeekPos(timestamp);
+  auto it = std::lower_bound(entry.records.begin(), entry.records.end(), pos);
+  return wpi::span<const uint64_t>{entry.records}.subspan(
+      it - entry.records.begin());
+}
+
+uint64_t DataLogIndex::GetLogHash() const {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  auto add = [&](wpi::span<const uint8_t> data) {
+    for (auto b : data) {
+      hash = (hash ^ b) * 1099511628211ull;
+    }
+  };
+  auto buf = m_reader.m_buf->GetBuffer();
+  if (buf.size() <= 2 * kHashSize) {
+    add(buf);
+  } else {
+    add(buf.subspan(0, kHashSize));
+    add(buf.subspan(buf.size() - kHashSize));
+  }
+  return hash;
+}
+
+bool DataLogIndex::Load(std::string_view filename, std::error_code& ec) {
+  auto file = MemoryBuffer::GetFile(filename, ec);
+  if (!file || !m_reader) {
+    return false;
+  }
+  auto buf = file->GetBuffer();
+  auto logSize = m_reader.m_buf->size();
+
+  // header
+  if (buf.size() < kIndexMagic.size() + 2 ||
+      std::string_view{reinterpret_cast<const char*>(buf.data()),
+                       kIndexMagic.size()} != kIndexMagic ||
+      wpi::support::endian::read16le(&buf[kIndexMagic.size()]) !=
+          kIndexVersion) {
+    return false;
+  }
+  buf = buf.subspan(kIndexMagic.size() + 2);
+  uint64_t size, hash, numRecords, numPoints;
+  if (!Read64(&buf, &size) || size != logSize || !Read64(&buf, &hash) ||
+      hash != GetLogHash() || !Read64(&buf, &numRecords) ||
+      !Read64(&buf, &numPoints) || numPoints > buf.size() / 16) {
+    return false;
+  }
+
+  // time index
+  std::vector<TimePoint> timeIndex;
+  timeIndex.reserve(numPoints);
+  for (uint64_t i = 0; i < numPoints; ++i) {
+    uint64_t pos = 0;
+    uint64_t timestamp = 0;
+    Read64(&buf, &pos);
+    Read64(&buf, &timestamp);
+    if (pos >= logSize) {
+      return false;
+    }
+    timeIndex.push_back({pos, static_cast<int64_t>(timestamp)});
+  }
+
+  // entries; names and metadata are read from the log
+  uint64_t numEntries;
+  if (!Read64(&buf, &numEntries) || numEntries > buf.size() / 32) {
+    return false;
+  }
+  std::vector<Entry> entries;
+  entries.reserve(numEntries);
+  for (uint64_t i = 0; i < numEntries; ++i) {
+    auto& entry = entries.emplace_back();
+    uint64_t numEntryRecords;
+    if (!Read64(&buf, &entry.startPos) || !Read64(&buf, &entry.metadataPos) ||
+        !Read64(&buf, &entry.finishPos) || !Read64(&buf, &numEntryRecords) ||
+        numEntryRecords > buf.size() / 8) {
+      return false;
+    }
+    auto start = GetRecord(entry.startPos);
+    if (!start.IsStart() || !start.GetStartData(&entry.data)) {
+      return false;
+    }
+    if (entry.metadataPos != UINT64_MAX) {
+      MetadataRecordData data;
+      auto record = GetRecord(entry.metadataPos);
+      if (!record.IsSetMetadata() || !record.GetSetMetadataData(&data)) {
+        return false;
+      }
+      entry.data.metadata = data.metadata;
+    }
+    entry.records.reserve(numEntryRecords);
+    for (uint64_t j = 0; j < numEntryRecords; ++j) {
+      uint64_t pos = 0;
+      Read64(&buf, &pos);
+      if (pos >= logSize) {
+        return false;
+      }
+      entry.records.push_back(pos);
+    }
+  }
+
+  m_pos = logSize;
+  m_numRecords = numRecords;
+  m_complete = true;
+  m_entries = std::move(entries);
+  m_timeIndex = std::move(timeIndex);
+  m_activeEntries.clear();
+  m_entryNames.clear();
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    if (m_entries[i].finishPos == UINT64_MAX) {
+      m_activeEntries[m_entries[i].data.entry] = i;
+    }
+    m_entryNames[m_entries[i].data.name] = i;
+  }
+  return true;
+}
+
+void DataLogIndex::Save(std::string_view filename, std::error_code& ec) const {
+  if (!m_complete || !m_reader) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return;
+  }
+  wpi::raw_fd_ostream os{filename, ec, fs::OF_None};
+  if (ec) {
+    return;
+  }
+  os << kIndexMagic;
+  uint8_t version[2];
+  wpi::support::endian::write16le(version, kIndexVersion);
+  os << wpi::span<const uint8_t>{version};
+  Write64(os, m_reader.m_buf->size());
+  Write64(os, GetLogHash());
+  Write64(os, m_numRecords);
+  Write64(os, m_timeIndex.size());
+  for (auto&& point : m_timeIndex) {
+    Write64(os, point.pos);
+    Write64(os, point.maxTimestamp);
+  }
+  Write64(os, m_entries.size());
+  for (auto&& entry : m_entries) {
+    Write64(os, entry.startPos);
+    Write64(os, entry.metadataPos);
+    Write64(os, entry.finishPos);
+    Write64(os, entry.records.size());
+    for (auto pos : entry.records) {
+      Write64(os, pos);
+    }
+  }
+  os.close();
+  if (os.has_error()) {
+    ec = os.error();
+    os.clear_error();
+  }
+}
@@ -4,9 +4,13 @@
 
 #include "wpi/DataLogReader.h"
 
+#include <cstring>
+
 #include "wpi/DataLog.h"
 #include "wpi/Endian.h"
 #include "wpi/MathExtras.h"
+#include "wpi/StringExtras.h"
+#include "wpi/lz4.h"
 
 using namespace wpi::log;
 
@@ -187,8 +191,64 @@ bool DataLogRecord::GetStringArray(std::vector<std::string_view>* arr) const {
   return true;
 }
 
+static std::string_view GetRawExtraHeader(wpi::span<const uint8_t> buf) {
+  if (buf.size() < 8) {
+    return {};
+  }
+  std::string_view rv;
+  buf = buf.subspan(8);
+  ReadString(&buf, &rv);
+  return rv;
+}
+
 DataLogReader::DataLogReader(std::unique_ptr<MemoryBuffer> buffer)
-    : m_buf{std::move(buffer)} {}
+    : m_buf{std::move(buffer)} {
+  if (IsValid() && IsCompressed()) {
+    Decompress();
+  }
+}
+
+void DataLogReader::Decompress() {
+  auto buf = m_buf->GetBuffer();
+  size_t headerSize = 12 + GetRawExtraHeader(buf).size();
+  auto frames = buf.subspan(headerSize);
+
+  // total size of the complete frames; LZ4 can't compress better than 255:1,
+  // so larger sizes are corrupt
+  size_t size = headerSize;
+  for (auto rest = frames; rest.size() >= 8;) {
+    uint32_t frameSize = wpi::support::endian::read32le(rest.data());
+    uint32_t compressedSize = wpi::support::endian::read32le(rest.data() + 4);
+    if (compressedSize > rest.size() - 8 || compressedSize > frameSize ||
+        frameSize / 256 > compressedSize) {
+      break;
+    }
+    size += frameSize;
+    rest = rest.subspan(8 + compressedSize);
+  }
+
+  auto out = WritableMemoryBuffer::GetNewUninitMemBuffer(
+      size, m_buf->GetBufferIdentifier());
+  auto outBuf = out->GetBuffer();
+  std::memcpy(outBuf.data(), buf.data(), headerSize);
+  for (size_t pos = headerSize; pos < size;) {
+    uint32_t frameSize = wpi::support::endian::read32le(frames.data());
+    uint32_t compressedSize = wpi::support::endian::read32le(frames.data() + 4);
+    auto data = frames.subspan(8, compressedSize);
+    auto dest = outBuf.subspan(pos, frameSize);
+    if (compressedSize == frameSize) {
+      std::memcpy(dest.data(), data.data(), frameSize);
+    } else if (!wpi::LZ4Decompress(data, dest)) {
+      // keep the records before the corrupt frame
+      m_buf = MemoryBuffer::GetMemBufferCopy(outBuf.subspan(0, pos),
+                                             m_buf->GetBufferIdentifier());
+      return;
+    }
+    pos += frameSize;
+    frames = frames.subspan(8 + compressedSize);
+  }
+  m_buf = std::move(out);
+}
 
 bool DataLogReader::IsValid() const {
   if (!m_buf) {
@@ -216,16 +276,18 @@ std::string_view DataLogReader::GetExtraHeader() const {
   if (!m_buf) {
     return {};
   }
-  auto buf = m_buf->GetBuffer();
-  if (buf.size() < 8) {
-    return {};
+  auto rv = GetRawExtraHeader(m_buf->GetBuffer());
+  if (wpi::starts_with(rv, impl::kCompressedHeader)) {
+    rv.remove_prefix(impl::kCompressedHeader.size());
   }
-  std::string_view rv;
-  buf = buf.subspan(8);
-  ReadString(&buf, &rv);
   return rv;
 }
 
+bool DataLogReader::IsCompressed() const {
+  return m_buf && wpi::starts_with(GetRawExtraHeader(m_buf->GetBuffer()),
+                                   impl::kCompressedHeader);
+}
+
 DataLogReader::iterator DataLogReader::begin() const {
   if (!m_buf) {
     return end();
@@ -255,7 +317,11 @@ bool DataLogReader::GetRecord(size_t* pos, DataLogRecord* out) const {
   if (!m_buf) {
     return false;
   }
-  auto buf = m_buf->GetBuffer();
+  return ParseRecord(m_buf->GetBuffer(), pos, out);
+}
+
+bool DataLogReader::ParseRecord(wpi::span<const uint8_t> buf, size_t* pos,
+                                DataLogRecord* out) {
   if (*pos >= buf.size()) {
     return false;
   }
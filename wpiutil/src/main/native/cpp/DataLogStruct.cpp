@@ -0,0 +1,239 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/DataLogStruct.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <tuple>
+
+#include "wpi/DataLogReader.h"
+#include "wpi/Endian.h"
+#include "wpi/MathExtras.h"
+#include "wpi/StringExtras.h"
+
+using namespace wpi::log;
+
+namespace {
+struct TypeInfo {
+  std::string_view name;
+  StructFieldType type;
+  size_t size;
+};
+}  // namespace
+
+static constexpr TypeInfo kTypes[] = {
+    {"bool", StructFieldType::kBool, 1},
+    {"char", StructFieldType::kChar, 1},
+    {"int8", StructFieldType::kInt8, 1},
+    {"int16", StructFieldType::kInt16, 2},
+    {"int32", StructFieldType::kInt32, 4},
+    {"int64", StructFieldType::kInt64, 8},
+    {"uint8", StructFieldType::kUint8, 1},
+    {"uint16", StructFieldType::kUint16, 2},
+    {"uint32", StructFieldType::kUint32, 4},
+    {"uint64", StructFieldType::kUint64, 8},
+    {"float", StructFieldType::kFloat, 4},
+    {"float32", StructFieldType::kFloat, 4},
+    {"double", StructFieldType::kDouble, 8},
+    {"float64", StructFieldType::kDouble, 8},
+};
+
+// truncates a floating point value to an integer; returns false if it's NaN
+// or out of range
+static bool TruncateToInteger(double value, int64_t* result) {
+  // -2^63 and 2^63, which are exactly representable as doubles
+  constexpr double kMin = -9223372036854775808.0;
+  constexpr double kMax = 9223372036854775808.0;
+  if (!(value >= kMin && value < kMax)) {
+    return false;
+  }
+  *result = static_cast<int64_t>(value);
+  return true;
+}
+
+// returns pointer to the element, or nullptr if out of range
+static const uint8_t* GetElement(const StructField& field,
+                                 wpi::span<const uint8_t> data, size_t index) {
+  if (index >= field.count ||
+      data.size() < field.offset + (index + 1) * field.size) {
+    return nullptr;
+  }
+  return data.data() + field.offset + index * field.size;
+}
+
+bool StructField::GetBoolean(wpi::span<const uint8_t> data, bool* value,
+                             size_t index) const {
+  int64_t val;
+  if (type == StructFieldType::kFloat || type == StructFieldType::kDouble) {
+    double dval;
+    if (!GetDouble(data, &dval, index)) {
+      return false;
+    }
+    *value = dval != 0;
+    return true;
+  }
+  if (!GetInteger(data, &val, index)) {
+    return false;
+  }
+  *value = val != 0;
+  return true;
+}
+
+bool StructField::GetInteger(wpi::span<const uint8_t> data, int64_t* value,
+                             size_t index) const {
+  auto p = GetElement(*this, data, index);
+  if (!p) {
+    return false;
+  }
+  using namespace wpi::support::endian;
+  switch (type) {
+    case StructFieldType::kBool:
+    case StructFieldType::kChar:
+    case StructFieldType::kUint8:
+      *value = *p;
+      break;
+    case StructFieldType::kInt8:
+      *value = static_cast<int8_t>(*p);
+      break;
+    case StructFieldType::kInt16:
+      *value = static_cast<int16_t>(read16le(p));
+      break;
+    case StructFieldType::kInt32:
+      *value = static_cast<int32_t>(read32le(p));
+      break;
+    case StructFieldType::kInt64:
+    case StructFieldType::kUint64:
+      *value = static_cast<int64_t>(read64le(p));
+      break;
+    case StructFieldType::kUint16:
+      *value = read16le(p);
+      break;
+    case StructFieldType::kUint32:
+      *value = read32le(p);
+      break;
+    case StructFieldType::kFloat:
+      return TruncateToInteger(wpi::BitsToFloat(read32le(p)), value);
+    case StructFieldType::kDouble:
+      return TruncateToInteger(wpi::BitsToDouble(read64le(p)), value);
+  }
+  return true;
+}
+
+bool StructField::GetDouble(wpi::span<const uint8_t> data, double* value,
+                            size_t index) const {
+  if (type == StructFieldType::kFloat || type == StructFieldType::kDouble) {
+    auto p = GetElement(*this, data, index);
+    if (!p) {
+      return false;
+    }
+    using namespace wpi::support::endian;
+    *value = type == StructFieldType::kFloat ? wpi::BitsToFloat(read32le(p))
+                                             : wpi::BitsToDouble(read64le(p));
+    return true;
+  }
+  int64_t val;
+  if (!GetInteger(data, &val, index)) {
+    return false;
+  }
+  if (type == StructFieldType::kUint64) {
+    *value = static_cast<uint64_t>(val);
+  } else {
+    *value = val;
+  }
+  return true;
+}
+
+bool StructField::GetString(wpi::span<const uint8_t> data,
+                            std::string_view* value) const {
+  if (type != StructFieldType::kChar || data.size() < offset + count) {
+    return false;
+  }
+  auto p = reinterpret_cast<const char*>(data.data() + offset);
+  *value = std::string_view{p, count};
+  *value = value->substr(0, value->find('\0'));
+  return true;
+}
+
+std::optional<StructDescriptor> StructDescriptor::Parse(
+    std::string_view schema) {
+  StructDescriptor desc;
+  while (!schema.empty()) {
+    std::string_view decl;
+    std::tie(decl, schema) = wpi::split(schema, ';');
+    decl = wpi::trim(decl);
+    if (decl.empty()) {
+      continue;
+    }
+
+    // type
+    auto [typeName, rest] = wpi::split(decl, ' ');
+    auto typeIt =
+        std::find_if(std::begin(kTypes), std::end(kTypes),
+                     [&](const auto& info) { return info.name == typeName; });
+    if (typeIt == std::end(kTypes)) {
+      return {};
+    }
+
+    // name and optional array length
+    std::string_view name = wpi::trim(rest);
+    size_t count = 1;
+    if (wpi::ends_with(name, ']')) {
+      auto [arrName, countStr] = wpi::split(name, '[');
+      countStr.remove_suffix(1);
+      auto parsed = wpi::parse_integer<size_t>(wpi::trim(countStr), 10);
+      if (!parsed || *parsed == 0) {
+        return {};
+      }
+      name = wpi::trim(arrName);
+      count = *parsed;
+    }
+    if (name.empty() || desc.FindField(name) ||
+        std::any_of(name.begin(), name.end(), [](char ch) {
+          return !wpi::isAlnum(ch) && ch != '_';
+        })) {
+      return {};
+    }
+
+    if (count > (std::numeric_limits<size_t>::max() - desc.m_size) /
+                    typeIt->size) {
+      return {};  // size overflows
+    }
+    desc.m_fields.push_back(StructField{std::string{name}, typeIt->type,
+                                        desc.m_size, typeIt->size, count});
+    desc.m_size += typeIt->size * count;
+  }
+  if (desc.m_fields.empty()) {
+    return {};
+  }
+  return desc;
+}
+
+const StructField* StructDescriptor::FindField(std::string_view name) const {
+  auto it = std::find_if(m_fields.begin(), m_fields.end(),
+                         [&](const auto& field) { return field.name == name; });
+  return it == m_fields.end() ? nullptr : &*it;
+}
+
+bool StructRegistry::Add(const StartRecordData& data) {
+  if (data.type != kStructSchemaType ||
+      !wpi::starts_with(data.name, kStructSchemaPrefix)) {
+    return false;
+  }
+  auto desc = StructDescriptor::Parse(data.metadata);
+  if (!desc) {
+    return false;
+  }
+  // like the writer, keep the first schema of a name
+  return m_descriptors
+      .try_emplace(data.name.substr(kStructSchemaPrefix.size()),
+                   std::move(*desc))
+      .second;
+}
+
+const StructDescriptor* StructRegistry::Find(std::string_view type) const {
+  auto it = m_descriptors.find(type);
+  return it == m_descriptors.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/DataLogTailReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "wpi/DataLog.h"
+#include "wpi/Endian.h"
+#include "wpi/StringExtras.h"
+#include "wpi/lz4.h"
+
+using namespace wpi::log;
+
+// size of each read from the file
+static constexpr size_t kReadSize = 64 * 1024;
+
+DataLogTailReader::DataLogTailReader(std::string_view filename,
+                                     std::error_code& ec)
+    : m_is{filename, ec, kReadSize} {
+  if (ec) {
+    m_state = kInvalid;
+  }
+}
+
+wpi::span<const DataLogRecord> DataLogTailReader::Read() {
+  m_records.clear();
+  if (m_state == kInvalid) {
+    return {};
+  }
+
+  // drop the records returned by the last call
+  m_data.erase(m_data.begin(), m_data.begin() + m_dataPos);
+  m_dataPos = 0;
+
+  // uncompressed records are read directly into the record data
+  auto& buf = m_state == kRecords && !m_compressed ? m_data : m_raw;
+  for (size_t total = 0; total < kMaxReadSize;) {
+    m_is.readinto(buf, kReadSize);
+    total += m_is.read_count();
+    if (m_is.has_error()) {
+      // end of file (so far)
+      m_is.clear_error();
+      break;
+    }
+  }
+
+  if (m_state == kHeader && !ReadHeader()) {
+    return {};
+  }
+  if (m_compressed && !DecompressFrames()) {
+    m_state = kInvalid;
+  }
+
+  size_t pos = m_dataPos;
+  DataLogRecord record;
+  while (DataLogReader::ParseRecord(m_data, &pos, &record)) {
+    m_records.push_back(record);
+  }
+  m_dataPos = pos;
+  return m_records;
+}
+
+wpi::span<const DataLogRecord> DataLogTailReader::Wait(double timeout,
+                                                       double period) {
+  using namespace std::chrono;
+  auto end = steady_clock::now() +
+             duration_cast<steady_clock::duration>(duration<double>(timeout));
+  for (;;) {
+    auto records = Read();
+    if (!records.empty() || m_state == kInvalid) {
+      return records;
+    }
+    auto now = steady_clock::now();
+    if (now >= end) {
+      return records;
+    }
+    std::this_thread::sleep_for((std::min)(
+        duration_cast<steady_clock::duration>(duration<double>(period)),
+        end - now));
+  }
+}
+
+bool DataLogTailReader::ReadHeader() {
+  if (m_raw.size() < 12) {
+    return false;
+  }
+  if (std::string_view{reinterpret_cast<const char*>(m_raw.data()), 6} !=
+          "WPILOG" ||
+      wpi::support::endian::read16le(&m_raw[6]) < 0x0100) {
+    m_state = kInvalid;
+    return false;
+  }
+  uint32_t extraLen = wpi::support::endian::read32le(&m_raw[8]);
+  if (m_raw.size() - 12 < extraLen) {
+    return false;
+  }
+
+  m_version = wpi::support::endian::read16le(&m_raw[6]);
+  std::string_view extra{reinterpret_cast<const char*>(&m_raw[12]), extraLen};
+  m_compressed = wpi::starts_with(extra, impl::kCompressedHeader);
+  if (m_compressed) {
+    extra.remove_prefix(impl::kCompressedHeader.size());
+  }
+  m_extraHeader = extra;
+  m_raw.erase(m_raw.begin(), m_raw.begin() + 12 + extraLen);
+  if (!m_compressed) {
+    m_data.insert(m_data.end(), m_raw.begin(), m_raw.end());
+    m_raw.clear();
+  }
+  m_state = kRecords;
+  return true;
+}
+
+bool DataLogTailReader::DecompressFrames() {
+  wpi::span<const uint8_t> frames{m_raw};
+  bool ok = true;
+  while (frames.size() >= 8) {
+    uint32_t frameSize = wpi::support::endian::read32le(frames.data());
+    uint32_t compressedSize = wpi::support::endian::read32le(frames.data() + 4);
+    // LZ4 can't compress better than 255:1, so larger sizes are corrupt
+    if (compressedSize > frameSize || frameSize / 256 > compressedSize) {
+      ok = false;
+      break;
+    }
+    if (compressedSize > frames.size() - 8) {
+      break;  // not completely written yet
+    }
+    auto data = frames.subspan(8, compressedSize);
+    size_t pos = m_data.size();
+    m_data.resize(pos + frameSize);
+    if (compressedSize == frameSize) {
+      std::copy(data.begin(), data.end(), m_data.begin() + pos);
+    } else if (!wpi::LZ4Decompress(data, wpi::span{m_data}.subspan(pos))) {
+      m_data.resize(pos);
+      ok = false;
+      break;
+    }
+    frames = frames.subspan(8 + compressedSize);
+  }
+  m_raw.erase(m_raw.begin(), m_raw.end() - frames.size());
+  return ok;
+}
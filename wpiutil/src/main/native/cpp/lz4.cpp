@@ -0,0 +1,202 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/lz4.h"
+
+#include <cstring>
+
+#include "wpi/Endian.h"
+#include "wpi/MathExtras.h"
+
+// Block format limits; see the LZ4 block format description.  The last
+// match must start at least 12 bytes before the end of the input, and the
+// last 5 bytes are always literals.
+static constexpr size_t kMinMatch = 4;
+static constexpr size_t kLastLiterals = 5;
+static constexpr size_t kMFLimit = 12;
+static constexpr size_t kMaxOffset = 65535;
+
+static constexpr unsigned int kHashLog = 12;
+// how quickly to skip ahead through incompressible data
+static constexpr unsigned int kSkipTrigger = 6;
+
+static uint32_t Read32(const uint8_t* p) {
+  uint32_t val;
+  std::memcpy(&val, p, sizeof(val));
+  return val;
+}
+
+static uint32_t Hash(uint32_t val) {
+  return (val * 2654435761u) >> (32 - kHashLog);
+}
+
+static uint8_t* WriteLength(uint8_t* op, size_t len) {
+  while (len >= 255) {
+    *op++ = 255;
+    len -= 255;
+  }
+  *op++ = len;
+  return op;
+}
+
+static uint8_t* WriteLiterals(uint8_t* op, uint8_t* token, const uint8_t* lit,
+                              size_t len) {
+  if (len >= 15) {
+    *token = 15 << 4;
+    op = WriteLength(op, len - 15);
+  } else {
+    *token = len << 4;
+  }
+  std::memcpy(op, lit, len);
+  return op + len;
+}
+
+// returns end of match
+static const uint8_t* ExtendMatch(const uint8_t* ip, const uint8_t* ref,
+                                  const uint8_t* limit) {
+  while (ip + 8 <= limit) {
+    uint64_t diff = wpi::support::endian::read64le(ip) ^
+                    wpi::support::endian::read64le(ref);
+    if (diff != 0) {
+      return ip + wpi::countTrailingZeros(diff) / 8;
+    }
+    ip += 8;
+    ref += 8;
+  }
+  while (ip < limit && *ip == *ref) {
+    ++ip;
+    ++ref;
+  }
+  return ip;
+}
+
+size_t wpi::LZ4Compress(span<const uint8_t> in, span<uint8_t> out) {
+  const uint8_t* const base = in.data();
+  const uint8_t* const iend = base + in.size();
+  const uint8_t* anchor = base;
+  uint8_t* op = out.data();
+
+  if (in.size() > kMFLimit) {
+    const uint8_t* const mflimit = iend - kMFLimit;
+    const uint8_t* const matchlimit = iend - kLastLiterals;
+    // positions relative to base; position 0 doubles as the empty value
+    uint32_t table[1 << kHashLog] = {};
+
+    const uint8_t* ip = base + 1;
+    while (ip < mflimit) {
+      uint32_t seq = Read32(ip);
+      uint32_t h = Hash(seq);
+      const uint8_t* ref = base + table[h];
+      table[h] = ip - base;
+      if (static_cast<size_t>(ip - ref) > kMaxOffset || Read32(ref) != seq) {
+        ip += 1 + ((ip - anchor) >> kSkipTrigger);
+        continue;
+      }
+
+      // extend backwards into pending literals
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        --ip;
+        --ref;
+      }
+      const uint8_t* matchEnd =
+          ExtendMatch(ip + kMinMatch, ref + kMinMatch, matchlimit);
+
+      uint8_t* token = op++;
+      op = WriteLiterals(op, token, anchor, ip - anchor);
+      size_t offset = ip - ref;
+      *op++ = offset & 0xff;
+      *op++ = offset >> 8;
+      size_t matchLen = (matchEnd - ip) - kMinMatch;
+      if (matchLen >= 15) {
+        *token |= 15;
+        op = WriteLength(op, matchLen - 15);
+      } else {
+        *token |= matchLen;
+      }
+
+      ip = matchEnd;
+      anchor = ip;
+      // seed the table from inside the match so runs chain together
+      if (ip < mflimit) {
+        table[Hash(Read32(ip - 2))] = ip - 2 - base;
+      }
+    }
+  }
+
+  // last literals
+  uint8_t* token = op++;
+  op = WriteLiterals(op, token, anchor, iend - anchor);
+  return op - out.data();
+}
+
+static bool ReadLength(const uint8_t** ip, const uint8_t* iend, size_t* len) {
+  uint8_t b;
+  do {
+    if (*ip >= iend) {
+      return false;
+    }
+    b = *(*ip)++;
+    *len += b;
+  } while (b == 255);
+  return true;
+}
+
+bool wpi::LZ4Decompress(span<const uint8_t> in, span<uint8_t> out) {
+  const uint8_t* ip = in.data();
+  const uint8_t* const iend = ip + in.size();
+  uint8_t* op = out.data();
+  uint8_t* const oend = op + out.size();
+
+  while (ip < iend) {
+    uint8_t token = *ip++;
+
+    // literals
+    size_t litLen = token >> 4;
+    if (litLen == 15 && !ReadLength(&ip, iend, &litLen)) {
+      return false;
+    }
+    if (litLen > static_cast<size_t>(iend - ip) ||
+        litLen > static_cast<size_t>(oend - op)) {
+      return false;
+    }
+    std::memcpy(op, ip, litLen);
+    ip += litLen;
+    op += litLen;
+
+    // the last sequence has no match
+    if (ip == iend) {
+      break;
+    }
+
+    // match
+    if (iend - ip < 2) {
+      return false;
+    }
+    size_t offset = support::endian::read16le(ip);
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - out.data())) {
+      return false;
+    }
+    size_t matchLen = token & 0xf;
+    if (matchLen == 15 && !ReadLength(&ip, iend, &matchLen)) {
+      return false;
+    }
+    matchLen += kMinMatch;
+    if (matchLen > static_cast<size_t>(oend - op)) {
+      return false;
+    }
+    const uint8_t* match = op - offset;
+    if (offset >= matchLen) {
+      std::memcpy(op, match, matchLen);
+      op += matchLen;
+    } else {
+      // overlapping copy repeats the last offset bytes
+      for (size_t i = 0; i < matchLen; ++i) {
+        *op++ = *match++;
+      }
+    }
+  }
+
+  return op == oend;
+}
@@ -5,15 +5,20 @@
 #ifndef WPIUTIL_WPI_CALLBACKMANAGER_H_
 #define WPIUTIL_WPI_CALLBACKMANAGER_H_
 
+#include <stdint.h>
+
 #include <atomic>
 #include <climits>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
 
+#include "wpi/DenseMap.h"
 #include "wpi/SafeThread.h"
+#include "wpi/SmallVector.h"
 #include "wpi/UidVector.h"
 #include "wpi/condition_variable.h"
 #include "wpi/mutex.h"
@@ -21,6 +26,18 @@
 
 namespace wpi {
 
+/**
+ * Statistics for a callback poller.
+ */
+struct CallbackPollerStats {
+  /** Number of events currently queued. */
+  size_t queued = 0;
+  /** Number of events merged into an already queued event. */
+  uint64_t coalesced = 0;
+  /** Number of events dropped because the queue limit was reached. */
+  uint64_t dropped = 0;
+};
+
 template <typename Callback>
 class CallbackListenerData {
  public:
@@ -43,6 +60,22 @@ class CallbackListenerData {
 //   bool Matches(const ListenerData& listener, const NotifierData& data);
 //   void SetListener(NotifierData* data, unsigned int listener_uid);
 //   void DoCallback(Callback callback, const NotifierData& data);
+// Derived may optionally hide the following functions to maintain an index
+// of m_listeners (all are called with m_mutex held):
+//   void ListenerAdded(unsigned int listener_uid);
+//   void ListenerRemoved(unsigned int listener_uid);
+//   bool GetListeners(const NotifierData& data,
+//                     SmallVectorImpl<unsigned int>& listener_uids);
+// GetListeners() should fill listener_uids with the listeners (in increasing
+// order) that may match data and return true, or return false to check
+// every listener.  Matches() is still called for each returned listener.
+// To allow polled events to be coalesced, Derived may also hide:
+//   bool GetCoalesceKey(const ListenerData& listener, const NotifierData& data,
+//                       unsigned int* key);
+//   bool Coalesce(NotifierData* pending, const NotifierData& data);
+// If GetCoalesceKey() returns true and an event for the same listener and key
+// is still queued in the poller, Coalesce() is called to merge data into the
+// queued event; if it returns false, data is queued as a new event.
 template <typename Derived, typename TUserInfo,
           typename TListenerData =
               CallbackListenerData<std::function<void(const TUserInfo& info)>>,
@@ -67,6 +100,20 @@ class CallbackThread : public wpi::SafeThread {
 
   void Main() override;
 
+  void ListenerAdded(unsigned int /*listener_uid*/) {}
+  void ListenerRemoved(unsigned int /*listener_uid*/) {}
+  bool GetListeners(const NotifierData& /*data*/,
+                    SmallVectorImpl<unsigned int>& /*listener_uids*/) {
+    return false;
+  }
+  bool GetCoalesceKey(const ListenerData& /*listener*/,
+                      const NotifierData& /*data*/, unsigned int* /*key*/) {
+    return false;
+  }
+  bool Coalesce(NotifierData* /*pending*/, const NotifierData& /*data*/) {
+    return false;
+  }
+
   wpi::UidVector<ListenerData, 64> m_listeners;
 
   std::queue<std::pair<unsigned int, NotifierData>> m_queue;
@@ -80,7 +127,23 @@ class CallbackThread : public wpi::SafeThread {
       }
       poll_cond.notify_all();
     }
-    std::queue<NotifierData> poll_queue;
+    template <typename... Args>
+    void Push(Args&&... args) {
+      if (max_queue != 0 && poll_queue.size() >= max_queue) {
+        poll_queue.pop_front();
+        ++poll_queue_start;
+        ++stats.dropped;
+      }
+      poll_queue.emplace_back(std::forward<Args>(args)...);
+    }
+    std::deque<NotifierData> poll_queue;
+    // Sequence number of poll_queue.front()
+    uint64_t poll_queue_start = 0;
+    // Coalescing key to sequence number of the queued event
+    wpi::DenseMap<uint64_t, uint64_t> coalesce_index;
+    // Maximum queue size (0 for unlimited)
+    size_t max_queue = 0;
+    CallbackPollerStats stats;
     wpi::mutex poll_mutex;
     wpi::condition_variable poll_cond;
     bool terminating = false;
@@ -103,7 +166,33 @@ class CallbackThread : public wpi::SafeThread {
     }
     {
       std::scoped_lock lock(poller->poll_mutex);
-      poller->poll_queue.emplace(std::forward<Args>(args)...);
+      poller->Push(std::forward<Args>(args)...);
+    }
+    poller->poll_cond.notify_one();
+  }
+
+  // Must be called with m_mutex held
+  void SendPollerCoalesce(unsigned int poller_uid, uint64_t key,
+                          const NotifierData& data) {
+    if (poller_uid > m_pollers.size()) {
+      return;
+    }
+    auto poller = m_pollers[poller_uid];
+    if (!poller) {
+      return;
+    }
+    {
+      std::scoped_lock lock(poller->poll_mutex);
+      auto [it, inserted] = poller->coalesce_index.try_emplace(key, 0);
+      if (!inserted && it->second >= poller->poll_queue_start &&
+          static_cast<Derived*>(this)->Coalesce(
+              &poller->poll_queue[it->second - poller->poll_queue_start],
+              data)) {
+        ++poller->stats.coalesced;
+        return;  // already queued, so no need to wake up the poller
+      }
+      poller->Push(data);
+      it->second = poller->poll_queue_start + poller->poll_queue.size() - 1;
     }
     poller->poll_cond.notify_one();
   }
@@ -117,6 +206,32 @@ void CallbackThread<Derived, TUserInfo, TListenerData, TNotifierData>::Main() {
   }
 
   std::unique_lock lock(m_mutex);
+
+  // Dispatches data to listener i
+  auto dispatch = [&](unsigned int i, NotifierData& data, bool copy) {
+    auto& listener = m_listeners[i];
+    if (!listener || !static_cast<Derived*>(this)->Matches(listener, data)) {
+      return;
+    }
+    static_cast<Derived*>(this)->SetListener(&data, i);
+    if (listener.callback) {
+      lock.unlock();
+      static_cast<Derived*>(this)->DoCallback(listener.callback, data);
+      lock.lock();
+    } else if (listener.poller_uid != UINT_MAX) {
+      unsigned int key;
+      if (static_cast<Derived*>(this)->GetCoalesceKey(listener, data, &key)) {
+        SendPollerCoalesce(listener.poller_uid, (uint64_t{i} << 32) | key,
+                           data);
+      } else if (copy) {
+        SendPoller(listener.poller_uid, data);
+      } else {
+        SendPoller(listener.poller_uid, std::move(data));
+      }
+    }
+  };
+
+  SmallVector<unsigned int, 16> candidates;
   while (m_active) {
     while (m_queue.empty()) {
       m_cond.wait(lock);
@@ -133,40 +248,22 @@ void CallbackThread<Derived, TUserInfo, TListenerData, TNotifierData>::Main() {
 
       if (item.first != UINT_MAX) {
         if (item.first < m_listeners.size()) {
-          auto& listener = m_listeners[item.first];
-          if (listener &&
-              static_cast<Derived*>(this)->Matches(listener, item.second)) {
-            static_cast<Derived*>(this)->SetListener(&item.second, item.first);
-            if (listener.callback) {
-              lock.unlock();
-              static_cast<Derived*>(this)->DoCallback(listener.callback,
-                                                      item.second);
-              lock.lock();
-            } else if (listener.poller_uid != UINT_MAX) {
-              SendPoller(listener.poller_uid, std::move(item.second));
-            }
-          }
+          dispatch(item.first, item.second, false);
         }
       } else {
-        // Use index because iterator might get invalidated.
-        for (size_t i = 0; i < m_listeners.size(); ++i) {
-          auto& listener = m_listeners[i];
-          if (!listener) {
-            continue;
-          }
-
-          if (!static_cast<Derived*>(this)->Matches(listener, item.second)) {
-            continue;
+        candidates.clear();
+        if (static_cast<Derived*>(this)->GetListeners(item.second,
+                                                      candidates)) {
+          // Candidates are a snapshot, as callbacks may add/remove listeners.
+          for (auto i : candidates) {
+            if (i < m_listeners.size()) {
+              dispatch(i, item.second, true);
+            }
           }
-          static_cast<Derived*>(this)->SetListener(&item.second,
-                                                   static_cast<unsigned>(i));
-          if (listener.callback) {
-            lock.unlock();
-            static_cast<Derived*>(this)->DoCallback(listener.callback,
-                                                    item.second);
-            lock.lock();
-          } else if (listener.poller_uid != UINT_MAX) {
-            SendPoller(listener.poller_uid, item.second);
+        } else {
+          // Use index because iterator might get invalidated.
+          for (size_t i = 0; i < m_listeners.size(); ++i) {
+            dispatch(static_cast<unsigned int>(i), item.second, true);
           }
         }
       }
@@ -208,6 +305,10 @@ class CallbackManager {
     if (!thr) {
       return;
     }
+    if (listener_uid < thr->m_listeners.size() &&
+        thr->m_listeners[listener_uid]) {
+      thr->ListenerRemoved(listener_uid);
+    }
     thr->m_listeners.erase(listener_uid);
   }
 
@@ -226,7 +327,9 @@ class CallbackManager {
 
     // Remove any listeners that are associated with this poller
     for (size_t i = 0; i < thr->m_listeners.size(); ++i) {
-      if (thr->m_listeners[i].poller_uid == poller_uid) {
+      if (thr->m_listeners[i] &&
+          thr->m_listeners[i].poller_uid == poller_uid) {
+        thr->ListenerRemoved(i);
         thr->m_listeners.erase(i);
       }
     }
@@ -324,13 +427,37 @@ class CallbackManager {
       }
     }
 
-    while (!poller->poll_queue.empty()) {
-      infos.emplace_back(std::move(poller->poll_queue.front()));
-      poller->poll_queue.pop();
+    // drain everything in a single lock acquisition
+    infos.reserve(poller->poll_queue.size());
+    for (auto&& data : poller->poll_queue) {
+      infos.emplace_back(std::move(data));
     }
+    poller->poll_queue_start += poller->poll_queue.size();
+    poller->poll_queue.clear();
+    poller->coalesce_index.clear();
     return infos;
   }
 
+  void SetPollerQueueLimit(unsigned int poller_uid, size_t limit) {
+    auto poller = GetPoller(poller_uid);
+    if (!poller) {
+      return;
+    }
+    std::scoped_lock lock(poller->poll_mutex);
+    poller->max_queue = limit;
+  }
+
+  CallbackPollerStats GetPollerStats(unsigned int poller_uid) {
+    auto poller = GetPoller(poller_uid);
+    if (!poller) {
+      return {};
+    }
+    std::scoped_lock lock(poller->poll_mutex);
+    CallbackPollerStats stats = poller->stats;
+    stats.queued = poller->poll_queue.size();
+    return stats;
+  }
+
   void CancelPoll(unsigned int poller_uid) {
     std::shared_ptr<typename Thread::Poller> poller;
     {
@@ -355,6 +482,14 @@ class CallbackManager {
   }
 
  protected:
+  std::shared_ptr<typename Thread::Poller> GetPoller(unsigned int poller_uid) {
+    auto thr = m_owner.GetThread();
+    if (!thr || poller_uid >= thr->m_pollers.size()) {
+      return nullptr;
+    }
+    return thr->m_pollers[poller_uid];
+  }
+
   template <typename... Args>
   void DoStart(Args&&... args) {
     m_owner.Start(m_on_start, m_on_exit, std::forward<Args>(args)...);
@@ -364,7 +499,10 @@ class CallbackManager {
   unsigned int DoAdd(Args&&... args) {
     static_cast<Derived*>(this)->Start();
     auto thr = m_owner.GetThread();
-    return thr->m_listeners.emplace_back(std::forward<Args>(args)...);
+    unsigned int uid =
+        thr->m_listeners.emplace_back(std::forward<Args>(args)...);
+    thr->ListenerAdded(uid);
+    return uid;
   }
 
   template <typename... Args>
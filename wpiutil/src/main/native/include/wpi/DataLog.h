@@ -6,9 +6,11 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -34,6 +36,14 @@ enum ControlRecordType {
   kControlSetMetadata
 };
 
+// Extra header prefix marking a log whose records are stored in compressed
+// frames
+constexpr std::string_view kCompressedHeader = "compression=lz4\n";
+
+// Maximum uncompressed size of a compressed frame (larger records are stored
+// in a frame of their own)
+constexpr size_t kCompressedFrameSize = 64 * 1024;
+
 }  // namespace impl
 
 /**
@@ -56,12 +66,17 @@ enum ControlRecordType {
  * good idea to call Finish() from destructors for this reason.
  *
  * DataLog calls are thread safe.  DataLog uses a typical multiple-supplier,
- * single-consumer setup.  Writes to the log are atomic, but there is no
- * guaranteed order in the log when multiple threads are writing to it;
- * whichever thread grabs the write mutex first will get written first.
- * For this reason (as well as the fact that timestamps can be set to
- * arbitrary values), records in the log are not guaranteed to be sorted by
- * timestamp.
+ * single-consumer setup.  Each thread appends records to its own buffer
+ * without locking, and the background thread merges the buffers in timestamp
+ * order as it writes them.  Writes to the log are atomic, and start records
+ * are always written before records appended to the started entry.  Records
+ * written in different flush periods are not reordered, so (as well as the
+ * fact that timestamps can be set to arbitrary values) records in the log are
+ * not guaranteed to be sorted by timestamp.
+ *
+ * The log can optionally be compressed.  Each flush is split into frames of
+ * whole records that are compressed independently, so readers can skip
+ * through frames and recover all complete frames of a truncated log.
  */
 class DataLog final {
  public:
@@ -75,9 +90,11 @@ class DataLog final {
    * @param period time between automatic flushes to disk, in seconds;
    *               this is a time/storage tradeoff
    * @param extraHeader extra header data
+   * @param compressed compress the log
    */
   explicit DataLog(std::string_view dir = "", std::string_view filename = "",
-                   double period = 0.25, std::string_view extraHeader = "");
+                   double period = 0.25, std::string_view extraHeader = "",
+                   bool compressed = false);
 
   /**
    * Construct a new Data Log.  The log will be initially created with a
@@ -90,10 +107,11 @@ class DataLog final {
    * @param period time between automatic flushes to disk, in seconds;
    *               this is a time/storage tradeoff
    * @param extraHeader extra header data
+   * @param compressed compress the log
    */
   explicit DataLog(wpi::Logger& msglog, std::string_view dir = "",
                    std::string_view filename = "", double period = 0.25,
-                   std::string_view extraHeader = "");
+                   std::string_view extraHeader = "", bool compressed = false);
 
   /**
    * Construct a new Data Log that passes its output to the provided function
@@ -105,9 +123,11 @@ class DataLog final {
    * @param period time between automatic calls to write, in seconds;
    *               this is a time/storage tradeoff
    * @param extraHeader extra header data
+   * @param compressed compress the log
    */
   explicit DataLog(std::function<void(wpi::span<const uint8_t> data)> write,
-                   double period = 0.25, std::string_view extraHeader = "");
+                   double period = 0.25, std::string_view extraHeader = "",
+                   bool compressed = false);
 
   /**
    * Construct a new Data Log that passes its output to the provided function
@@ -120,10 +140,12 @@ class DataLog final {
    * @param period time between automatic calls to write, in seconds;
    *               this is a time/storage tradeoff
    * @param extraHeader extra header data
+   * @param compressed compress the log
    */
   explicit DataLog(wpi::Logger& msglog,
                    std::function<void(wpi::span<const uint8_t> data)> write,
-                   double period = 0.25, std::string_view extraHeader = "");
+                   double period = 0.25, std::string_view extraHeader = "",
+                   bool compressed = false);
 
   ~DataLog();
   DataLog(const DataLog&) = delete;
@@ -155,6 +177,60 @@ class DataLog final {
    */
   void Resume();
 
+  /**
+   * What to do with data records appended while the memory limit is reached.
+   */
+  enum class LimitPolicy {
+    /** Appends wait for the background thread to write buffered records. */
+    kBlock,
+    /** Records are dropped. */
+    kDrop,
+    /**
+     * Records of low priority entries are dropped once half the memory limit
+     * is used; other records are dropped when all of it is used.
+     */
+    kDropLowPriority
+  };
+
+  /**
+   * Limits the memory used to buffer records that have not been written yet
+   * (e.g. because the disk has stalled).  Control records (entry starts /
+   * finishes / metadata changes) are never dropped.  Dropped records are
+   * counted per entry and logged to "DataLog/dropped/<entry name>" entries
+   * (without the leading "/" of the entry name).
+   *
+   * @param bytes memory limit, in bytes; 0 for no limit (the default)
+   * @param policy what to do with data records appended at the limit
+   */
+  void SetMemoryLimit(size_t bytes, LimitPolicy policy = LimitPolicy::kDrop);
+
+  /**
+   * Sets the minimum free space on the log file's disk.  While less space is
+   * available, data records are dropped rather than written to the file.
+   * Has no effect if the log is written to a function.
+   *
+   * @param bytes free space, in bytes; 0 to disable (the default)
+   */
+  void SetMinFreeSpace(uintmax_t bytes);
+
+  /**
+   * Sets whether an entry is low priority.  Records of low priority entries
+   * are dropped first when using LimitPolicy::kDropLowPriority.
+   *
+   * @param entry Entry index
+   * @param lowPriority true to make the entry low priority
+   */
+  void SetLowPriority(int entry, bool lowPriority = true);
+
+  /**
+   * Gets the number of records of an entry that have been dropped because of
+   * the memory limit or low disk space.
+   *
+   * @param entry Entry index
+   * @return Number of dropped records
+   */
+  uint64_t GetDroppedCount(int entry) const;
+
   /**
    * Start an entry.  Duplicate names are allowed (with the same type), and
    * result in the same index being returned (Start/Finish are reference
@@ -189,6 +265,20 @@ class DataLog final {
    */
   void SetMetadata(int entry, std::string_view metadata, int64_t timestamp = 0);
 
+  /**
+   * Registers a struct schema, so readers can decode the records of entries
+   * of the returned data type (see StructDescriptor for the schema format).
+   * The schema is stored as the metadata of a "/.schema/struct:<name>" entry;
+   * the first schema registered for a name is used.
+   *
+   * @param name Struct name (e.g. "Pose2d")
+   * @param schema Struct schema (e.g. "double x; double y; double rot")
+   * @param timestamp Time stamp (may be 0 to indicate now)
+   * @return Data type of entries of the struct (e.g. "struct:Pose2d")
+   */
+  std::string AddStructSchema(std::string_view name, std::string_view schema,
+                              int64_t timestamp = 0);
+
   /**
    * Appends a record to the log.
    *
@@ -231,29 +321,94 @@ class DataLog final {
                          int64_t timestamp);
 
  private:
+  friend class DataLogBatch;
+  class ThreadBuffer;
+
   void WriterThreadMain(std::string_view dir);
   void WriterThreadMain(
       std::function<void(wpi::span<const uint8_t> data)> write);
 
+  // gets (registering if needed) the calling thread's buffer for this log;
+  // must not be called with m_mutex held
+  ThreadBuffer& GetThreadBuffer();
+
+  // returns nullptr if the record was dropped
+  uint8_t* StartRecord(ThreadBuffer& buf, uint32_t entry, uint64_t timestamp,
+                       uint32_t payloadSize, size_t reserveSize);
+  // checks the memory limit before buf allocates blocks for a record of the
+  // given size; returns false if the record should be dropped
+  bool CheckMemoryLimit(ThreadBuffer& buf, int entry, size_t size);
+
   // must be called with m_mutex held
-  uint8_t* StartRecord(uint32_t entry, uint64_t timestamp, uint32_t payloadSize,
-                       size_t reserveSize);
-  uint8_t* Reserve(size_t size);
-  void AppendImpl(wpi::span<const uint8_t> data);
-  void AppendStringImpl(std::string_view str);
+  uint8_t* StartControlRecord(ThreadBuffer& buf, uint64_t timestamp,
+                              uint32_t payloadSize, size_t reserveSize);
+  void FinishControlRecord(ThreadBuffer& buf);
+
+  // append implementations, for an entry > 0 and a log that isn't paused
+  void AppendRaw(ThreadBuffer& buf, int entry, wpi::span<const uint8_t> data,
+                 int64_t timestamp);
+  void AppendBoolean(ThreadBuffer& buf, int entry, bool value,
+                     int64_t timestamp);
+  void AppendInteger(ThreadBuffer& buf, int entry, int64_t value,
+                     int64_t timestamp);
+  void AppendFloat(ThreadBuffer& buf, int entry, float value,
+                   int64_t timestamp);
+  void AppendDouble(ThreadBuffer& buf, int entry, double value,
+                    int64_t timestamp);
+
+  // called from the writer thread with m_mutex held (released while merging);
+  // moves committed records from the thread buffers to out, merged in
+  // timestamp order
+  void CollectRecords(std::vector<uint8_t>* out,
+                      std::unique_lock<wpi::mutex>& lock);
+  // called from the writer thread with m_mutex held after collecting; frees
+  // idle blocks if the memory limit was reached and wakes blocked appends
+  void ReleaseBlocks();
+  // called from the writer thread with m_mutex held; removes data records
+  // from records, counting them as dropped
+  void DropRecords(std::vector<uint8_t>* records);
+  // called from the writer thread with m_mutex held (released while
+  // appending); logs changed dropped record counts
+  void LogDroppedCounts(std::unique_lock<wpi::mutex>& lock);
 
   wpi::Logger& m_msglog;
   mutable wpi::mutex m_mutex;
   wpi::condition_variable m_cond;
+  // notified when blocks are released
+  wpi::condition_variable m_spaceCond;
   bool m_active{true};
   bool m_doFlush{false};
-  bool m_paused{false};
+  std::atomic_bool m_paused{false};
   double m_period;
+  bool m_compressed;
   std::string m_extraHeader;
   std::string m_newFilename;
-  class Buffer;
-  std::vector<Buffer> m_free;
-  std::vector<Buffer> m_outgoing;
+  uint64_t m_id;
+  std::vector<std::shared_ptr<ThreadBuffer>> m_threadBuffers;
+  // sequence number of the last control record (written with m_mutex held)
+  std::atomic<uint32_t> m_controlSeq{0};
+  // sequence number of the last control record written out (writer thread)
+  uint32_t m_controlWritten{0};
+  // number of blocks holding or waiting for data in the thread buffers (see
+  // ThreadBuffer)
+  std::atomic<size_t> m_numBlocks{0};
+  // 0 for no limit
+  std::atomic<size_t> m_maxBlocks{0};
+  std::atomic<LimitPolicy> m_limitPolicy{LimitPolicy::kDrop};
+  // set when an append reaches the memory limit
+  std::atomic_bool m_limited{false};
+  // number of flushes that found nothing to write
+  uint64_t m_idleFlushes{0};
+  std::atomic<uintmax_t> m_minFreeSpace{0};
+  struct EntryStats {
+    // true for the entries logging dropped counts
+    bool stats = false;
+    bool lowPriority = false;
+    uint64_t dropped = 0;
+    uint64_t droppedLogged = 0;
+    int statsEntry = 0;
+  };
+  wpi::DenseMap<int, EntryStats> m_entryStats;
   struct EntryInfo {
     std::string type;
     int id{0};
@@ -264,6 +419,81 @@ class DataLog final {
   std::thread m_thread;
 };
 
+/**
+ * Appends records for several entries with one timestamp, e.g. the values
+ * of a mechanism sampled together.  This is cheaper than the DataLog append
+ * functions, as the calling thread's buffer is looked up and the timestamp is
+ * taken once for the batch rather than for each record.
+ *
+ * A batch must only be used on the thread that created it, and must not
+ * outlive the log.
+ */
+class DataLogBatch {
+ public:
+  /**
+   * Starts a batch.
+   *
+   * @param log Data log
+   * @param timestamp Time stamp of the records (may be 0 to indicate now)
+   */
+  explicit DataLogBatch(DataLog& log, int64_t timestamp = 0);
+
+  DataLogBatch(const DataLogBatch&) = delete;
+  DataLogBatch& operator=(const DataLogBatch&) = delete;
+
+  /**
+   * Gets the time stamp of the records.
+   *
+   * @return Time stamp
+   */
+  int64_t GetTimestamp() const { return m_timestamp; }
+
+  /**
+   * Appends a record to the log with the batch's time stamp.
+   *
+   * @param entry Entry index, as returned by DataLog::Start()
+   * @param data Data to record
+   */
+  void AppendRaw(int entry, wpi::span<const uint8_t> data);
+
+  /**
+   * Appends a boolean record to the log with the batch's time stamp.
+   *
+   * @param entry Entry index, as returned by DataLog::Start()
+   * @param value Boolean value to record
+   */
+  void AppendBoolean(int entry, bool value);
+
+  /**
+   * Appends a integer record to the log with the batch's time stamp.
+   *
+   * @param entry Entry index, as returned by DataLog::Start()
+   * @param value Integer value to record
+   */
+  void AppendInteger(int entry, int64_t value);
+
+  /**
+   * Appends a float record to the log with the batch's time stamp.
+   *
+   * @param entry Entry index, as returned by DataLog::Start()
+   * @param value Float value to record
+   */
+  void AppendFloat(int entry, float value);
+
+  /**
+   * Appends a double record to the log with the batch's time stamp.
+   *
+   * @param entry Entry index, as returned by DataLog::Start()
+   * @param value Double value to record
+   */
+  void AppendDouble(int entry, double value);
+
+ private:
+  DataLog& m_log;
+  DataLog::ThreadBuffer& m_buf;
+  int64_t m_timestamp;
+};
+
 /**
  * Log entry base class.
  */
@@ -693,4 +923,35 @@ class StringArrayLogEntry : public DataLogEntry {
   }
 };
 
+/**
+ * Log fixed-layout struct values.  The layout is described by a schema (see
+ * StructDescriptor) registered with the log, so readers can decode the
+ * fields.  Logging related values (e.g. a pose) as one struct record takes
+ * less space and time than logging a record per value.
+ */
+class StructLogEntry : public DataLogEntry {
+ public:
+  StructLogEntry() = default;
+  StructLogEntry(DataLog& log, std::string_view name,
+                 std::string_view structName, std::string_view schema,
+                 int64_t timestamp = 0)
+      : StructLogEntry{log, name, structName, schema, {}, timestamp} {}
+  StructLogEntry(DataLog& log, std::string_view name,
+                 std::string_view structName, std::string_view schema,
+                 std::string_view metadata, int64_t timestamp = 0)
+      : DataLogEntry{log, name,
+                     log.AddStructSchema(structName, schema, timestamp),
+                     metadata, timestamp} {}
+
+  /**
+   * Appends a record to the log.
+   *
+   * @param data Struct data, laid out as described by the schema
+   * @param timestamp Time stamp (may be 0 to indicate now)
+   */
+  void Append(wpi::span<const uint8_t> data, int64_t timestamp = 0) {
+    m_log->AppendRaw(m_entry, data, timestamp);
+  }
+};
+
 }  // namespace wpi::log
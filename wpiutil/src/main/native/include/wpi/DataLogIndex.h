@@ -0,0 +1,169 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "wpi/DataLogReader.h"
+#include "wpi/DenseMap.h"
+#include "wpi/StringMap.h"
+#include "wpi/span.h"
+
+namespace wpi::log {
+
+/**
+ * Index of the records in a data log, for random access.  The index stores
+ * the position of every data record by entry and a sparse time index, so
+ * seeking to a timestamp is O(log n) and iterating over the records of one
+ * entry doesn't touch the records of any other entries.
+ *
+ * The index refers to the reader's buffer, so the reader must outlive it.
+ * Opening the log with MemoryBuffer::GetFile() maps the file into memory, so
+ * only the parts of the file that are used are read.
+ *
+ * Building the index requires a full pass over the log; the index can be
+ * saved to a sidecar file to avoid this the next time the log is opened.
+ */
+class DataLogIndex {
+ public:
+  /** Number of records between sparse time index points. */
+  static constexpr size_t kTimeIndexInterval = 1024;
+
+  /** An indexed entry.  An entry ID that is reused is a separate entry. */
+  struct Entry {
+    /** Start record data; the metadata is the latest set for the entry. */
+    StartRecordData data;
+    /** Position of the start record. */
+    uint64_t startPos = 0;
+    /** Position of the last set metadata record, or UINT64_MAX if none. */
+    uint64_t metadataPos = UINT64_MAX;
+    /** Position of the finish record, or UINT64_MAX if not finished. */
+    uint64_t finishPos = UINT64_MAX;
+    /** Positions of the data records, in log order. */
+    std::vector<uint64_t> records;
+  };
+
+  /**
+   * Constructs an empty index.  Call IndexRecords() or Load() to fill it.
+   * The reader must be valid.
+   *
+   * @param reader data log reader
+   */
+  explicit DataLogIndex(const DataLogReader& reader);
+
+  /**
+   * Indexes more of the log.  This allows building the index in steps, e.g.
+   * to report progress or cancel.
+   *
+   * @param count maximum number of records to index
+   * @return True if the index is complete
+   */
+  bool IndexRecords(size_t count = SIZE_MAX);
+
+  /**
+   * Returns true if the entire log has been indexed.
+   *
+   * @return True if complete
+   */
+  bool IsComplete() const { return m_complete; }
+
+  /**
+   * Gets the number of records (including control records) indexed.
+   *
+   * @return Number of records
+   */
+  uint64_t GetNumRecords() const { return m_numRecords; }
+
+  /**
+   * Gets all entries, in order of their start records.
+   *
+   * @return Entries
+   */
+  wpi::span<const Entry> GetEntries() const { return m_entries; }
+
+  /**
+   * Finds the last entry started with a name.
+   *
+   * @param name entry name
+   * @return Entry, or nullptr if not found
+   */
+  const Entry* FindEntry(std::string_view name) const;
+
+  /**
+   * Gets the record at a position stored in the index.
+   *
+   * @param pos record position
+   * @return Record (empty if the position is invalid)
+   */
+  DataLogRecord GetRecord(uint64_t pos) const;
+
+  /**
+   * Seeks to a timestamp.  All records with a timestamp at or after the
+   * given timestamp are at or after the returned iterator.  As records in a
+   * log are not strictly sorted, some records before the timestamp may
+   * follow it as well.
+   *
+   * @param timestamp timestamp, in integer microseconds
+   * @return Iterator
+   */
+  DataLogIterator Seek(int64_t timestamp) const;
+
+  /**
+   * Gets the positions of the data records of an entry, starting with the
+   * first that may be at or after a timestamp (see Seek()).
+   *
+   * @param entry entry
+   * @param timestamp timestamp, in integer microseconds
+   * @return Record positions
+   */
+  wpi::span<const uint64_t> GetRecords(const Entry& entry,
+                                       int64_t timestamp = INT64_MIN) const;
+
+  /**
+   * Loads a saved index.  Fails if the index was saved for a different log
+   * (or a different length of the same log).
+   *
+   * @param filename index filename
+   * @param ec error code (set if the file could not be read)
+   * @return True if loaded
+   */
+  bool Load(std::string_view filename, std::error_code& ec);
+
+  /**
+   * Saves a complete index.
+   *
+   * @param filename index filename
+   * @param ec error code
+   */
+  void Save(std::string_view filename, std::error_code& ec) const;
+
+ private:
+  uint64_t GetLogHash() const;
+  // returns the position of the first time index block that may contain
+  // a record at or after timestamp
+  uint64_t SeekPos(int64_t timestamp) const;
+
+  const DataLogReader& m_reader;
+  uint64_t m_pos;
+  uint64_t m_numRecords = 0;
+  bool m_complete = false;
+  std::vector<Entry> m_entries;
+  // index into m_entries of started entries, by entry ID
+  wpi::DenseMap<int, size_t> m_activeEntries;
+  wpi::StringMap<size_t> m_entryNames;
+  // sparse time index: position of every kTimeIndexInterval'th record and
+  // the maximum timestamp of all records before the next point
+  struct TimePoint {
+    uint64_t pos;
+    int64_t maxTimestamp;
+  };
+  std::vector<TimePoint> m_timeIndex;
+};
+
+}  // namespace wpi::log
@@ -297,12 +297,17 @@ class DataLogIterator {
 
 /** Data log reader (reads logs written by the DataLog class). */
 class DataLogReader {
+  friend class DataLogIndex;
   friend class DataLogIterator;
+  friend class DataLogTailReader;
 
  public:
   using iterator = DataLogIterator;
 
-  /** Constructs from a memory buffer. */
+  /**
+   * Constructs from a memory buffer.  Compressed logs are decompressed into a
+   * new buffer; a partially written last frame is ignored.
+   */
   explicit DataLogReader(std::unique_ptr<MemoryBuffer> buffer);
 
   /** Returns true if the data log is valid (e.g. has a valid header). */
@@ -326,6 +331,13 @@ class DataLogReader {
    */
   std::string_view GetExtraHeader() const;
 
+  /**
+   * Returns true if the data log was written compressed.
+   *
+   * @return True if compressed
+   */
+  bool IsCompressed() const;
+
   /**
    * Gets the buffer identifier, typically the filename.
    *
@@ -344,6 +356,9 @@ class DataLogReader {
  private:
   std::unique_ptr<MemoryBuffer> m_buf;
 
+  void Decompress();
+  static bool ParseRecord(wpi::span<const uint8_t> buf, size_t* pos,
+                          DataLogRecord* out);
   bool GetRecord(size_t* pos, DataLogRecord* out) const;
   bool GetNextRecord(size_t* pos) const;
 };
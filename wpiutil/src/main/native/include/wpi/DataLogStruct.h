@@ -0,0 +1,186 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "wpi/StringMap.h"
+#include "wpi/span.h"
+
+namespace wpi::log {
+
+struct StartRecordData;
+
+/** Prefix of the data type of struct entries (followed by the struct name). */
+constexpr std::string_view kStructTypePrefix = "struct:";
+
+/** Data type of struct schema entries. */
+constexpr std::string_view kStructSchemaType = "structschema";
+
+/**
+ * Prefix of the name of struct schema entries (followed by the data type of
+ * the struct entries, e.g. "/.schema/struct:Pose2d").
+ */
+constexpr std::string_view kStructSchemaPrefix = "/.schema/";
+
+/** Type of a struct field. */
+enum class StructFieldType {
+  kBool,
+  kChar,
+  kInt8,
+  kInt16,
+  kInt32,
+  kInt64,
+  kUint8,
+  kUint16,
+  kUint32,
+  kUint64,
+  kFloat,
+  kDouble
+};
+
+/** A field of a struct. */
+struct StructField {
+  /** Field name. */
+  std::string name;
+
+  /** Field type. */
+  StructFieldType type;
+
+  /** Offset of the field from the start of the struct, in bytes. */
+  size_t offset;
+
+  /** Size of each element, in bytes. */
+  size_t size;
+
+  /** Number of elements (1 if not an array). */
+  size_t count;
+
+  /**
+   * Gets an element as a boolean (true if nonzero).
+   *
+   * @param data struct data
+   * @param value value (output)
+   * @param index array index
+   * @return False if the data is too short or the index is out of range
+   */
+  bool GetBoolean(wpi::span<const uint8_t> data, bool* value,
+                  size_t index = 0) const;
+
+  /**
+   * Gets an element as an integer.  Floating point values are truncated.
+   *
+   * @param data struct data
+   * @param value value (output)
+   * @param index array index
+   * @return False if the data is too short, the index is out of range, or a
+   *         floating point value is NaN or out of range of int64_t
+   */
+  bool GetInteger(wpi::span<const uint8_t> data, int64_t* value,
+                  size_t index = 0) const;
+
+  /**
+   * Gets an element as a double.
+   *
+   * @param data struct data
+   * @param value value (output)
+   * @param index array index
+   * @return False if the data is too short or the index is out of range
+   */
+  bool GetDouble(wpi::span<const uint8_t> data, double* value,
+                 size_t index = 0) const;
+
+  /**
+   * Gets a char array field as a string.  The string ends at the first null
+   * character, if any.
+   *
+   * @param data struct data
+   * @param value value (output)
+   * @return False if not a char field or the data is too short
+   */
+  bool GetString(wpi::span<const uint8_t> data, std::string_view* value) const;
+};
+
+/**
+ * Layout of a struct record, as described by its schema.  A schema is a list
+ * of fields separated by semicolons, each a type followed by a name and an
+ * optional array length, e.g. "double x; double y; int32 flags[2]".  The
+ * types are bool, char, int8, int16, int32, int64, uint8, uint16, uint32,
+ * uint64, float (or float32), and double (or float64).  Fields are stored in
+ * order without padding, in little endian byte order.
+ */
+class StructDescriptor {
+ public:
+  /**
+   * Parses a schema.
+   *
+   * @param schema schema
+   * @return Descriptor, or empty if the schema is invalid
+   */
+  static std::optional<StructDescriptor> Parse(std::string_view schema);
+
+  /**
+   * Gets the size of the struct, in bytes.
+   *
+   * @return Size
+   */
+  size_t GetSize() const { return m_size; }
+
+  /**
+   * Gets the fields of the struct, in order.
+   *
+   * @return Fields
+   */
+  wpi::span<const StructField> GetFields() const { return m_fields; }
+
+  /**
+   * Finds a field by name.
+   *
+   * @param name field name
+   * @return Field, or nullptr if not found
+   */
+  const StructField* FindField(std::string_view name) const;
+
+ private:
+  std::vector<StructField> m_fields;
+  size_t m_size = 0;
+};
+
+/**
+ * Struct descriptors of a log, by entry data type.  Pass every start record
+ * read from a log to Add(); the descriptor of the data type of a struct entry
+ * can then be looked up with Find().
+ */
+class StructRegistry {
+ public:
+  /**
+   * Adds the struct schema of a start record, if it starts a struct schema
+   * entry.  As with DataLog::AddStructSchema(), the first schema for a name
+   * is used; later ones are ignored.
+   *
+   * @param data start record data
+   * @return True if a schema was added
+   */
+  bool Add(const StartRecordData& data);
+
+  /**
+   * Finds the descriptor of an entry data type (e.g. "struct:Pose2d").
+   *
+   * @param type entry data type
+   * @return Descriptor, or nullptr if not found
+   */
+  const StructDescriptor* Find(std::string_view type) const;
+
+ private:
+  wpi::StringMap<StructDescriptor> m_descriptors;
+};
+
+}  // namespace wpi::log
@@ -0,0 +1,108 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "wpi/DataLogReader.h"
+#include "wpi/raw_istream.h"
+#include "wpi/span.h"
+
+namespace wpi::log {
+
+/**
+ * Data log reader that follows a log file while it is being written.  Each
+ * call to Read() returns the complete records appended to the file since the
+ * previous call; a partially written record at the end of the file is kept
+ * until the rest of it is written.  The file is read only once, and memory use
+ * is bounded by the read size (or the largest record, if larger).
+ */
+class DataLogTailReader {
+ public:
+  /** Maximum number of bytes read from the file by each call to Read(). */
+  static constexpr size_t kMaxReadSize = 1024 * 1024;
+
+  /**
+   * Opens a log file.
+   *
+   * @param filename filename
+   * @param ec error code (set if the file could not be opened)
+   */
+  DataLogTailReader(std::string_view filename, std::error_code& ec);
+
+  /**
+   * Returns false if the file does not have a valid data log header.  Returns
+   * true if the header has not been written yet.
+   *
+   * @return False if invalid
+   */
+  bool IsValid() const { return m_state != kInvalid; }
+
+  /**
+   * Returns true once the header has been read.
+   *
+   * @return True if the header has been read
+   */
+  bool HasHeader() const { return m_state == kRecords; }
+
+  /**
+   * Gets the data log version. Returns 0 until the header has been read.
+   *
+   * @return Version number; most significant byte is major, least significant
+   *         is minor (so version 1.0 will be 0x0100)
+   */
+  uint16_t GetVersion() const { return m_version; }
+
+  /**
+   * Gets the extra header data.
+   *
+   * @return Extra header data
+   */
+  std::string_view GetExtraHeader() const { return m_extraHeader; }
+
+  /**
+   * Reads the complete records appended to the file since the last call.
+   * Does not block.  The returned records refer to internal storage, and are
+   * only valid until the next call.
+   *
+   * @return Records
+   */
+  wpi::span<const DataLogRecord> Read();
+
+  /**
+   * Like Read(), but if no records are available, polls the file until
+   * records are appended or the timeout expires.
+   *
+   * @param timeout timeout, in seconds
+   * @param period polling period, in seconds
+   * @return Records (empty on timeout)
+   */
+  wpi::span<const DataLogRecord> Wait(double timeout, double period = 0.05);
+
+ private:
+  enum State { kHeader, kRecords, kInvalid };
+
+  bool ReadHeader();
+  bool DecompressFrames();
+
+  wpi::raw_fd_istream m_is;
+  State m_state = kHeader;
+  uint16_t m_version = 0;
+  bool m_compressed = false;
+  std::string m_extraHeader;
+  // bytes read from the file but not yet decoded (header or frames)
+  std::vector<uint8_t> m_raw;
+  // record data; m_data[m_dataPos:] is the start of an incomplete record
+  std::vector<uint8_t> m_data;
+  size_t m_dataPos = 0;
+  std::vector<DataLogRecord> m_records;
+};
+
+}  // namespace wpi::log
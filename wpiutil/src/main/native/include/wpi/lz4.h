@@ -0,0 +1,48 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "wpi/span.h"
+
+namespace wpi {
+
+/**
+ * Gets the maximum compressed size of an input of the given size.
+ *
+ * @param size input size, in bytes
+ * @return Maximum size of the LZ4Compress() output
+ */
+constexpr size_t LZ4CompressBound(size_t size) {
+  return size + size / 255 + 16;
+}
+
+/**
+ * Compresses data into the LZ4 block format (without the LZ4 frame wrapper).
+ * Compression is fast and greedy; it favors CPU cost over compression ratio.
+ * The output is compatible with any LZ4 block decoder.
+ *
+ * @param in data to compress
+ * @param out output buffer; must be at least LZ4CompressBound(in.size())
+ *            bytes
+ * @return Number of bytes written to out
+ */
+size_t LZ4Compress(span<const uint8_t> in, span<uint8_t> out);
+
+/**
+ * Decompresses LZ4 block format data.  The decompressed size must be known in
+ * advance (it is not stored in the block).  Malformed input never reads or
+ * writes out of bounds.
+ *
+ * @param in compressed data
+ * @param out output buffer; must be exactly the decompressed size
+ * @return False if the input is malformed or does not decompress to exactly
+ *         out.size() bytes
+ */
+bool LZ4Decompress(span<const uint8_t> in, span<uint8_t> out);
+
+}  // namespace wpi
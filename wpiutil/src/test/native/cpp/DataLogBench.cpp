@@ -0,0 +1,237 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fmt/core.h"
+#include "gtest/gtest.h"
+#include "wpi/DataLog.h"
+#include "wpi/fs.h"
+#include "wpi/lz4.h"
+
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+// Appends from several threads at once (e.g. robot loop, vision, NT and DS
+// loggers) and reports per-append latency and total throughput.
+TEST(DataLogBenchTest, DISABLED_ContendedAppend) {
+  static constexpr int kNumAppends = 200000;
+
+  for (int numThreads : {1, 2, 4}) {
+    std::atomic<size_t> written{0};
+    std::vector<std::vector<int64_t>> latencies(numThreads);
+    high_resolution_clock::duration elapsed;
+    {
+      wpi::log::DataLog log{
+          [&](auto data) { written += data.size(); }, 0.02};
+      std::vector<wpi::log::DoubleLogEntry> entries;
+      for (int i = 0; i < numThreads; ++i) {
+        entries.emplace_back(log, fmt::format("/bench/{}", i));
+      }
+
+      std::atomic_int ready{0};
+      std::vector<std::thread> threads;
+      for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&, i] {
+          auto& entry = entries[i];
+          auto& lat = latencies[i];
+          lat.reserve(kNumAppends);
+          ++ready;
+          while (ready != numThreads) {
+            std::this_thread::yield();
+          }
+          for (int j = 0; j < kNumAppends; ++j) {
+            auto start = high_resolution_clock::now();
+            entry.Append(j);
+            auto stop = high_resolution_clock::now();
+            lat.push_back(duration_cast<nanoseconds>(stop - start).count());
+          }
+        });
+      }
+      auto start = high_resolution_clock::now();
+      for (auto&& thread : threads) {
+        thread.join();
+      }
+      elapsed = high_resolution_clock::now() - start;
+    }
+
+    std::vector<int64_t> all;
+    for (auto&& lat : latencies) {
+      all.insert(all.end(), lat.begin(), lat.end());
+    }
+    std::sort(all.begin(), all.end());
+    fmt::print(
+        "{} threads: p50: {}ns p99: {}ns max: {}ns, {:.1f}M appends/s, {} "
+        "bytes\n",
+        numThreads, all[all.size() / 2], all[all.size() * 99 / 100],
+        all.back(),
+        all.size() / static_cast<double>(
+                         duration_cast<microseconds>(elapsed).count()),
+        written.load());
+  }
+}
+
+// Logs a minute of typical robot telemetry (50 Hz loop: sensor values,
+// states, a pose and occasional status strings) to a file, uncompressed and
+// compressed, and reports write bandwidth, file size and compression CPU cost.
+TEST(DataLogBenchTest, DISABLED_Compression) {
+  static constexpr int kNumLoops = 3000;
+  static constexpr int kNumDoubles = 100;
+  static constexpr int kNumIntegers = 20;
+
+  auto logTelemetry = [](wpi::log::DataLog& log) {
+    std::vector<wpi::log::DoubleLogEntry> doubles;
+    for (int i = 0; i < kNumDoubles; ++i) {
+      doubles.emplace_back(log, fmt::format("/robot/sensor{}", i));
+    }
+    std::vector<wpi::log::IntegerLogEntry> integers;
+    for (int i = 0; i < kNumIntegers; ++i) {
+      integers.emplace_back(log, fmt::format("/robot/state{}", i));
+    }
+    wpi::log::DoubleArrayLogEntry pose{log, "/robot/pose"};
+    wpi::log::StringLogEntry status{log, "/robot/status"};
+
+    int64_t time = 1000000;
+    for (int loop = 0; loop < kNumLoops; ++loop) {
+      for (int i = 0; i < kNumDoubles; ++i) {
+        // slowly varying values with a little noise
+        doubles[i].Append(
+            std::sin(loop * 0.01 + i) * 10 + ((loop * 31 + i) % 7) * 0.001,
+            time + i);
+      }
+      for (int i = 0; i < kNumIntegers; ++i) {
+        integers[i].Append((loop / (50 + i)) % 4, time + kNumDoubles + i);
+      }
+      double p[] = {loop * 0.01, std::cos(loop * 0.01), loop * 0.001};
+      pose.Append(p, time + 150);
+      if (loop % 50 == 0) {
+        status.Append(fmt::format("loop {} overrun: false", loop), time + 151);
+      }
+      time += 20000;
+    }
+  };
+
+  auto dir = fs::temp_directory_path();
+  uintmax_t rawSize = 0;
+  for (bool compressed : {false, true}) {
+    auto filename =
+        fmt::format("datalogbench_{}.wpilog", compressed ? "lz4" : "raw");
+    std::error_code ec;
+    fs::remove(dir / filename, ec);
+    auto start = high_resolution_clock::now();
+    {
+      wpi::log::DataLog log{dir.string(), filename, 0.25, "", compressed};
+      logTelemetry(log);
+    }
+    auto elapsed = high_resolution_clock::now() - start;
+    auto size = fs::file_size(dir / filename);
+    fs::remove(dir / filename, ec);
+    if (!compressed) {
+      rawSize = size;
+    }
+    fmt::print("{}: {} bytes ({:.1f}%), {:.1f} MB/s\n",
+               compressed ? "compressed" : "uncompressed", size,
+               100.0 * size / rawSize,
+               rawSize / static_cast<double>(
+                             duration_cast<microseconds>(elapsed).count()));
+  }
+
+  // compression cost on the uncompressed records, in 64 KB frames
+  std::vector<uint8_t> records;
+  {
+    wpi::log::DataLog log{
+        [&](auto data) { records.insert(records.end(), data.begin(),
+                                        data.end()); },
+        1000.0};
+    logTelemetry(log);
+  }
+  static constexpr size_t kFrameSize = 64 * 1024;
+  std::vector<uint8_t> compressed(wpi::LZ4CompressBound(kFrameSize));
+  std::vector<uint8_t> decompressed(kFrameSize);
+  high_resolution_clock::duration compressTime{0};
+  high_resolution_clock::duration decompressTime{0};
+  for (size_t pos = 0; pos < records.size(); pos += kFrameSize) {
+    wpi::span<const uint8_t> frame{records.data() + pos,
+                                   std::min(kFrameSize, records.size() - pos)};
+    auto start = high_resolution_clock::now();
+    size_t size = wpi::LZ4Compress(frame, compressed);
+    auto mid = high_resolution_clock::now();
+    ASSERT_TRUE(wpi::LZ4Decompress({compressed.data(), size},
+                                   {decompressed.data(), frame.size()}));
+    auto stop = high_resolution_clock::now();
+    compressTime += mid - start;
+    decompressTime += stop - mid;
+  }
+  fmt::print("compress: {:.1f} MB/s, decompress: {:.1f} MB/s\n",
+             records.size() / static_cast<double>(
+                                  duration_cast<microseconds>(compressTime)
+                                      .count()),
+             records.size() / static_cast<double>(
+                                  duration_cast<microseconds>(decompressTime)
+                                      .count()));
+}
+
+// Logs a pose (x, y, rotation) per loop as three double entries, as a batch
+// of three double entries, and as one struct entry, and reports append time
+// and log size.
+TEST(DataLogBenchTest, DISABLED_StructAndBatch) {
+  static constexpr int kNumLoops = 200000;
+
+  auto run = [](const char* name, auto&& logPoses) {
+    size_t written = 0;
+    high_resolution_clock::duration elapsed;
+    {
+      wpi::log::DataLog log{[&](auto data) { written += data.size(); }, 0.02};
+      auto start = high_resolution_clock::now();
+      logPoses(log);
+      elapsed = high_resolution_clock::now() - start;
+    }
+    fmt::print("{}: {:.1f} ns/pose, {} bytes\n", name,
+               duration_cast<nanoseconds>(elapsed).count() /
+                   static_cast<double>(kNumLoops),
+               written);
+  };
+
+  run("entries", [](wpi::log::DataLog& log) {
+    wpi::log::DoubleLogEntry x{log, "/pose/x"};
+    wpi::log::DoubleLogEntry y{log, "/pose/y"};
+    wpi::log::DoubleLogEntry rot{log, "/pose/rot"};
+    for (int i = 0; i < kNumLoops; ++i) {
+      int64_t time = 1000 + i * 20;
+      x.Append(i * 0.01, time);
+      y.Append(i * 0.02, time);
+      rot.Append(i * 0.001, time);
+    }
+  });
+
+  run("batch", [](wpi::log::DataLog& log) {
+    int x = log.Start("/pose/x", "double");
+    int y = log.Start("/pose/y", "double");
+    int rot = log.Start("/pose/rot", "double");
+    for (int i = 0; i < kNumLoops; ++i) {
+      wpi::log::DataLogBatch batch{log, 1000 + i * 20};
+      batch.AppendDouble(x, i * 0.01);
+      batch.AppendDouble(y, i * 0.02);
+      batch.AppendDouble(rot, i * 0.001);
+    }
+  });
+
+  run("struct", [](wpi::log::DataLog& log) {
+    wpi::log::StructLogEntry pose{log, "/pose", "Pose2d",
+                                  "double x; double y; double rot"};
+    for (int i = 0; i < kNumLoops; ++i) {
+      double p[] = {i * 0.01, i * 0.02, i * 0.001};
+      pose.Append({reinterpret_cast<const uint8_t*>(p), sizeof(p)},
+                  1000 + i * 20);
+    }
+  });
+}
@@ -0,0 +1,174 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/DataLogIndex.h"  // NOLINT(build/include_order)
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "wpi/DataLog.h"
+#include "wpi/fs.h"
+#include "wpi/raw_ostream.h"
+
+namespace {
+class DataLogIndexTest : public ::testing::Test {
+ protected:
+  // writes 10000 records each of /even and /odd; record i has value i and
+  // timestamp i + 1
+  void WriteLog() {
+    wpi::log::DataLog log{[this](auto data) {
+                            output.insert(output.end(), data.begin(),
+                                          data.end());
+                          },
+                          1000.0};
+    int even = log.Start("/even", "int64", "", 1);
+    int odd = log.Start("/odd", "int64", "first", 1);
+    for (int i = 0; i < 20000; ++i) {
+      log.AppendInteger(i % 2 == 0 ? even : odd, i, i + 1);
+    }
+    log.SetMetadata(odd, "second", 20001);
+    log.Finish(even, 20001);
+  }
+
+  wpi::log::DataLogReader GetReader() {
+    return wpi::log::DataLogReader{wpi::MemoryBuffer::GetMemBufferCopy(output)};
+  }
+
+  static int64_t GetValue(const wpi::log::DataLogRecord& record) {
+    int64_t value = -1;
+    record.GetInteger(&value);
+    return value;
+  }
+
+  std::vector<uint8_t> output;
+};
+}  // namespace
+
+TEST_F(DataLogIndexTest, Entries) {
+  WriteLog();
+  auto reader = GetReader();
+  wpi::log::DataLogIndex index{reader};
+  EXPECT_FALSE(index.IsComplete());
+  EXPECT_TRUE(index.IndexRecords());
+  EXPECT_TRUE(index.IsComplete());
+  EXPECT_EQ(index.GetNumRecords(), 20004u);
+
+  ASSERT_EQ(index.GetEntries().size(), 2u);
+  auto even = index.FindEntry("/even");
+  auto odd = index.FindEntry("/odd");
+  ASSERT_TRUE(even);
+  ASSERT_TRUE(odd);
+  EXPECT_FALSE(index.FindEntry("/none"));
+  EXPECT_NE(even->finishPos, UINT64_MAX);
+  EXPECT_EQ(odd->finishPos, UINT64_MAX);
+  EXPECT_EQ(odd->data.type, "int64");
+  EXPECT_EQ(odd->data.metadata, "second");
+  ASSERT_EQ(odd->records.size(), 10000u);
+  for (size_t i = 0; i < odd->records.size(); ++i) {
+    auto record = index.GetRecord(odd->records[i]);
+    ASSERT_EQ(GetValue(record), static_cast<int64_t>(i * 2 + 1));
+  }
+  EXPECT_EQ(index.GetRecord(output.size()).GetEntry(), -1);
+}
+
+TEST_F(DataLogIndexTest, Incremental) {
+  WriteLog();
+  auto reader = GetReader();
+  wpi::log::DataLogIndex index{reader};
+  int steps = 0;
+  while (!index.IndexRecords(1000)) {
+    ++steps;
+  }
+  EXPECT_EQ(steps, 20);
+  EXPECT_EQ(index.GetNumRecords(), 20004u);
+  EXPECT_EQ(index.FindEntry("/even")->records.size(), 10000u);
+}
+
+TEST_F(DataLogIndexTest, Seek) {
+  WriteLog();
+  auto reader = GetReader();
+  wpi::log::DataLogIndex index{reader};
+  index.IndexRecords();
+
+  constexpr int64_t kInterval = wpi::log::DataLogIndex::kTimeIndexInterval;
+  for (int64_t t : {1, 1024, 1025, 12345, 20000}) {
+    // no earlier than an interval before the timestamp
+    auto it = index.Seek(t);
+    ASSERT_TRUE(it != reader.end());
+    EXPECT_LE(it->GetTimestamp(), t);
+    EXPECT_GT(it->GetTimestamp() + kInterval, t);
+
+    auto records = index.GetRecords(*index.FindEntry("/odd"), t);
+    ASSERT_FALSE(records.empty());
+    EXPECT_LE(index.GetRecord(records.front()).GetTimestamp(), t + 1);
+    EXPECT_EQ(GetValue(index.GetRecord(records.back())), 19999);
+  }
+  EXPECT_TRUE(index.Seek(20002) == reader.end());
+  EXPECT_TRUE(index.GetRecords(*index.FindEntry("/odd"), 20002).empty());
+}
+
+TEST_F(DataLogIndexTest, SaveLoad) {
+  WriteLog();
+  auto path = fs::temp_directory_path() / "datalogindextest.wpilogidx";
+  std::error_code ec;
+  {
+    auto reader = GetReader();
+    wpi::log::DataLogIndex index{reader};
+    index.Save(path.string(), ec);
+    EXPECT_TRUE(ec);  // not complete
+    ec.clear();
+    index.IndexRecords();
+    index.Save(path.string(), ec);
+    ASSERT_FALSE(ec);
+  }
+
+  {
+    auto reader = GetReader();
+    wpi::log::DataLogIndex index{reader};
+    ASSERT_TRUE(index.Load(path.string(), ec));
+    EXPECT_TRUE(index.IsComplete());
+    EXPECT_EQ(index.GetNumRecords(), 20004u);
+    auto odd = index.FindEntry("/odd");
+    ASSERT_TRUE(odd);
+    EXPECT_EQ(odd->data.metadata, "second");
+    ASSERT_EQ(odd->records.size(), 10000u);
+    EXPECT_EQ(GetValue(index.GetRecord(odd->records[5])), 11);
+    EXPECT_FALSE(index.GetRecords(*odd, 12345).empty());
+  }
+
+  // a different log is rejected
+  output.back() ^= 1;
+  {
+    auto reader = GetReader();
+    wpi::log::DataLogIndex index{reader};
+    EXPECT_FALSE(index.Load(path.string(), ec));
+    EXPECT_FALSE(index.IsComplete());
+  }
+  fs::remove(path, ec);
+}
+
+TEST_F(DataLogIndexTest, MappedFile) {
+  WriteLog();
+  auto path = fs::temp_directory_path() / "datalogindextest.wpilog";
+  std::error_code ec;
+  {
+    wpi::raw_fd_ostream os{path.string(), ec, fs::OF_None};
+    ASSERT_FALSE(ec);
+    os << wpi::span<const uint8_t>{output};
+  }
+  {
+    wpi::log::DataLogReader reader{
+        wpi::MemoryBuffer::GetFile(path.string(), ec)};
+    ASSERT_TRUE(reader.IsValid());
+    wpi::log::DataLogIndex index{reader};
+    index.IndexRecords();
+    auto even = index.FindEntry("/even");
+    ASSERT_TRUE(even);
+    ASSERT_EQ(even->records.size(), 10000u);
+    EXPECT_EQ(GetValue(index.GetRecord(even->records.back())), 19998);
+  }
+  fs::remove(path, ec);
+}
@@ -0,0 +1,170 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/DataLogStruct.h"  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "wpi/DataLog.h"
+#include "wpi/DataLogReader.h"
+#include "wpi/Endian.h"
+#include "wpi/MathExtras.h"
+#include "wpi/MemoryBuffer.h"
+
+using wpi::log::StructDescriptor;
+using wpi::log::StructFieldType;
+
+TEST(DataLogStructTest, Parse) {
+  auto desc =
+      StructDescriptor::Parse("double x; float32 y;int16 flags[3] ; char s[4]");
+  ASSERT_TRUE(desc);
+  EXPECT_EQ(desc->GetSize(), 8u + 4 + 6 + 4);
+  auto fields = desc->GetFields();
+  ASSERT_EQ(fields.size(), 4u);
+  EXPECT_EQ(fields[0].name, "x");
+  EXPECT_EQ(fields[0].type, StructFieldType::kDouble);
+  EXPECT_EQ(fields[0].offset, 0u);
+  EXPECT_EQ(fields[1].name, "y");
+  EXPECT_EQ(fields[1].type, StructFieldType::kFloat);
+  EXPECT_EQ(fields[1].offset, 8u);
+  EXPECT_EQ(fields[2].name, "flags");
+  EXPECT_EQ(fields[2].type, StructFieldType::kInt16);
+  EXPECT_EQ(fields[2].offset, 12u);
+  EXPECT_EQ(fields[2].size, 2u);
+  EXPECT_EQ(fields[2].count, 3u);
+  EXPECT_EQ(fields[3].offset, 18u);
+  EXPECT_EQ(desc->FindField("flags"), &fields[2]);
+  EXPECT_EQ(desc->FindField("z"), nullptr);
+}
+
+TEST(DataLogStructTest, ParseInvalid) {
+  EXPECT_FALSE(StructDescriptor::Parse(""));
+  EXPECT_FALSE(StructDescriptor::Parse("int x"));
+  EXPECT_FALSE(StructDescriptor::Parse("double"));
+  EXPECT_FALSE(StructDescriptor::Parse("double x; double x"));
+  EXPECT_FALSE(StructDescriptor::Parse("double x[0]"));
+  EXPECT_FALSE(StructDescriptor::Parse("double x[a]"));
+  EXPECT_FALSE(StructDescriptor::Parse("double x-y"));
+  EXPECT_FALSE(StructDescriptor::Parse("double x[2305843009213693952]"));
+  EXPECT_FALSE(
+      StructDescriptor::Parse("int64 a; double x[2305843009213693951]"));
+}
+
+TEST(DataLogStructTest, Fields) {
+  auto desc = StructDescriptor::Parse("int8 a; uint16 b; float64 c[2]");
+  ASSERT_TRUE(desc);
+  std::vector<uint8_t> data(desc->GetSize());
+  data[0] = 0xff;
+  wpi::support::endian::write16le(&data[1], 0xfffe);
+  wpi::support::endian::write64le(&data[3], wpi::DoubleToBits(1.5));
+  wpi::support::endian::write64le(&data[11], wpi::DoubleToBits(-2.0));
+
+  int64_t ival = 0;
+  double dval = 0;
+  bool bval = false;
+  ASSERT_TRUE(desc->FindField("a")->GetInteger(data, &ival));
+  EXPECT_EQ(ival, -1);
+  ASSERT_TRUE(desc->FindField("b")->GetInteger(data, &ival));
+  EXPECT_EQ(ival, 0xfffe);
+  ASSERT_TRUE(desc->FindField("b")->GetBoolean(data, &bval));
+  EXPECT_TRUE(bval);
+  ASSERT_TRUE(desc->FindField("c")->GetDouble(data, &dval, 1));
+  EXPECT_EQ(dval, -2.0);
+  ASSERT_TRUE(desc->FindField("c")->GetInteger(data, &ival));
+  EXPECT_EQ(ival, 1);
+  EXPECT_FALSE(desc->FindField("c")->GetDouble(data, &dval, 2));
+  EXPECT_FALSE(desc->FindField("c")->GetDouble(
+      wpi::span{data}.subspan(0, 10), &dval));
+}
+
+TEST(DataLogStructTest, FloatToInteger) {
+  auto desc = StructDescriptor::Parse("double d[4]");
+  ASSERT_TRUE(desc);
+  std::vector<uint8_t> data(desc->GetSize());
+  double values[] = {-2.5, std::numeric_limits<double>::quiet_NaN(), 1e19,
+                     -9223372036854775808.0};
+  for (size_t i = 0; i < 4; ++i) {
+    wpi::support::endian::write64le(&data[i * 8], wpi::DoubleToBits(values[i]));
+  }
+
+  auto field = desc->FindField("d");
+  int64_t ival = 0;
+  ASSERT_TRUE(field->GetInteger(data, &ival, 0));
+  EXPECT_EQ(ival, -2);
+  EXPECT_FALSE(field->GetInteger(data, &ival, 1));
+  EXPECT_FALSE(field->GetInteger(data, &ival, 2));
+  ASSERT_TRUE(field->GetInteger(data, &ival, 3));
+  EXPECT_EQ(ival, std::numeric_limits<int64_t>::min());
+}
+
+TEST(DataLogStructTest, RegistryKeepsFirst) {
+  wpi::log::StructRegistry registry;
+  EXPECT_TRUE(registry.Add({1, "/.schema/struct:A", "structschema", "int8 a"}));
+  EXPECT_FALSE(
+      registry.Add({2, "/.schema/struct:A", "structschema", "double b"}));
+  EXPECT_FALSE(registry.Add({3, "/a", "struct:A", ""}));
+  auto desc = registry.Find("struct:A");
+  ASSERT_TRUE(desc);
+  EXPECT_TRUE(desc->FindField("a"));
+  EXPECT_FALSE(desc->FindField("b"));
+}
+
+TEST(DataLogStructTest, RoundTrip) {
+  std::vector<uint8_t> output;
+  {
+    wpi::log::DataLog log{
+        [&](auto data) { output.insert(output.end(), data.begin(),
+                                       data.end()); },
+        1000.0};
+    wpi::log::StructLogEntry pose{log, "/pose", "Pose2d",
+                                  "double x; double y; char name[8]", 1};
+    // a second entry of the same struct shares the schema
+    wpi::log::StructLogEntry pose2{log, "/pose2", "Pose2d",
+                                   "double x; double y; char name[8]", 1};
+    for (int i = 0; i < 10; ++i) {
+      uint8_t data[24] = {};
+      wpi::support::endian::write64le(data, wpi::DoubleToBits(i * 1.0));
+      wpi::support::endian::write64le(data + 8, wpi::DoubleToBits(i * 2.0));
+      std::copy_n("robot", 5, data + 16);
+      pose.Append(data, 10 + i);
+    }
+  }
+
+  wpi::log::DataLogReader reader{wpi::MemoryBuffer::GetMemBufferCopy(output)};
+  ASSERT_TRUE(reader.IsValid());
+  wpi::log::StructRegistry registry;
+  const StructDescriptor* desc = nullptr;
+  int schemas = 0;
+  int count = 0;
+  for (auto&& record : reader) {
+    wpi::log::StartRecordData start;
+    if (record.GetStartData(&start)) {
+      if (registry.Add(start)) {
+        EXPECT_EQ(start.name, "/.schema/struct:Pose2d");
+        ++schemas;
+      } else if (start.name == "/pose") {
+        EXPECT_EQ(start.type, "struct:Pose2d");
+        desc = registry.Find(start.type);
+        ASSERT_TRUE(desc);
+      }
+    } else if (!record.IsControl() && desc) {
+      double x = 0;
+      double y = 0;
+      std::string_view name;
+      ASSERT_TRUE(desc->FindField("x")->GetDouble(record.GetRaw(), &x));
+      ASSERT_TRUE(desc->FindField("y")->GetDouble(record.GetRaw(), &y));
+      ASSERT_TRUE(desc->FindField("name")->GetString(record.GetRaw(), &name));
+      EXPECT_EQ(x, count * 1.0);
+      EXPECT_EQ(y, count * 2.0);
+      EXPECT_EQ(name, "robot");
+      ++count;
+    }
+  }
+  EXPECT_EQ(schemas, 1);
+  EXPECT_EQ(count, 10);
+}
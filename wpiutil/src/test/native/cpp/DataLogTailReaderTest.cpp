@@ -0,0 +1,123 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/DataLogTailReader.h"  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "wpi/DataLog.h"
+#include "wpi/fs.h"
+
+namespace {
+class DataLogTailReaderTest : public ::testing::Test {
+ protected:
+  DataLogTailReaderTest() {
+    std::error_code ec;
+    fs::remove(path, ec);
+  }
+
+  ~DataLogTailReaderTest() override {
+    std::error_code ec;
+    fs::remove(path, ec);
+  }
+
+  // generates a log with 10000 integer records, with values 0 to 9999
+  std::vector<uint8_t> MakeLog(bool compressed) {
+    std::vector<uint8_t> output;
+    {
+      wpi::log::DataLog log{[&](auto data) {
+                              output.insert(output.end(), data.begin(),
+                                            data.end());
+                            },
+                            1000.0, "extra", compressed};
+      int entry = log.Start("/value", "int64", "", 1);
+      for (int i = 0; i < 10000; ++i) {
+        log.AppendInteger(entry, i, i + 1);
+        if (i % 1000 == 0) {
+          log.Flush();
+        }
+      }
+    }
+    return output;
+  }
+
+  // appends pieces of a log of increasing size (which don't end on record
+  // boundaries), reading after each, and returns the values read
+  std::vector<int64_t> Follow(const std::vector<uint8_t>& data) {
+    std::ofstream os{path, std::ios::binary};
+    std::error_code ec;
+    wpi::log::DataLogTailReader reader{path.string(), ec};
+    EXPECT_FALSE(ec);
+    std::vector<int64_t> values;
+    size_t pos = 0;
+    for (size_t size = 5; pos < data.size(); size = size * 3 / 2) {
+      size = (std::min)(size, data.size() - pos);
+      os.write(reinterpret_cast<const char*>(data.data() + pos), size);
+      os.flush();
+      pos += size;
+      for (auto&& record : reader.Read()) {
+        int64_t value;
+        if (!record.IsControl() && record.GetInteger(&value)) {
+          values.push_back(value);
+        }
+      }
+      EXPECT_TRUE(reader.IsValid());
+    }
+    EXPECT_TRUE(reader.HasHeader());
+    EXPECT_EQ(reader.GetExtraHeader(), "extra");
+    return values;
+  }
+
+  fs::path path = fs::temp_directory_path() / "datalogtailreadertest.wpilog";
+};
+}  // namespace
+
+TEST_F(DataLogTailReaderTest, Follow) {
+  auto values = Follow(MakeLog(false));
+  ASSERT_EQ(values.size(), 10000u);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(values[i], static_cast<int64_t>(i));
+  }
+}
+
+TEST_F(DataLogTailReaderTest, FollowCompressed) {
+  auto values = Follow(MakeLog(true));
+  ASSERT_EQ(values.size(), 10000u);
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(values[i], static_cast<int64_t>(i));
+  }
+}
+
+TEST_F(DataLogTailReaderTest, Wait) {
+  std::ofstream os{path, std::ios::binary};
+  std::error_code ec;
+  wpi::log::DataLogTailReader reader{path.string(), ec};
+  ASSERT_FALSE(ec);
+  EXPECT_TRUE(reader.Wait(0.01, 0.001).empty());
+  EXPECT_TRUE(reader.IsValid());
+  EXPECT_FALSE(reader.HasHeader());
+  EXPECT_EQ(reader.GetVersion(), 0);
+}
+
+TEST_F(DataLogTailReaderTest, Invalid) {
+  std::error_code ec;
+  {
+    wpi::log::DataLogTailReader reader{path.string(), ec};
+    EXPECT_TRUE(ec);
+    EXPECT_FALSE(reader.IsValid());
+  }
+
+  std::ofstream os{path, std::ios::binary};
+  os << "NOT A DATA LOG";
+  os.flush();
+  ec.clear();
+  wpi::log::DataLogTailReader reader{path.string(), ec};
+  ASSERT_FALSE(ec);
+  EXPECT_TRUE(reader.Read().empty());
+  EXPECT_FALSE(reader.IsValid());
+}
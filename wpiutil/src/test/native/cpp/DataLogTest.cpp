@@ -0,0 +1,530 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/DataLog.h"  // NOLINT(build/include_order)
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "wpi/DataLogReader.h"
+#include "wpi/DenseMap.h"
+#include "wpi/fs.h"
+
+namespace {
+class DataLogTest : public ::testing::Test {
+ protected:
+  // only flushes when requested or on destruction
+  std::unique_ptr<wpi::log::DataLog> MakeLog() {
+    return std::make_unique<wpi::log::DataLog>(
+        [this](auto data) { output.insert(output.end(), data.begin(),
+                                          data.end()); },
+        1000.0);
+  }
+
+  // like MakeLog(), but writes wait until stalled is cleared, as if the disk
+  // has stalled
+  std::unique_ptr<wpi::log::DataLog> MakeStalledLog() {
+    return std::make_unique<wpi::log::DataLog>(
+        [this](auto data) {
+          while (stalled) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+          output.insert(output.end(), data.begin(), data.end());
+        },
+        1000.0);
+  }
+
+  // returns the last value of each integer entry, by name
+  wpi::StringMap<int64_t> GetLastValues() {
+    auto reader = GetReader();
+    wpi::DenseMap<int, std::string> names;
+    wpi::StringMap<int64_t> values;
+    for (auto&& record : reader) {
+      wpi::log::StartRecordData data;
+      int64_t value;
+      if (record.GetStartData(&data)) {
+        names[data.entry] = data.name;
+      } else if (!record.IsControl() && record.GetInteger(&value)) {
+        values[names[record.GetEntry()]] = value;
+      }
+    }
+    return values;
+  }
+
+  wpi::log::DataLogReader GetReader() {
+    return wpi::log::DataLogReader{wpi::MemoryBuffer::GetMemBufferCopy(output)};
+  }
+
+  std::vector<uint8_t> output;
+  std::atomic_bool stalled{true};
+};
+}  // namespace
+
+TEST_F(DataLogTest, MultipleThreadsMergedByTimestamp) {
+  static constexpr int kNumThreads = 4;
+  static constexpr int kNumRecords = 1000;
+  {
+    auto log = MakeLog();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back([&, i] {
+        wpi::log::IntegerLogEntry entry{*log, fmt::format("/thread{}", i), 1};
+        for (int j = 0; j < kNumRecords; ++j) {
+          entry.Append(i, 2 + j * kNumThreads + i);
+        }
+      });
+    }
+    for (auto&& thread : threads) {
+      thread.join();
+    }
+  }
+
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  wpi::DenseMap<int, int> threadForEntry;
+  int64_t lastTimestamp = 0;
+  int count = 0;
+  for (auto&& record : reader) {
+    if (record.IsStart()) {
+      wpi::log::StartRecordData data;
+      ASSERT_TRUE(record.GetStartData(&data));
+      threadForEntry[data.entry] = data.name.back() - '0';
+    } else if (!record.IsControl()) {
+      auto it = threadForEntry.find(record.GetEntry());
+      ASSERT_NE(it, threadForEntry.end()) << "data before start";
+      int64_t value;
+      ASSERT_TRUE(record.GetInteger(&value));
+      EXPECT_EQ(value, it->second);
+      EXPECT_GT(record.GetTimestamp(), lastTimestamp);
+      lastTimestamp = record.GetTimestamp();
+      ++count;
+    }
+  }
+  EXPECT_EQ(count, kNumThreads * kNumRecords);
+}
+
+TEST_F(DataLogTest, StartBeforeEarlierData) {
+  {
+    auto log = MakeLog();
+    // the start record is stamped with the current time
+    wpi::log::DoubleLogEntry entry{*log, "/value", "initial"};
+    std::thread thread{[&] {
+      entry.Append(1.5, 1);
+      entry.SetMetadata("changed", 2);
+    }};
+    thread.join();
+  }
+
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  std::vector<std::string> kinds;
+  for (auto&& record : reader) {
+    if (record.IsStart()) {
+      kinds.emplace_back("start");
+    } else if (record.IsSetMetadata()) {
+      wpi::log::MetadataRecordData data;
+      ASSERT_TRUE(record.GetSetMetadataData(&data));
+      EXPECT_EQ(data.metadata, "changed");
+      kinds.emplace_back("metadata");
+    } else if (!record.IsControl()) {
+      kinds.emplace_back("data");
+    }
+  }
+  EXPECT_EQ(kinds, (std::vector<std::string>{"start", "data", "metadata"}));
+}
+
+TEST_F(DataLogTest, RecordsSpanningBlocks) {
+  std::vector<uint8_t> large(40000);
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = i * 7;
+  }
+  {
+    auto log = MakeLog();
+    wpi::log::RawLogEntry entry{*log, "/raw", 1};
+    for (int i = 0; i < 3; ++i) {
+      entry.Append({large.data(), large.size() - i * 1000}, 10 + i);
+      entry.Append({large.data(), 100}, 20 + i);
+      log->Flush();
+    }
+  }
+
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  std::vector<size_t> sizes;
+  for (auto&& record : reader) {
+    if (!record.IsControl()) {
+      auto data = record.GetRaw();
+      ASSERT_TRUE(std::equal(data.begin(), data.end(), large.begin()));
+      sizes.push_back(data.size());
+    }
+  }
+  EXPECT_EQ(sizes, (std::vector<size_t>{40000, 100, 39000, 100, 38000, 100}));
+}
+
+TEST_F(DataLogTest, ThreadExit) {
+  {
+    auto log = MakeLog();
+    wpi::log::IntegerLogEntry entry{*log, "/value", 1};
+    for (int i = 0; i < 3; ++i) {
+      std::thread{[&] { entry.Append(i, 10 + i); }}.join();
+      log->Flush();
+    }
+    entry.Append(3, 13);
+  }
+
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  std::vector<int64_t> values;
+  for (auto&& record : reader) {
+    int64_t value;
+    if (!record.IsControl() && record.GetInteger(&value)) {
+      values.push_back(value);
+    }
+  }
+  EXPECT_EQ(values, (std::vector<int64_t>{0, 1, 2, 3}));
+}
+
+TEST_F(DataLogTest, Compressed) {
+  std::vector<uint8_t> large(100000);
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = i * 7;
+  }
+  {
+    auto log = std::make_unique<wpi::log::DataLog>(
+        [this](auto data) { output.insert(output.end(), data.begin(),
+                                          data.end()); },
+        1000.0, "extra", true);
+    wpi::log::IntegerLogEntry entry{*log, "/value", 1};
+    wpi::log::RawLogEntry raw{*log, "/raw", 1};
+    for (int i = 0; i < 20000; ++i) {
+      entry.Append(i, 10 + i);
+    }
+    log->Flush();
+    raw.Append(large, 30000);
+    entry.Append(20000, 30001);
+  }
+
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  EXPECT_TRUE(reader.IsCompressed());
+  EXPECT_EQ(reader.GetExtraHeader(), "extra");
+  int64_t count = 0;
+  for (auto&& record : reader) {
+    int64_t value;
+    if (record.IsControl()) {
+      continue;
+    } else if (record.GetInteger(&value)) {
+      EXPECT_EQ(value, count);
+      ++count;
+    } else {
+      EXPECT_EQ(record.GetRaw().size(), large.size());
+    }
+  }
+  EXPECT_EQ(count, 20001);
+}
+
+TEST_F(DataLogTest, CompressedTruncated) {
+  {
+    auto log = std::make_unique<wpi::log::DataLog>(
+        [this](auto data) { output.insert(output.end(), data.begin(),
+                                          data.end()); },
+        1000.0, "", true);
+    wpi::log::IntegerLogEntry entry{*log, "/value", 1};
+    for (int i = 0; i < 20000; ++i) {
+      entry.Append(i, 10 + i);
+    }
+  }
+  size_t fullSize = output.size();
+
+  // drop part of the last frame, as if the robot lost power while writing
+  output.resize(output.size() - 10);
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  int64_t count = 0;
+  for (auto&& record : reader) {
+    int64_t value;
+    if (!record.IsControl() && record.GetInteger(&value)) {
+      EXPECT_EQ(value, count);
+      ++count;
+    }
+  }
+  // only the records of the last frame are lost
+  EXPECT_GT(count, 0);
+  EXPECT_LT(count, 20000);
+  EXPECT_LT(fullSize, output.size() + 10 + 64 * 1024);
+}
+
+TEST_F(DataLogTest, MemoryLimitDrop) {
+  uint64_t dropped;
+  {
+    auto log = MakeStalledLog();
+    log->SetMemoryLimit(64 * 1024);
+    int entry = log->Start("/value", "int64", "", 1);
+    for (int i = 0; i < 20000; ++i) {
+      log->AppendInteger(entry, i, 10 + i);
+    }
+    dropped = log->GetDroppedCount(entry);
+    stalled = false;
+  }
+
+  EXPECT_GT(dropped, 0u);
+  EXPECT_LT(dropped, 20000u);
+  auto values = GetLastValues();
+  EXPECT_EQ(values["DataLog/dropped/value"], static_cast<int64_t>(dropped));
+  // later records are the ones dropped
+  EXPECT_EQ(values["/value"], 20000 - static_cast<int64_t>(dropped) - 1);
+}
+
+TEST_F(DataLogTest, MemoryLimitDropLowPriority) {
+  wpi::DenseMap<int, uint64_t> dropped;
+  int low;
+  int high;
+  {
+    auto log = MakeStalledLog();
+    log->SetMemoryLimit(256 * 1024,
+                        wpi::log::DataLog::LimitPolicy::kDropLowPriority);
+    low = log->Start("/low", "int64", "", 1);
+    high = log->Start("/high", "int64", "", 1);
+    log->SetLowPriority(low);
+    // about 180 KB of records
+    for (int i = 0; i < 5000; ++i) {
+      log->AppendInteger(low, i, 10 + 2 * i);
+      log->AppendInteger(high, i, 11 + 2 * i);
+    }
+    dropped[low] = log->GetDroppedCount(low);
+    dropped[high] = log->GetDroppedCount(high);
+    stalled = false;
+  }
+
+  EXPECT_GT(dropped[low], 0u);
+  EXPECT_EQ(dropped[high], 0u);
+  auto values = GetLastValues();
+  EXPECT_EQ(values["/high"], 4999);
+}
+
+TEST_F(DataLogTest, MemoryLimitBlock) {
+  {
+    auto log = MakeStalledLog();
+    log->SetMemoryLimit(64 * 1024, wpi::log::DataLog::LimitPolicy::kBlock);
+    int entry = log->Start("/value", "int64", "", 1);
+    std::atomic_bool done{false};
+    std::thread thread{[&] {
+      for (int i = 0; i < 20000; ++i) {
+        log->AppendInteger(entry, i, 10 + i);
+      }
+      done = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(done);
+    stalled = false;
+    thread.join();
+    EXPECT_EQ(log->GetDroppedCount(entry), 0u);
+  }
+
+  auto values = GetLastValues();
+  EXPECT_EQ(values["/value"], 19999);
+  EXPECT_EQ(values.count("DataLog/dropped/value"), 0u);
+}
+
+TEST_F(DataLogTest, MemoryLimitBlockOversized) {
+  {
+    auto log = MakeLog();
+    log->SetMemoryLimit(64 * 1024, wpi::log::DataLog::LimitPolicy::kBlock);
+    int entry = log->Start("/raw", "raw", "", 1);
+    std::vector<uint8_t> data(100 * 1024, 0x55);
+    std::atomic_bool done{false};
+    std::thread thread{[&] {
+      log->AppendRaw(entry, data, 2);
+      done = true;
+    }};
+    for (int i = 0; i < 200 && !done; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(done);
+    thread.join();
+  }
+
+  auto reader = GetReader();
+  bool found = false;
+  for (auto&& record : reader) {
+    if (!record.IsControl() && record.GetSize() == 100 * 1024) {
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+// Blocks cached by a thread that has gone idle must not count against the
+// limit for other threads
+class DataLogIdleThreadTest : public DataLogTest {
+ protected:
+  // appends about 60 KB and then 20 KB from another thread, each written out
+  // before the next, so the thread is left with cached blocks; the thread is
+  // kept alive until idleDone is set
+  std::thread StartIdleThread(wpi::log::DataLog& log, int entry) {
+    std::atomic_int flushed{0};
+    std::thread thread{[&, entry] {
+      for (int count : {3600, 1200}) {
+        for (int i = 0; i < count; ++i) {
+          log.AppendDouble(entry, i, 2 + i);
+        }
+        log.Flush();
+        ++flushed;
+        // let the writer thread write it out
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+      ++flushed;
+      while (!idleDone) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }};
+    while (flushed != 3) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return thread;
+  }
+
+  std::atomic_bool idleDone{false};
+};
+
+TEST_F(DataLogIdleThreadTest, Block) {
+  auto log = MakeLog();
+  log->SetMemoryLimit(64 * 1024, wpi::log::DataLog::LimitPolicy::kBlock);
+  int idle = log->Start("/idle", "double", "", 1);
+  int entry = log->Start("/value", "double", "", 1);
+  auto idleThread = StartIdleThread(*log, idle);
+
+  std::atomic_bool done{false};
+  std::thread thread{[&] {
+    for (int i = 0; i < 3000; ++i) {
+      log->AppendDouble(entry, i, 10000 + i);
+    }
+    done = true;
+  }};
+  for (int i = 0; i < 200 && !done; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(done);
+  thread.join();
+  idleDone = true;
+  idleThread.join();
+}
+
+TEST_F(DataLogIdleThreadTest, Drop) {
+  uint64_t dropped;
+  {
+    stalled = false;
+    auto log = MakeStalledLog();
+    log->SetMemoryLimit(64 * 1024);
+    int idle = log->Start("/idle", "double", "", 1);
+    int entry = log->Start("/value", "double", "", 1);
+    auto idleThread = StartIdleThread(*log, idle);
+
+    // about 25 KB while the disk is stalled; fits in the limit along with
+    // the (empty) buffers of the other threads
+    stalled = true;
+    std::thread thread{[&] {
+      for (int i = 0; i < 1500; ++i) {
+        log->AppendDouble(entry, i, 10000 + i);
+      }
+    }};
+    thread.join();
+    dropped = log->GetDroppedCount(entry);
+    idleDone = true;
+    idleThread.join();
+    stalled = false;
+  }
+  EXPECT_EQ(dropped, 0u);
+}
+
+TEST_F(DataLogTest, MinFreeSpace) {
+  auto dir = fs::temp_directory_path();
+  std::error_code ec;
+  fs::remove(dir / "datalogtest_freespace.wpilog", ec);
+  {
+    wpi::log::DataLog log{dir.string(), "datalogtest_freespace.wpilog", 1000.0};
+    // more than any disk has free
+    log.SetMinFreeSpace(UINTMAX_MAX);
+    int entry = log.Start("/value", "int64", "", 1);
+    for (int i = 0; i < 100; ++i) {
+      log.AppendInteger(entry, i, 10 + i);
+    }
+    log.Flush();
+    for (int i = 0; i < 100 && log.GetDroppedCount(entry) != 100; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(log.GetDroppedCount(entry), 100u);
+  }
+
+  std::ifstream is{dir / "datalogtest_freespace.wpilog", std::ios::binary};
+  output.assign(std::istreambuf_iterator<char>{is}, {});
+  is.close();
+  fs::remove(dir / "datalogtest_freespace.wpilog", ec);
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  int starts = 0;
+  int data = 0;
+  for (auto&& record : reader) {
+    if (record.IsStart()) {
+      ++starts;
+    } else if (!record.IsControl()) {
+      ++data;
+    }
+  }
+  // the entry and its dropped count entry
+  EXPECT_EQ(starts, 2);
+  // only the dropped count
+  EXPECT_EQ(data, 1);
+}
+
+TEST_F(DataLogTest, Batch) {
+  {
+    auto log = MakeLog();
+    int a = log->Start("/a", "int64", "", 1);
+    int b = log->Start("/b", "double", "", 1);
+    int c = log->Start("/c", "boolean", "", 1);
+    for (int i = 0; i < 10; ++i) {
+      wpi::log::DataLogBatch batch{*log, 10 + i};
+      EXPECT_EQ(batch.GetTimestamp(), 10 + i);
+      batch.AppendInteger(a, i);
+      batch.AppendDouble(b, i * 0.5);
+      batch.AppendBoolean(c, i % 2 == 0);
+      batch.AppendInteger(0, i);  // invalid entry, ignored
+    }
+  }
+
+  auto reader = GetReader();
+  ASSERT_TRUE(reader.IsValid());
+  int count = 0;
+  for (auto&& record : reader) {
+    if (record.IsControl()) {
+      continue;
+    }
+    int i = count / 3;
+    EXPECT_EQ(record.GetTimestamp(), 10 + i);
+    if (record.GetEntry() == 1) {
+      int64_t value;
+      ASSERT_TRUE(record.GetInteger(&value));
+      EXPECT_EQ(value, i);
+    } else if (record.GetEntry() == 2) {
+      double value;
+      ASSERT_TRUE(record.GetDouble(&value));
+      EXPECT_EQ(value, i * 0.5);
+    } else {
+      bool value;
+      ASSERT_TRUE(record.GetBoolean(&value));
+      EXPECT_EQ(value, i % 2 == 0);
+    }
+    ++count;
+  }
+  EXPECT_EQ(count, 30);
+}
@@ -0,0 +1,95 @@
+// Copyright (c) FIRST and other WPILib contributors.
+// Open Source Software; you can modify and/or share it under the terms of
+// the WPILib BSD license file in the root directory of this project.
+
+#include "wpi/lz4.h"  // NOLINT(build/include_order)
+
+#include <algorithm>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+std::vector<uint8_t> Compress(wpi::span<const uint8_t> in) {
+  std::vector<uint8_t> out(wpi::LZ4CompressBound(in.size()));
+  out.resize(wpi::LZ4Compress(in, out));
+  return out;
+}
+
+void CheckRoundTrip(wpi::span<const uint8_t> in) {
+  auto compressed = Compress(in);
+  std::vector<uint8_t> out(in.size());
+  ASSERT_TRUE(wpi::LZ4Decompress(compressed, out));
+  EXPECT_TRUE(std::equal(in.begin(), in.end(), out.begin()));
+}
+}  // namespace
+
+TEST(LZ4Test, Empty) {
+  CheckRoundTrip({});
+}
+
+TEST(LZ4Test, Short) {
+  std::vector<uint8_t> in;
+  for (int i = 0; i < 20; ++i) {
+    in.push_back('a');
+    CheckRoundTrip(in);
+  }
+}
+
+TEST(LZ4Test, Compressible) {
+  std::vector<uint8_t> in;
+  for (int i = 0; i < 100000; ++i) {
+    in.push_back(i % 7);
+    in.push_back((i / 100) & 0xff);
+  }
+  CheckRoundTrip(in);
+  EXPECT_LT(Compress(in).size(), in.size() / 10);
+
+  // long run of a single byte (overlapping matches)
+  CheckRoundTrip(std::vector<uint8_t>(70000, 0));
+}
+
+TEST(LZ4Test, Incompressible) {
+  std::mt19937 gen{1234};
+  std::vector<uint8_t> in(70000);
+  for (auto&& b : in) {
+    b = gen();
+  }
+  CheckRoundTrip(in);
+  EXPECT_LE(Compress(in).size(), wpi::LZ4CompressBound(in.size()));
+}
+
+// a block encoded by hand from the format description
+TEST(LZ4Test, DecompressReference) {
+  const uint8_t in[] = {0x35, 'a', 'b', 'c', 0x03, 0x00,
+                        0x50, 'x', 'y', 'z', 'w', 'v'};
+  std::vector<uint8_t> out(17);
+  ASSERT_TRUE(wpi::LZ4Decompress(in, out));
+  EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(out.data()),
+                             out.size()),
+            "abcabcabcabcxyzwv");
+}
+
+TEST(LZ4Test, DecompressMalformed) {
+  std::vector<uint8_t> out(17);
+  // offset before start of output
+  const uint8_t badOffset[] = {0x35, 'a', 'b', 'c', 0x04, 0x00,
+                               0x50, 'x', 'y', 'z', 'w', 'v'};
+  EXPECT_FALSE(wpi::LZ4Decompress(badOffset, out));
+  // truncated
+  const uint8_t truncated[] = {0x35, 'a', 'b', 'c', 0x03};
+  EXPECT_FALSE(wpi::LZ4Decompress(truncated, out));
+  // literals past end of input
+  const uint8_t longLiterals[] = {0xf0, 0x10, 'a'};
+  EXPECT_FALSE(wpi::LZ4Decompress(longLiterals, out));
+  // output too small
+  const uint8_t valid[] = {0x35, 'a', 'b', 'c', 0x03, 0x00,
+                           0x50, 'x', 'y', 'z', 'w', 'v'};
+  std::vector<uint8_t> small(16);
+  EXPECT_FALSE(wpi::LZ4Decompress(valid, small));
+  // output too large
+  std::vector<uint8_t> large(18);
+  EXPECT_FALSE(wpi::LZ4Decompress(valid, large));
+}